@@ -113,6 +113,23 @@ PyAPI_FUNC(const char *) PyEval_GetFuncDesc(PyObject *);
 PyAPI_FUNC(PyObject *) PyEval_GetCallStats(PyObject *);
 PyAPI_FUNC(PyObject *) PyEval_EvalFrame(struct _frame *);
 PyAPI_FUNC(PyObject *) PyEval_EvalFrameEx(struct _frame *f, int exc);
+#ifndef Py_LIMITED_API
+PyAPI_FUNC(PyObject *) _PyEval_EvalFrameDefault(struct _frame *f, int exc);
+
+/* Reserve a slot of the co_extra scratch space of all the code objects
+   (see _PyCode_SetExtra()), whose data will be released with free.
+   Return its index, or -1 if all the slots are taken. */
+PyAPI_FUNC(Py_ssize_t) _PyEval_RequestCodeExtraIndex(freefunc free);
+
+/* Opcode statistics, see sys._stats_on() */
+PyAPI_FUNC(int) _PyEval_StatsOn(void);
+PyAPI_FUNC(void) _PyEval_StatsOff(void);
+PyAPI_FUNC(void) _PyEval_StatsClear(void);
+PyAPI_FUNC(PyObject *) _PyEval_GetStats(void);
+
+/* Sentinel returned by monitoring callbacks, see sys.setmonitor() */
+PyAPI_FUNC(PyObject *) _PyEval_GetMonitorDisable(void);
+#endif
 
 /* Interface for threads.
 
@@ -176,6 +193,12 @@ PyAPI_FUNC(void) PyEval_ReInitThreads(void);
 #ifndef Py_LIMITED_API
 PyAPI_FUNC(void) _PyEval_SetSwitchInterval(unsigned long microseconds);
 PyAPI_FUNC(unsigned long) _PyEval_GetSwitchInterval(void);
+
+/* Thread switch policies */
+#define _Py_SWITCH_INTERVAL 0   /* waiters ask for the GIL after the interval */
+#define _Py_SWITCH_IO 1         /* threads back from blocking calls ask first */
+PyAPI_FUNC(void) _PyEval_SetSwitchPolicy(int policy);
+PyAPI_FUNC(int) _PyEval_GetSwitchPolicy(void);
 #endif
 
 #define Py_BEGIN_ALLOW_THREADS { \
@@ -7,6 +7,71 @@
 extern "C" {
 #endif
 
+/* Every instruction is one code unit: the opcode in its first byte and an
+   8-bit argument in the second, whatever the byte order of the platform.
+   Larger arguments are built by EXTENDED_ARG prefixes, each contributing
+   the next 8 more significant bits. */
+typedef unsigned short _Py_CODEUNIT;
+
+#ifdef WORDS_BIGENDIAN
+#  define _Py_OPCODE(word) ((word) >> 8)
+#  define _Py_OPARG(word) ((word) & 255)
+#  define _Py_MAKECODEUNIT(opcode, oparg) \
+    ((_Py_CODEUNIT)(((opcode) << 8) | (oparg)))
+#else
+#  define _Py_OPCODE(word) ((word) & 255)
+#  define _Py_OPARG(word) ((word) >> 8)
+#  define _Py_MAKECODEUNIT(opcode, oparg) \
+    ((_Py_CODEUNIT)(((oparg) << 8) | (opcode)))
+#endif
+
+/* Per-instruction inline caches.  Each cached instruction owns one
+   _PyOpcache entry; the union holds the opcode-specific payload. */
+
+typedef struct {
+    PyObject *ptr;              /* Cached pointer (borrowed reference) */
+    PY_UINT64_T globals_ver;    /* ma_version_tag of the globals dict */
+    PY_UINT64_T builtins_ver;   /* ma_version_tag of the builtins dict */
+} _PyOpcache_LoadGlobal;
+
+typedef struct {
+    unsigned int tp_version_tag;    /* tp_version_tag of the owner's type */
+    PyDictKeysObject *keys;     /* keys of the split __dict__; only
+                                   compared, never dereferenced */
+    Py_ssize_t index;           /* index of the attribute in keys */
+    unsigned char misses;       /* number of times the cache was refilled */
+} _PyOpcache_Attr;
+
+typedef struct {
+    union {
+        _PyOpcache_LoadGlobal lg;
+        _PyOpcache_Attr attr;   /* LOAD_ATTR and STORE_ATTR */
+    } u;
+    char optimized;             /* non-zero once the entry is filled in */
+} _PyOpcache;
+
+/* Per-code object monitoring, set by sys.setmonitor().  Only the frames of
+   a code object which has one leave the computed-goto fast path of the eval
+   loop to report its events; other code runs at full speed. */
+
+#define _PyMonitor_CALL     0x01
+#define _PyMonitor_RETURN   0x02
+#define _PyMonitor_LINE     0x04
+#define _PyMonitor_BRANCH   0x08
+
+/* Bits of _PyCodeMonitor.flags */
+#define _PyMonitor_LINE_START       0x01    /* first instruction of a line */
+#define _PyMonitor_NO_LINE          0x02    /* line event disabled */
+#define _PyMonitor_NO_FALLTHROUGH   0x04    /* branch not taken disabled */
+#define _PyMonitor_NO_JUMP          0x08    /* branch taken disabled */
+
+typedef struct {
+    int events;                 /* _PyMonitor_... event bits */
+    PyObject *callback;
+    int *lines;                 /* line number of each code unit */
+    unsigned char *flags;       /* _PyMonitor_... flags of each code unit */
+} _PyCodeMonitor;
+
 /* Bytecode object */
 typedef struct {
     PyObject_HEAD
@@ -35,6 +100,48 @@ typedef struct {
 				   Objects/lnotab_notes.txt for details. */
     void *co_zombieframe;     /* for optimization only (see frameobject.c) */
     PyObject *co_weakreflist;   /* to support weakrefs to code objects */
+
+    /* Inline caches, allocated by _PyCode_InitOpcache() once the code
+       object has been run often enough.  To keep the map small, it holds
+       one byte per code unit:
+
+           cache = &co_opcache[co_opcache_map[offset / 2] - 1]
+
+       where a zero byte means the instruction at offset is not cached. */
+    unsigned char *co_opcache_map;
+    _PyOpcache *co_opcache;
+    int co_opcache_flag;        /* number of runs before caching kicks in */
+    unsigned char co_opcache_size;  /* length of co_opcache */
+
+    /* Quickened copy of co_code, allocated by _PyCode_Quicken() together
+       with the caches.  It has the same layout as co_code, but the eval
+       loop rewrites some of its instructions into type-specialized forms.
+       co_quickened_counters holds one backoff counter per code unit for
+       the instructions that may be specialized. */
+    _Py_CODEUNIT *co_quickened;
+    unsigned char *co_quickened_counters;
+
+    /* Blocks of the try, with and loop statements that are not in the
+       code of an exception handler.  Instead of being set up and popped
+       at run time on the block stack, they are only looked up here when
+       an exception (or a return, break or continue) unwinds the frame.
+       See _PyCode_FindBlock(). */
+    PyObject *co_exceptiontable;
+
+    /* Scratch space for the users of the frame evaluation hook in
+       PyInterpreterState.eval_frame, e.g. the machine code a JIT compiler
+       generated for this code object.  Each user gets its own slot from
+       _PyEval_RequestCodeExtraIndex() and goes through _PyCode_GetExtra()
+       and _PyCode_SetExtra(); NULL until one of them stores something.
+       The interpreter itself never looks at it. */
+    void *co_extra;
+
+    /* Execution counts of this code object, allocated by the eval loop
+       while sys._stats_on() is in effect.  See Python/ceval.c. */
+    struct _PyCodeStats *co_stats;
+
+    /* Events reported for this code object, see _PyCode_SetMonitor() */
+    _PyCodeMonitor *co_monitor;
 } PyCodeObject;
 
 /* Masks for co_flags above */
@@ -116,9 +223,75 @@ PyAPI_FUNC(int) _PyCode_CheckLineNumber(PyCodeObject* co,
                                         int lasti, PyAddrPair *bounds);
 #endif
 
+#ifndef Py_LIMITED_API
+/* A block of co_exceptiontable.  The instructions at offsets start to
+   end - 1 run as if a SETUP_LOOP, SETUP_EXCEPT or SETUP_FINALLY
+   instruction (type) had pushed a block with the given handler and value
+   stack level on the block stack.  Blocks are sorted by start, and an
+   enclosing block comes before the blocks it contains. */
+typedef struct {
+    int cb_start;
+    int cb_end;
+    int cb_type;
+    int cb_handler;
+    int cb_level;
+} _PyCodeBlock;
+
+/* Build the bytes object for co_exceptiontable from n blocks. */
+PyAPI_FUNC(PyObject *) _PyCode_MakeExceptionTable(const _PyCodeBlock *, int n);
+
+/* Store the next block of co_exceptiontable, starting from *pos (0 for the
+   first one), in *block and return 1; return 0 after the last one. */
+PyAPI_FUNC(int) _PyCode_NextBlock(PyCodeObject *co, Py_ssize_t *pos,
+                                  _PyCodeBlock *block);
+
+/* Find the innermost block of co_exceptiontable that contains the
+   instruction at offset, among its first limit blocks (all of them if
+   limit is -1).  Return its index and store it in *block, or return -1 if
+   there is none. */
+PyAPI_FUNC(int) _PyCode_FindBlock(PyCodeObject *co, int offset, int limit,
+                                  _PyCodeBlock *block);
+
+/* Allocate the inline caches of a code object; return -1 on error. */
+PyAPI_FUNC(int) _PyCode_InitOpcache(PyCodeObject *co);
+
+/* Allocate the quickened copy of the bytecode; return -1 on error. */
+PyAPI_FUNC(int) _PyCode_Quicken(PyCodeObject *co);
+
+/* Report the _PyMonitor_... events of the frames of a code object to
+   callback, or stop reporting them if events is 0; return -1 on error.
+   Like settrace(), the callback is called as callback(frame, event, arg). */
+PyAPI_FUNC(int) _PyCode_SetMonitor(PyCodeObject *co, int events,
+                                   PyObject *callback);
+
+/* Release the co_stats of a code object.  Defined in Python/ceval.c. */
+PyAPI_FUNC(void) _PyEval_FreeCodeStats(PyCodeObject *co);
+
+/* Store in *extra the scratch data of the user of co_extra with the given
+   index (see _PyEval_RequestCodeExtraIndex()), or NULL if it has stored
+   none; return -1 with an exception set on a bad argument. */
+PyAPI_FUNC(int) _PyCode_GetExtra(PyObject *code, Py_ssize_t index,
+                                 void **extra);
+
+/* Set the scratch data of the user of co_extra with the given index.  The
+   previous data, if any, and the data left when the code object is
+   deallocated are released with the free function of the user.  Return -1
+   with an exception set on error. */
+PyAPI_FUNC(int) _PyCode_SetExtra(PyObject *code, Py_ssize_t index,
+                                 void *extra);
+#endif
+
 PyAPI_FUNC(PyObject*) PyCode_Optimize(PyObject *code, PyObject* consts,
                                       PyObject *names, PyObject *lineno_obj);
 
+#ifndef Py_LIMITED_API
+/* Same as PyCode_Optimize(), which also moves the nblocks blocks of the
+   exception table along with the instructions. */
+PyAPI_FUNC(PyObject*) _PyCode_Optimize(PyObject *code, PyObject* consts,
+                                       PyObject *names, PyObject *lineno_obj,
+                                       _PyCodeBlock *blocks, int nblocks);
+#endif
+
 #ifdef __cplusplus
 }
 #endif
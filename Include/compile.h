@@ -52,6 +52,9 @@ PyAPI_FUNC(PyFutureFeatures *) PyFuture_FromASTObject(
     PyObject *filename
     );
 
+/* Constant folding and dead code removal, in ast_opt.c */
+PyAPI_FUNC(int) _PyAST_Optimize(struct _mod *mod, PyArena *arena, int optimize);
+
 /* _Py_Mangle is defined in compile.c */
 PyAPI_FUNC(PyObject*) _Py_Mangle(PyObject *p, PyObject *name);
 
@@ -23,6 +23,11 @@ typedef struct _dictkeysobject PyDictKeysObject;
 typedef struct {
     PyObject_HEAD
     Py_ssize_t ma_used;
+
+    /* Dictionary version: globally unique, value change each time
+       the dictionary is modified */
+    PY_UINT64_T ma_version_tag;
+
     PyDictKeysObject *ma_keys;
     PyObject **ma_values;
 } PyDictObject;
@@ -139,6 +144,14 @@ PyAPI_FUNC(void) _PyDict_DebugMallocStats(FILE *out);
 
 int _PyObjectDict_SetItem(PyTypeObject *tp, PyObject **dictptr, PyObject *name, PyObject *value);
 PyObject *_PyDict_LoadGlobal(PyDictObject *, PyDictObject *, PyObject *);
+
+/* Access to split tables by entry index, for the attribute caches of
+   the eval loop. */
+Py_ssize_t _PyDict_GetSplitIndex(PyDictObject *, PyObject *);
+PyObject *_PyDict_GetSplitItemAt(PyDictObject *, PyDictKeysObject *,
+                                 Py_ssize_t, PyObject *);
+int _PyDict_SetSplitItemAt(PyDictObject *, PyDictKeysObject *,
+                           Py_ssize_t, PyObject *, PyObject *);
 #endif
 
 #ifdef __cplusplus
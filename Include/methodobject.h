@@ -19,6 +19,10 @@ typedef PyObject *(*PyCFunction)(PyObject *, PyObject *);
 typedef PyObject *(*PyCFunctionWithKeywords)(PyObject *, PyObject *,
                                              PyObject *);
 typedef PyObject *(*PyNoArgsFunction)(PyObject *);
+#ifndef Py_LIMITED_API
+typedef PyObject *(*_PyCFunctionFast)(PyObject *self, PyObject *const *args,
+                                      Py_ssize_t nargs, PyObject *kwnames);
+#endif
 
 PyAPI_FUNC(PyCFunction) PyCFunction_GetFunction(PyObject *);
 PyAPI_FUNC(PyObject *) PyCFunction_GetSelf(PyObject *);
@@ -50,6 +54,25 @@ typedef struct PyMethodDef PyMethodDef;
 PyAPI_FUNC(PyObject *) PyCFunction_NewEx(PyMethodDef *, PyObject *,
                                          PyObject *);
 
+#ifndef Py_LIMITED_API
+/* Call func with the nargs positional arguments at args, followed by the
+   values of the keyword arguments named in the kwnames tuple (kwnames may
+   be NULL when there are none).  No argument tuple is built for
+   METH_NOARGS, METH_O and METH_FASTCALL functions. */
+PyAPI_FUNC(PyObject *) _PyCFunction_FastCallKeywords(PyObject *func,
+                                                     PyObject *const *args,
+                                                     Py_ssize_t nargs,
+                                                     PyObject *kwnames);
+/* Same as above for the C function described by method, called with
+   self as first argument.  The result is not checked with
+   _Py_CheckFunctionResult(). */
+PyAPI_FUNC(PyObject *) _PyMethodDef_RawFastCallKeywords(PyMethodDef *method,
+                                                        PyObject *self,
+                                                        PyObject *const *args,
+                                                        Py_ssize_t nargs,
+                                                        PyObject *kwnames);
+#endif
+
 /* Flag passed to newmethodobject */
 /* #define METH_OLDARGS  0x0000   -- unsupported now */
 #define METH_VARARGS  0x0001
@@ -71,6 +94,15 @@ PyAPI_FUNC(PyObject *) PyCFunction_NewEx(PyMethodDef *, PyObject *,
 
 #define METH_COEXIST   0x0040
 
+#ifndef Py_LIMITED_API
+/* METH_FASTCALL functions are _PyCFunctionFast: they receive their
+   positional arguments as a C array and the names of their keyword
+   arguments as a tuple (or NULL), the values following the positional
+   ones.  It must not be combined with METH_VARARGS, METH_KEYWORDS,
+   METH_NOARGS or METH_O. */
+#define METH_FASTCALL  0x0080
+#endif
+
 #ifndef Py_LIMITED_API
 typedef struct {
     PyObject_HEAD
@@ -564,6 +564,15 @@ PyAPI_FUNC(int)
 _PyObject_GenericSetAttrWithDict(PyObject *, PyObject *,
                                  PyObject *, PyObject *);
 
+#ifndef Py_LIMITED_API
+/* Look up the method name of obj for LOAD_METHOD.  Return 1 and set
+   *method to the unbound function when it can be called with obj
+   prepended to the arguments, else return 0 and set *method to the
+   attribute value or NULL on error. */
+PyAPI_FUNC(int) _PyObject_GetMethod(PyObject *obj, PyObject *name,
+                                    PyObject **method);
+#endif
+
 /* Helper to look up a builtin object */
 #ifndef Py_LIMITED_API
 PyAPI_FUNC(PyObject *)
@@ -684,6 +693,16 @@ we ignore the possibility.  Provided a C int is at least 32 bits (which
 is implicitly assumed in many parts of this code), that's enough for
 about 2**31 references to an object.
 
+In builds configured with --with-immortal-objects (Py_IMMORTAL_OBJECTS),
+an object whose reference count is at least _Py_IMMORTAL_REFCNT is
+immortal: Py_INCREF and Py_DECREF leave its reference count alone, so it
+is never deallocated and reading it doesn't write to its memory, which
+keeps the pages shared between forked processes clean.  Objects become
+immortal through gc.immortalize_heap().  The value leaves room for the
+flag bits the collector keeps in the low bits of a copy of the reference
+count.  The check costs a compare and a branch in every Py_INCREF and
+Py_DECREF, so other builds leave it out.
+
 XXX The following became out of date in Python 2.2, but I'm not sure
 XXX what the full truth is now.  Certainly, heap-allocated type objects
 XXX can and should be deallocated.
@@ -707,7 +726,6 @@ you can count such references to the type object.)
 PyAPI_DATA(Py_ssize_t) _Py_RefTotal;
 PyAPI_FUNC(void) _Py_NegativeRefcount(const char *fname,
                                             int lineno, PyObject *op);
-PyAPI_FUNC(PyObject *) _PyDict_Dummy(void);
 PyAPI_FUNC(Py_ssize_t) _Py_GetRefTotal(void);
 #define _Py_INC_REFTOTAL        _Py_RefTotal++
 #define _Py_DEC_REFTOTAL        _Py_RefTotal--
@@ -773,6 +791,45 @@ PyAPI_FUNC(void) _Py_Dealloc(PyObject *);
 #endif
 #endif /* !Py_TRACE_REFS */
 
+#ifdef Py_IMMORTAL_OBJECTS
+#define _Py_IMMORTAL_REFCNT (PY_SSIZE_T_MAX >> 4)
+/* Most objects are mortal: tell GCC, so that the common path of Py_INCREF
+   and Py_DECREF is laid out without a taken branch. */
+#if defined(__GNUC__) && (__GNUC__ > 2) && defined(__OPTIMIZE__)
+#define _Py_IsImmortal(op) \
+    __builtin_expect(((PyObject *)(op))->ob_refcnt >= _Py_IMMORTAL_REFCNT, 0)
+#else
+#define _Py_IsImmortal(op) \
+    (((PyObject *)(op))->ob_refcnt >= _Py_IMMORTAL_REFCNT)
+#endif
+
+/* A function, so that the argument is only evaluated once while Py_INCREF
+   remains an expression. */
+Py_LOCAL_INLINE(void)
+_Py_IncRefInline(PyObject *op)
+{
+    if (!_Py_IsImmortal(op)) {
+        _Py_INC_REFTOTAL;
+        op->ob_refcnt++;
+    }
+}
+
+#define Py_INCREF(op) _Py_IncRefInline((PyObject *)(op))
+
+#define Py_DECREF(op)                                   \
+    do {                                                \
+        PyObject *_py_decref_tmp = (PyObject *)(op);    \
+        if (!_Py_IsImmortal(_py_decref_tmp)) {          \
+            if (_Py_DEC_REFTOTAL  _Py_REF_DEBUG_COMMA   \
+            --(_py_decref_tmp)->ob_refcnt != 0)         \
+                _Py_CHECK_REFCNT(_py_decref_tmp)        \
+            else                                        \
+            _Py_Dealloc(_py_decref_tmp);                \
+        }                                               \
+    } while (0)
+#else
+#define _Py_IsImmortal(op) 0
+
 #define Py_INCREF(op) (                         \
     _Py_INC_REFTOTAL  _Py_REF_DEBUG_COMMA       \
     ((PyObject *)(op))->ob_refcnt++)
@@ -786,6 +843,7 @@ PyAPI_FUNC(void) _Py_Dealloc(PyObject *);
         else                                            \
         _Py_Dealloc(_py_decref_tmp);                    \
     } while (0)
+#endif /* Py_IMMORTAL_OBJECTS */
 
 /* Safely decref `op` and set `op` to NULL, especially useful in tp_clear
  * and tp_dealloc implementations.
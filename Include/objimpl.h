@@ -106,6 +106,25 @@ PyAPI_FUNC(Py_ssize_t) _Py_GetAllocatedBlocks(void);
 #ifdef WITH_PYMALLOC
 #ifndef Py_LIMITED_API
 PyAPI_FUNC(void) _PyObject_DebugMallocStats(FILE *out);
+
+/* Snapshot of pymalloc's state, filled in by _PyObject_GetMallocStats() */
+#define _PyObject_MALLOC_MAX_CLASSES 64
+typedef struct {
+    size_t narenas;             /* # of arenas currently allocated */
+    size_t narenas_total;       /* # of times an arena was allocated */
+    size_t narenas_highwater;   /* max value ever seen for narenas */
+    size_t nfreepools;          /* # of unused pools in the arenas */
+    size_t arena_alignment;     /* # of bytes lost to arena alignment */
+    unsigned int nclasses;      /* # of entries used in classes */
+    struct {
+        size_t size;            /* block size of the class */
+        size_t pools;           /* # of pools in use */
+        size_t blocks_used;     /* # of allocated blocks in those pools */
+        size_t blocks_free;     /* # of available blocks in those pools */
+        size_t arenas;          /* # of arenas holding those pools */
+    } classes[_PyObject_MALLOC_MAX_CLASSES];
+} _PyObject_MallocStats;
+PyAPI_FUNC(void) _PyObject_GetMallocStats(_PyObject_MallocStats *stats);
 #endif /* #ifndef Py_LIMITED_API */
 #endif
 
@@ -259,8 +278,13 @@ extern PyGC_Head *_PyGC_generation0;
 
 /* Bit 0 is set when tp_finalize is called */
 #define _PyGC_REFS_MASK_FINALIZED  (1 << 0)
-/* The (N-1) most significant bits contain the gc state / refcount */
-#define _PyGC_REFS_SHIFT           (1)
+/* Bit 1 tells which half of the oldest generation an object is in during
+   incremental collections */
+#define _PyGC_REFS_MASK_VISITED    (1 << 1)
+/* Bit 2 is set for objects in the permanent generation (see gc.freeze()) */
+#define _PyGC_REFS_MASK_FROZEN     (1 << 2)
+/* The (N-3) most significant bits contain the gc state / refcount */
+#define _PyGC_REFS_SHIFT           (3)
 #define _PyGC_REFS_MASK            (((size_t) -1) << _PyGC_REFS_SHIFT)
 
 #define _PyGCHead_REFS(g) ((g)->gc.gc_refs >> _PyGC_REFS_SHIFT)
@@ -32,6 +32,7 @@ extern "C" {
 #define GET_AITER                50
 #define GET_ANEXT                51
 #define BEFORE_ASYNC_WITH        52
+#define BEFORE_WITH              53
 #define INPLACE_ADD              55
 #define INPLACE_SUBTRACT         56
 #define INPLACE_MULTIPLY         57
@@ -121,6 +122,19 @@ extern "C" {
 #define BUILD_TUPLE_UNPACK      152
 #define BUILD_SET_UNPACK        153
 #define SETUP_ASYNC_WITH        154
+#define LOAD_METHOD             160
+#define CALL_METHOD             161
+
+    /* Specialized instructions, see Python/ceval.c */
+#define BINARY_ADD_INT          200
+#define BINARY_ADD_FLOAT        201
+#define BINARY_SUBTRACT_INT     202
+#define BINARY_SUBTRACT_FLOAT   203
+#define BINARY_MULTIPLY_FLOAT   204
+#define BINARY_SUBSCR_LIST_INT  205
+#define COMPARE_OP_INT          206
+#define COMPARE_OP_FLOAT        207
+#define COMPARE_OP_STR          208
 
 /* EXCEPT_HANDLER is a special, implicit block type which is created when
    entering an except handler. It is not an opcode but we define it here
@@ -84,6 +84,7 @@ PyAPI_FUNC(int) _PyFrame_Init(void);
 PyAPI_FUNC(int) _PyFloat_Init(void);
 PyAPI_FUNC(int) PyByteArray_Init(void);
 PyAPI_FUNC(void) _PyRandom_Init(void);
+PyAPI_FUNC(void) _PyGC_Init(void);
 #endif
 
 /* Various internal finalizers */
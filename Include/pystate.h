@@ -16,6 +16,14 @@ struct _is; /* Forward */
 #ifdef Py_LIMITED_API
 typedef struct _is PyInterpreterState;
 #else
+struct _frame; /* Avoid including frameobject.h */
+
+/* Evaluates a frame; see PyEval_EvalFrameEx() and eval_frame below. */
+typedef PyObject* (*_PyFrameEvalFunction)(struct _frame *, int);
+
+/* Number of slots of the co_extra scratch space of code objects */
+#define MAX_CO_EXTRA_USERS 255
+
 typedef struct _is {
 
     struct _is *next;
@@ -41,6 +49,18 @@ typedef struct _is {
 #endif
 
     PyObject *builtins_copy;
+
+    /* Function called by PyEval_EvalFrameEx() to run every Python frame of
+       the interpreter; _PyEval_EvalFrameDefault() unless an extension
+       module (a JIT compiler, for instance) has replaced it.  A
+       replacement is expected to fall back to the default function for the
+       frames it does not handle itself. */
+    _PyFrameEvalFunction eval_frame;
+
+    /* Free functions of the users of co_extra, by the index returned by
+       _PyEval_RequestCodeExtraIndex() */
+    Py_ssize_t co_extra_user_count;
+    freefunc co_extra_freefuncs[MAX_CO_EXTRA_USERS];
 } PyInterpreterState;
 #endif
 
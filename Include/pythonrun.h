@@ -16,6 +16,7 @@ extern "C" {
 #define PyCF_DONT_IMPLY_DEDENT 0x0200
 #define PyCF_ONLY_AST 0x0400
 #define PyCF_IGNORE_COOKIE 0x0800
+#define PyCF_OPTIMIZED_AST (0x1000 | PyCF_ONLY_AST)
 
 #ifndef Py_LIMITED_API
 typedef struct {
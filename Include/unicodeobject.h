@@ -1300,6 +1300,12 @@ PyAPI_FUNC(PyObject*) PyUnicode_EncodeUTF8(
     Py_ssize_t length,          /* number of Py_UNICODE chars to encode */
     const char *errors          /* error handling */
     );
+
+/* Enable or disable the UTF-8 cache: if enabled, the UTF-8 decoder keeps a
+   copy of valid input in the non-ASCII strings it creates, so that encoding
+   them back to UTF-8 does not convert them.  See sys.setutf8cache(). */
+PyAPI_FUNC(void) _PyUnicode_SetUTF8Cache(int enabled);
+PyAPI_FUNC(int) _PyUnicode_GetUTF8Cache(void);
 #endif
 
 /* --- UTF-32 Codecs ------------------------------------------------------ */
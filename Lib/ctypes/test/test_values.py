@@ -80,9 +80,9 @@ class Win_ValuesTestCase(unittest.TestCase):
                 continue
             items.append((entry.name, entry.size))
 
-        expected = [(b"__hello__", 161),
-                    (b"__phello__", -161),
-                    (b"__phello__.spam", 161),
+        expected = [(b"__hello__", 124),
+                    (b"__phello__", -124),
+                    (b"__phello__.spam", 124),
                     ]
         self.assertEqual(items, expected)
 
@@ -150,6 +150,12 @@ def _format_code_info(co):
         lines.append("Cell variables:")
         for i_n in enumerate(co.co_cellvars):
             lines.append("%4d: %s" % i_n)
+    exception_table = _parse_exception_table(co)
+    if exception_table:
+        lines.append("Exception table:")
+        for i, (start, end, op, handler, level) in enumerate(exception_table):
+            lines.append("%4d: %d to %d -> %d %s (level %d)" %
+                         (i, start, end, handler, opname[op], level))
     return "\n".join(lines)
 
 def show_code(co, *, file=None):
@@ -233,7 +239,7 @@ def get_instructions(x, *, first_line=None):
         line_offset = 0
     return _get_instructions_bytes(co.co_code, co.co_varnames, co.co_names,
                                    co.co_consts, cell_names, linestarts,
-                                   line_offset)
+                                   line_offset, _find_handlers(co))
 
 def _get_const_info(const_index, const_list):
     """Helper to get optional details about const references
@@ -264,41 +270,29 @@ def _get_name_info(name_index, name_list):
 
 
 def _get_instructions_bytes(code, varnames=None, names=None, constants=None,
-                      cells=None, linestarts=None, line_offset=0):
+                      cells=None, linestarts=None, line_offset=0,
+                      handlers=()):
     """Iterate over the instructions in a bytecode string.
 
     Generates a sequence of Instruction namedtuples giving the details of each
     opcode.  Additional information about the code's runtime environment
-    (e.g. variable names, constants) can be specified using optional
-    arguments.
+    (e.g. variable names, constants, the offsets of the exception handlers)
+    can be specified using optional arguments.
 
     """
     labels = findlabels(code)
-    extended_arg = 0
+    labels.extend(handler for handler in handlers if handler not in labels)
     starts_line = None
     free = None
-    # enumerate() is not an option, since we sometimes process
-    # multiple elements on a single pass through the loop
-    n = len(code)
-    i = 0
-    while i < n:
-        op = code[i]
-        offset = i
+    for offset, op, arg in _unpack_opargs(code):
         if linestarts is not None:
-            starts_line = linestarts.get(i, None)
+            starts_line = linestarts.get(offset, None)
             if starts_line is not None:
                 starts_line += line_offset
-        is_jump_target = i in labels
-        i = i+1
-        arg = None
+        is_jump_target = offset in labels
         argval = None
         argrepr = ''
-        if op >= HAVE_ARGUMENT:
-            arg = code[i] + code[i+1]*256 + extended_arg
-            extended_arg = 0
-            i = i+2
-            if op == EXTENDED_ARG:
-                extended_arg = arg*65536
+        if arg is not None:
             #  Set argval to the dereferenced value of the argument when
             #  availabe, and argrepr to the string representation of argval.
             #    _disassemble_bytes needs the string repr of the
@@ -309,7 +303,7 @@ def _get_instructions_bytes(code, varnames=None, names=None, constants=None,
             elif op in hasname:
                 argval, argrepr = _get_name_info(arg, names)
             elif op in hasjrel:
-                argval = i + arg
+                argval = offset + 2 + arg
                 argrepr = "to " + repr(argval)
             elif op in haslocal:
                 argval, argrepr = _get_name_info(arg, varnames)
@@ -319,7 +313,8 @@ def _get_instructions_bytes(code, varnames=None, names=None, constants=None,
             elif op in hasfree:
                 argval, argrepr = _get_name_info(arg, cells)
             elif op in hasnargs:
-                argrepr = "%d positional, %d keyword pair" % (code[i-2], code[i-1])
+                argrepr = "%d positional, %d keyword pair" % (arg & 0xff,
+                                                             arg >> 8 & 0xff)
         yield Instruction(opname[op], op,
                           arg, argval, argrepr,
                           offset, starts_line, is_jump_target)
@@ -329,18 +324,20 @@ def disassemble(co, lasti=-1, *, file=None):
     cell_names = co.co_cellvars + co.co_freevars
     linestarts = dict(findlinestarts(co))
     _disassemble_bytes(co.co_code, lasti, co.co_varnames, co.co_names,
-                       co.co_consts, cell_names, linestarts, file=file)
+                       co.co_consts, cell_names, linestarts, file=file,
+                       handlers=_find_handlers(co))
 
 def _disassemble_bytes(code, lasti=-1, varnames=None, names=None,
                        constants=None, cells=None, linestarts=None,
-                       *, file=None, line_offset=0):
+                       *, file=None, line_offset=0, handlers=()):
     # Omit the line number column entirely if we have no line number info
     show_lineno = linestarts is not None
     # TODO?: Adjust width upwards if max(linestarts.values()) >= 1000?
     lineno_width = 3 if show_lineno else 0
     for instr in _get_instructions_bytes(code, varnames, names,
                                          constants, cells, linestarts,
-                                         line_offset=line_offset):
+                                         line_offset=line_offset,
+                                         handlers=handlers):
         new_source_line = (show_lineno and
                            instr.starts_line is not None and
                            instr.offset > 0)
@@ -355,6 +352,26 @@ def _disassemble_str(source, *, file=None):
 
 disco = disassemble                     # XXX For backwards compatibility
 
+def _unpack_opargs(code):
+    """Iterate over the instructions in a bytecode string.
+
+    Every instruction is two bytes long: the opcode and an 8-bit argument.
+    EXTENDED_ARG prefixes are folded into the argument of the instruction
+    that follows them, but are still reported on their own.  Generates
+    (offset, opcode, arg) triples; arg is None for opcodes that take no
+    argument.
+
+    """
+    extended_arg = 0
+    for i in range(0, len(code), 2):
+        op = code[i]
+        if op >= HAVE_ARGUMENT:
+            arg = code[i+1] | extended_arg
+            extended_arg = (arg << 8) if op == EXTENDED_ARG else 0
+        else:
+            arg = None
+        yield (i, op, arg)
+
 def findlabels(code):
     """Detect all offsets in a byte code which are jump targets.
 
@@ -362,19 +379,11 @@ def findlabels(code):
 
     """
     labels = []
-    # enumerate() is not an option, since we sometimes process
-    # multiple elements on a single pass through the loop
-    n = len(code)
-    i = 0
-    while i < n:
-        op = code[i]
-        i = i+1
-        if op >= HAVE_ARGUMENT:
-            arg = code[i] + code[i+1]*256
-            i = i+2
+    for offset, op, arg in _unpack_opargs(code):
+        if arg is not None:
             label = -1
             if op in hasjrel:
-                label = i+arg
+                label = offset + 2 + arg
             elif op in hasjabs:
                 label = arg
             if label >= 0:
@@ -382,6 +391,41 @@ def findlabels(code):
                     labels.append(label)
     return labels
 
+def _read_varint(table, i):
+    value = shift = 0
+    while True:
+        byte = table[i]
+        i += 1
+        value |= (byte & 0x7f) << shift
+        shift += 7
+        if not byte & 0x80:
+            return value, i
+
+def _parse_exception_table(code):
+    """Decode co_exceptiontable.
+
+    Return a list of (start, end, opcode, handler, level) tuples: the
+    instructions at offsets start to end - 1 run as if the SETUP_* opcode
+    had pushed a block with the given handler and stack level.  Enclosing
+    blocks come first.
+
+    """
+    table = code.co_exceptiontable
+    entries = []
+    i = 0
+    while i < len(table):
+        fields = []
+        for _ in range(5):
+            value, i = _read_varint(table, i)
+            fields.append(value)
+        start, size, handler, level, op = fields
+        entries.append((start, start + size, op, handler, level))
+    return entries
+
+def _find_handlers(code):
+    """Return the offsets of the handlers of co_exceptiontable."""
+    return [entry[3] for entry in _parse_exception_table(code)]
+
 def findlinestarts(code):
     """Find the offsets in a byte code which are start of lines in the source.
 
@@ -430,7 +474,8 @@ class Bytecode:
         return _get_instructions_bytes(co.co_code, co.co_varnames, co.co_names,
                                        co.co_consts, self._cell_names,
                                        self._linestarts,
-                                       line_offset=self._line_offset)
+                                       line_offset=self._line_offset,
+                                       handlers=_find_handlers(co))
 
     def __repr__(self):
         return "{}({!r})".format(self.__class__.__name__,
@@ -461,7 +506,8 @@ class Bytecode:
                                linestarts=self._linestarts,
                                line_offset=self._line_offset,
                                file=output,
-                               lasti=offset)
+                               lasti=offset,
+                               handlers=_find_handlers(co))
             return output.getvalue()
 
 
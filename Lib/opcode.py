@@ -88,6 +88,7 @@ def_op('INPLACE_TRUE_DIVIDE', 29)
 def_op('GET_AITER', 50)
 def_op('GET_ANEXT', 51)
 def_op('BEFORE_ASYNC_WITH', 52)
+def_op('BEFORE_WITH', 53)
 
 def_op('INPLACE_ADD', 55)
 def_op('INPLACE_SUBTRACT', 56)
@@ -213,4 +214,22 @@ def_op('BUILD_MAP_UNPACK_WITH_CALL', 151)
 def_op('BUILD_TUPLE_UNPACK', 152)
 def_op('BUILD_SET_UNPACK', 153)
 
+name_op('LOAD_METHOD', 160)
+def_op('CALL_METHOD', 161)
+
 del def_op, name_op, jrel_op, jabs_op
+
+# Type-specialized forms of some of the instructions above.  The compiler
+# never emits them: the eval loop writes them into the quickened copy of
+# hot code objects only, so they are neither in opmap nor seen by dis.
+_specialized_instructions = [
+    ('BINARY_ADD_INT', 200),
+    ('BINARY_ADD_FLOAT', 201),
+    ('BINARY_SUBTRACT_INT', 202),
+    ('BINARY_SUBTRACT_FLOAT', 203),
+    ('BINARY_MULTIPLY_FLOAT', 204),
+    ('BINARY_SUBSCR_LIST_INT', 205),
+    ('COMPARE_OP_INT', 206),
+    ('COMPARE_OP_FLOAT', 207),
+    ('COMPARE_OP_STR', 208),
+]
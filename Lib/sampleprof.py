@@ -0,0 +1,159 @@
+#! /usr/bin/env python3
+
+"""Statistical profiler.
+
+Rather than timing every call and return like cProfile, a sampling profiler
+records the call stacks of the running threads at a regular interval.  Its
+overhead does not depend on the number of calls, so it can be left running
+on production workloads.  The stacks are reported in the "collapsed" format
+read by flame graph tools: one line per distinct stack, with the frames
+from the outermost to the innermost separated by semicolons, followed by
+the number of samples which saw it.
+"""
+
+__all__ = ["run", "runctx", "Profile"]
+
+import _sampleprof
+
+# ____________________________________________________________
+# Simple interface
+
+def run(statement, filename=None, interval=0.005):
+    """Run statement under the sampling profiler, write the collapsed
+    stacks to filename, or print them if no filename is given, and return
+    the Profile."""
+    import __main__
+    dict = __main__.__dict__
+    return runctx(statement, dict, dict, filename, interval)
+
+def runctx(statement, globals, locals, filename=None, interval=0.005):
+    """Run statement under the sampling profiler, with the given globals and
+    locals, and write or print the collapsed stacks like run()."""
+    prof = Profile(interval)
+    try:
+        prof.runctx(statement, globals, locals)
+    except SystemExit:
+        pass
+    finally:
+        if filename is not None:
+            with open(filename, 'w') as file:
+                prof.write_collapsed(file)
+        else:
+            prof.write_collapsed()
+    return prof
+
+# ____________________________________________________________
+
+class Profile(_sampleprof.Sampler):
+    """Profile(interval=0.005, all_threads=True)
+
+    Builds a sampling profiler which records the Python call stacks of the
+    threads every interval seconds while it is enabled.  If all_threads is
+    false, only the thread which enables it is sampled.
+    """
+
+    # Most of the functionality is in the base class.
+    # This subclass only adds the reports and convenient methods.
+
+    def rate(self):
+        """Return the number of samples taken per second while enabled.
+        It is lower than 1 / interval when the sampled threads don't
+        release the GIL often enough."""
+        duration = self.duration
+        if not duration:
+            return 0.0
+        return self.samples / duration
+
+    def collapsed(self):
+        """Return the stacks in the collapsed format, as a list of lines
+        sorted by stack."""
+        lines = []
+        for stack, count in self.getstacks().items():
+            frames = ";".join(map(label, stack))
+            lines.append("%s %d" % (frames, count))
+        lines.sort()
+        return lines
+
+    def write_collapsed(self, file=None):
+        if file is None:
+            import sys
+            file = sys.stdout
+        for line in self.collapsed():
+            print(line, file=file)
+
+    def __enter__(self):
+        self.enable()
+        return self
+
+    def __exit__(self, *exc_info):
+        self.disable()
+
+    def run(self, cmd):
+        import __main__
+        dict = __main__.__dict__
+        return self.runctx(cmd, dict, dict)
+
+    def runctx(self, cmd, globals, locals):
+        self.enable()
+        try:
+            exec(cmd, globals, locals)
+        finally:
+            self.disable()
+        return self
+
+    # This method is more useful to profile a single function call.
+    def runcall(self, func, *args, **kw):
+        self.enable()
+        try:
+            return func(*args, **kw)
+        finally:
+            self.disable()
+
+# ____________________________________________________________
+
+def label(code):
+    return "%s (%s:%d)" % (code.co_name, code.co_filename,
+                           code.co_firstlineno)
+
+# ____________________________________________________________
+
+def main():
+    import os, sys
+    from optparse import OptionParser
+    usage = "sampleprof.py [-i interval] [-o output_file_path] scriptfile [arg] ..."
+    parser = OptionParser(usage=usage)
+    parser.allow_interspersed_args = False
+    parser.add_option('-i', '--interval', dest="interval", type="float",
+        help="Seconds between two samples (default: 0.005)", default=0.005)
+    parser.add_option('-o', '--outfile', dest="outfile",
+        help="Save collapsed stacks to <outfile>", default=None)
+
+    if not sys.argv[1:]:
+        parser.print_usage()
+        sys.exit(2)
+
+    (options, args) = parser.parse_args()
+    sys.argv[:] = args
+
+    if len(args) > 0:
+        progname = args[0]
+        sys.path.insert(0, os.path.dirname(progname))
+        with open(progname, 'rb') as fp:
+            code = compile(fp.read(), progname, 'exec')
+        globs = {
+            '__file__': progname,
+            '__name__': '__main__',
+            '__package__': None,
+            '__cached__': None,
+        }
+        prof = runctx(code, globs, None, options.outfile, options.interval)
+        print("sampleprof: %d samples in %.3f seconds (%.0f per second, "
+              "interval %g seconds)" % (prof.samples, prof.duration,
+              prof.rate(), prof.interval), file=sys.stderr)
+    else:
+        parser.print_usage()
+    return parser
+
+# When invoked as main program, invoke the profiler on a script
+if __name__ == '__main__':
+    main()
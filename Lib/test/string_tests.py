@@ -2,7 +2,7 @@
 Common tests shared by test_unicode, test_userstring and test_string.
 """
 
-import unittest, string, sys, struct
+import unittest, string, sys, struct, random
 from test import support
 from collections import UserList
 
@@ -210,6 +210,58 @@ class BaseTest:
                 if loc != -1:
                     self.assertEqual(i[loc:loc+len(j)], j)
 
+    def test_find_long(self):
+        self.check_find_long('ab')
+        self.check_find_long('abc')
+
+    def check_find_long(self, charset):
+        # Long periodic needles send the search through memchr(), the
+        # Boyer-Moore-Horspool loop and the two-way algorithm: check them
+        # against a naive search
+        def naive_find(s, sub):
+            for i in range(len(s) - len(sub) + 1):
+                if s[i:i+len(sub)] == sub:
+                    return i
+            return -1
+        def naive_count(s, sub):
+            count = i = 0
+            while i <= len(s) - len(sub):
+                if s[i:i+len(sub)] == sub:
+                    count += 1
+                    i += len(sub)
+                else:
+                    i += 1
+            return count
+
+        rnd = random.Random(42)
+        for trial in range(100):
+            period = ''.join(rnd.choice(charset)
+                             for i in range(rnd.randint(1, 4)))
+            needle = period * rnd.randint(1, 80)
+            pos = rnd.randrange(len(needle))
+            needle = needle[:pos] + rnd.choice(charset) + needle[pos+1:]
+            parts = []
+            while sum(map(len, parts)) < 2000:
+                parts.append(rnd.choice((period * 10, needle,
+                                         rnd.choice(charset))))
+            haystack = ''.join(parts)
+            s, sub = self.fixtype(haystack), self.fixtype(needle)
+            self.assertEqual(s.find(sub), naive_find(haystack, needle))
+            self.assertEqual(s.count(sub), naive_count(haystack, needle))
+            self.assertEqual(sub in s, naive_find(haystack, needle) != -1)
+            self.assertEqual(len(s.replace(sub, self.fixtype(''))),
+                             len(haystack) -
+                             len(needle) * naive_count(haystack, needle))
+
+        a, b = self.fixtype(charset[0]), self.fixtype(charset[1])
+        s = a * 10000
+        sub = a * 500 + b + a * 500
+        self.assertEqual(s.find(sub), -1)
+        self.assertEqual(s.count(sub), 0)
+        self.assertEqual((s + sub + s).find(sub), 10000)
+        self.assertEqual((s + sub + s + sub).count(sub), 2)
+        self.assertEqual((s + sub + s + sub).count(sub, 0, -1), 1)
+
     def test_rfind(self):
         self.checkequal(9,  'abcdefghiabc', 'rfind', 'abc')
         self.checkequal(12, 'abcdefghiabc', 'rfind', '')
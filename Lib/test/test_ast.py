@@ -522,6 +522,12 @@ class ASTHelpers_Test(unittest.TestCase):
         self.assertEqual(ast.literal_eval('-6j+3'), 3-6j)
         self.assertEqual(ast.literal_eval('3.25'), 3.25)
 
+    def test_literal_eval_constant(self):
+        node = ast.Expression(ast.Constant((1, frozenset({2}))))
+        self.assertEqual(ast.literal_eval(node), (1, frozenset({2})))
+        node = ast.Expression(ast.List([ast.Constant(None)], ast.Load()))
+        self.assertEqual(ast.literal_eval(node), [None])
+
     def test_literal_eval_issue4907(self):
         self.assertEqual(ast.literal_eval('2j'), 2j)
         self.assertEqual(ast.literal_eval('10 + 2j'), 10 + 2j)
@@ -539,6 +545,81 @@ class ASTHelpers_Test(unittest.TestCase):
         self.assertIn("invalid integer value: None", str(cm.exception))
 
 
+class ASTOptimizerTests(unittest.TestCase):
+
+    def optimize(self, source, mode="exec", optimize=0):
+        return compile(source, "<test>", mode, ast.PyCF_OPTIMIZED_AST,
+                       optimize=optimize)
+
+    def test_flag(self):
+        self.assertEqual(ast.PyCF_OPTIMIZED_AST & ast.PyCF_ONLY_AST,
+                         ast.PyCF_ONLY_AST)
+        tree = self.optimize("1 + 2", "eval")
+        self.assertIsInstance(tree, ast.Expression)
+        self.assertEqual(ast.dump(tree), "Expression(body=Constant(value=3))")
+        # ast.parse() does not optimize
+        self.assertEqual(ast.dump(ast.parse("1 + 2", mode="eval")),
+            "Expression(body=BinOp(left=Num(n=1), op=Add(), right=Num(n=2)))")
+
+    def test_ast_input(self):
+        tree = ast.parse("x = (1, 2) + (3,)")
+        tree = self.optimize(tree)
+        self.assertEqual(ast.dump(tree.body[0].value),
+                         "Constant(value=(1, 2, 3))")
+
+    def test_debug(self):
+        self.assertTrue(self.optimize("__debug__", "eval").body.value)
+        tree = self.optimize("__debug__", "eval", optimize=1)
+        self.assertFalse(tree.body.value)
+        tree = self.optimize("if not __debug__:\n    f()")
+        self.assertEqual(ast.dump(tree), "Module(body=[Pass()])")
+
+    def test_dead_code(self):
+        tree = self.optimize("if 0:\n    f()\nelse:\n    g()\nh()")
+        self.assertEqual([ast.dump(s.value.func) for s in tree.body],
+                         ["Name(id='g', ctx=Load())",
+                          "Name(id='h', ctx=Load())"])
+        tree = self.optimize("def f():\n    return 1\n    g()")
+        self.assertEqual(len(tree.body[0].body), 1)
+        # Code which binds names or yields stays
+        tree = self.optimize("def f():\n    if 0:\n        yield")
+        self.assertIsInstance(tree.body[0].body[0], ast.If)
+        tree = self.optimize("if 0:\n    x = 1")
+        self.assertIsInstance(tree.body[0], ast.If)
+
+    def test_dead_code_after_live_branch(self):
+        for test in ("1", "__debug__"):
+            tree = self.optimize("def f():\n"
+                                 "    if %s:\n"
+                                 "        return 1\n"
+                                 "    return 2" % test)
+            self.assertEqual([ast.dump(s) for s in tree.body[0].body],
+                             ["Return(value=Num(n=1))"])
+        tree = self.optimize("while 1:\n"
+                             "    if 1:\n"
+                             "        break\n"
+                             "    f()")
+        self.assertEqual([ast.dump(s) for s in tree.body[0].body],
+                         ["Break()"])
+
+    def test_dead_code_free_variables(self):
+        # Names only used in removed code are not free variables
+        source = ("def g(x):\n"
+                  "    def f():\n"
+                  "        if 0:\n"
+                  "            return x\n"
+                  "    return f\n")
+        ns = {}
+        exec(compile(source, "<test>", "exec"), ns)
+        self.assertEqual(ns["g"].__code__.co_cellvars, ())
+        self.assertEqual(ns["g"](1).__code__.co_freevars, ())
+
+    def test_no_docstring_from_dead_code(self):
+        tree = self.optimize("if 1:\n    'not a docstring'")
+        self.assertIsInstance(tree.body[0], ast.Pass)
+        self.assertIsNone(ast.get_docstring(tree))
+
+
 class ASTValidatorTests(unittest.TestCase):
 
     def mod(self, mod, msg=None, mode="exec", *, exc=ValueError):
@@ -914,6 +995,17 @@ class ASTValidatorTests(unittest.TestCase):
     def test_nameconstant(self):
         self.expr(ast.NameConstant(4), "singleton must be True, False, or None")
 
+    def test_constant(self):
+        self.expr(ast.Constant([1]), "got an invalid type in Constant: list",
+                  exc=TypeError)
+        self.expr(ast.Constant((1, {2})), "got an invalid type in Constant: tuple",
+                  exc=TypeError)
+        for value in (None, ..., True, 1, 2.5, 3j, "s", b"b",
+                      (1, (2.5, "s")), frozenset({(1,), None})):
+            node = ast.Expression(ast.Constant(value))
+            ast.fix_missing_locations(node)
+            self.assertEqual(eval(compile(node, "<test>", "eval")), value)
+
     def test_stdlib_validates(self):
         stdlib = os.path.dirname(ast.__file__)
         tests = [fn for fn in os.listdir(stdlib) if fn.endswith(".py")]
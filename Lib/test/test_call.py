@@ -122,5 +122,211 @@ class CFunctionCalls(unittest.TestCase):
         self.assertRaises(TypeError, [].count, x=2, y=2)
 
 
+class MethodCalls(unittest.TestCase):
+    # obj.meth(args) compiles to LOAD_METHOD/CALL_METHOD, which calls
+    # functions found on the type without creating a bound method.
+
+    def test_python_method(self):
+        class C:
+            def meth(self, *args):
+                return self, args
+
+        c = C()
+        self.assertEqual(c.meth(), (c, ()))
+        self.assertEqual(c.meth(1, 2), (c, (1, 2)))
+
+    def test_instance_attribute_shadows_method(self):
+        class C:
+            def meth(self):
+                return 'method'
+
+        c = C()
+        c.meth = lambda: 'instance'
+        self.assertEqual(c.meth(), 'instance')
+
+    def test_descriptors(self):
+        class C:
+            @staticmethod
+            def static(*args):
+                return args
+
+            @classmethod
+            def cls(*args):
+                return args
+
+            @property
+            def prop(self):
+                return lambda *args: args
+
+        c = C()
+        self.assertEqual(c.static(1), (1,))
+        self.assertEqual(c.cls(1), (C, 1))
+        self.assertEqual(c.prop(1), (1,))
+        self.assertEqual(C.static(1), (1,))
+        self.assertEqual(C.cls(1), (C, 1))
+
+    def test_getattr(self):
+        class C:
+            def __getattr__(self, name):
+                return lambda *args: (name, args)
+
+        self.assertEqual(C().meth(1), ('meth', (1,)))
+
+    def test_getattribute(self):
+        class C:
+            def meth(self):
+                return 'method'
+
+            def __getattribute__(self, name):
+                return lambda: 'getattribute'
+
+        self.assertEqual(C().meth(), 'getattribute')
+
+    def test_missing_attribute(self):
+        class C:
+            pass
+
+        self.assertRaises(AttributeError, lambda: C().meth())
+
+    def test_c_methods(self):
+        l = []
+        l.append(1)
+        l.extend([2, 3])
+        l.insert(0, 0)
+        self.assertEqual(l, [0, 1, 2, 3])
+        self.assertEqual(l.pop(), 3)
+        self.assertEqual(' '.join(['a', 'b']), 'a b')
+        self.assertEqual({'a': 1}.get('a'), 1)
+
+    def test_c_method_arguments(self):
+        l = []
+        self.assertRaises(TypeError, lambda: l.append())
+        self.assertRaises(TypeError, lambda: l.append(1, 2))
+        self.assertRaises(TypeError, lambda: l.clear(1))
+
+    def test_c_method_subclass(self):
+        class L(list):
+            pass
+
+        l = L()
+        l.append(1)
+        self.assertEqual(l, [1])
+
+        class L2(list):
+            def append(self, item):
+                list.append(self, item * 2)
+
+        l = L2()
+        l.append(1)
+        self.assertEqual(l, [2])
+
+    def test_unbound_c_method_wrong_self(self):
+        self.assertRaises(TypeError, list.append, (), 1)
+        self.assertRaises(TypeError, lambda: list.append({}, 1))
+
+    def test_module_function(self):
+        import math
+        self.assertEqual(math.floor(1.5), 1)
+
+    def test_yield_in_arguments(self):
+        class C:
+            def meth(self, *args):
+                return args
+
+        def gen():
+            return C().meth(1, (yield), 3)
+
+        g = gen()
+        next(g)
+        with self.assertRaises(StopIteration) as cm:
+            g.send(2)
+        self.assertEqual(cm.exception.value, (1, 2, 3))
+
+    def test_exception_in_arguments(self):
+        class C:
+            def meth(self, *args):
+                return args
+
+        def f():
+            return C().meth(1, 1 / 0)
+
+        self.assertRaises(ZeroDivisionError, f)
+
+    def test_compiled_opcodes(self):
+        import dis
+        code = compile('obj.meth(1)', '<test>', 'eval')
+        ops = [instr.opname for instr in dis.get_instructions(code)]
+        self.assertIn('LOAD_METHOD', ops)
+        self.assertIn('CALL_METHOD', ops)
+
+        # keyword and star arguments still use the generic call
+        for source in ('obj.meth(x=1)', 'obj.meth(*args)',
+                       'obj.meth(**kwargs)'):
+            code = compile(source, '<test>', 'eval')
+            ops = [instr.opname for instr in dis.get_instructions(code)]
+            self.assertNotIn('LOAD_METHOD', ops)
+
+
+class FastCallTests(unittest.TestCase):
+    # The functions used here are METH_FASTCALL: they get their arguments
+    # as a C array, either straight from the stack or unpacked from the
+    # argument tuple and keyword dict of a generic call.
+
+    def test_positional(self):
+        self.assertEqual(divmod(7, 2), (3, 1))
+        self.assertEqual(divmod(*(7, 2)), (3, 1))
+        self.assertEqual(getattr(1, 'real'), 1)
+        self.assertEqual(getattr(1, 'spam', 5), 5)
+        self.assertEqual({1: 2}.get(1), 2)
+        self.assertEqual({}.get(1, 3), 3)
+        self.assertEqual(dict.get({1: 2}, 1), 2)
+        self.assertRaises(TypeError, divmod, 1)
+        self.assertRaises(TypeError, divmod, 1, 2, 3)
+        self.assertRaises(TypeError, getattr, 1)
+        self.assertRaises(TypeError, {}.get)
+        self.assertRaises(TypeError, {}.get, 1, 2, 3)
+        self.assertRaises(TypeError, dict.get, [], 1)
+
+    def test_positional_only_keywords(self):
+        for func, args in ((divmod, (1, 2)), (getattr, (1, 'real')),
+                           ({}.get, (1,))):
+            with self.assertRaisesRegex(TypeError,
+                                        'takes no keyword arguments'):
+                func(*args, x=1)
+            with self.assertRaisesRegex(TypeError,
+                                        'takes no keyword arguments'):
+                func(*args, **{'x': 1})
+        # an empty keyword dict is fine
+        self.assertEqual(divmod(7, 2, **{}), (3, 1))
+
+    def test_keywords(self):
+        self.assertEqual(eval(compile(source='1', filename='f',
+                                      mode='eval')), 1)
+        self.assertEqual(eval(compile('2', 'f', mode='eval')), 2)
+        self.assertEqual(eval(compile('3', **{'filename': 'f',
+                                              'mode': 'eval'})), 3)
+        self.assertEqual(eval(compile('4', 'f', 'eval', dont_inherit=True)),
+                         4)
+        with self.assertRaisesRegex(TypeError, 'given by name'):
+            compile('1', 'f', 'eval', source='2')
+        with self.assertRaisesRegex(TypeError, 'invalid keyword'):
+            compile('1', 'f', 'eval', spam=1)
+        with self.assertRaisesRegex(TypeError, 'invalid keyword'):
+            compile('1', 'f', 'eval', **{'spam': 1})
+        with self.assertRaisesRegex(TypeError, "'mode'"):
+            compile('1', filename='f')
+        with self.assertRaisesRegex(TypeError, 'at most'):
+            compile('1', 'f', 'eval', 0, 0, 0, optimize=0)
+
+    def test_generic_call(self):
+        # PyObject_Call() with a keyword dict
+        import functools
+        c = functools.partial(compile, mode='eval', filename='f')
+        self.assertEqual(eval(c('5')), 5)
+        self.assertEqual(eval(c(source='6')), 6)
+        g = functools.partial(getattr, default=1)
+        self.assertRaises(TypeError, g, 1, 'real')
+
+
 if __name__ == "__main__":
     unittest.main()
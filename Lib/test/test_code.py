@@ -134,6 +134,28 @@ class CodeTest(unittest.TestCase):
         self.assertEqual(co.co_name, "funcname")
         self.assertEqual(co.co_firstlineno, 15)
 
+    def test_exceptiontable(self):
+        def f(x):
+            return x
+        def g(x):
+            try:
+                x = x + 1
+            finally:
+                del x
+        self.assertEqual(f.__code__.co_exceptiontable, b'')
+        co = g.__code__
+        self.assertIsInstance(co.co_exceptiontable, bytes)
+        self.assertTrue(co.co_exceptiontable)
+        # The constructor takes the table as an optional argument
+        args = [co.co_argcount, co.co_kwonlyargcount, co.co_nlocals,
+                co.co_stacksize, co.co_flags, co.co_code, co.co_consts,
+                co.co_names, co.co_varnames, co.co_filename, co.co_name,
+                co.co_firstlineno, co.co_lnotab, co.co_freevars,
+                co.co_cellvars]
+        self.assertEqual(type(co)(*args).co_exceptiontable, b'')
+        self.assertNotEqual(type(co)(*args), co)
+        self.assertEqual(type(co)(*args + [co.co_exceptiontable]), co)
+
 
 class CodeWeakRefTest(unittest.TestCase):
 
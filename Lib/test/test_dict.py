@@ -5,6 +5,8 @@ import collections, random, string
 import collections.abc
 import gc, weakref
 import pickle
+import struct
+import sys
 
 
 class DictTest(unittest.TestCase):
@@ -937,6 +939,80 @@ class DictTest(unittest.TestCase):
                 d.popitem()
         self.check_reentrant_insertion(mutate)
 
+    @support.cpython_only
+    def test_insertion_order(self):
+        # The compact layout keeps entries in insertion order, across
+        # deletions and resizes
+        d = {}
+        keys = [str(i) for i in range(100)]
+        for k in keys:
+            d[k] = k
+        for k in keys[::3]:
+            del d[k]
+        del keys[::3]
+        self.assertEqual(list(d), keys)
+        d['new'] = 1
+        self.assertEqual(list(d)[-1], 'new')
+        self.assertEqual(d.popitem(), ('new', 1))
+        self.assertEqual(list(d.copy()), keys)
+        self.assertEqual(list(dict(d)), keys)
+
+    @support.cpython_only
+    def test_splittable_del(self):
+        # Deleting from a split table turns it into a combined table
+        # without losing order or the other instance's keys
+        class C:
+            pass
+        a, b = C(), C()
+        a.x, a.y, a.z = 1, 2, 3
+        b.x, b.y, b.z = 4, 5, 6
+        del a.__dict__['y']
+        self.assertEqual(list(a.__dict__), ['x', 'z'])
+        self.assertEqual(list(b.__dict__), ['x', 'y', 'z'])
+        a.y = 7
+        self.assertEqual(list(a.__dict__), ['x', 'z', 'y'])
+        self.assertEqual(b.y, 5)
+        with self.assertRaises(KeyError):
+            del a.__dict__['missing']
+        self.assertEqual(a.__dict__, {'x': 1, 'z': 3, 'y': 7})
+
+    @support.cpython_only
+    def test_splittable_pop(self):
+        class C:
+            pass
+        a, b = C(), C()
+        a.x, a.y = 1, 2
+        b.x, b.y = 3, 4
+        self.assertEqual(a.__dict__.pop('x'), 1)
+        self.assertEqual(a.__dict__, {'y': 2})
+        self.assertEqual(b.__dict__, {'x': 3, 'y': 4})
+        self.assertEqual(b.__dict__.popitem(), ('y', 4))
+        self.assertEqual(b.__dict__, {'x': 3})
+
+    @support.cpython_only
+    def test_splittable_setdefault(self):
+        # Inserting into a split table in a different order than the
+        # shared keys must not reorder the other instances
+        class C:
+            pass
+        a, b = C(), C()
+        a.x, a.y = 1, 2
+        b.__dict__.setdefault('y', 3)
+        b.__dict__.setdefault('x', 4)
+        self.assertEqual(list(a.__dict__), ['x', 'y'])
+        self.assertEqual(list(b.__dict__), ['y', 'x'])
+        self.assertEqual(b.__dict__, {'x': 4, 'y': 3})
+
+    @support.cpython_only
+    def test_sizeof_compact(self):
+        # The entries are stored densely, so small dicts use less memory
+        # than a table of hash/key/value slots for every index
+        entry = struct.calcsize('n2P')
+        self.assertLess(sys.getsizeof({}), 8 * entry + 100)
+        d = dict.fromkeys(range(1000))
+        keys_size = sys.getsizeof(d) - sys.getsizeof({})
+        self.assertLess(keys_size, 2048 * entry)
+
 
 from test import mapping_tests
 
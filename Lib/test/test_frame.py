@@ -1,5 +1,6 @@
 import gc
 import sys
+import threading
 import types
 import unittest
 import weakref
@@ -161,5 +162,71 @@ class FrameLocalsTest(unittest.TestCase):
         self.assertEqual(inner.f_locals, {})
 
 
+class FrameStackTest(unittest.TestCase):
+    """
+    Tests for frames outliving the call which evaluated them.
+    """
+
+    def escape(self, a, b=2):
+        c = [a, b]
+        return sys._getframe()
+
+    def clobber(self, depth=10):
+        x = y = z = object()
+        if depth:
+            self.clobber(depth - 1)
+
+    def test_getframe_after_return(self):
+        f = self.escape(1)
+        self.clobber()
+        self.assertEqual(f.f_locals, {'self': self, 'a': 1, 'b': 2,
+                                      'c': [1, 2]})
+
+    def test_traceback_after_return(self):
+        def f(x):
+            y = x * 2
+            raise ValueError
+        try:
+            f(21)
+        except ValueError as e:
+            tb = e.__traceback__
+        self.clobber()
+        self.assertEqual(tb.tb_next.tb_frame.f_locals, {'x': 21, 'y': 42})
+
+    def test_recursion(self):
+        # Only the outermost call can reuse the zombie frame
+        frames = []
+        def f(n, a=1, b=2, c=3, d=4, e=5, g=6):
+            if n % 100 == 0:
+                frames.append(sys._getframe())
+            if n:
+                return f(n - 1) + 1
+            return 0
+        for i in range(3):
+            self.assertEqual(f(500), 500)
+            self.clobber()
+        self.assertEqual([fr.f_locals['n'] for fr in frames[:6]],
+                         [500, 400, 300, 200, 100, 0])
+
+    def test_generator(self):
+        def gen(x):
+            y = yield x
+            yield sys._getframe()
+        g = gen(1)
+        self.assertEqual(next(g), 1)
+        self.clobber()
+        f = g.send(2)
+        self.clobber()
+        self.assertEqual(f.f_locals, {'x': 1, 'y': 2})
+
+    def test_thread_exit(self):
+        frames = []
+        t = threading.Thread(target=lambda: frames.append(self.escape(5)))
+        t.start()
+        t.join()
+        f = frames.pop()
+        self.assertEqual(f.f_locals['c'], [5, 2])
+
+
 if __name__ == "__main__":
     unittest.main()
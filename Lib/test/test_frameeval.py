@@ -0,0 +1,93 @@
+# Test the frame evaluation hook through the _testframeeval module
+
+import unittest
+import weakref
+from test import support
+
+_testframeeval = support.import_module('_testframeeval')
+
+
+def _make_function(source="def f(x):\n    return x + 1"):
+    # A fresh code object, which no previous test (or previous run of the
+    # test) has counted
+    namespace = {}
+    exec(source, namespace)
+    return namespace['f']
+
+
+class FrameEvalTests(unittest.TestCase):
+
+    def setUp(self):
+        _testframeeval.install(3)
+        self.addCleanup(_testframeeval.uninstall)
+
+    def test_counts(self):
+        f = _make_function()
+        self.assertIsNone(_testframeeval.get_counts(f))
+        for i in range(10):
+            self.assertEqual(f(i), i + 1)
+        # Switched to the specialized evaluator after 3 calls
+        self.assertEqual(_testframeeval.get_counts(f), (3, 7))
+        self.assertEqual(_testframeeval.get_counts(f.__code__), (3, 7))
+
+    def test_generator_resumption(self):
+        gen = _make_function("def f():\n    yield 1\n    yield 2")
+        for i in range(5):
+            self.assertEqual(list(gen()), [1, 2])
+        self.assertEqual(_testframeeval.get_counts(gen), (3, 2))
+
+    def test_exceptions(self):
+        f = _make_function("def f():\n    raise KeyError")
+        for i in range(5):
+            self.assertRaises(KeyError, f)
+        self.assertEqual(_testframeeval.get_counts(f), (3, 2))
+
+    def test_install_twice(self):
+        self.assertRaises(RuntimeError, _testframeeval.install, 3)
+
+    def test_uninstall(self):
+        _testframeeval.uninstall()
+        try:
+            f = _make_function()
+            f(1)
+            self.assertIsNone(_testframeeval.get_counts(f))
+        finally:
+            _testframeeval.install(3)
+
+    def test_other_user(self):
+        # Two users of co_extra don't overwrite each other's data
+        class Data:
+            pass
+        f = _make_function()
+        f(0)
+        data = Data()
+        wr = weakref.ref(data)
+        _testframeeval.set_other(f, data)
+        for i in range(9):
+            f(i)
+        self.assertEqual(_testframeeval.get_counts(f), (3, 7))
+        self.assertIs(_testframeeval.get_other(f), data)
+        # The data of the other user is released when replaced...
+        _testframeeval.set_other(f, Data())
+        del data
+        self.assertIsNone(wr())
+        # ... and with the code object
+        data = _testframeeval.get_other(f)
+        wr = weakref.ref(data)
+        del data, f
+        support.gc_collect()
+        self.assertIsNone(wr())
+
+    def test_bad_arguments(self):
+        self.assertRaises(TypeError, _testframeeval.get_counts, 42)
+        self.assertRaises(TypeError, _testframeeval.set_other, 42, 1)
+        self.assertRaises(TypeError, _testframeeval.get_other, 42)
+        _testframeeval.uninstall()
+        try:
+            self.assertRaises(ValueError, _testframeeval.install, 0)
+        finally:
+            _testframeeval.install(3)
+
+
+if __name__ == "__main__":
+    unittest.main()
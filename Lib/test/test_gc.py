@@ -718,10 +718,14 @@ class GCTests(unittest.TestCase):
         for st in stats:
             self.assertIsInstance(st, dict)
             self.assertEqual(set(st),
-                             {"collected", "collections", "uncollectable"})
+                             {"collected", "collections", "uncollectable",
+                              "pause_time", "max_pause", "max_increment"})
             self.assertGreaterEqual(st["collected"], 0)
             self.assertGreaterEqual(st["collections"], 0)
             self.assertGreaterEqual(st["uncollectable"], 0)
+            self.assertGreaterEqual(st["max_pause"], 0)
+            self.assertGreaterEqual(st["pause_time"], st["max_pause"])
+            self.assertGreaterEqual(st["max_increment"], 0)
         # Check that collection counts are incremented correctly
         if gc.isenabled():
             self.addCleanup(gc.enable)
@@ -737,6 +741,276 @@ class GCTests(unittest.TestCase):
         self.assertEqual(new[0]["collections"], old[0]["collections"] + 1)
         self.assertEqual(new[1]["collections"], old[1]["collections"])
         self.assertEqual(new[2]["collections"], old[2]["collections"] + 1)
+        self.assertGreater(new[2]["pause_time"], old[2]["pause_time"])
+        self.assertGreater(new[2]["max_pause"], 0)
+
+    def set_parallel_mode(self, threads):
+        self.addCleanup(gc.set_mode, *gc.get_mode())
+        try:
+            gc.set_mode("parallel", threads)
+        except NotImplementedError:
+            self.skipTest("parallel collections are not supported")
+
+    def test_set_mode(self):
+        self.addCleanup(gc.set_mode, *gc.get_mode())
+        gc.set_mode("serial")
+        self.assertEqual(gc.get_mode(), ("serial", 1))
+        self.set_parallel_mode(3)
+        self.assertEqual(gc.get_mode(), ("parallel", 3))
+        gc.set_mode("parallel")
+        self.assertEqual(gc.get_mode(), ("parallel", 4))
+        gc.set_mode("serial")
+        self.assertEqual(gc.get_mode(), ("serial", 1))
+        self.assertRaises(ValueError, gc.set_mode, "spam")
+        self.assertRaises(ValueError, gc.set_mode, "parallel", 1)
+        self.assertRaises(ValueError, gc.set_mode, "parallel", 65)
+        self.assertRaises(TypeError, gc.set_mode, 1)
+        self.assertEqual(gc.get_mode(), ("serial", 1))
+
+    def test_parallel_collect(self):
+        # Enough objects for the generation to be split among the threads
+        self.set_parallel_mode(4)
+        class A:
+            __slots__ = ('a', 'b', '__weakref__')
+        gc.collect()
+        cycles = []
+        for i in range(50000):
+            a = A()
+            a.b = A()
+            a.b.a = a
+            cycles.append(a)
+        # Reachable cycles survive; references from the other objects of
+        # the generation must not be subtracted twice.
+        self.assertEqual(gc.collect(), 0)
+        wr = weakref.ref(cycles[0].b)
+        del cycles[1::2], a
+        self.assertEqual(gc.collect(), 50000)
+        self.assertIsNotNone(wr())
+        self.assertEqual(len(cycles), 25000)
+        self.assertTrue(all(c.b.a is c for c in cycles))
+        del cycles
+        self.assertEqual(gc.collect(), 50000)
+        self.assertIsNone(wr())
+
+    def test_set_incremental(self):
+        self.addCleanup(gc.set_incremental, gc.get_incremental())
+        gc.set_incremental(2.5)
+        self.assertEqual(gc.get_incremental(), 2.5)
+        gc.set_incremental(0)
+        self.assertEqual(gc.get_incremental(), 0.0)
+        self.assertRaises(ValueError, gc.set_incremental, -1)
+        self.assertRaises(ValueError, gc.set_incremental, float('nan'))
+        self.assertRaises(TypeError, gc.set_incremental, 'spam')
+
+    def test_incremental_collect(self):
+        class A:
+            pass
+        self.addCleanup(gc.set_incremental, gc.get_incremental())
+        self.addCleanup(gc.set_threshold, *gc.get_threshold())
+        self.addCleanup(gc.disable)
+        gc.set_incremental(0.1)
+        gc.set_threshold(100, 2, 2)
+        live = [[A() for i in range(10)] for j in range(1000)]
+        cycles = []
+        for i in range(5000):
+            a = A()
+            a.b = A()
+            a.b.a = a
+            cycles.append(a)
+        gc.collect()
+        wr = weakref.ref(cycles[0].b)
+        del cycles, a
+        # Only automatic collections run increments
+        gc.enable()
+        collections = gc.get_stats()[2]['collections']
+        junk = []
+        while wr() is not None and len(junk) < 100000:
+            junk.append([A() for i in range(5)])
+        gc.disable()
+        self.assertIsNone(wr())
+        self.assertGreater(gc.get_stats()[2]['collections'], collections + 1)
+        # The objects examined by the increments are still known
+        self.assertIn(live[-1], gc.get_objects())
+        self.assertIn(live, gc.get_referrers(live[0]))
+        gc.set_incremental(0)
+        self.assertIn(live[-1], gc.get_objects())
+        del live, junk
+        gc.collect()
+
+    def test_incremental_limit(self):
+        # An increment doesn't pull in a whole long-lived structure
+        class A:
+            pass
+        self.addCleanup(gc.set_incremental, gc.get_incremental())
+        self.addCleanup(gc.set_threshold, *gc.get_threshold())
+        self.addCleanup(gc.disable)
+        big = [[] for i in range(100000)]
+        gc.collect()
+        gc.set_incremental(0.1)
+        gc.set_threshold(100, 2, 2)
+        gc.enable()
+        collections = gc.get_stats()[2]['collections']
+        junk = []
+        while gc.get_stats()[2]['collections'] < collections + 20:
+            junk.append([A() for i in range(5)])
+        gc.disable()
+        self.assertLess(gc.get_stats()[2]['max_increment'], len(big) // 2)
+        del big, junk
+        gc.collect()
+
+    def test_incremental_large_cycle(self):
+        # A garbage cycle larger than an increment is still collected
+        class A:
+            pass
+        self.addCleanup(gc.set_incremental, gc.get_incremental())
+        self.addCleanup(gc.set_threshold, *gc.get_threshold())
+        self.addCleanup(gc.disable)
+        first = last = A()
+        for i in range(50000):
+            last.next = A()
+            last = last.next
+        last.next = first
+        gc.collect()
+        wr = weakref.ref(first)
+        del first, last
+        gc.set_incremental(0.1)
+        gc.set_threshold(100, 2, 2)
+        gc.enable()
+        junk = []
+        while wr() is not None and len(junk) < 200000:
+            junk.append([A() for i in range(5)])
+        gc.disable()
+        self.assertIsNone(wr())
+        del junk
+        gc.collect()
+
+    def test_incremental_mutations(self):
+        # Moving references around between increments never frees a
+        # reachable object
+        import random
+        freed = set()
+        class Node:
+            def __init__(self, serial):
+                self.serial = serial
+                self.refs = []
+            def __del__(self):
+                freed.add(self.serial)
+        self.addCleanup(gc.set_incremental, gc.get_incremental())
+        self.addCleanup(gc.set_threshold, *gc.get_threshold())
+        self.addCleanup(gc.disable)
+        rand = random.Random(0)
+        roots = [Node(i) for i in range(2000)]
+        for node in roots:
+            node.refs.append(rand.choice(roots))
+        serial = len(roots)
+        gc.collect()
+        gc.set_incremental(0.1)
+        gc.set_threshold(100, 2, 2)
+        collections = gc.get_stats()[2]['collections']
+        gc.enable()
+        while gc.get_stats()[2]['collections'] < collections + 50:
+            node = rand.choice(roots)
+            if rand.random() < 0.5:
+                # hide a root behind another node
+                node.refs.append(roots.pop(rand.randrange(len(roots))))
+            elif node.refs:
+                # bring a hidden node back to the roots
+                roots.append(node.refs.pop())
+            new = Node(serial)
+            serial += 1
+            new.refs.append(rand.choice(roots))
+            roots.append(new)
+            if rand.random() < 0.5:
+                # drop a root, which may make a cycle garbage
+                del roots[rand.randrange(len(roots))]
+        gc.disable()
+        reachable = set()
+        stack = list(roots)
+        while stack:
+            node = stack.pop()
+            if node.serial not in reachable:
+                reachable.add(node.serial)
+                stack.extend(node.refs)
+        self.assertTrue(freed)
+        self.assertFalse(reachable & freed)
+        del roots, stack, node, new
+        gc.collect()
+
+    def test_freeze(self):
+        self.addCleanup(gc.unfreeze)
+        gc.freeze()
+        self.assertGreater(gc.get_freeze_count(), 0)
+        gc.unfreeze()
+        self.assertEqual(gc.get_freeze_count(), 0)
+
+    def test_frozen_objects_are_ignored(self):
+        class A:
+            pass
+        self.addCleanup(gc.unfreeze)
+        self.addCleanup(gc.set_incremental, gc.get_incremental())
+        a = A()
+        a.a = a
+        wr = weakref.ref(a)
+        gc.collect()
+        gc.freeze()
+        del a
+        self.assertEqual(gc.collect(), 0)
+        self.assertIsNotNone(wr())
+        self.assertIn(wr(), gc.get_objects())
+        self.assertTrue(gc.is_tracked(wr()))
+        # Increments don't take frozen objects along either
+        self.addCleanup(gc.set_threshold, *gc.get_threshold())
+        self.addCleanup(gc.disable)
+        gc.set_incremental(0.1)
+        gc.set_threshold(100, 2, 2)
+        b = A()
+        b.b = b
+        b.a = wr()
+        gc.collect()
+        wrb = weakref.ref(b)
+        del b
+        gc.enable()
+        junk = []
+        while wrb() is not None and len(junk) < 100000:
+            junk.append([A() for i in range(5)])
+        gc.disable()
+        self.assertIsNone(wrb())
+        self.assertIsNotNone(wr())
+        self.assertIn(wr(), gc.get_objects())
+        del junk
+        gc.unfreeze()
+        self.assertEqual(gc.get_freeze_count(), 0)
+        gc.collect()
+        self.assertIsNone(wr())
+
+    @unittest.skipUnless(hasattr(gc, 'immortalize_heap'),
+                         'requires a build with immortal objects')
+    def test_immortalize_heap(self):
+        # Immortal objects are never freed, so use a child process
+        code = """if 1:
+            import gc, sys
+            data = [{'key': str(i)} for i in range(100)]
+            gc.immortalize_heap()
+            refcounts = [sys.getrefcount(data[0]), sys.getrefcount(data[0]['key'])]
+            copies = data[0], data[0]['key']
+            assert [sys.getrefcount(o) for o in copies] == refcounts
+            del copies, data
+            # New objects are still reference counted
+            obj = []
+            refcount = sys.getrefcount(obj)
+            copy = obj
+            assert sys.getrefcount(obj) == refcount + 1
+            print(gc.get_freeze_count() > 0)
+            """
+        rc, out, err = assert_python_ok('-c', code)
+        self.assertEqual(out.strip(), b'True')
+
+    def test_gcthreads_envvar(self):
+        code = "import gc; print(gc.get_mode())"
+        rc, out, err = assert_python_ok('-c', code, PYTHONGCTHREADS='1')
+        self.assertEqual(out.strip(), b"('serial', 1)")
+        rc, out, err = assert_python_ok('-c', code, PYTHONGCTHREADS='6')
+        self.assertIn(out.strip(), (b"('parallel', 6)", b"('serial', 1)"))
 
 
 class GCCallbackTests(unittest.TestCase):
@@ -214,6 +214,24 @@ class LongTest(unittest.TestCase):
 
 
 
+    def test_division_dc(self):
+        # divisors and quotients long enough for the divide-and-conquer
+        # division, which starts above 2 * KARATSUBA_CUTOFF digits
+        cutoff = 2 * KARATSUBA_CUTOFF
+        digits = [cutoff + 1, cutoff * 2 + 1, cutoff * 3, cutoff * 8 + 5]
+        for lenq in digits:
+            for leny in digits:
+                x = self.getran(lenq + leny)
+                y = self.getran(leny)
+                self.check_division(x, y)
+
+        # all the quotient digit estimates are too large
+        for leny in digits:
+            y = (1 << (leny * SHIFT)) - 1
+            self.check_division(y * y - 1, y)
+            self.check_division(y * y, y)
+            self.check_division((y << (leny * SHIFT)) + y, y + 2)
+
     def test_karatsuba(self):
         digits = list(range(1, 5)) + list(range(KARATSUBA_CUTOFF,
                                                 KARATSUBA_CUTOFF + 10))
@@ -338,6 +356,22 @@ class LongTest(unittest.TestCase):
                 x = self.getran(lenx)
                 self.check_format_1(x)
 
+    def test_format_dc(self):
+        # long enough for the divide-and-conquer conversions
+        for n in 1000, 5000, 10001, 40000:
+            self.assertEqual(str(10**n - 1), '9' * n)
+            self.assertEqual(str(-10**n), '-1' + '0' * n)
+            self.assertEqual(str(10**n + 1), '1' + '0' * (n - 1) + '1')
+            self.assertEqual(int('9' * n), 10**n - 1)
+            self.assertEqual(int('-1' + '0' * n), -10**n)
+            self.assertEqual(int(' 1' + '0' * (n - 1) + '1 '), 10**n + 1)
+            self.assertEqual(int('6' * n, 7), 7**n - 1)
+            self.assertEqual('{}'.format(10**n - 1), '9' * n)
+            x = self.getran(n // 9 * 2)
+            self.assertEqual(int(str(x)), x)
+            if n <= 5000:
+                self.assertEqual(str(x), self.slow_format(x, 10))
+
     def test_long(self):
         # Check conversions from string
         LL = [
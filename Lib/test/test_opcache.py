@@ -0,0 +1,434 @@
+"""
+Test the per-instruction inline caches of the eval loop.
+
+The caches of a code object are only allocated after it has run a number
+of times, so every test warms its function up first and then checks that
+the cached path notices changes to the namespaces it depends on.
+"""
+import builtins
+import gc
+import unittest
+import weakref
+
+# Must be at least OPCACHE_MIN_RUNS in Python/ceval.c.
+WARMUP = 2000
+
+
+def warm_up(func, *args):
+    for i in range(WARMUP):
+        func(*args)
+
+
+class LoadGlobalCacheTests(unittest.TestCase):
+
+    def make_func(self, namespace, body='return x'):
+        exec('def f():\n    ' + body, namespace)
+        return namespace['f']
+
+    def test_global_rebound(self):
+        ns = {'x': 1}
+        f = self.make_func(ns)
+        warm_up(f)
+        self.assertEqual(f(), 1)
+        ns['x'] = 2
+        self.assertEqual(f(), 2)
+
+    def test_global_deleted(self):
+        ns = {'x': 1}
+        f = self.make_func(ns)
+        warm_up(f)
+        del ns['x']
+        self.assertRaises(NameError, f)
+        ns['x'] = 3
+        self.assertEqual(f(), 3)
+
+    def test_builtin(self):
+        ns = {}
+        f = self.make_func(ns, 'return len')
+        warm_up(f)
+        self.assertIs(f(), len)
+
+        # shadowing a builtin with a global must be seen
+        ns['len'] = 'shadow'
+        self.assertEqual(f(), 'shadow')
+        del ns['len']
+        self.assertIs(f(), len)
+
+    def test_builtin_changed(self):
+        name = '_test_opcache_builtin'
+        ns = {}
+        f = self.make_func(ns, 'return ' + name)
+        setattr(builtins, name, 1)
+        try:
+            warm_up(f)
+            self.assertEqual(f(), 1)
+            setattr(builtins, name, 2)
+            self.assertEqual(f(), 2)
+        finally:
+            delattr(builtins, name)
+        self.assertRaises(NameError, f)
+
+    def test_different_globals(self):
+        # the same code object run with different globals must not mix
+        # up cached values
+        ns1 = {'x': 1}
+        f = self.make_func(ns1)
+        warm_up(f)
+        ns2 = {'x': 2}
+        g = type(f)(f.__code__, ns2)
+        self.assertEqual(f(), 1)
+        self.assertEqual(g(), 2)
+        self.assertEqual(f(), 1)
+
+    def test_cached_value_kept_alive(self):
+        class Value:
+            pass
+
+        ns = {'x': Value()}
+        f = self.make_func(ns)
+        warm_up(f)
+        old = f()
+        ns['x'] = Value()
+        new = f()
+        self.assertIsNot(old, new)
+        self.assertIs(new, ns['x'])
+
+    def test_globals_not_dict(self):
+        class Globals(dict):
+            pass
+
+        ns = Globals(x=1)
+        f = self.make_func(ns)
+        warm_up(f)
+        ns['x'] = 2
+        self.assertEqual(f(), 2)
+
+
+class AttrCacheTests(unittest.TestCase):
+
+    def test_load_attr(self):
+        class C:
+            def __init__(self, x):
+                self.x = x
+
+        def f(o):
+            return o.x
+
+        warm_up(f, C(1))
+        self.assertEqual(f(C(2)), 2)
+        o = C(3)
+        o.x = 4
+        self.assertEqual(f(o), 4)
+        del o.x
+        self.assertRaises(AttributeError, f, o)
+
+    def test_load_attr_shadowed_by_class(self):
+        class C:
+            def __init__(self):
+                self.x = 'instance'
+
+        def f(o):
+            return o.x
+
+        o = C()
+        warm_up(f, o)
+        self.assertEqual(f(o), 'instance')
+
+        # a data descriptor defined later on the class wins
+        C.x = property(lambda self: 'property')
+        self.assertEqual(f(o), 'property')
+        del C.x
+        self.assertEqual(f(o), 'instance')
+
+    def test_load_attr_shadowed_by_base_class(self):
+        class Base:
+            pass
+
+        class C(Base):
+            def __init__(self):
+                self.x = 'instance'
+
+        def f(o):
+            return o.x
+
+        o = C()
+        warm_up(f, o)
+        Base.x = property(lambda self: 'property')
+        self.assertEqual(f(o), 'property')
+
+    def test_load_attr_getattribute(self):
+        class C:
+            def __init__(self):
+                self.x = 'instance'
+
+        def f(o):
+            return o.x
+
+        o = C()
+        warm_up(f, o)
+        C.__getattribute__ = lambda self, name: 'getattribute'
+        self.assertEqual(f(o), 'getattribute')
+
+    def test_load_attr_class_changed(self):
+        class A:
+            def __init__(self):
+                self.x = 'A'
+
+        class B:
+            def __init__(self):
+                self.y = 'B'
+
+        def f(o):
+            return o.x
+
+        o = A()
+        warm_up(f, o)
+        o.__class__ = B
+        self.assertEqual(f(o), 'A')
+        o.__dict__.clear()
+        self.assertRaises(AttributeError, f, o)
+
+    def test_load_attr_polymorphic(self):
+        class A:
+            def __init__(self):
+                self.x = 'A'
+
+        class B:
+            def __init__(self):
+                self.y = None
+                self.x = 'B'
+
+        def f(o):
+            return o.x
+
+        objs = [A(), B(), A(), B()]
+        for i in range(WARMUP):
+            for o in objs:
+                self.assertEqual(f(o), type(o).__name__)
+
+    def test_load_attr_combined_dict(self):
+        class C:
+            pass
+
+        def f(o):
+            return o.x
+
+        o = C()
+        o.x = 1
+        warm_up(f, o)
+        # adding a non-string key turns the dict into a combined table
+        o.__dict__[1] = 2
+        self.assertEqual(f(o), 1)
+        o.x = 3
+        self.assertEqual(f(o), 3)
+
+    def test_store_attr(self):
+        class C:
+            def __init__(self):
+                self.x = 0
+
+        def f(o, v):
+            o.x = v
+
+        o = C()
+        warm_up(f, o, 1)
+        f(o, 2)
+        self.assertEqual(o.x, 2)
+        p = C()
+        f(p, 3)
+        self.assertEqual((o.x, p.x), (2, 3))
+        del p.x
+        f(p, 4)
+        self.assertEqual(p.x, 4)
+
+    def test_store_attr_descriptor(self):
+        class C:
+            def __init__(self):
+                self.x = 0
+
+        def f(o, v):
+            o.x = v
+
+        o = C()
+        warm_up(f, o, 1)
+        stored = []
+        C.x = property(lambda self: None, lambda self, v: stored.append(v))
+        f(o, 5)
+        self.assertEqual(stored, [5])
+        self.assertEqual(o.__dict__['x'], 1)
+
+    def test_store_attr_releases_old_value(self):
+        class C:
+            def __init__(self):
+                self.x = None
+
+        class Value:
+            pass
+
+        def f(o, v):
+            o.x = v
+
+        o = C()
+        warm_up(f, o, None)
+        v = Value()
+        r = weakref.ref(v)
+        f(o, v)
+        del v
+        self.assertIsNotNone(r())
+        f(o, None)
+        self.assertIsNone(r())
+
+    def test_store_attr_tracks_dict(self):
+        class C:
+            def __init__(self):
+                self.x = None
+
+        def f(o, v):
+            o.x = v
+
+        o = C()
+        warm_up(f, o, None)
+        f(o, o)
+        self.assertTrue(gc.is_tracked(o.__dict__))
+
+
+class SpecializationTests(unittest.TestCase):
+    # Hot code is quickened: its arithmetic, comparison and subscript
+    # instructions specialize for the operand types they see, and must go
+    # back to the generic path when those types change.
+
+    def test_add(self):
+        def f(a, b):
+            return a + b
+
+        warm_up(f, 1, 2)
+        self.assertEqual(f(1, 2), 3)
+        self.assertEqual(f(-1, 1), 0)
+        self.assertEqual(f(0, 0), 0)
+        self.assertEqual(f(2**30 - 1, 2**30 - 1), 2**31 - 2)
+        self.assertEqual(f(-2**30 + 1, -2**30 + 1), -2**31 + 2)
+        self.assertEqual(f(2**62, 2**62), 2**63)
+        self.assertIs(type(f(True, True)), int)
+        self.assertEqual(f(1.5, 2), 3.5)
+        self.assertEqual(f('a', 'b'), 'ab')
+        self.assertEqual(f([1], [2]), [1, 2])
+        warm_up(f, 1.0, 2.0)
+        self.assertEqual(f(1.0, 2.5), 3.5)
+        self.assertEqual(f(1, 2), 3)
+
+    def test_inplace_add(self):
+        def f(a, b):
+            a += b
+            return a
+
+        warm_up(f, 1, 2)
+        self.assertEqual(f(3, 4), 7)
+        x = [1]
+        self.assertIs(f(x, [2]), x)
+        self.assertEqual(x, [1, 2])
+
+    def test_subtract_multiply(self):
+        def f(a, b):
+            return a - b, a * b
+
+        warm_up(f, 1.5, 2.0)
+        self.assertEqual(f(1.5, 2.0), (-0.5, 3.0))
+        self.assertEqual(f(5, 3), (2, 15))
+        self.assertEqual(f(2.0, 3), (-1.0, 6.0))
+        self.assertRaises(TypeError, f, 'a', 'b')
+        warm_up(f, 5, 3)
+        self.assertEqual(f(-2**30 + 1, 2**30 - 1),
+                         (-2**31 + 2, -(2**30 - 1) ** 2))
+
+    def test_int_subclass(self):
+        class MyInt(int):
+            def __add__(self, other):
+                return 'add'
+            def __lt__(self, other):
+                return 'lt'
+
+        def f(a, b):
+            return a + b, a < b
+
+        warm_up(f, 1, 2)
+        self.assertEqual(f(MyInt(1), 2), ('add', 'lt'))
+        self.assertEqual(f(1, 2), (3, True))
+
+    def test_compare(self):
+        def f(a, b):
+            return a < b, a <= b, a == b, a != b, a > b, a >= b
+
+        for args in (1, 2), (1.5, 0.5), ('a', 'b'):
+            with self.subTest(args=args):
+                warm_up(f, *args)
+                for a, b in [(1, 2), (2, 2), (-3, 2), (2**70, 1), (-2**70, 1),
+                             (0.5, 1.5), (2.0, 2.0), (1, 1.0),
+                             ('abc', 'abd'), ('x', 'x'), ('', 'a'),
+                             ((1, 2), (1, 3))]:
+                    self.assertEqual(f(a, b),
+                                     (a < b, a <= b, a == b, a != b,
+                                      a > b, a >= b))
+                nan = float('nan')
+                self.assertEqual(f(nan, nan),
+                                 (False, False, False, True, False, False))
+                self.assertEqual(f(nan, 1.0),
+                                 (False, False, False, True, False, False))
+                self.assertRaises(TypeError, f, 1, 'a')
+
+    def test_compare_in_condition(self):
+        def f(a, b):
+            if a < b:
+                return 'less'
+            return 'not less'
+
+        warm_up(f, 1, 2)
+        self.assertEqual(f(1, 2), 'less')
+        self.assertEqual(f(2, 1), 'not less')
+        self.assertEqual(f(1.0, 2.0), 'less')
+
+    def test_list_subscript(self):
+        def f(seq, i):
+            return seq[i]
+
+        lst = [1, 2, 3]
+        warm_up(f, lst, 0)
+        self.assertEqual(f(lst, 2), 3)
+        self.assertEqual(f(lst, -1), 3)
+        self.assertEqual(f(lst, -3), 1)
+        self.assertRaises(IndexError, f, lst, 3)
+        self.assertRaises(IndexError, f, lst, -4)
+        self.assertRaises(IndexError, f, lst, 2**70)
+        self.assertRaises(IndexError, f, [], 0)
+        self.assertEqual(f(lst, True), 2)
+        self.assertEqual(f(lst, slice(1, None)), [2, 3])
+        self.assertEqual(f((4, 5), 1), 5)
+        self.assertEqual(f({0: 'x'}, 0), 'x')
+        self.assertRaises(TypeError, f, lst, 1.0)
+
+    def test_hot_loop(self):
+        # A function called once is quickened while it loops, and its
+        # instructions specialize and deoptimize in the middle of the loop.
+        def f(values):
+            total = 0
+            for i in range(len(values)):
+                total = total + values[i]
+            return total
+
+        values = list(range(3000)) + [0.5] * 10 + [2**70] + list(range(100))
+        self.assertEqual(f(values), sum(values))
+        self.assertEqual(f([]), 0)
+
+    def test_recursion(self):
+        # Frames running quickened and not yet quickened code of the same
+        # function may be on the stack together.
+        def f(n):
+            if n <= 0:
+                return 0
+            return f(n - 1) + 1
+
+        for i in range(WARMUP // 100):
+            self.assertEqual(f(100), 100)
+
+
+if __name__ == "__main__":
+    unittest.main()
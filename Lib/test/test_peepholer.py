@@ -1,4 +1,5 @@
 import dis
+import inspect
 import re
 import sys
 from io import StringIO
@@ -179,6 +180,12 @@ class TestTranforms(BytecodeTestCase):
         code = compile('a="x"*1000', '', 'single')
         self.assertInBytecode(code, 'LOAD_CONST', 1000)
 
+        # Nor large ints
+        code = compile('a=2**1000', '', 'single')
+        self.assertInBytecode(code, 'LOAD_CONST', 1000)
+        code = compile('a=1<<1000', '', 'single')
+        self.assertInBytecode(code, 'LOAD_CONST', 1000)
+
     def test_binary_subscr_on_unicode(self):
         # valid code get optimized
         code = compile('"foo"[0]', '', 'single')
@@ -278,6 +285,23 @@ class TestTranforms(BytecodeTestCase):
                           if instr.opname == 'RETURN_VALUE']
         self.assertEqual(len(returns), 2)
 
+    def test_return_after_constant_if(self):
+        # The dead "return 2" is filled with NOPs which end the code;
+        # compacting them must not look past the end of the code.
+        for test in ('1', '__debug__'):
+            source = ('def f():\n'
+                      '    if %s:\n'
+                      '        return 1\n'
+                      '    return 2\n' % test)
+            for optimize in (0, 1):
+                with self.subTest(test=test, optimize=optimize):
+                    ns = {}
+                    exec(compile(source, '<test>', 'exec',
+                                 optimize=optimize), ns)
+                    f = ns['f']
+                    self.assertEqual(f(), 2 if test == '__debug__' and
+                                          optimize else 1)
+
     def test_make_function_doesnt_bail(self):
         def f():
             def g()->1+1:
@@ -305,6 +329,72 @@ class TestTranforms(BytecodeTestCase):
                 self.assertFalse(instr.opname.startswith('BINARY_'))
                 self.assertFalse(instr.opname.startswith('BUILD_'))
 
+    def test_folding_errors_raised_at_run_time(self):
+        for source, exc in [('1/0', ZeroDivisionError),
+                            ('2.0**10000', OverflowError),
+                            ('-"a"', TypeError),
+                            ('"%d" % "a"', TypeError),
+                            ('"%z" % 1', ValueError),
+                            ('(1, 2)[5]', IndexError),
+                            ('"ab"[1.5]', TypeError)]:
+            code = compile(source, '', 'eval')
+            self.assertRaises(exc, eval, code)
+
+    def test_folding_inside_comprehensions(self):
+        def f():
+            return [x * (2 ** 8) for x in [1, 2, 3] if 1 + 1]
+        code = f.__code__.co_consts[1]
+        self.assertInBytecode(code, 'LOAD_CONST', 256)
+        self.assertNotInBytecode(code, 'BINARY_POWER')
+        self.assertNotInBytecode(code, 'POP_JUMP_IF_FALSE')
+        self.assertInBytecode(f, 'LOAD_CONST', (1, 2, 3))
+        self.assertEqual(f(), [256, 512, 768])
+
+    def test_debug_is_constant(self):
+        code = compile('if __debug__: a = 1\nelse: a = 2', '', 'exec',
+                       optimize=0)
+        self.assertInBytecode(code, 'LOAD_CONST', 1)
+        self.assertNotInBytecode(code, 'LOAD_CONST', 2)
+        self.assertNotInBytecode(code, 'LOAD_NAME', '__debug__')
+        code = compile('a = __debug__', '', 'exec', optimize=1)
+        self.assertInBytecode(code, 'LOAD_CONST', False)
+
+    def test_elim_dead_branches(self):
+        def f(x):
+            if 0:
+                print('if')
+            elif x:
+                print('elif')
+            while 0:
+                print('while')
+            return x if 1 else print('ifexp')
+        for instr in dis.get_instructions(f):
+            self.assertNotIn(instr.argval, ('if', 'while', 'ifexp'))
+        self.assertInBytecode(f, 'LOAD_CONST', 'elif')
+
+    def test_dead_code_keeps_semantics(self):
+        # A yield in dead code still makes a generator
+        def g():
+            if 0:
+                yield
+        self.assertTrue(inspect.isgeneratorfunction(g))
+        # and an assignment a local variable
+        x = 1
+        def f():
+            if 0:
+                x = 2
+            return x
+        self.assertRaises(UnboundLocalError, f)
+
+    def test_folded_constants_not_merged(self):
+        def f():
+            return (0.0,), (-0.0,), (1,), (True,), frozenset({0.0}), {-0.0}
+        a, b, c, d, e, s = f()
+        self.assertEqual(copysign(1.0, a[0]), 1.0)
+        self.assertEqual(copysign(1.0, b[0]), -1.0)
+        self.assertIs(type(c[0]), int)
+        self.assertIs(type(d[0]), bool)
+
 
 class TestBuglets(unittest.TestCase):
 
@@ -0,0 +1,135 @@
+import os
+import threading
+import time
+import unittest
+from test import support
+from test.support.script_helper import assert_python_ok
+
+sampleprof = support.import_module('sampleprof')
+
+
+def spin(duration):
+    end = time.monotonic() + duration
+    while time.monotonic() < end:
+        pass
+
+def sleeper(event):
+    event.wait()
+
+
+class SampleprofTest(unittest.TestCase):
+
+    def stacks_with(self, prof, code):
+        return {stack: count for stack, count in prof.getstacks().items()
+                if code in stack}
+
+    def test_samples(self):
+        prof = sampleprof.Profile(0.001)
+        self.assertFalse(prof.enabled)
+        with prof:
+            self.assertTrue(prof.enabled)
+            spin(0.2)
+        self.assertFalse(prof.enabled)
+        self.assertEqual(prof.interval, 0.001)
+        self.assertGreater(prof.samples, 0)
+
+        stacks = self.stacks_with(prof, spin.__code__)
+        self.assertTrue(stacks)
+        for stack in stacks:
+            # The stack starts with the outermost frame
+            self.assertIs(stack[-1], spin.__code__)
+            self.assertIn(self.test_samples.__code__, stack)
+        self.assertLessEqual(sum(stacks.values()), prof.samples)
+
+        # Disabling keeps the samples
+        samples = prof.samples
+        spin(0.05)
+        self.assertEqual(prof.samples, samples)
+
+        prof.clear()
+        self.assertEqual(prof.samples, 0)
+        self.assertEqual(prof.getstacks(), {})
+
+    def test_threads(self):
+        event = threading.Event()
+        thread = threading.Thread(target=sleeper, args=(event,))
+        thread.start()
+        try:
+            all_threads = sampleprof.Profile(0.001)
+            this_thread = sampleprof.Profile(0.001, all_threads=False)
+            with all_threads, this_thread:
+                spin(0.2)
+        finally:
+            event.set()
+            thread.join()
+        self.assertTrue(self.stacks_with(all_threads, sleeper.__code__))
+        self.assertTrue(self.stacks_with(all_threads, spin.__code__))
+        self.assertFalse(self.stacks_with(this_thread, sleeper.__code__))
+        self.assertTrue(self.stacks_with(this_thread, spin.__code__))
+
+    def test_enable_disable(self):
+        prof = sampleprof.Profile()
+        prof.disable()
+        prof.enable()
+        prof.enable()
+        prof.disable()
+        prof.disable()
+        prof.runcall(spin, 0.05)
+        self.assertFalse(prof.enabled)
+
+    def test_rate(self):
+        prof = sampleprof.Profile(0.01)
+        self.assertEqual(prof.duration, 0.0)
+        self.assertEqual(prof.rate(), 0.0)
+        prof.runcall(spin, 0.2)
+        duration = prof.duration
+        self.assertGreaterEqual(duration, 0.2)
+        self.assertEqual(prof.duration, duration)
+        self.assertAlmostEqual(prof.rate(), prof.samples / duration)
+        # The sampler never takes more than one sample per interval
+        self.assertLessEqual(prof.samples, duration / prof.interval + 1)
+        prof.clear()
+        self.assertEqual(prof.duration, 0.0)
+
+    def test_interval(self):
+        self.assertEqual(sampleprof.Profile().interval, 0.005)
+        self.assertRaises(ValueError, sampleprof.Profile, 0)
+        self.assertRaises(ValueError, sampleprof.Profile, -1.0)
+        self.assertRaises(OverflowError, sampleprof.Profile, 1e300)
+
+    def test_collapsed(self):
+        prof = sampleprof.Profile(0.001)
+        prof.runcall(spin, 0.1)
+        lines = prof.collapsed()
+        self.assertEqual(lines, sorted(lines))
+        label = sampleprof.label(spin.__code__)
+        spinning = 0
+        for line in lines:
+            frames, count = line.rsplit(' ', 1)
+            self.assertGreater(int(count), 0)
+            if frames.endswith(';' + label):
+                spinning += int(count)
+        self.assertGreater(spinning, 0)
+
+    def test_script(self):
+        script = os.path.join(os.path.dirname(__file__), 'pystone.py')
+        rc, out, err = assert_python_ok('-m', 'sampleprof', script, '5000')
+        self.assertIn(b'Proc0 (', out)
+        self.assertIn(b'per second', err)
+
+    def test_disabled_at_exit(self):
+        code = """if 1:
+            import atexit
+            # atexit functions are called last in, first out: register
+            # this one before sampleprof registers its own
+            atexit.register(lambda: print(prof.enabled))
+            import sampleprof
+            prof = sampleprof.Profile(0.001)
+            prof.enable()
+            """
+        rc, out, err = assert_python_ok('-c', code)
+        self.assertEqual(out.strip(), b'False')
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -262,5 +262,91 @@ class TestDecorateSortUndecorate(unittest.TestCase):
 
 #==============================================================================
 
+class Wrapper:
+    # Sorts like its wrapped object, through the generic compare
+    def __init__(self, obj):
+        self.obj = obj
+    def __lt__(self, other):
+        return self.obj < other.obj
+
+class TestOptimizedCompares(unittest.TestCase):
+    # list.sort() uses a specialized compare when all the keys have the
+    # same type: check it against the generic compare
+
+    def check_against_PyObject_RichCompare(self, L):
+        for data in (L, L[::-1]):
+            expected = [w.obj for w in sorted(map(Wrapper, data))]
+            result = sorted(data)
+            self.assertEqual(result, expected)
+            for x, y in zip(result, expected):
+                self.assertIs(x, y)
+
+    def test_homogeneous(self):
+        n = 50
+        ints = [random.randrange(-2**31, 2**31) for i in range(n)]
+        check = self.check_against_PyObject_RichCompare
+        check(ints)
+        check([x * 2**40 for x in ints])
+        check(ints + [2**100, -2**100])
+        check([float(x) / 3 for x in ints] +
+              [0.0, -0.0, float('inf'), float('-inf')])
+        check([str(x) for x in ints] + ['', 'a', 'ab', '\xe9'])
+        check([str(x) + '€' for x in ints])
+        check([str(x) + c for x in ints for c in ('', '\xe9', '€',
+                                                  '\U0001f600')])
+        check([b'%d' % x for x in ints])
+        check([(x % 5, str(x)) for x in ints])
+        check([(x % 5, str(x), x) for x in ints] + [(0,), (0, '0')])
+        check([(str(x % 5), x) for x in ints])
+        check([(float(x % 5), x) for x in ints])
+        check([((x % 5,), x) for x in ints])
+        check([(x % 5 * 2**40, x) for x in ints])
+        check([Wrapper(x) for x in ints])
+
+    def test_heterogeneous(self):
+        check = self.check_against_PyObject_RichCompare
+        check([1, 2.5, 0, -1.5, 2**70, True, False])
+        check([(1, 'a'), (0.5, 'b'), (1, 'c'), (True, 'd')])
+        self.assertRaises(TypeError, sorted, ['a', 1, 'b'])
+        self.assertRaises(TypeError, sorted, [(1, 'a'), (1, 2)])
+        self.assertRaises(TypeError, sorted, [(1,), ('a',)])
+        self.assertRaises(TypeError, sorted, [(1, 'a'), [0, 'b']])
+
+    def test_nan(self):
+        nan = float('nan')
+        data = [3.0, nan, 1.0, nan, 2.0]
+        self.assertEqual(list(map(id, sorted(data))),
+                         list(map(id, [w.obj for w in
+                                       sorted(map(Wrapper, data))])))
+
+    def test_class_assignment(self):
+        # A key can change its type during the sort
+        class A:
+            def __lt__(self, other):
+                return id(self) < id(other)
+        class B(A):
+            def __lt__(self, other):
+                self.__class__ = C
+                return A.__lt__(self, other)
+        class C(A):
+            def __lt__(self, other):
+                raise ZeroDivisionError
+        data = [B() for i in range(10)]
+        self.assertRaises(ZeroDivisionError, data.sort)
+
+    def test_compare_error(self):
+        class Bad:
+            def __lt__(self, other):
+                raise ZeroDivisionError
+        self.assertRaises(ZeroDivisionError, sorted, [Bad(), Bad()])
+        self.assertRaises(ZeroDivisionError, sorted, [(Bad(), 1), (Bad(), 2)])
+
+    def test_key_and_reverse(self):
+        data = [random.randrange(100) for i in range(200)]
+        expected = sorted(data, key=lambda x: Wrapper(str(x)), reverse=True)
+        self.assertEqual(sorted(data, key=str, reverse=True), expected)
+
+#==============================================================================
+
 if __name__ == "__main__":
     unittest.main()
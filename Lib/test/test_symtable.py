@@ -167,6 +167,20 @@ class SymtableTest(unittest.TestCase):
     def test_exec(self):
         symbols = symtable.symtable("def f(x): return x", "?", "exec")
 
+    def test_dead_code(self):
+        # The table matches the compiled code, from which the optimizer
+        # removed the only use of x
+        source = ("def g(x):\n"
+                  "    def f():\n"
+                  "        if 0:\n"
+                  "            return x\n"
+                  "    return f\n")
+        g = symtable.symtable(source, "?", "exec").lookup("g").get_namespace()
+        f = g.lookup("f").get_namespace()
+        self.assertEqual(f.get_frees(), ())
+        self.assertTrue(g.lookup("x").is_parameter())
+        self.assertFalse(g.lookup("x").is_free())
+
 
 if __name__ == '__main__':
     unittest.main()
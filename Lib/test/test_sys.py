@@ -1,9 +1,11 @@
 import unittest, test.support
 from test.support.script_helper import assert_python_ok, assert_python_failure
 import sys, io, os
+import dis
 import struct
 import subprocess
 import textwrap
+import time
 import warnings
 import operator
 import codecs
@@ -188,6 +190,89 @@ class SysModuleTest(unittest.TestCase):
         finally:
             sys.setswitchinterval(orig)
 
+    @unittest.skipUnless(threading, 'Threading required for this test.')
+    def test_switchpolicy(self):
+        self.assertRaises(TypeError, sys.setswitchpolicy)
+        self.assertRaises(TypeError, sys.setswitchpolicy, 1)
+        self.assertRaises(ValueError, sys.setswitchpolicy, "spam")
+        orig = sys.getswitchpolicy()
+        self.assertEqual(orig, "interval")
+        try:
+            for policy in "io", "interval", "io":
+                sys.setswitchpolicy(policy)
+                self.assertEqual(sys.getswitchpolicy(), policy)
+
+            # CPU-bound threads and threads doing blocking calls all
+            # get the GIL
+            done = []
+            def spin():
+                for i in range(20000):
+                    pass
+                done.append('spin')
+            def block():
+                for i in range(200):
+                    time.sleep(0)
+                done.append('block')
+            threads = [threading.Thread(target=f)
+                       for f in (spin, block, spin, block)]
+            for t in threads:
+                t.start()
+            for t in threads:
+                t.join()
+            self.assertEqual(sorted(done), ['block'] * 2 + ['spin'] * 2)
+        finally:
+            sys.setswitchpolicy(orig)
+
+    def test_utf8cache(self):
+        self.assertRaises(TypeError, sys.setutf8cache)
+        orig = sys.getutf8cache()
+        self.assertIs(orig, False)
+        text = 'h\xe9llo € \U0001f600' * 10
+        data = text.encode('utf-8')
+        try:
+            sys.setutf8cache(True)
+            self.assertIs(sys.getutf8cache(), True)
+
+            # valid non-ASCII data is kept along with the string
+            s = data.decode('utf-8')
+            self.assertEqual(s, text)
+            self.assertEqual(sys.getsizeof(s),
+                             sys.getsizeof(text) + len(data) + 1)
+            self.assertEqual(s.encode('utf-8'), data)
+            decoded, consumed = codecs.utf_8_decode(data + b'\xe2\x82')
+            self.assertEqual(consumed, len(data))
+            self.assertEqual(decoded.encode('utf-8'), data)
+            with io.TextIOWrapper(io.BytesIO(data), encoding='utf-8') as f:
+                s = f.read()
+            self.assertEqual(sys.getsizeof(s),
+                             sys.getsizeof(text) + len(data) + 1)
+            out = io.BytesIO()
+            f = io.TextIOWrapper(out, encoding='utf-8')
+            f.write(s)
+            f.flush()
+            self.assertEqual(out.getvalue(), data)
+
+            # a string modified in place drops its UTF-8 data
+            s = data.decode('utf-8')
+            s += '\xe9'
+            self.assertEqual(s.encode('utf-8'), data + b'\xc3\xa9')
+
+            # nothing is kept for ASCII strings or after an error
+            ascii = b'spam'.decode('utf-8')
+            self.assertEqual(sys.getsizeof(ascii), sys.getsizeof('spam'))
+            s = (data + b'\xff').decode('utf-8', 'surrogateescape')
+            self.assertEqual(sys.getsizeof(s),
+                             sys.getsizeof(text + '\udcff'))
+            self.assertEqual(s.encode('utf-8', 'surrogateescape'),
+                             data + b'\xff')
+
+            sys.setutf8cache(False)
+            self.assertIs(sys.getutf8cache(), False)
+            s = data.decode('utf-8')
+            self.assertEqual(sys.getsizeof(s), sys.getsizeof(text))
+        finally:
+            sys.setutf8cache(orig)
+
     def test_recursionlimit(self):
         self.assertRaises(TypeError, sys.getrecursionlimit, 42)
         oldlimit = sys.getrecursionlimit()
@@ -716,6 +801,91 @@ class SysModuleTest(unittest.TestCase):
         # The function has no parameter
         self.assertRaises(TypeError, sys._debugmallocstats, True)
 
+    @unittest.skipUnless(hasattr(sys, "_getmallocstats"),
+                         "sys._getmallocstats unavailable on this build")
+    def test_getmallocstats(self):
+        stats = sys._getmallocstats()
+        self.assertGreater(stats['arenas'], 0)
+        self.assertGreaterEqual(stats['arenas_highwater'], stats['arenas'])
+        self.assertGreaterEqual(stats['arenas_allocated_total'],
+                                stats['arenas_highwater'])
+        self.assertGreaterEqual(stats['free_pools'], 0)
+        classes = stats['size_classes']
+        self.assertTrue(classes)
+        sizes = [cls['size'] for cls in classes]
+        self.assertEqual(sizes, sorted(set(sizes)))
+        for cls in classes:
+            self.assertGreater(cls['pools'], 0)
+            self.assertGreater(cls['blocks_used'], 0)
+            self.assertGreaterEqual(cls['blocks_free'], 0)
+            self.assertIn(cls['arenas'], range(1, stats['arenas'] + 1))
+            self.assertGreaterEqual(cls['fragmentation'], 0.0)
+            self.assertLess(cls['fragmentation'], 1.0)
+
+        # The function has no parameter
+        self.assertRaises(TypeError, sys._getmallocstats, True)
+
+    def test_stats(self):
+        def f(n):
+            total = 0
+            for i in range(n):
+                total += i
+            return total
+
+        self.addCleanup(sys._stats_clear)
+        self.addCleanup(sys._stats_off)
+        sys._stats_clear()
+        sys._stats_on()
+        for _ in range(3):
+            f(10)
+        sys._stats_off()
+        stats = sys._stats()
+        f(10)
+        self.assertEqual(sys._stats(), stats)
+
+        opmap = dis.opmap
+        code = stats['code'][id(f.__code__)]
+        self.assertIs(code['code'], f.__code__)
+        self.assertEqual(code['calls'], 3)
+        self.assertEqual(code['opcodes'][opmap['RETURN_VALUE']], 3)
+        self.assertEqual(code['opcodes'][opmap['FOR_ITER']], 33)
+        for op, count in code['opcodes'].items():
+            self.assertGreaterEqual(stats['opcodes'][op], count)
+        self.assertGreaterEqual(stats['pairs'][opmap['FOR_ITER'],
+                                              opmap['STORE_FAST']], 30)
+        # Row 0 counts the first instruction of each frame evaluation
+        self.assertGreaterEqual(stats['pairs'][0, opmap['LOAD_CONST']], 3)
+        for counts in stats['cache'].values():
+            self.assertEqual(set(counts), {'hits', 'misses'})
+        for counts in stats['specialization'].values():
+            self.assertEqual(set(counts), {'success', 'failure'})
+
+        sys._stats_clear()
+        stats = sys._stats()
+        self.assertEqual(stats['opcodes'], {})
+        self.assertEqual(stats['code'], {})
+
+    def test_stats_equal_code(self):
+        # Code objects which compare equal are counted separately
+        ns1, ns2 = {}, {}
+        exec("def g(): return 1", ns1)
+        exec("def g(): return 1", ns2)
+        g1, g2 = ns1['g'], ns2['g']
+        self.assertEqual(g1.__code__, g2.__code__)
+        self.assertIsNot(g1.__code__, g2.__code__)
+
+        self.addCleanup(sys._stats_clear)
+        self.addCleanup(sys._stats_off)
+        sys._stats_clear()
+        sys._stats_on()
+        g1()
+        g2()
+        g2()
+        sys._stats_off()
+        code = sys._stats()['code']
+        self.assertEqual(code[id(g1.__code__)]['calls'], 1)
+        self.assertEqual(code[id(g2.__code__)]['calls'], 2)
+
     @unittest.skipUnless(hasattr(sys, "getallocatedblocks"),
                          "sys.getallocatedblocks unavailable on this build")
     def test_getallocatedblocks(self):
@@ -857,13 +1027,13 @@ class SizeofTest(unittest.TestCase):
             return inner
         check(get_cell().__closure__[0], size('P'))
         # code
-        check(get_cell().__code__, size('5i9Pi3P'))
-        check(get_cell.__code__, size('5i9Pi3P'))
+        check(get_cell().__code__, size('5i9Pi3P2Pic6P'))
+        check(get_cell.__code__, size('5i9Pi3P2Pic6P'))
         def get_cell2(x):
             def inner():
                 return x
             return inner
-        check(get_cell2.__code__, size('5i9Pi3P') + 1)
+        check(get_cell2.__code__, size('5i9Pi3P2Pic6P') + 1)
         # complex
         check(complex(0,1), size('2d'))
         # method_descriptor (descriptor object)
@@ -881,9 +1051,12 @@ class SizeofTest(unittest.TestCase):
         # method-wrapper (descriptor object)
         check({}.__iter__, size('2P'))
         # dict
-        check({}, size('n2P' + '2nPn' + 8*'n2P'))
+        # (dict object + keys header + one-byte indices + entries)
+        check({}, size('nQ2P') + struct.calcsize('2nP2n') + 8 +
+              5*struct.calcsize('n2P'))
         longdict = {1:1, 2:2, 3:3, 4:4, 5:5, 6:6, 7:7, 8:8}
-        check(longdict, size('n2P' + '2nPn') + 16*struct.calcsize('n2P'))
+        check(longdict, size('nQ2P') + struct.calcsize('2nP2n') + 16 +
+              11*struct.calcsize('n2P'))
         # dictionary-keyiterator
         check({}.keys(), size('P'))
         # dictionary-valueiterator
@@ -1028,13 +1201,13 @@ class SizeofTest(unittest.TestCase):
         # (PyTypeObject + PyAsyncMethods + PyNumberMethods + PyMappingMethods +
         #  PySequenceMethods + PyBufferProcs + 4P)
         s = vsize('P2n17Pl4Pn9Pn11PIP') + struct.calcsize('34P 3P 3P 10P 2P 4P')
-        # Separate block for PyDictKeysObject with 4 entries
-        s += struct.calcsize("2nPn") + 4*struct.calcsize("n2P")
+        # Separate block for PyDictKeysObject with 8 slots and 5 entries
+        s += struct.calcsize("2nP2n") + 8 + 5*struct.calcsize("n2P")
         # class
         class newstyleclass(object): pass
         check(newstyleclass, s)
         # dict with shared keys
-        check(newstyleclass().__dict__, size('n2P' + '2nPn'))
+        check(newstyleclass().__dict__, size('nQ2P') + 5*struct.calcsize('P'))
         # unicode
         # each tuple contains a string and its expected character size
         # don't put any static strings here, as they may contain
@@ -0,0 +1,224 @@
+# Testing the per-code object monitoring of sys.setmonitor()
+
+import gc
+import sys
+import unittest
+import weakref
+
+
+def branches(x):
+    if x:
+        y = 1
+    else:
+        y = 2
+    return y
+
+def loop(n):
+    total = 0
+    for i in range(n):
+        total += i
+    return total
+
+def untraced():
+    return 1
+
+def caller():
+    return untraced() + 1
+
+def generator():
+    yield 1
+    yield 2
+
+
+class Recorder:
+    def __init__(self, result=None):
+        self.events = []
+        self.result = result
+
+    def __call__(self, frame, event, arg):
+        self.events.append((frame.f_code.co_name, event, arg))
+        return self.result
+
+
+class SetMonitorTest(unittest.TestCase):
+
+    def monitor(self, func, events, callback):
+        self.addCleanup(sys.setmonitor, func.__code__, (), None)
+        sys.setmonitor(func.__code__, events, callback)
+
+    def first_line(self, func):
+        return func.__code__.co_firstlineno
+
+    def test_call_line_return(self):
+        rec = Recorder()
+        self.monitor(branches, ('call', 'line', 'return'), rec)
+        self.assertEqual(branches(True), 1)
+        first = self.first_line(branches)
+        self.assertEqual(rec.events,
+                         [('branches', 'call', None),
+                          ('branches', 'line', first + 1),
+                          ('branches', 'line', first + 2),
+                          ('branches', 'line', first + 5),
+                          ('branches', 'return', 1)])
+
+    def test_events_filter(self):
+        rec = Recorder()
+        self.monitor(branches, ('return',), rec)
+        branches(False)
+        self.assertEqual(rec.events, [('branches', 'return', 2)])
+
+    def test_loop_lines(self):
+        rec = Recorder()
+        self.monitor(loop, ('line',), rec)
+        loop(2)
+        first = self.first_line(loop)
+        lines = [arg for name, event, arg in rec.events]
+        # The jump back to the "for" line reports it again
+        self.assertEqual(lines, [first + 1, first + 2, first + 3,
+                                 first + 2, first + 3, first + 2,
+                                 first + 4])
+
+    def test_branch(self):
+        rec = Recorder()
+        self.monitor(branches, ('branch',), rec)
+        branches(True)
+        branches(False)
+        self.assertEqual(len(rec.events), 2)
+        (_, _, (src1, dest1)), (_, _, (src2, dest2)) = rec.events
+        self.assertEqual(src1, src2)
+        # The branch not taken goes to the next instruction
+        self.assertEqual(dest1, src1 + 2)
+        self.assertGreater(dest2, dest1)
+
+    def test_disable(self):
+        rec = Recorder(sys.monitor_disable)
+        self.monitor(loop, ('line', 'branch'), rec)
+        loop(3)
+        first_run = list(rec.events)
+        loop(3)
+        loop(0)
+        # Each location is reported once: the loop exit branch is only
+        # taken by the last iteration
+        self.assertEqual(rec.events, first_run)
+        first = self.first_line(loop)
+        lines = [arg for name, event, arg in rec.events if event == 'line']
+        # Only the jump back to the "for" line was seen twice, by another
+        # instruction than the start of the line
+        self.assertEqual(lines, [first + 1, first + 2, first + 3,
+                                 first + 2, first + 4])
+        branch = [arg for name, event, arg in rec.events if event == 'branch']
+        self.assertEqual(len(branch), 2)
+
+        # Setting a new callback reports the locations again
+        rec2 = Recorder()
+        sys.setmonitor(loop.__code__, ('line',), rec2)
+        loop(1)
+        self.assertEqual(len(rec2.events), 5)
+
+    def test_untraced_code(self):
+        rec = Recorder()
+        self.monitor(caller, ('call', 'line', 'return'), rec)
+        caller()
+        self.assertEqual({name for name, event, arg in rec.events},
+                         {'caller'})
+
+    def test_generator(self):
+        rec = Recorder()
+        self.monitor(generator, ('call', 'return'), rec)
+        self.assertEqual(list(generator()), [1, 2])
+        self.assertEqual([(event, arg) for name, event, arg in rec.events],
+                         [('call', None), ('return', 1),
+                          ('call', None), ('return', 2),
+                          ('call', None), ('return', None)])
+
+    def test_callback_error(self):
+        def callback(frame, event, arg):
+            if event == 'line':
+                raise ZeroDivisionError
+        self.monitor(branches, ('line',), callback)
+        self.assertRaises(ZeroDivisionError, branches, True)
+
+    def test_remove_in_callback(self):
+        events = []
+        def callback(frame, event, arg):
+            events.append(event)
+            sys.setmonitor(loop.__code__, (), None)
+            return sys.monitor_disable
+        self.monitor(loop, ('line', 'branch'), callback)
+        self.assertEqual(loop(3), 3)
+        self.assertEqual(events, ['line'])
+        self.assertIsNone(sys.getmonitor(loop.__code__))
+
+    def test_no_recursion(self):
+        rec = Recorder()
+        def callback(frame, event, arg):
+            # Monitored code run by a callback is not reported
+            caller()
+            rec(frame, event, arg)
+        self.monitor(caller, ('call',), callback)
+        caller()
+        self.assertEqual(rec.events, [('caller', 'call', None)])
+
+    def test_getmonitor(self):
+        rec = Recorder()
+        self.assertIsNone(sys.getmonitor(branches.__code__))
+        self.monitor(branches, ['line', 'call'], rec)
+        self.assertEqual(sys.getmonitor(branches.__code__),
+                         (frozenset({'line', 'call'}), rec))
+        sys.setmonitor(branches.__code__, ['line'], None)
+        self.assertIsNone(sys.getmonitor(branches.__code__))
+        self.assertRaises(TypeError, sys.getmonitor, branches)
+
+    def test_setmonitor_errors(self):
+        code = branches.__code__
+        self.assertRaises(TypeError, sys.setmonitor, branches, ('line',), id)
+        self.assertRaises(ValueError, sys.setmonitor, code, ('spam',), id)
+        self.assertRaises(ValueError, sys.setmonitor, code, (1,), id)
+        self.assertRaises(TypeError, sys.setmonitor, code, ('line',), 42)
+        self.assertRaises(TypeError, sys.setmonitor, code, 42, id)
+        self.assertIsNone(sys.getmonitor(code))
+
+    def test_cycle_collected(self):
+        # A callback referring to the code object it monitors makes a
+        # cycle which the garbage collector frees
+        ns = {}
+        exec('def f():\n    return 1', ns)
+        code = ns.pop('f').__code__
+        def callback(frame, event, arg, code=code):
+            pass
+        sys.setmonitor(code, ('call',), callback)
+        self.assertTrue(gc.is_tracked(code))
+        ref = weakref.ref(code)
+        del code, callback
+        gc.collect()
+        self.assertIsNone(ref())
+
+        # Code objects are only tracked while they are monitored
+        code = untraced.__code__
+        self.assertFalse(gc.is_tracked(code))
+        sys.setmonitor(code, ('call',), id)
+        self.assertTrue(gc.is_tracked(code))
+        sys.setmonitor(code, (), None)
+        self.assertFalse(gc.is_tracked(code))
+
+    def test_settrace(self):
+        # Monitoring and tracing don't get in the way of each other
+        rec = Recorder()
+        traced = []
+        def tracer(frame, event, arg):
+            if frame.f_code is branches.__code__:
+                traced.append(event)
+            return tracer
+        self.monitor(branches, ('call', 'return'), rec)
+        sys.settrace(tracer)
+        try:
+            branches(True)
+        finally:
+            sys.settrace(None)
+        self.assertEqual(traced, ['call', 'line', 'line', 'line', 'return'])
+        self.assertEqual([event for name, event, arg in rec.events],
+                         ['call', 'return'])
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -169,6 +169,13 @@ class UnicodeTest(string_tests.CommonTest,
         self.assertEqual(next(it), "\u3333")
         self.assertRaises(StopIteration, next, it)
 
+    def test_find_long_nonlatin(self):
+        # The low byte of U+0161 is "a": false positives for memchr()
+        self.check_find_long('a\u0161')
+        # The low byte of U+0100 is 0: memchr() is not used
+        self.check_find_long('\u0100\u0101')
+        self.check_find_long('\U0001f600\U0001f601\U0001f602')
+
     def test_count(self):
         string_tests.CommonTest.test_count(self)
         # check mixed argument types
@@ -1666,6 +1673,81 @@ class UnicodeTest(string_tests.CommonTest,
             self.assertRaises(UnicodeDecodeError,
                               (b'\xF4'+cb+b'\xBF\xBF').decode, 'utf-8')
 
+    def test_utf8_decode_kinds(self):
+        # Check that the result has the smallest kind, whatever the
+        # alignment and wherever decoding stops
+        def check(text, decoded):
+            self.assertEqual(decoded, text)
+            self.assertEqual(sys.getsizeof(decoded),
+                             sys.getsizeof(''.join(list(text))))
+
+        chars = ['a', '\x7f', '\x80', '\xe9', '\xff', '\u0100', '\u20ac',
+                 '\uffff', '\U00010000', '\U0010ffff']
+        for c1 in chars:
+            for c2 in chars:
+                for n in range(18):
+                    text = 'x' * n + c1 + 'y' * (17 - n) + c2
+                    data = text.encode('utf-8')
+                    check(text, data.decode('utf-8'))
+                    check(text + '\udcff',
+                          (data + b'\xff').decode('utf-8', 'surrogateescape'))
+                    if c2 < '\x80':
+                        continue
+                    # truncated last character
+                    check(text[:-1], data[:-1].decode('utf-8', 'ignore'))
+                    check(text[:-1] + '\ufffd',
+                          data[:-1].decode('utf-8', 'replace'))
+                    decoded, consumed = codecs.utf_8_decode(data[:-1])
+                    check(text[:-1], decoded)
+                    self.assertEqual(consumed,
+                                     len(text[:-1].encode('utf-8')))
+
+        # Invalid data after valid characters of each kind
+        for c in chars:
+            text = c * 20
+            data = text.encode('utf-8')
+            check(text + '\ufffd',
+                  (data + b'\x80').decode('utf-8', 'replace'))
+            check(text + 'a', (data + b'\xc0a').decode('utf-8', 'ignore'))
+            with self.assertRaises(UnicodeDecodeError) as cm:
+                (data + b'\xed\xa0\x80' + data).decode('utf-8')
+            self.assertEqual(cm.exception.start, len(data))
+            self.assertEqual(cm.exception.end, len(data) + 1)
+
+        # Large data is decoded into a string sized from a count of the
+        # characters: errors need more room than valid data
+        for c in chars:
+            text = ('abc' + c) * 20000
+            data = text.encode('utf-8')
+            check(text, data.decode('utf-8'))
+            if c >= '\x80':
+                check(text[:-1] + '\ufffd',
+                      data[:-1].decode('utf-8', 'replace'))
+                decoded, consumed = codecs.utf_8_decode(data[:-1])
+                check(text[:-1], decoded)
+                self.assertEqual(consumed, len(text[:-1].encode('utf-8')))
+            invalid = b'\x80\xc3\xe2\x82\xf0\x9f\x98\xff' * 10000
+            check(text + '\ufffd' * 50000 + text,
+                  (data + invalid + data).decode('utf-8', 'replace'))
+            check(text + text,
+                  (data + invalid + data).decode('utf-8', 'ignore'))
+
+    def test_utf8_decode_size(self):
+        # Large data is decoded into a string sized from a count of the
+        # characters, instead of one character per byte of the widest kind
+        import tracemalloc
+        for c in '\u20ac', '\u4e16', '\U0001f600':
+            for text in c * 100000, ('abc' + c) * 25000:
+                data = text.encode('utf-8')
+                tracemalloc.start()
+                try:
+                    decoded = data.decode('utf-8')
+                    peak = tracemalloc.get_traced_memory()[1]
+                finally:
+                    tracemalloc.stop()
+                self.assertEqual(decoded, text)
+                self.assertLess(peak, 2 * sys.getsizeof(decoded))
+
     def test_issue8271(self):
         # Issue #8271: during the decoding of an invalid UTF-8 byte sequence,
         # only the start byte and the continuation byte(s) are now considered
@@ -23,6 +23,11 @@ and this one is not used.
 
 Making CDataObject a variable size object would be a better solution, but more
 difficult in the presence of PyCFuncPtrObject.  Maybe later.
+
+There is room for a long double, but not its alignment: the allocator only
+aligns objects to 8 bytes, and a member with 16-byte alignment lets the
+compiler access CDataObject with aligned SSE moves.  The values are copied
+in and out with memcpy().
 */
 union value {
                 char c[16];
@@ -34,7 +39,7 @@ union value {
 #ifdef HAVE_LONG_LONG
                 PY_LONG_LONG ll;
 #endif
-                long double D;
+                char D[sizeof(long double)];
 };
 
 /*
@@ -306,7 +311,7 @@ struct tagPyCArgObject {
 #ifdef HAVE_LONG_LONG
         PY_LONG_LONG q;
 #endif
-        long double D;
+        char D[sizeof(long double)];   /* see union value */
         double d;
         float f;
         void *p;
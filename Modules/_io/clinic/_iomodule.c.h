@@ -127,7 +127,7 @@ PyDoc_STRVAR(_io_open__doc__,
 "opened in a binary mode.");
 
 #define _IO_OPEN_METHODDEF    \
-    {"open", (PyCFunction)_io_open, METH_VARARGS|METH_KEYWORDS, _io_open__doc__},
+    {"open", (PyCFunction)_io_open, METH_FASTCALL, _io_open__doc__},
 
 static PyObject *
 _io_open_impl(PyModuleDef *module, PyObject *file, const char *mode,
@@ -135,7 +135,7 @@ _io_open_impl(PyModuleDef *module, PyObject *file, const char *mode,
               const char *newline, int closefd, PyObject *opener);
 
 static PyObject *
-_io_open(PyModuleDef *module, PyObject *args, PyObject *kwargs)
+_io_open(PyModuleDef *module, PyObject *const *args, Py_ssize_t nargs, PyObject *kwnames)
 {
     PyObject *return_value = NULL;
     static char *_keywords[] = {"file", "mode", "buffering", "encoding", "errors", "newline", "closefd", "opener", NULL};
@@ -148,7 +148,7 @@ _io_open(PyModuleDef *module, PyObject *args, PyObject *kwargs)
     int closefd = 1;
     PyObject *opener = Py_None;
 
-    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|sizzziO:open", _keywords,
+    if (!_PyArg_ParseStackAndKeywords(args, nargs, kwnames, "O|sizzziO:open", _keywords,
         &file, &mode, &buffering, &encoding, &errors, &newline, &closefd, &opener))
         goto exit;
     return_value = _io_open_impl(module, file, mode, buffering, encoding, errors, newline, closefd, opener);
@@ -156,4 +156,4 @@ _io_open(PyModuleDef *module, PyObject *args, PyObject *kwargs)
 exit:
     return return_value;
 }
-/*[clinic end generated code: output=97cdc09bf68a8064 input=a9049054013a1b77]*/
+/*[clinic end generated code: output=cee37b630b51e742 input=a9049054013a1b77]*/
@@ -0,0 +1,538 @@
+/* Statistical profiler: the core of the sampleprof module.
+ *
+ * Instead of hooking every call and return like _lsprof, a Sampler starts
+ * a thread which wakes up every interval, takes the GIL, and records the
+ * Python call stack of each thread of the interpreter: the chain of frames
+ * starting at PyThreadState.frame.  Stacks are counted in a dict mapping
+ * tuples of code objects, outermost first, to the number of samples in
+ * which they were seen.
+ *
+ * The frames are only read with the GIL held.  Unlike faulthandler, which
+ * walks them without it because the process is about to die anyway, the
+ * sampler must never look at a frame being freed by another thread.  The
+ * cost is that a thread running Python code is sampled at its next eval
+ * loop check point, at most sys.getswitchinterval() later; a thread blocked
+ * with the GIL released is sampled right away.  The samples are scheduled
+ * at fixed deadlines, so that the time spent waiting for the GIL is not
+ * added to the interval: an interval shorter than the switch interval
+ * cannot be reached for CPU-bound code, and the sampler then takes one
+ * sample per switch.
+ *
+ * The enabled samplers are linked in a list, and the module registers an
+ * atexit function which disables them, so that no sampling thread is left
+ * running while the interpreter is finalized.
+ */
+
+#include "Python.h"
+#include "frameobject.h"
+
+#ifdef WITH_THREAD
+#include "pythread.h"
+#include <signal.h>
+#if defined(HAVE_PTHREAD_SIGMASK) && !defined(HAVE_BROKEN_PTHREAD_SIGMASK)
+#  include <pthread.h>
+#endif
+
+typedef struct SamplerObject {
+    PyObject_HEAD
+    PY_TIMEOUT_T interval_us;   /* time between two samples */
+    int all_threads;            /* sample every thread, or only the one
+                                   which called enable() */
+    long thread_id;             /* thread which called enable() */
+    PyObject *stacks;           /* dict: tuple of code objects -> count */
+    Py_ssize_t samples;         /* number of times the threads were
+                                   sampled */
+    int enabled;
+    _PyTime_t enabled_since;    /* monotonic clock when enabled */
+    _PyTime_t duration;         /* time spent enabled before that */
+    PyThreadState *tstate;      /* thread state of the sampling thread */
+    /* Held by the sampled threads while the sampler is enabled; releasing
+       it stops the sampling thread. */
+    PyThread_type_lock cancel_event;
+    /* Released by the sampling thread when it exits */
+    PyThread_type_lock running;
+    /* Links in the list of the enabled samplers */
+    struct SamplerObject *prev, *next;
+} SamplerObject;
+
+static PyTypeObject Sampler_Type;
+
+/* The enabled samplers, most recently enabled first */
+static SamplerObject *enabled_samplers = NULL;
+
+/* Count the stack of tstate in self->stacks.  Return -1 with an exception
+   set on error.  Called with the GIL held. */
+static int
+sample_thread(SamplerObject *self, PyThreadState *tstate)
+{
+    PyFrameObject *frame;
+    PyObject *stack, *count;
+    Py_ssize_t depth = 0;
+    int err;
+
+    for (frame = tstate->frame; frame != NULL; frame = frame->f_back)
+        depth++;
+    if (depth == 0)
+        return 0;
+    stack = PyTuple_New(depth);
+    if (stack == NULL)
+        return -1;
+    for (frame = tstate->frame; frame != NULL; frame = frame->f_back) {
+        Py_INCREF(frame->f_code);
+        PyTuple_SET_ITEM(stack, --depth, (PyObject *)frame->f_code);
+    }
+
+    count = PyDict_GetItemWithError(self->stacks, stack);
+    if (count == NULL) {
+        if (PyErr_Occurred()) {
+            Py_DECREF(stack);
+            return -1;
+        }
+        count = PyLong_FromLong(1);
+    }
+    else
+        count = PyLong_FromSsize_t(PyLong_AsSsize_t(count) + 1);
+    if (count == NULL) {
+        Py_DECREF(stack);
+        return -1;
+    }
+    err = PyDict_SetItem(self->stacks, stack, count);
+    Py_DECREF(stack);
+    Py_DECREF(count);
+    return err;
+}
+
+/* Take one sample of the threads.  Called with the GIL held. */
+static int
+take_sample(SamplerObject *self)
+{
+    PyThreadState *tstate;
+
+    tstate = PyInterpreterState_ThreadHead(self->tstate->interp);
+    for (; tstate != NULL; tstate = PyThreadState_Next(tstate)) {
+        if (tstate == self->tstate)
+            continue;
+        if (!self->all_threads && tstate->thread_id != self->thread_id)
+            continue;
+        if (sample_thread(self, tstate) < 0)
+            return -1;
+    }
+    self->samples++;
+    return 0;
+}
+
+static void
+sampler_thread(void *arg)
+{
+    SamplerObject *self = (SamplerObject *)arg;
+    PyThreadState *tstate = self->tstate;
+    _PyTime_t deadline, timeout;
+    PyLockStatus st;
+#if defined(HAVE_PTHREAD_SIGMASK) && !defined(HAVE_BROKEN_PTHREAD_SIGMASK)
+    sigset_t set;
+
+    /* Signals are for the main thread, not for us */
+    sigfillset(&set);
+    pthread_sigmask(SIG_SETMASK, &set, NULL);
+#endif
+
+    tstate->thread_id = PyThread_get_thread_ident();
+    _PyThreadState_Init(tstate);
+
+    /* The clock is only read with the GIL held: _PyTime_GetMonotonicClock()
+       is not thread-safe.  The samples are scheduled from enable(). */
+    PyEval_RestoreThread(tstate);
+    deadline = self->enabled_since + (_PyTime_t)self->interval_us * 1000;
+    timeout = deadline - _PyTime_GetMonotonicClock();
+    if (timeout < 0) {
+        deadline -= timeout;
+        timeout = 0;
+    }
+    PyEval_SaveThread();
+    for (;;) {
+        st = PyThread_acquire_lock_timed(
+            self->cancel_event,
+            _PyTime_AsMicroseconds(timeout, _PyTime_ROUND_CEILING), 0);
+        if (st == PY_LOCK_ACQUIRED) {
+            PyThread_release_lock(self->cancel_event);
+            break;
+        }
+        PyEval_RestoreThread(tstate);
+        if (take_sample(self) < 0) {
+            /* Stop sampling rather than report the error at each tick */
+            PyErr_WriteUnraisable((PyObject *)self);
+            PyEval_SaveThread();
+            break;
+        }
+        deadline += (_PyTime_t)self->interval_us * 1000;
+        timeout = deadline - _PyTime_GetMonotonicClock();
+        if (timeout < 0) {
+            /* Waiting for the GIL took longer than the interval: sample
+               again right away, but don't try to catch up the lost ones */
+            deadline -= timeout;
+            timeout = 0;
+        }
+        PyEval_SaveThread();
+    }
+
+    PyEval_RestoreThread(tstate);
+    PyThreadState_Clear(tstate);
+    PyThreadState_DeleteCurrent();
+    PyThread_release_lock(self->running);
+}
+
+static PyObject *
+sampler_enable(SamplerObject *self, PyObject *noargs)
+{
+    if (self->enabled)
+        Py_RETURN_NONE;
+
+    PyEval_InitThreads();
+    self->tstate = _PyThreadState_Prealloc(PyThreadState_GET()->interp);
+    if (self->tstate == NULL)
+        return PyErr_NoMemory();
+    self->thread_id = PyThread_get_thread_ident();
+
+    /* Arm these locks to serve as events when released */
+    PyThread_acquire_lock(self->cancel_event, 1);
+    PyThread_acquire_lock(self->running, 1);
+
+    self->enabled_since = _PyTime_GetMonotonicClock();
+    if (PyThread_start_new_thread(sampler_thread, self) == -1) {
+        PyThread_release_lock(self->running);
+        PyThread_release_lock(self->cancel_event);
+        PyThreadState_Clear(self->tstate);
+        PyThreadState_Delete(self->tstate);
+        self->tstate = NULL;
+        PyErr_SetString(PyExc_RuntimeError,
+                        "unable to start the sampling thread");
+        return NULL;
+    }
+    /* The sampling thread uses self until disable() joins it */
+    Py_INCREF(self);
+    self->enabled = 1;
+    self->prev = NULL;
+    self->next = enabled_samplers;
+    if (self->next != NULL)
+        self->next->prev = self;
+    enabled_samplers = self;
+    Py_RETURN_NONE;
+}
+
+PyDoc_STRVAR(enable_doc, "\
+enable()\n\
+\n\
+Start sampling the call stacks of the threads.");
+
+static PyObject *
+sampler_disable(SamplerObject *self, PyObject *noargs)
+{
+    if (!self->enabled)
+        Py_RETURN_NONE;
+
+    if (self->prev != NULL)
+        self->prev->next = self->next;
+    else
+        enabled_samplers = self->next;
+    if (self->next != NULL)
+        self->next->prev = self->prev;
+    self->prev = self->next = NULL;
+
+    /* Notify cancellation */
+    PyThread_release_lock(self->cancel_event);
+
+    /* Wait for the thread to join; it needs the GIL to exit */
+    Py_BEGIN_ALLOW_THREADS
+    PyThread_acquire_lock(self->running, 1);
+    Py_END_ALLOW_THREADS
+    PyThread_release_lock(self->running);
+
+    self->tstate = NULL;
+    self->enabled = 0;
+    self->duration += _PyTime_GetMonotonicClock() - self->enabled_since;
+    Py_DECREF(self);
+    Py_RETURN_NONE;
+}
+
+PyDoc_STRVAR(disable_doc, "\
+disable()\n\
+\n\
+Stop sampling, keeping the samples taken so far.");
+
+static PyObject *
+sampler_getstacks(SamplerObject *self, PyObject *noargs)
+{
+    return PyDict_Copy(self->stacks);
+}
+
+PyDoc_STRVAR(getstacks_doc, "\
+getstacks() -> dict\n\
+\n\
+Return a dictionary mapping the call stacks seen by the sampler to the\n\
+number of samples which saw them.  A stack is a tuple of code objects,\n\
+starting with the outermost frame.");
+
+static PyObject *
+sampler_clear(SamplerObject *self, PyObject *noargs)
+{
+    PyDict_Clear(self->stacks);
+    self->samples = 0;
+    self->duration = 0;
+    if (self->enabled)
+        self->enabled_since = _PyTime_GetMonotonicClock();
+    Py_RETURN_NONE;
+}
+
+PyDoc_STRVAR(clear_doc, "\
+clear()\n\
+\n\
+Forget the samples taken so far.");
+
+static PyMethodDef sampler_methods[] = {
+    {"enable",      (PyCFunction)sampler_enable, METH_NOARGS, enable_doc},
+    {"disable",     (PyCFunction)sampler_disable, METH_NOARGS, disable_doc},
+    {"getstacks",   (PyCFunction)sampler_getstacks, METH_NOARGS,
+     getstacks_doc},
+    {"clear",       (PyCFunction)sampler_clear, METH_NOARGS, clear_doc},
+    {NULL, NULL}
+};
+
+static PyObject *
+sampler_get_interval(SamplerObject *self, void *closure)
+{
+    return PyFloat_FromDouble((double)self->interval_us / 1e6);
+}
+
+static PyObject *
+sampler_get_samples(SamplerObject *self, void *closure)
+{
+    return PyLong_FromSsize_t(self->samples);
+}
+
+static PyObject *
+sampler_get_duration(SamplerObject *self, void *closure)
+{
+    _PyTime_t duration = self->duration;
+
+    if (self->enabled)
+        duration += _PyTime_GetMonotonicClock() - self->enabled_since;
+    return PyFloat_FromDouble(_PyTime_AsSecondsDouble(duration));
+}
+
+static PyObject *
+sampler_get_enabled(SamplerObject *self, void *closure)
+{
+    return PyBool_FromLong(self->enabled);
+}
+
+static PyGetSetDef sampler_getset[] = {
+    {"interval", (getter)sampler_get_interval, NULL,
+     "time between two samples, in seconds"},
+    {"samples", (getter)sampler_get_samples, NULL,
+     "number of times the threads were sampled"},
+    {"duration", (getter)sampler_get_duration, NULL,
+     "time spent sampling, in seconds"},
+    {"enabled", (getter)sampler_get_enabled, NULL,
+     "True while the sampler is running"},
+    {NULL}
+};
+
+static int
+sampler_init(SamplerObject *self, PyObject *args, PyObject *kw)
+{
+    static char *kwlist[] = {"interval", "all_threads", 0};
+    double interval = 0.005;
+    int all_threads = 1;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kw, "|dp:Sampler", kwlist,
+                                     &interval, &all_threads))
+        return -1;
+    if (self->enabled) {
+        PyErr_SetString(PyExc_RuntimeError,
+                        "cannot reinitialize an enabled sampler");
+        return -1;
+    }
+    if ((interval * 1e6) >= (double) PY_TIMEOUT_MAX) {
+        PyErr_SetString(PyExc_OverflowError, "interval is too large");
+        return -1;
+    }
+    self->interval_us = (PY_TIMEOUT_T)(interval * 1e6);
+    if (self->interval_us <= 0) {
+        PyErr_SetString(PyExc_ValueError,
+                        "interval must be greater than 0");
+        return -1;
+    }
+    self->all_threads = all_threads;
+
+    if (self->stacks == NULL) {
+        self->stacks = PyDict_New();
+        if (self->stacks == NULL)
+            return -1;
+    }
+    if (self->cancel_event == NULL) {
+        self->cancel_event = PyThread_allocate_lock();
+        if (self->cancel_event == NULL) {
+            PyErr_NoMemory();
+            return -1;
+        }
+    }
+    if (self->running == NULL) {
+        self->running = PyThread_allocate_lock();
+        if (self->running == NULL) {
+            PyErr_NoMemory();
+            return -1;
+        }
+    }
+    return 0;
+}
+
+static void
+sampler_dealloc(SamplerObject *self)
+{
+    /* An enabled sampler is kept alive by its thread */
+    assert(!self->enabled);
+    Py_XDECREF(self->stacks);
+    if (self->cancel_event != NULL)
+        PyThread_free_lock(self->cancel_event);
+    if (self->running != NULL)
+        PyThread_free_lock(self->running);
+    Py_TYPE(self)->tp_free((PyObject *)self);
+}
+
+PyDoc_STRVAR(sampler_doc, "\
+Sampler(interval=0.005, all_threads=True)\n\
+\n\
+Statistical profiler recording the Python call stacks of the threads\n\
+every interval seconds while it is enabled.  If all_threads is false,\n\
+only the thread which called enable() is sampled.\n\
+\n\
+A thread running Python code is only sampled when it releases the GIL,\n\
+so an interval shorter than sys.getswitchinterval() is not reached for\n\
+CPU-bound code: compare samples / duration with 1 / interval.");
+
+static PyTypeObject Sampler_Type = {
+    PyVarObject_HEAD_INIT(NULL, 0)
+    "_sampleprof.Sampler",                  /* tp_name */
+    sizeof(SamplerObject),                  /* tp_basicsize */
+    0,                                      /* tp_itemsize */
+    (destructor)sampler_dealloc,            /* tp_dealloc */
+    0,                                      /* tp_print */
+    0,                                      /* tp_getattr */
+    0,                                      /* tp_setattr */
+    0,                                      /* tp_reserved */
+    0,                                      /* tp_repr */
+    0,                                      /* tp_as_number */
+    0,                                      /* tp_as_sequence */
+    0,                                      /* tp_as_mapping */
+    0,                                      /* tp_hash */
+    0,                                      /* tp_call */
+    0,                                      /* tp_str */
+    0,                                      /* tp_getattro */
+    0,                                      /* tp_setattro */
+    0,                                      /* tp_as_buffer */
+    Py_TPFLAGS_DEFAULT | Py_TPFLAGS_BASETYPE, /* tp_flags */
+    sampler_doc,                            /* tp_doc */
+    0,                                      /* tp_traverse */
+    0,                                      /* tp_clear */
+    0,                                      /* tp_richcompare */
+    0,                                      /* tp_weaklistoffset */
+    0,                                      /* tp_iter */
+    0,                                      /* tp_iternext */
+    sampler_methods,                        /* tp_methods */
+    0,                                      /* tp_members */
+    sampler_getset,                         /* tp_getset */
+    0,                                      /* tp_base */
+    0,                                      /* tp_dict */
+    0,                                      /* tp_descr_get */
+    0,                                      /* tp_descr_set */
+    0,                                      /* tp_dictoffset */
+    (initproc)sampler_init,                 /* tp_init */
+    PyType_GenericAlloc,                    /* tp_alloc */
+    PyType_GenericNew,                      /* tp_new */
+    PyObject_Del,                           /* tp_free */
+};
+
+static PyObject *
+sampleprof_disable_all(PyObject *module, PyObject *noargs)
+{
+    while (enabled_samplers != NULL) {
+        PyObject *res = sampler_disable(enabled_samplers, NULL);
+        if (res == NULL)
+            return NULL;
+        Py_DECREF(res);
+    }
+    Py_RETURN_NONE;
+}
+
+PyDoc_STRVAR(disable_all_doc, "\
+_disable_all()\n\
+\n\
+Disable all the enabled samplers.  Registered with atexit.");
+
+#endif  /* WITH_THREAD */
+
+static PyMethodDef sampleprof_methods[] = {
+#ifdef WITH_THREAD
+    {"_disable_all", (PyCFunction)sampleprof_disable_all, METH_NOARGS,
+     disable_all_doc},
+#endif
+    {NULL, NULL}
+};
+
+static struct PyModuleDef sampleprofmodule = {
+    PyModuleDef_HEAD_INIT,
+    "_sampleprof",
+    "Sampling profiler.",
+    -1,
+    sampleprof_methods,
+    NULL,
+    NULL,
+    NULL,
+    NULL
+};
+
+PyMODINIT_FUNC
+PyInit__sampleprof(void)
+{
+    PyObject *module, *atexit, *disable_all, *res;
+
+#ifndef WITH_THREAD
+    PyErr_SetString(PyExc_ImportError,
+                    "the sampling profiler needs thread support");
+    return NULL;
+#else
+    if (PyType_Ready(&Sampler_Type) < 0)
+        return NULL;
+    module = PyModule_Create(&sampleprofmodule);
+    if (module == NULL)
+        return NULL;
+    Py_INCREF(&Sampler_Type);
+    if (PyModule_AddObject(module, "Sampler",
+                           (PyObject *)&Sampler_Type) < 0) {
+        Py_DECREF(module);
+        return NULL;
+    }
+
+    /* Stop the sampling threads before the interpreter is finalized */
+    atexit = PyImport_ImportModule("atexit");
+    if (atexit == NULL) {
+        Py_DECREF(module);
+        return NULL;
+    }
+    disable_all = PyObject_GetAttrString(module, "_disable_all");
+    if (disable_all == NULL) {
+        Py_DECREF(atexit);
+        Py_DECREF(module);
+        return NULL;
+    }
+    res = PyObject_CallMethod(atexit, "register", "O", disable_all);
+    Py_DECREF(disable_all);
+    Py_DECREF(atexit);
+    if (res == NULL) {
+        Py_DECREF(module);
+        return NULL;
+    }
+    Py_DECREF(res);
+    return module;
+#endif
+}
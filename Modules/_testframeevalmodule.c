@@ -0,0 +1,253 @@
+/* Reference user of the frame evaluation hook (PyInterpreterState.eval_frame)
+ * and of the co_extra scratch space of code objects.
+ *
+ * install() replaces the frame evaluation function of the interpreter by a
+ * counting one, which works the way a method JIT would: it counts the calls
+ * of every code object in a small structure kept in its co_extra slot, and
+ * once a code object has been called threshold times, it "compiles" it by
+ * switching the evaluator recorded there to a specialized one.  The
+ * specialized evaluator here just counts the calls it gets and runs the
+ * frame with the default evaluator, where a real JIT would run its machine
+ * code.
+ *
+ * set_other() and get_other() stand for a second, unrelated user of
+ * co_extra, which keeps an object in a slot of its own.
+ */
+
+#include "Python.h"
+#include "frameobject.h"
+
+typedef struct {
+    _PyFrameEvalFunction eval;  /* evaluator of the code object */
+    Py_ssize_t calls;           /* calls seen by the counting evaluator */
+    Py_ssize_t specialized_calls;   /* calls of the specialized evaluator */
+} CodeInfo;
+
+static Py_ssize_t threshold;
+static int installed = 0;
+static _PyFrameEvalFunction previous_eval_frame;
+
+/* Slots of co_extra, requested on first use */
+static Py_ssize_t info_index = -1;
+static Py_ssize_t other_index = -1;
+
+static int
+request_index(Py_ssize_t *index, freefunc free)
+{
+    if (*index < 0) {
+        *index = _PyEval_RequestCodeExtraIndex(free);
+        if (*index < 0) {
+            PyErr_SetString(PyExc_RuntimeError,
+                            "no co_extra slot left");
+            return -1;
+        }
+    }
+    return 0;
+}
+
+static PyObject *
+specialized_eval(PyFrameObject *f, int throwflag)
+{
+    void *info;
+
+    if (_PyCode_GetExtra((PyObject *)f->f_code, info_index, &info) < 0)
+        return NULL;
+    /* Resuming a generator is not a new call */
+    if (f->f_lasti == -1)
+        ((CodeInfo *)info)->specialized_calls++;
+    return previous_eval_frame(f, throwflag);
+}
+
+static PyObject *
+counting_eval(PyFrameObject *f, int throwflag)
+{
+    PyObject *co = (PyObject *)f->f_code;
+    CodeInfo *info;
+
+    if (_PyCode_GetExtra(co, info_index, (void **)&info) < 0)
+        return NULL;
+    if (info == NULL) {
+        info = PyMem_Malloc(sizeof(CodeInfo));
+        if (info == NULL)
+            return PyErr_NoMemory();
+        info->eval = counting_eval;
+        info->calls = 0;
+        info->specialized_calls = 0;
+        if (_PyCode_SetExtra(co, info_index, info) < 0) {
+            PyMem_Free(info);
+            return NULL;
+        }
+    }
+    if (info->eval != counting_eval)
+        return info->eval(f, throwflag);
+    if (f->f_lasti == -1 && ++info->calls >= threshold)
+        info->eval = specialized_eval;
+    return previous_eval_frame(f, throwflag);
+}
+
+static PyObject *
+install(PyObject *self, PyObject *args)
+{
+    PyInterpreterState *interp = PyThreadState_GET()->interp;
+    Py_ssize_t n;
+
+    if (!PyArg_ParseTuple(args, "n:install", &n))
+        return NULL;
+    if (n < 1) {
+        PyErr_SetString(PyExc_ValueError, "threshold must be positive");
+        return NULL;
+    }
+    if (installed) {
+        PyErr_SetString(PyExc_RuntimeError, "already installed");
+        return NULL;
+    }
+    if (request_index(&info_index, PyMem_Free) < 0)
+        return NULL;
+    threshold = n;
+    previous_eval_frame = interp->eval_frame;
+    interp->eval_frame = counting_eval;
+    installed = 1;
+    Py_RETURN_NONE;
+}
+
+PyDoc_STRVAR(install_doc,
+"install(threshold)\n\
+\n\
+Make the interpreter run every frame through the counting evaluator, which\n\
+switches a code object to the specialized evaluator after threshold calls.");
+
+static PyObject *
+uninstall(PyObject *self, PyObject *noargs)
+{
+    PyInterpreterState *interp = PyThreadState_GET()->interp;
+
+    if (!installed) {
+        PyErr_SetString(PyExc_RuntimeError, "not installed");
+        return NULL;
+    }
+    interp->eval_frame = previous_eval_frame;
+    installed = 0;
+    Py_RETURN_NONE;
+}
+
+PyDoc_STRVAR(uninstall_doc,
+"uninstall()\n\
+\n\
+Restore the frame evaluation function replaced by install().");
+
+/* Return the code object of a function or code object, or NULL */
+static PyObject *
+get_code(PyObject *arg)
+{
+    if (PyFunction_Check(arg))
+        arg = PyFunction_GET_CODE(arg);
+    if (!PyCode_Check(arg)) {
+        PyErr_SetString(PyExc_TypeError, "expected a function or code object");
+        return NULL;
+    }
+    return arg;
+}
+
+static PyObject *
+get_counts(PyObject *self, PyObject *arg)
+{
+    PyObject *co = get_code(arg);
+    CodeInfo *info;
+
+    if (co == NULL)
+        return NULL;
+    if (info_index < 0)
+        Py_RETURN_NONE;
+    if (_PyCode_GetExtra(co, info_index, (void **)&info) < 0)
+        return NULL;
+    if (info == NULL)
+        Py_RETURN_NONE;
+    return Py_BuildValue("nn", info->calls, info->specialized_calls);
+}
+
+PyDoc_STRVAR(get_counts_doc,
+"get_counts(code) -> (calls, specialized_calls) or None\n\
+\n\
+Return the number of calls of a function or code object counted before and\n\
+after its switch to the specialized evaluator, or None if the counting\n\
+evaluator has not seen it.");
+
+static void
+other_free(void *obj)
+{
+    Py_DECREF((PyObject *)obj);
+}
+
+static PyObject *
+set_other(PyObject *self, PyObject *args)
+{
+    PyObject *arg, *co, *obj;
+
+    if (!PyArg_ParseTuple(args, "OO:set_other", &arg, &obj))
+        return NULL;
+    co = get_code(arg);
+    if (co == NULL || request_index(&other_index, other_free) < 0)
+        return NULL;
+    Py_INCREF(obj);
+    if (_PyCode_SetExtra(co, other_index, obj) < 0) {
+        Py_DECREF(obj);
+        return NULL;
+    }
+    Py_RETURN_NONE;
+}
+
+PyDoc_STRVAR(set_other_doc,
+"set_other(code, obj)\n\
+\n\
+Keep obj in a co_extra slot of a function or code object distinct from the\n\
+one of the counting evaluator.");
+
+static PyObject *
+get_other(PyObject *self, PyObject *arg)
+{
+    PyObject *co = get_code(arg);
+    void *obj;
+
+    if (co == NULL)
+        return NULL;
+    if (other_index < 0)
+        Py_RETURN_NONE;
+    if (_PyCode_GetExtra(co, other_index, &obj) < 0)
+        return NULL;
+    if (obj == NULL)
+        Py_RETURN_NONE;
+    Py_INCREF((PyObject *)obj);
+    return (PyObject *)obj;
+}
+
+PyDoc_STRVAR(get_other_doc,
+"get_other(code) -> object or None\n\
+\n\
+Return the object stored by set_other(), or None.");
+
+static PyMethodDef frameeval_methods[] = {
+    {"install", install, METH_VARARGS, install_doc},
+    {"uninstall", uninstall, METH_NOARGS, uninstall_doc},
+    {"get_counts", get_counts, METH_O, get_counts_doc},
+    {"set_other", set_other, METH_VARARGS, set_other_doc},
+    {"get_other", get_other, METH_O, get_other_doc},
+    {NULL, NULL}        /* sentinel */
+};
+
+static struct PyModuleDef frameevalmodule = {
+    PyModuleDef_HEAD_INIT,
+    "_testframeeval",
+    NULL,
+    -1,
+    frameeval_methods,
+    NULL,
+    NULL,
+    NULL,
+    NULL
+};
+
+PyMODINIT_FUNC
+PyInit__testframeeval(void)
+{
+    return PyModule_Create(&frameevalmodule);
+}
@@ -26,6 +26,9 @@
 #include "Python.h"
 #include "frameobject.h"        /* for PyFrame_ClearFreeList */
 #include "pytime.h"             /* for _PyTime_GetMonotonicClock() */
+#ifdef WITH_THREAD
+#include "pythread.h"           /* for parallel collections */
+#endif
 
 /* Get an object's GC head */
 #define AS_GC(o) ((PyGC_Head *)(o)-1)
@@ -55,6 +58,11 @@ static struct gc_generation generations[NUM_GENERATIONS] = {
 
 PyGC_Head *_PyGC_generation0 = GEN_HEAD(0);
 
+/* objects moved out of the generations by gc.freeze(); the collector never
+   examines them */
+static PyGC_Head permanent_generation = {{&permanent_generation,
+                                          &permanent_generation, 0}};
+
 static int enabled = 1; /* automatic collection enabled? */
 
 /* true if we are currently running the collector */
@@ -158,6 +166,70 @@ static Py_ssize_t long_lived_pending = 0;
    the algorithm was refined in response to issue #14775.
 */
 
+/*
+   NOTE: about incremental collections.
+
+   A full collection examines every object of the oldest generation at
+   once, so its pause grows with the heap.  With gc.set_incremental(),
+   the oldest generation is instead examined in increments.  Each
+   increment is an ordinary stop-the-world collection of the young
+   generations plus a slice of the oldest one, sized from the requested
+   pause and the measured cost per object.
+
+   No write barrier is needed between increments: the collector only
+   frees objects whose reference counts are fully explained by references
+   from within the set being collected, so collecting any subset of the
+   objects is safe; objects referred to from outside the subset just
+   survive.  Each increment takes its own snapshot of the reference counts
+   of its set and trusts nothing computed by earlier increments, so the
+   program can freely mutate the objects between increments.  To find
+   cycles anyway, an increment takes along the objects not yet examined in
+   the current pass that the slice refers to, directly or not; only cycles
+   through objects examined earlier in the pass are left for the next pass.
+
+   The objects taken along count against the size of the increment, which
+   is a hard limit: a long-lived structure reachable from the slice is
+   otherwise pulled in whole, and the pause becomes as long as that of a
+   full collection.  When the limit cuts a slice short, a garbage cycle
+   larger than an increment can go unnoticed by every pass.  Such a pass
+   sets incremental_truncated, and if the oldest generation grew by more
+   than 25% since the previous pass, as for the quadratic-time guard of
+   full collections, the next pass is replaced by a full collection.
+
+   During a pass the oldest generation is split in two lists: the objects
+   still pending, in GEN_HEAD(NUM_GENERATIONS-1), and those already
+   examined, in old_visited.  The _PyGC_REFS_MASK_VISITED bit of an
+   examined object equals visited_space; at the end of a pass the lists
+   are merged back and visited_space is flipped, which makes every object
+   pending again without touching them.  While a pass is in progress,
+   increments replace the collections of the middle generation, so the
+   young objects don't pile up in the oldest generation ahead of it.
+*/
+
+/* target pause of an increment, 0 when incremental collections are off */
+static _PyTime_t incremental_pause = 0;
+
+/* estimated cost of an increment per unit of work, in nanoseconds */
+static double incremental_cost = 100.0;
+
+/* true while a pass over the oldest generation is in progress */
+static int incremental_pass = 0;
+
+/* number of objects that survived the increments of the current pass */
+static Py_ssize_t incremental_survivors = 0;
+
+/* true if an increment of the current pass reached its size limit */
+static int incremental_truncated = 0;
+
+/* true if the next pass must be a full collection instead */
+static int incremental_full = 0;
+
+/* objects of the oldest generation examined in the current pass */
+static PyGC_Head old_visited = {{&old_visited, &old_visited, 0}};
+
+/* value of _PyGC_REFS_MASK_VISITED for the objects in old_visited */
+static int visited_space = 0;
+
 /* set for debugging information */
 #define DEBUG_STATS             (1<<0) /* print collection statistics */
 #define DEBUG_COLLECTABLE       (1<<1) /* print collectable objects */
@@ -176,6 +248,11 @@ struct gc_generation_stats {
     Py_ssize_t collected;
     /* total number of uncollectable objects (put into gc.garbage) */
     Py_ssize_t uncollectable;
+    /* total and longest time spent collecting */
+    _PyTime_t pause_time;
+    _PyTime_t max_pause;
+    /* largest number of objects examined by an increment */
+    Py_ssize_t max_increment;
 };
 
 static struct gc_generation_stats generation_stats[NUM_GENERATIONS];
@@ -225,6 +302,12 @@ GC_TENTATIVELY_UNREACHABLE
 
 #define IS_TRACKED(o) (_PyGC_REFS(o) != GC_UNTRACKED)
 #define IS_REACHABLE(o) (_PyGC_REFS(o) == GC_REACHABLE)
+#define IS_FROZEN(gc) (((gc)->gc.gc_refs & _PyGC_REFS_MASK_FROZEN) != 0)
+#define IS_VISITED(gc) \
+    ((((gc)->gc.gc_refs & _PyGC_REFS_MASK_VISITED) != 0) == visited_space)
+#define SET_SPACE(gc, space) \
+    ((gc)->gc.gc_refs = ((gc)->gc.gc_refs & ~_PyGC_REFS_MASK_VISITED) \
+                        | ((space) ? _PyGC_REFS_MASK_VISITED : 0))
 #define IS_TENTATIVELY_UNREACHABLE(o) ( \
     _PyGC_REFS(o) == GC_TENTATIVELY_UNREACHABLE)
 
@@ -243,8 +326,6 @@ gc_list_is_empty(PyGC_Head *list)
     return (list->gc.gc_next == list);
 }
 
-#if 0
-/* This became unused after gc_list_move() was introduced. */
 /* Append `node` to `list`. */
 static void
 gc_list_append(PyGC_Head *node, PyGC_Head *list)
@@ -254,7 +335,6 @@ gc_list_append(PyGC_Head *node, PyGC_Head *list)
     node->gc.gc_prev->gc.gc_next = node;
     list->gc.gc_prev = node;
 }
-#endif
 
 /* Remove `node` from the gc list it's currently in. */
 static void
@@ -311,6 +391,22 @@ gc_list_size(PyGC_Head *list)
     return n;
 }
 
+/* Like gc_list_size(), but also mark the objects as examined in the
+ * current pass (if visited is true) or pending.
+ */
+static Py_ssize_t
+gc_list_size_set_visited(PyGC_Head *list, int visited)
+{
+    PyGC_Head *gc;
+    Py_ssize_t n = 0;
+    int space = visited ? visited_space : !visited_space;
+    for (gc = list->gc.gc_next; gc != list; gc = gc->gc.gc_next) {
+        SET_SPACE(gc, space);
+        n++;
+    }
+    return n;
+}
+
 /* Append objects in a GC list to a Python list.
  * Return 0 if all OK, < 0 if error (out of memory for list).
  */
@@ -331,6 +427,162 @@ append_objects(PyObject *py_list, PyGC_Head *gc_list)
 
 /*** end of list stuff ***/
 
+/*
+   NOTE: about parallel collections.
+
+   Most of the time of a collection of a large generation is spent in
+   subtract_refs(), which calls tp_traverse on every object and touches
+   every object it refers to.  tp_traverse only reports references to the
+   visit function, so with gc.set_mode("parallel") (or PYTHONGCTHREADS)
+   this pass is split among several threads while the collecting thread
+   keeps holding the GIL.  The other phases move objects between lists
+   and stay serial.
+
+   update_refs() remembers every GC_CHUNK_SIZE-th object it passes, which
+   cuts the generation into chunks without another walk of the list.
+   Each thread repeatedly claims the next chunk until none are left.
+   gc_refs stays in the GC header: only objects of the generation being
+   collected have a positive gc_refs, and it never drops below zero, so
+   the threads only need an atomic subtraction to update it.
+*/
+
+#if defined(WITH_THREAD) && defined(HAVE_BUILTIN_ATOMIC)
+#define HAVE_PARALLEL_GC
+#endif
+
+/* maximum number of threads taking part in a collection */
+#define GC_MAX_THREADS 64
+/* number of threads used by gc.set_mode("parallel") by default */
+#define GC_DEFAULT_THREADS 4
+/* number of objects in a unit of work handed to a thread */
+#define GC_CHUNK_SIZE 1024
+/* smaller generations are not worth starting threads for */
+#define GC_PARALLEL_MIN_CHUNKS 32
+
+/* number of threads scanning a generation; 1 in serial mode */
+static int gc_threads = 1;
+
+#ifdef HAVE_PARALLEL_GC
+static struct {
+    PyGC_Head *containers;      /* the list the chunks belong to */
+    PyGC_Head **chunks;         /* first object of each chunk */
+    Py_ssize_t nchunks;         /* -1 if the chunks couldn't be recorded */
+    Py_ssize_t allocated;
+    Py_ssize_t next_chunk;      /* next chunk to scan (atomic) */
+    int running;                /* threads still scanning (atomic) */
+    PyThread_type_lock done;    /* released by the last thread to finish */
+} parallel;
+
+/* Record gc as the start of a new chunk. */
+static void
+add_chunk(PyGC_Head *gc)
+{
+    if (parallel.nchunks < 0)
+        return;
+    if (parallel.nchunks == parallel.allocated) {
+        Py_ssize_t newsize = parallel.allocated ? parallel.allocated * 2 : 256;
+        PyGC_Head **chunks = PyMem_RawRealloc(parallel.chunks,
+                                              newsize * sizeof(PyGC_Head *));
+        if (chunks == NULL) {
+            /* Fall back to a serial scan */
+            parallel.nchunks = -1;
+            return;
+        }
+        parallel.chunks = chunks;
+        parallel.allocated = newsize;
+    }
+    parallel.chunks[parallel.nchunks++] = gc;
+}
+#endif
+
+
+/* The state of fill_increment() */
+typedef struct {
+    PyGC_Head *list;      /* the objects of the increment */
+    Py_ssize_t size;      /* the number of objects in list */
+    Py_ssize_t work;      /* size plus the references traversed so far */
+    Py_ssize_t limit;     /* the work not to exceed */
+    int truncated;        /* whether an object was left out for the limit */
+} increment_state;
+
+/* Add gc to the increment. */
+static void
+add_to_increment(PyGC_Head *gc, increment_state *state)
+{
+    gc_list_move(gc, state->list);
+    SET_SPACE(gc, visited_space);
+    state->size++;
+    state->work++;
+}
+
+/* A traversal callback for fill_increment(). */
+static int
+visit_add_to_increment(PyObject *op, increment_state *state)
+{
+    state->work++;
+    if (PyObject_IS_GC(op)) {
+        PyGC_Head *gc = AS_GC(op);
+        if (_PyGCHead_REFS(gc) == GC_REACHABLE && !IS_VISITED(gc)
+            && !IS_FROZEN(gc)) {
+            if (state->work >= state->limit) {
+                /* stop the traversal of a large container here */
+                state->truncated = 1;
+                return 1;
+            }
+            add_to_increment(gc, state);
+        }
+    }
+    return 0;
+}
+
+/* Move pending objects of the oldest generation to increment, along with
+ * the pending objects they refer to, until the work of the increment
+ * reaches limit.  The work counts the objects and the references they
+ * hold, which the collection traverses several times, so that a few large
+ * containers weigh as much as many small objects.  At least one pending
+ * object is moved, so that the pass progresses.  The young generations
+ * must already be merged into increment; their references are not
+ * counted.  Return the number of objects in increment, store the work in
+ * *work and set *truncated if a pending object referred to by the
+ * increment was left out because of the limit.
+ */
+static Py_ssize_t
+fill_increment(PyGC_Head *increment, Py_ssize_t limit, Py_ssize_t *work,
+               int *truncated)
+{
+    PyGC_Head *pending = GEN_HEAD(NUM_GENERATIONS-1);
+    PyGC_Head *scan = increment->gc.gc_prev;
+    increment_state state;
+    int progress = 0;
+
+    state.list = increment;
+    state.size = state.work = gc_list_size(increment);
+    state.limit = limit;
+    state.truncated = 0;
+    while (!gc_list_is_empty(pending)
+           && (state.work < limit || !progress)) {
+        add_to_increment(pending->gc.gc_next, &state);
+        /* Everything it refers to, recursively, is appended behind it;
+         * stop when the scan catches up with the end of the list, or
+         * when the limit is reached.
+         */
+        while (scan->gc.gc_next != increment && !state.truncated) {
+            traverseproc traverse;
+            scan = scan->gc.gc_next;
+            traverse = Py_TYPE(FROM_GC(scan))->tp_traverse;
+            (void) traverse(FROM_GC(scan),
+                            (visitproc)visit_add_to_increment,
+                            &state);
+        }
+        if (state.truncated) {
+            *truncated = 1;
+            break;
+        }
+        progress = 1;
+    }
+    *work = state.work;
+    return state.size;
+}
 
 /* Set all gc_refs = ob_refcnt.  After this, gc_refs is > 0 for all objects
  * in containers, and is GC_REACHABLE for all tracked gc objects not in
@@ -340,7 +592,16 @@ static void
 update_refs(PyGC_Head *containers)
 {
     PyGC_Head *gc = containers->gc.gc_next;
+#ifdef HAVE_PARALLEL_GC
+    Py_ssize_t n = 0;
+    parallel.containers = containers;
+    parallel.nchunks = 0;
+#endif
     for (; gc != containers; gc = gc->gc.gc_next) {
+#ifdef HAVE_PARALLEL_GC
+        if (gc_threads > 1 && n++ % GC_CHUNK_SIZE == 0)
+            add_chunk(gc);
+#endif
         assert(_PyGCHead_REFS(gc) == GC_REACHABLE);
         _PyGCHead_SET_REFS(gc, Py_REFCNT(FROM_GC(gc)));
         /* Python's cyclic gc should never see an incoming refcount
@@ -383,6 +644,98 @@ visit_decref(PyObject *op, void *data)
     return 0;
 }
 
+#ifdef HAVE_PARALLEL_GC
+/* A traversal callback for subtract_refs() when several threads scan the
+ * generation at once.
+ */
+static int
+visit_decref_atomic(PyObject *op, void *data)
+{
+    assert(op != NULL);
+    if (PyObject_IS_GC(op)) {
+        PyGC_Head *gc = AS_GC(op);
+        /* As in visit_decref().  Other threads only ever lower a
+         * positive gc_refs, and never below zero, so the test can't
+         * be invalidated before the subtraction.
+         */
+        Py_ssize_t gc_refs = __atomic_load_n(&gc->gc.gc_refs,
+                                             __ATOMIC_RELAXED);
+        assert((gc_refs >> _PyGC_REFS_SHIFT) != 0);
+        if ((gc_refs >> _PyGC_REFS_SHIFT) > 0)
+            __atomic_fetch_sub(&gc->gc.gc_refs,
+                               (Py_ssize_t)1 << _PyGC_REFS_SHIFT,
+                               __ATOMIC_RELAXED);
+    }
+    return 0;
+}
+
+/* Scan chunks until there are none left. */
+static void
+subtract_chunks(void)
+{
+    for (;;) {
+        Py_ssize_t i = __atomic_fetch_add(&parallel.next_chunk, 1,
+                                          __ATOMIC_RELAXED);
+        PyGC_Head *gc, *end;
+
+        if (i >= parallel.nchunks)
+            break;
+        if (i + 1 < parallel.nchunks)
+            end = parallel.chunks[i + 1];
+        else
+            end = parallel.containers;
+        for (gc = parallel.chunks[i]; gc != end; gc = gc->gc.gc_next) {
+            traverseproc traverse = Py_TYPE(FROM_GC(gc))->tp_traverse;
+            (void) traverse(FROM_GC(gc),
+                            (visitproc)visit_decref_atomic,
+                            NULL);
+        }
+    }
+    /* The last thread to finish wakes up the collecting thread */
+    if (__atomic_sub_fetch(&parallel.running, 1, __ATOMIC_ACQ_REL) == 0)
+        PyThread_release_lock(parallel.done);
+}
+
+static void
+subtract_refs_thread(void *unused)
+{
+    subtract_chunks();
+}
+
+/* Run subtract_refs() on gc_threads threads, using the chunks recorded by
+ * update_refs().  Return -1 if no thread could be set up.
+ */
+static int
+subtract_refs_parallel(void)
+{
+    int i;
+
+    if (parallel.done == NULL) {
+        parallel.done = PyThread_allocate_lock();
+        if (parallel.done == NULL)
+            return -1;
+    }
+    PyThread_acquire_lock(parallel.done, WAIT_LOCK);
+    parallel.next_chunk = 0;
+    /* Count this thread, so that running can't drop to zero before all
+       the helpers are started. */
+    parallel.running = 1;
+    for (i = 1; i < gc_threads; i++) {
+        __atomic_add_fetch(&parallel.running, 1, __ATOMIC_RELAXED);
+        if (PyThread_start_new_thread(subtract_refs_thread, NULL) == -1) {
+            /* Make do with the threads we have */
+            __atomic_sub_fetch(&parallel.running, 1, __ATOMIC_RELAXED);
+            break;
+        }
+    }
+    subtract_chunks();
+    /* Wait for the helper threads to finish */
+    PyThread_acquire_lock(parallel.done, WAIT_LOCK);
+    PyThread_release_lock(parallel.done);
+    return 0;
+}
+#endif
+
 /* Subtract internal references from gc_refs.  After this, gc_refs is >= 0
  * for all objects in containers, and is GC_REACHABLE for all tracked gc
  * objects not in containers.  The ones with gc_refs > 0 are directly
@@ -393,6 +746,18 @@ subtract_refs(PyGC_Head *containers)
 {
     traverseproc traverse;
     PyGC_Head *gc = containers->gc.gc_next;
+#ifdef HAVE_PARALLEL_GC
+    /* The chunks are only valid right after update_refs(containers);
+       check_garbage() calls this on a list of its own. */
+    if (parallel.containers == containers) {
+        int done = (gc_threads > 1
+                    && parallel.nchunks >= GC_PARALLEL_MIN_CHUNKS
+                    && subtract_refs_parallel() == 0);
+        parallel.containers = NULL;
+        if (done)
+            return;
+    }
+#endif
     for (; gc != containers; gc=gc->gc.gc_next) {
         traverse = Py_TYPE(FROM_GC(gc))->tp_traverse;
         (void) traverse(FROM_GC(gc),
@@ -895,32 +1260,43 @@ clear_freelists(void)
 }
 
 /* This is the main function.  Read this to understand how the
- * collection process works. */
+ * collection process works.  If incremental is true, the oldest
+ * generation is only collected in part (see the note about incremental
+ * collections).
+ */
 static Py_ssize_t
-collect(int generation, Py_ssize_t *n_collected, Py_ssize_t *n_uncollectable,
-        int nofail)
+collect(int generation, int incremental, Py_ssize_t *n_collected,
+        Py_ssize_t *n_uncollectable, int nofail)
 {
     int i;
+    Py_ssize_t size = 0; /* # objects in an increment */
+    Py_ssize_t work = 0; /* work of an increment, see fill_increment() */
     Py_ssize_t m = 0; /* # objects collected */
     Py_ssize_t n = 0; /* # unreachable objects that couldn't be collected */
     PyGC_Head *young; /* the generation we are examining */
     PyGC_Head *old; /* next older generation */
     PyGC_Head unreachable; /* non-problematic unreachable trash */
     PyGC_Head finalizers;  /* objects with, & reachable from, __del__ */
+    PyGC_Head increment;   /* the objects examined by an increment */
     PyGC_Head *gc;
-    _PyTime_t t1 = 0;   /* initialize to prevent a compiler warning */
-
+    _PyTime_t t1, t2;
     struct gc_generation_stats *stats = &generation_stats[generation];
 
+    assert(!incremental || generation == NUM_GENERATIONS-1);
+
+    t1 = _PyTime_GetMonotonicClock();
+
     if (debug & DEBUG_STATS) {
-        PySys_WriteStderr("gc: collecting generation %d...\n",
+        PySys_WriteStderr("gc: collecting %sgeneration %d...\n",
+                          incremental ? "an increment of " : "",
                           generation);
         PySys_WriteStderr("gc: objects in each generation:");
-        for (i = 0; i < NUM_GENERATIONS; i++)
+        for (i = 0; i < NUM_GENERATIONS - 1; i++)
             PySys_FormatStderr(" %zd",
                               gc_list_size(GEN_HEAD(i)));
-        t1 = _PyTime_GetMonotonicClock();
-
+        PySys_FormatStderr(" %zd",
+                           gc_list_size(GEN_HEAD(i))
+                           + gc_list_size(&old_visited));
         PySys_WriteStderr("\n");
     }
 
@@ -930,17 +1306,46 @@ collect(int generation, Py_ssize_t *n_collected, Py_ssize_t *n_uncollectable,
     for (i = 0; i <= generation; i++)
         generations[i].count = 0;
 
-    /* merge younger generations with one we are currently collecting */
-    for (i = 0; i < generation; i++) {
-        gc_list_merge(GEN_HEAD(i), GEN_HEAD(generation));
+    if (incremental) {
+        /* collect the young generations and a slice of the oldest one;
+           the survivors are moved to old_visited */
+        gc_list_init(&increment);
+        for (i = 0; i < generation; i++) {
+            gc_list_merge(GEN_HEAD(i), &increment);
+        }
+        size = fill_increment(&increment, (Py_ssize_t)(
+            (double)incremental_pause / incremental_cost),
+            &work, &incremental_truncated);
+        if (size > stats->max_increment)
+            stats->max_increment = size;
+        incremental_pass = 1;
+        young = &increment;
+        old = &old_visited;
     }
+    else {
+        if (generation == NUM_GENERATIONS-1 && incremental_pass) {
+            /* a full collection ends the current pass */
+            gc_list_merge(&old_visited, GEN_HEAD(generation));
+            incremental_pass = 0;
+            incremental_survivors = 0;
+        }
+        if (generation == NUM_GENERATIONS-1) {
+            incremental_truncated = 0;
+            incremental_full = 0;
+        }
 
-    /* handy references */
-    young = GEN_HEAD(generation);
-    if (generation < NUM_GENERATIONS-1)
-        old = GEN_HEAD(generation+1);
-    else
-        old = young;
+        /* merge younger generations with one we are currently collecting */
+        for (i = 0; i < generation; i++) {
+            gc_list_merge(GEN_HEAD(i), GEN_HEAD(generation));
+        }
+
+        /* handy references */
+        young = GEN_HEAD(generation);
+        if (generation < NUM_GENERATIONS-1)
+            old = GEN_HEAD(generation+1);
+        else
+            old = young;
+    }
 
     /* Using ob_refcnt and gc_refs, calculate which objects in the
      * container set are reachable from outside the set (i.e., have a
@@ -960,9 +1365,16 @@ collect(int generation, Py_ssize_t *n_collected, Py_ssize_t *n_uncollectable,
     move_unreachable(young, &unreachable);
 
     /* Move reachable objects to next generation. */
-    if (young != old) {
+    if (incremental) {
+        /* Each object is only examined once per pass, so untracking
+           dicts here is as cheap as in full collections. */
+        untrack_dicts(young);
+        incremental_survivors += gc_list_size_set_visited(young, 1);
+        gc_list_merge(young, old);
+    }
+    else if (young != old) {
         if (generation == NUM_GENERATIONS - 2) {
-            long_lived_pending += gc_list_size(young);
+            long_lived_pending += gc_list_size_set_visited(young, 0);
         }
         gc_list_merge(young, old);
     }
@@ -971,7 +1383,7 @@ collect(int generation, Py_ssize_t *n_collected, Py_ssize_t *n_uncollectable,
            dict build-up. See issue #14775. */
         untrack_dicts(young);
         long_lived_pending = 0;
-        long_lived_total = gc_list_size(young);
+        long_lived_total = gc_list_size_set_visited(young, 0);
     }
 
     /* All objects in unreachable are trash, but objects reachable from
@@ -1024,7 +1436,7 @@ collect(int generation, Py_ssize_t *n_collected, Py_ssize_t *n_uncollectable,
             debug_cycle("uncollectable", FROM_GC(gc));
     }
     if (debug & DEBUG_STATS) {
-        _PyTime_t t2 = _PyTime_GetMonotonicClock();
+        t2 = _PyTime_GetMonotonicClock();
 
         if (m == 0 && n == 0)
             PySys_WriteStderr("gc: done");
@@ -1042,9 +1454,24 @@ collect(int generation, Py_ssize_t *n_collected, Py_ssize_t *n_uncollectable,
      */
     (void)handle_legacy_finalizers(&finalizers, old);
 
+    if (incremental && gc_list_is_empty(GEN_HEAD(generation))) {
+        /* The pass is complete: everything becomes pending again */
+        visited_space = !visited_space;
+        gc_list_merge(&old_visited, GEN_HEAD(generation));
+        incremental_pass = 0;
+        if (incremental_truncated
+            && incremental_survivors - long_lived_total
+               > long_lived_total / 4)
+            incremental_full = 1;
+        incremental_truncated = 0;
+        long_lived_pending = 0;
+        long_lived_total = incremental_survivors;
+        incremental_survivors = 0;
+    }
+
     /* Clear free list only during the collection of the highest
      * generation */
-    if (generation == NUM_GENERATIONS-1) {
+    if (generation == NUM_GENERATIONS-1 && !incremental_pass) {
         clear_freelists();
     }
 
@@ -1065,9 +1492,18 @@ collect(int generation, Py_ssize_t *n_collected, Py_ssize_t *n_uncollectable,
         *n_collected = m;
     if (n_uncollectable)
         *n_uncollectable = n;
+    t2 = _PyTime_GetMonotonicClock();
+    if (incremental && work > 0) {
+        /* smooth the estimate over a few increments */
+        incremental_cost = (3 * incremental_cost
+                            + (double)(t2 - t1) / work) / 4;
+    }
     stats->collections++;
     stats->collected += m;
     stats->uncollectable += n;
+    stats->pause_time += t2 - t1;
+    if (t2 - t1 > stats->max_pause)
+        stats->max_pause = t2 - t1;
     return n+m;
 }
 
@@ -1112,11 +1548,11 @@ invoke_gc_callback(const char *phase, int generation,
  * progress callbacks.
  */
 static Py_ssize_t
-collect_with_callback(int generation)
+collect_with_callback(int generation, int incremental)
 {
     Py_ssize_t result, collected, uncollectable;
     invoke_gc_callback("start", generation, 0, 0);
-    result = collect(generation, &collected, &uncollectable, 0);
+    result = collect(generation, incremental, &collected, &uncollectable, 0);
     invoke_gc_callback("stop", generation, collected, uncollectable);
     return result;
 }
@@ -1139,7 +1575,16 @@ collect_generations(void)
             if (i == NUM_GENERATIONS - 1
                 && long_lived_pending < long_lived_total / 4)
                 continue;
-            n = collect_with_callback(i);
+            if (incremental_pause > 0 && incremental_full
+                && i == NUM_GENERATIONS - 1 && !incremental_pass)
+                /* cycles larger than an increment may have been missed */
+                n = collect_with_callback(NUM_GENERATIONS - 1, 0);
+            else if (incremental_pause > 0
+                && (i == NUM_GENERATIONS - 1
+                    || (i == NUM_GENERATIONS - 2 && incremental_pass)))
+                n = collect_with_callback(NUM_GENERATIONS - 1, 1);
+            else
+                n = collect_with_callback(i, 0);
             break;
         }
     }
@@ -1210,7 +1655,7 @@ gc_collect(PyObject *self, PyObject *args, PyObject *kws)
         n = 0; /* already collecting, don't do anything */
     else {
         collecting = 1;
-        n = collect_with_callback(genarg);
+        n = collect_with_callback(genarg, 0);
         collecting = 0;
     }
 
@@ -1350,6 +1795,11 @@ gc_get_referrers(PyObject *self, PyObject *args)
             return NULL;
         }
     }
+    if (!(gc_referrers_for(args, &old_visited, result))
+        || !(gc_referrers_for(args, &permanent_generation, result))) {
+        Py_DECREF(result);
+        return NULL;
+    }
     return result;
 }
 
@@ -1411,6 +1861,11 @@ gc_get_objects(PyObject *self, PyObject *noargs)
             return NULL;
         }
     }
+    if (append_objects(result, &old_visited)
+        || append_objects(result, &permanent_generation)) {
+        Py_DECREF(result);
+        return NULL;
+    }
     return result;
 }
 
@@ -1439,10 +1894,15 @@ gc_get_stats(PyObject *self, PyObject *noargs)
     for (i = 0; i < NUM_GENERATIONS; i++) {
         PyObject *dict;
         st = &stats[i];
-        dict = Py_BuildValue("{snsnsn}",
+        dict = Py_BuildValue("{snsnsnsdsdsn}",
                              "collections", st->collections,
                              "collected", st->collected,
-                             "uncollectable", st->uncollectable
+                             "uncollectable", st->uncollectable,
+                             "pause_time",
+                             _PyTime_AsSecondsDouble(st->pause_time),
+                             "max_pause",
+                             _PyTime_AsSecondsDouble(st->max_pause),
+                             "max_increment", st->max_increment
                             );
         if (dict == NULL)
             goto error;
@@ -1459,6 +1919,233 @@ error:
     return NULL;
 }
 
+PyDoc_STRVAR(gc_set_incremental__doc__,
+"set_incremental(max_pause) -> None\n"
+"\n"
+"Collect the oldest generation in increments aiming to pause the program\n"
+"for at most max_pause milliseconds each.  0 turns incremental\n"
+"collections off.\n");
+
+static PyObject *
+gc_set_incremental(PyObject *self, PyObject *args)
+{
+    double max_pause;
+
+    if (!PyArg_ParseTuple(args, "d:set_incremental", &max_pause))
+        return NULL;
+    if (!(max_pause >= 0 && max_pause <= 1e6)) {
+        PyErr_SetString(PyExc_ValueError,
+                        "max_pause must be between 0 and 1e6 milliseconds");
+        return NULL;
+    }
+    incremental_pause = (_PyTime_t)(max_pause * 1e6);
+    if (incremental_pause == 0 && incremental_pass) {
+        /* The objects examined so far are pending again */
+        gc_list_merge(&old_visited, GEN_HEAD(NUM_GENERATIONS-1));
+        incremental_pass = 0;
+        incremental_survivors = 0;
+        incremental_truncated = 0;
+    }
+
+    Py_INCREF(Py_None);
+    return Py_None;
+}
+
+PyDoc_STRVAR(gc_get_incremental__doc__,
+"get_incremental() -> max_pause\n"
+"\n"
+"Return the target pause of incremental collections in milliseconds,\n"
+"0 if they are off.\n");
+
+static PyObject *
+gc_get_incremental(PyObject *self, PyObject *noargs)
+{
+    return PyFloat_FromDouble((double)incremental_pause / 1e6);
+}
+
+/* Set or clear the frozen bit of all the objects in list. */
+static void
+gc_list_set_frozen(PyGC_Head *list, int frozen)
+{
+    PyGC_Head *gc;
+    for (gc = list->gc.gc_next; gc != list; gc = gc->gc.gc_next) {
+        if (frozen)
+            gc->gc.gc_refs |= _PyGC_REFS_MASK_FROZEN;
+        else
+            gc->gc.gc_refs &= ~_PyGC_REFS_MASK_FROZEN;
+    }
+}
+
+PyDoc_STRVAR(gc_freeze__doc__,
+"freeze() -> None\n"
+"\n"
+"Move all the objects tracked by the collector to a permanent generation,\n"
+"which future collections ignore.\n");
+
+static void
+freeze_generations(void)
+{
+    int i;
+    PyGC_Head frozen;
+
+    gc_list_init(&frozen);
+    for (i = 0; i < NUM_GENERATIONS; i++) {
+        gc_list_merge(GEN_HEAD(i), &frozen);
+        generations[i].count = 0;
+    }
+    gc_list_merge(&old_visited, &frozen);
+    incremental_pass = 0;
+    incremental_survivors = 0;
+    incremental_truncated = 0;
+    incremental_full = 0;
+    long_lived_pending = 0;
+    long_lived_total = 0;
+    gc_list_set_frozen(&frozen, 1);
+    gc_list_merge(&frozen, &permanent_generation);
+}
+
+static PyObject *
+gc_freeze(PyObject *self, PyObject *noargs)
+{
+    freeze_generations();
+    Py_INCREF(Py_None);
+    return Py_None;
+}
+
+PyDoc_STRVAR(gc_unfreeze__doc__,
+"unfreeze() -> None\n"
+"\n"
+"Move the objects of the permanent generation back to the oldest\n"
+"generation.\n");
+
+static PyObject *
+gc_unfreeze(PyObject *self, PyObject *noargs)
+{
+    Py_ssize_t n;
+
+    gc_list_set_frozen(&permanent_generation, 0);
+    n = gc_list_size_set_visited(&permanent_generation, 0);
+    gc_list_merge(&permanent_generation, GEN_HEAD(NUM_GENERATIONS-1));
+    long_lived_pending += n;
+
+    Py_INCREF(Py_None);
+    return Py_None;
+}
+
+PyDoc_STRVAR(gc_get_freeze_count__doc__,
+"get_freeze_count() -> int\n"
+"\n"
+"Return the number of objects in the permanent generation.\n");
+
+static PyObject *
+gc_get_freeze_count(PyObject *self, PyObject *noargs)
+{
+    return PyLong_FromSsize_t(gc_list_size(&permanent_generation));
+}
+
+#ifdef Py_IMMORTAL_OBJECTS
+/* Make op immortal (see Include/object.h). */
+static int
+visit_immortalize(PyObject *op, void *arg)
+{
+    if (!_Py_IsImmortal(op)) {
+#ifdef Py_REF_DEBUG
+        _Py_RefTotal -= Py_REFCNT(op);
+#endif
+        Py_REFCNT(op) = _Py_IMMORTAL_REFCNT;
+    }
+    if (PyObject_IS_GC(op) && !_PyObject_GC_IS_TRACKED(op)) {
+        /* Containers of atomic objects, like most dicts of data, are not
+           tracked.  Track them in the permanent generation, so that
+           gc_immortalize_heap() reaches their contents too. */
+        PyGC_Head *gc = AS_GC(op);
+        _PyGCHead_SET_REFS(gc, GC_REACHABLE);
+        gc->gc.gc_refs |= _PyGC_REFS_MASK_FROZEN;
+        gc_list_append(gc, &permanent_generation);
+    }
+    return 0;
+}
+
+PyDoc_STRVAR(gc_immortalize_heap__doc__,
+"immortalize_heap() -> None\n"
+"\n"
+"Freeze all the objects tracked by the collector and make them, and the\n"
+"objects they refer to, immortal.\n");
+
+static PyObject *
+gc_immortalize_heap(PyObject *self, PyObject *noargs)
+{
+    PyGC_Head *gc;
+
+    freeze_generations();
+    /* The loop also handles the objects visit_immortalize() appends */
+    for (gc = permanent_generation.gc.gc_next;
+         gc != &permanent_generation;
+         gc = gc->gc.gc_next) {
+        PyObject *op = FROM_GC(gc);
+        visit_immortalize(op, NULL);
+        (void) Py_TYPE(op)->tp_traverse(op, visit_immortalize, NULL);
+    }
+
+    Py_INCREF(Py_None);
+    return Py_None;
+}
+#endif /* Py_IMMORTAL_OBJECTS */
+
+PyDoc_STRVAR(gc_set_mode__doc__,
+"set_mode(mode[, threads]) -> None\n"
+"\n"
+"Set the collection mode, \"serial\" or \"parallel\".  In parallel mode,\n"
+"threads threads (4 by default) share the scan of large generations.\n");
+
+static PyObject *
+gc_set_mode(PyObject *self, PyObject *args)
+{
+    char *mode;
+    int threads = GC_DEFAULT_THREADS;
+
+    if (!PyArg_ParseTuple(args, "s|i:set_mode", &mode, &threads))
+        return NULL;
+    if (strcmp(mode, "serial") == 0) {
+        gc_threads = 1;
+    }
+    else if (strcmp(mode, "parallel") == 0) {
+#ifdef HAVE_PARALLEL_GC
+        if (threads < 2 || threads > GC_MAX_THREADS) {
+            PyErr_Format(PyExc_ValueError,
+                         "threads must be between 2 and %d", GC_MAX_THREADS);
+            return NULL;
+        }
+        gc_threads = threads;
+#else
+        PyErr_SetString(PyExc_NotImplementedError,
+                        "parallel collections are not supported "
+                        "on this platform");
+        return NULL;
+#endif
+    }
+    else {
+        PyErr_Format(PyExc_ValueError, "invalid mode: '%.200s'", mode);
+        return NULL;
+    }
+
+    Py_INCREF(Py_None);
+    return Py_None;
+}
+
+PyDoc_STRVAR(gc_get_mode__doc__,
+"get_mode() -> (mode, threads)\n"
+"\n"
+"Return the collection mode and the number of threads it uses.\n");
+
+static PyObject *
+gc_get_mode(PyObject *self, PyObject *noargs)
+{
+    return Py_BuildValue("(si)",
+                         gc_threads > 1 ? "parallel" : "serial",
+                         gc_threads);
+}
+
 
 PyDoc_STRVAR(gc_is_tracked__doc__,
 "is_tracked(obj) -> bool\n"
@@ -1494,6 +2181,16 @@ PyDoc_STRVAR(gc__doc__,
 "get_debug() -- Get debugging flags.\n"
 "set_threshold() -- Set the collection thresholds.\n"
 "get_threshold() -- Return the current the collection thresholds.\n"
+"set_mode() -- Set the collection mode.\n"
+"get_mode() -- Return the collection mode.\n"
+"set_incremental() -- Collect the oldest generation in increments.\n"
+"get_incremental() -- Return the target pause of incremental collections.\n"
+"freeze() -- Move all tracked objects to a permanent generation.\n"
+"unfreeze() -- Move the permanent generation back to the oldest one.\n"
+"get_freeze_count() -- Return the number of objects in the permanent\n"
+"                      generation.\n"
+"immortalize_heap() -- Freeze and make immortal all the objects in use\n"
+"                      (builds with immortal objects only).\n"
 "get_objects() -- Return a list of all objects tracked by the collector.\n"
 "is_tracked() -- Returns true if a given object is tracked.\n"
 "get_referrers() -- Return the list of objects that refer to an object.\n"
@@ -1508,6 +2205,20 @@ static PyMethodDef GcMethods[] = {
     {"get_count",          gc_get_count,  METH_NOARGS,  gc_get_count__doc__},
     {"set_threshold",  gc_set_thresh, METH_VARARGS, gc_set_thresh__doc__},
     {"get_threshold",  gc_get_thresh, METH_NOARGS,  gc_get_thresh__doc__},
+    {"set_mode",       gc_set_mode,   METH_VARARGS, gc_set_mode__doc__},
+    {"get_mode",       gc_get_mode,   METH_NOARGS,  gc_get_mode__doc__},
+    {"set_incremental", gc_set_incremental, METH_VARARGS,
+        gc_set_incremental__doc__},
+    {"get_incremental", gc_get_incremental, METH_NOARGS,
+        gc_get_incremental__doc__},
+    {"freeze",         gc_freeze,     METH_NOARGS,  gc_freeze__doc__},
+    {"unfreeze",       gc_unfreeze,   METH_NOARGS,  gc_unfreeze__doc__},
+    {"get_freeze_count", gc_get_freeze_count, METH_NOARGS,
+        gc_get_freeze_count__doc__},
+#ifdef Py_IMMORTAL_OBJECTS
+    {"immortalize_heap", gc_immortalize_heap, METH_NOARGS,
+        gc_immortalize_heap__doc__},
+#endif
     {"collect",            (PyCFunction)gc_collect,
         METH_VARARGS | METH_KEYWORDS,           gc_collect__doc__},
     {"get_objects",    gc_get_objects,METH_NOARGS,  gc_get_objects__doc__},
@@ -1580,7 +2291,7 @@ PyGC_Collect(void)
         n = 0; /* already collecting, don't do anything */
     else {
         collecting = 1;
-        n = collect_with_callback(NUM_GENERATIONS - 1);
+        n = collect_with_callback(NUM_GENERATIONS - 1, 0);
         collecting = 0;
     }
 
@@ -1602,7 +2313,7 @@ _PyGC_CollectNoFail(void)
         n = 0;
     else {
         collecting = 1;
-        n = collect(NUM_GENERATIONS - 1, NULL, NULL, 1);
+        n = collect(NUM_GENERATIONS - 1, 0, NULL, NULL, 1);
         collecting = 0;
     }
     return n;
@@ -1644,6 +2355,27 @@ _PyGC_DumpShutdownStats(void)
     }
 }
 
+/* Select parallel collections if PYTHONGCTHREADS is 2 or more */
+void
+_PyGC_Init(void)
+{
+    char *env, *endptr;
+    unsigned long threads;
+
+    env = Py_GETENV("PYTHONGCTHREADS");
+    if (env == NULL || *env == '\0')
+        return;
+    errno = 0;
+    threads = strtoul(env, &endptr, 10);
+    if (*endptr != '\0' || errno == ERANGE || threads > GC_MAX_THREADS)
+        Py_FatalError("PYTHONGCTHREADS must be an integer "
+                      "in range [0; 64]");
+#ifdef HAVE_PARALLEL_GC
+    if (threads > 1)
+        gc_threads = (int)threads;
+#endif
+}
+
 void
 _PyGC_Fini(void)
 {
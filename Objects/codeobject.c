@@ -1,7 +1,16 @@
 #include "Python.h"
 #include "code.h"
+#include "opcode.h"
 #include "structmember.h"
 
+/* The co_extra scratch space of a code object: one slot per index
+   returned by _PyEval_RequestCodeExtraIndex(), up to the highest index
+   used with this code object. */
+typedef struct {
+    Py_ssize_t ce_size;
+    void *ce_extras[1];
+} _PyCodeObjectExtra;
+
 #define NAME_CHARS \
     "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ_abcdefghijklmnopqrstuvwxyz"
 
@@ -119,7 +128,7 @@ PyCode_New(int argcount, int kwonlyargcount,
             cell2arg = NULL;
         }
     }
-    co = PyObject_NEW(PyCodeObject, &PyCode_Type);
+    co = PyObject_GC_New(PyCodeObject, &PyCode_Type);
     if (co == NULL) {
         if (cell2arg)
             PyMem_FREE(cell2arg);
@@ -152,6 +161,20 @@ PyCode_New(int argcount, int kwonlyargcount,
     co->co_lnotab = lnotab;
     co->co_zombieframe = NULL;
     co->co_weakreflist = NULL;
+    co->co_opcache_map = NULL;
+    co->co_opcache = NULL;
+    co->co_opcache_flag = 0;
+    co->co_opcache_size = 0;
+    co->co_quickened = NULL;
+    co->co_quickened_counters = NULL;
+    co->co_extra = NULL;
+    co->co_stats = NULL;
+    co->co_monitor = NULL;
+    co->co_exceptiontable = PyBytes_FromStringAndSize(NULL, 0);
+    if (co->co_exceptiontable == NULL) {
+        Py_DECREF(co);
+        return NULL;
+    }
     return co;
 }
 
@@ -221,6 +244,7 @@ static PyMemberDef code_memberlist[] = {
     {"co_name",         T_OBJECT,       OFF(co_name),           READONLY},
     {"co_firstlineno", T_INT,           OFF(co_firstlineno),    READONLY},
     {"co_lnotab",       T_OBJECT,       OFF(co_lnotab),         READONLY},
+    {"co_exceptiontable", T_OBJECT,     OFF(co_exceptiontable), READONLY},
     {NULL}      /* Sentinel */
 };
 
@@ -269,7 +293,7 @@ validate_and_copy_tuple(PyObject *tup)
 PyDoc_STRVAR(code_doc,
 "code(argcount, kwonlyargcount, nlocals, stacksize, flags, codestring,\n\
       constants, names, varnames, filename, name, firstlineno,\n\
-      lnotab[, freevars[, cellvars]])\n\
+      lnotab[, freevars[, cellvars[, exceptiontable]]])\n\
 \n\
 Create a code object.  Not for the faint of heart.");
 
@@ -292,8 +316,9 @@ code_new(PyTypeObject *type, PyObject *args, PyObject *kw)
     PyObject *name;
     int firstlineno;
     PyObject *lnotab;
+    PyObject *exceptiontable = NULL;
 
-    if (!PyArg_ParseTuple(args, "iiiiiSO!O!O!UUiS|O!O!:code",
+    if (!PyArg_ParseTuple(args, "iiiiiSO!O!O!UUiS|O!O!S:code",
                           &argcount, &kwonlyargcount,
                               &nlocals, &stacksize, &flags,
                           &code,
@@ -303,7 +328,8 @@ code_new(PyTypeObject *type, PyObject *args, PyObject *kw)
                           &filename, &name,
                           &firstlineno, &lnotab,
                           &PyTuple_Type, &freevars,
-                          &PyTuple_Type, &cellvars))
+                          &PyTuple_Type, &cellvars,
+                          &exceptiontable))
         return NULL;
 
     if (argcount < 0) {
@@ -350,6 +376,12 @@ code_new(PyTypeObject *type, PyObject *args, PyObject *kw)
                                 code, consts, ournames, ourvarnames,
                                 ourfreevars, ourcellvars, filename,
                                 name, firstlineno, lnotab);
+    if (co != NULL && exceptiontable != NULL) {
+        PyCodeObject *c = (PyCodeObject *)co;
+        Py_INCREF(exceptiontable);
+        Py_DECREF(c->co_exceptiontable);
+        c->co_exceptiontable = exceptiontable;
+    }
   cleanup:
     Py_XDECREF(ournames);
     Py_XDECREF(ourvarnames);
@@ -361,6 +393,7 @@ code_new(PyTypeObject *type, PyObject *args, PyObject *kw)
 static void
 code_dealloc(PyCodeObject *co)
 {
+    PyObject_GC_UnTrack(co);
     Py_XDECREF(co->co_code);
     Py_XDECREF(co->co_consts);
     Py_XDECREF(co->co_names);
@@ -370,13 +403,54 @@ code_dealloc(PyCodeObject *co)
     Py_XDECREF(co->co_filename);
     Py_XDECREF(co->co_name);
     Py_XDECREF(co->co_lnotab);
+    Py_XDECREF(co->co_exceptiontable);
+    if (co->co_extra != NULL) {
+        PyInterpreterState *interp = PyThreadState_GET()->interp;
+        _PyCodeObjectExtra *co_extra = co->co_extra;
+        Py_ssize_t i;
+
+        for (i = 0; i < co_extra->ce_size; i++) {
+            freefunc free_extra = interp->co_extra_freefuncs[i];
+            if (co_extra->ce_extras[i] != NULL && free_extra != NULL)
+                free_extra(co_extra->ce_extras[i]);
+        }
+        PyMem_Free(co_extra);
+    }
+    _PyEval_FreeCodeStats(co);
+    _PyCode_SetMonitor(co, 0, NULL);
     if (co->co_cell2arg != NULL)
         PyMem_FREE(co->co_cell2arg);
     if (co->co_zombieframe != NULL)
         PyObject_GC_Del(co->co_zombieframe);
+    if (co->co_opcache_map != NULL)
+        PyMem_FREE(co->co_opcache_map);
+    if (co->co_opcache != NULL)
+        PyMem_FREE(co->co_opcache);
+    if (co->co_quickened != NULL)
+        PyMem_FREE(co->co_quickened);
+    if (co->co_quickened_counters != NULL)
+        PyMem_FREE(co->co_quickened_counters);
     if (co->co_weakreflist != NULL)
         PyObject_ClearWeakRefs((PyObject*)co);
-    PyObject_DEL(co);
+    PyObject_GC_Del(co);
+}
+
+/* Code objects are only tracked by the garbage collector while they are
+   monitored: the callback can refer to the code object, for example through
+   a closure.  The constants and names can't make a cycle. */
+static int
+code_traverse(PyCodeObject *co, visitproc visit, void *arg)
+{
+    if (co->co_monitor != NULL)
+        Py_VISIT(co->co_monitor->callback);
+    return 0;
+}
+
+static int
+code_clear(PyCodeObject *co)
+{
+    _PyCode_SetMonitor(co, 0, NULL);
+    return 0;
 }
 
 static PyObject *
@@ -387,6 +461,18 @@ code_sizeof(PyCodeObject *co, void *unused)
     res = sizeof(PyCodeObject);
     if (co->co_cell2arg != NULL && co->co_cellvars != NULL)
         res += PyTuple_GET_SIZE(co->co_cellvars) * sizeof(unsigned char);
+    if (co->co_opcache_map != NULL)
+        res += PyBytes_GET_SIZE(co->co_code) / sizeof(_Py_CODEUNIT);
+    if (co->co_opcache != NULL)
+        res += co->co_opcache_size * sizeof(_PyOpcache);
+    if (co->co_quickened != NULL)
+        res += PyBytes_GET_SIZE(co->co_code);
+    if (co->co_quickened_counters != NULL)
+        res += PyBytes_GET_SIZE(co->co_code) / sizeof(_Py_CODEUNIT);
+    if (co->co_monitor != NULL)
+        res += sizeof(_PyCodeMonitor) +
+               PyBytes_GET_SIZE(co->co_code) / sizeof(_Py_CODEUNIT) *
+               (sizeof(int) + 1);
     return PyLong_FromSsize_t(res);
 }
 
@@ -449,6 +535,9 @@ code_richcompare(PyObject *self, PyObject *other, int op)
     if (eq <= 0) goto unequal;
     eq = PyObject_RichCompareBool(co->co_cellvars, cp->co_cellvars, Py_EQ);
     if (eq <= 0) goto unequal;
+    eq = PyObject_RichCompareBool(co->co_exceptiontable,
+                                  cp->co_exceptiontable, Py_EQ);
+    if (eq <= 0) goto unequal;
 
     if (op == Py_EQ)
         res = Py_True;
@@ -472,7 +561,7 @@ code_richcompare(PyObject *self, PyObject *other, int op)
 static Py_hash_t
 code_hash(PyCodeObject *co)
 {
-    Py_hash_t h, h0, h1, h2, h3, h4, h5, h6;
+    Py_hash_t h, h0, h1, h2, h3, h4, h5, h6, h7;
     h0 = PyObject_Hash(co->co_name);
     if (h0 == -1) return -1;
     h1 = PyObject_Hash(co->co_code);
@@ -487,7 +576,9 @@ code_hash(PyCodeObject *co)
     if (h5 == -1) return -1;
     h6 = PyObject_Hash(co->co_cellvars);
     if (h6 == -1) return -1;
-    h = h0 ^ h1 ^ h2 ^ h3 ^ h4 ^ h5 ^ h6 ^
+    h7 = PyObject_Hash(co->co_exceptiontable);
+    if (h7 == -1) return -1;
+    h = h0 ^ h1 ^ h2 ^ h3 ^ h4 ^ h5 ^ h6 ^ h7 ^
         co->co_argcount ^ co->co_kwonlyargcount ^
         co->co_nlocals ^ co->co_flags;
     if (h == -1) h = -2;
@@ -521,10 +612,10 @@ PyTypeObject PyCode_Type = {
     PyObject_GenericGetAttr,            /* tp_getattro */
     0,                                  /* tp_setattro */
     0,                                  /* tp_as_buffer */
-    Py_TPFLAGS_DEFAULT,                 /* tp_flags */
+    Py_TPFLAGS_DEFAULT | Py_TPFLAGS_HAVE_GC,    /* tp_flags */
     code_doc,                           /* tp_doc */
-    0,                                  /* tp_traverse */
-    0,                                  /* tp_clear */
+    (traverseproc)code_traverse,        /* tp_traverse */
+    (inquiry)code_clear,                /* tp_clear */
     code_richcompare,                   /* tp_richcompare */
     offsetof(PyCodeObject, co_weakreflist),     /* tp_weaklistoffset */
     0,                                  /* tp_iter */
@@ -612,3 +703,311 @@ _PyCode_CheckLineNumber(PyCodeObject* co, int lasti, PyAddrPair *bounds)
 
     return line;
 }
+
+/* Allocate the inline caches used by the eval loop.  Every instruction
+   that can make use of a cache gets an entry in co_opcache, up to 255
+   entries (the map uses one byte per instruction).  Instructions
+   past that limit simply run uncached. */
+int
+_PyCode_InitOpcache(PyCodeObject *co)
+{
+    Py_ssize_t i, co_size;
+    _Py_CODEUNIT *code;
+    unsigned char opts = 0;
+
+    co_size = PyBytes_GET_SIZE(co->co_code) / sizeof(_Py_CODEUNIT);
+    code = (_Py_CODEUNIT *)PyBytes_AS_STRING(co->co_code);
+    co->co_opcache_map = (unsigned char *)PyMem_Calloc(co_size, 1);
+    if (co->co_opcache_map == NULL) {
+        PyErr_NoMemory();
+        return -1;
+    }
+
+    for (i = 0; i < co_size && opts < 255; i++) {
+        switch (_Py_OPCODE(code[i])) {
+        case LOAD_GLOBAL:
+        case LOAD_ATTR:
+        case STORE_ATTR:
+            co->co_opcache_map[i] = ++opts;
+            break;
+        }
+    }
+
+    if (opts) {
+        co->co_opcache = (_PyOpcache *)PyMem_Calloc(opts, sizeof(_PyOpcache));
+        if (co->co_opcache == NULL) {
+            PyMem_FREE(co->co_opcache_map);
+            co->co_opcache_map = NULL;
+            PyErr_NoMemory();
+            return -1;
+        }
+    }
+    else {
+        PyMem_FREE(co->co_opcache_map);
+        co->co_opcache_map = NULL;
+        co->co_opcache = NULL;
+    }
+    co->co_opcache_size = opts;
+    return 0;
+}
+
+/* co_exceptiontable holds each block as five unsigned varints (seven bits
+   per byte, least significant first, the high bit set on all but the last
+   byte): start, end - start, handler, level and type.  The offsets are byte
+   offsets of instructions, like f_lasti. */
+
+static int
+write_varint(unsigned char *p, unsigned int value)
+{
+    int n = 0;
+    while (value >= 0x80) {
+        p[n++] = (unsigned char)(value & 0x7f) | 0x80;
+        value >>= 7;
+    }
+    p[n++] = (unsigned char)value;
+    return n;
+}
+
+static int
+read_varint(const unsigned char *p, const unsigned char *end,
+            Py_ssize_t *pos, int *value)
+{
+    unsigned int result = 0;
+    int shift = 0;
+    const unsigned char *q = p + *pos;
+
+    do {
+        if (q >= end || shift > 28)
+            return 0;
+        result |= (unsigned int)(*q & 0x7f) << shift;
+        shift += 7;
+    } while (*q++ & 0x80);
+    *pos = q - p;
+    *value = (int)result;
+    return 1;
+}
+
+PyObject *
+_PyCode_MakeExceptionTable(const _PyCodeBlock *blocks, int n)
+{
+    PyObject *table;
+    unsigned char *p;
+    int i;
+
+    if (n == 0)
+        return PyBytes_FromStringAndSize(NULL, 0);
+    /* Each varint of a 32-bit value takes at most five bytes. */
+    table = PyBytes_FromStringAndSize(NULL, (Py_ssize_t)n * 5 * 5);
+    if (table == NULL)
+        return NULL;
+    p = (unsigned char *)PyBytes_AS_STRING(table);
+    for (i = 0; i < n; i++) {
+        const _PyCodeBlock *b = &blocks[i];
+        assert(b->cb_start <= b->cb_end);
+        p += write_varint(p, b->cb_start);
+        p += write_varint(p, b->cb_end - b->cb_start);
+        p += write_varint(p, b->cb_handler);
+        p += write_varint(p, b->cb_level);
+        p += write_varint(p, b->cb_type);
+    }
+    if (_PyBytes_Resize(&table,
+                        p - (unsigned char *)PyBytes_AS_STRING(table)) < 0)
+        return NULL;
+    return table;
+}
+
+int
+_PyCode_NextBlock(PyCodeObject *co, Py_ssize_t *pos, _PyCodeBlock *block)
+{
+    const unsigned char *p, *end;
+    int size;
+
+    p = (const unsigned char *)PyBytes_AS_STRING(co->co_exceptiontable);
+    end = p + PyBytes_GET_SIZE(co->co_exceptiontable);
+    if (!read_varint(p, end, pos, &block->cb_start) ||
+        !read_varint(p, end, pos, &size) ||
+        !read_varint(p, end, pos, &block->cb_handler) ||
+        !read_varint(p, end, pos, &block->cb_level) ||
+        !read_varint(p, end, pos, &block->cb_type))
+        return 0;
+    block->cb_end = block->cb_start + size;
+    return 1;
+}
+
+int
+_PyCode_FindBlock(PyCodeObject *co, int offset, int limit,
+                  _PyCodeBlock *block)
+{
+    Py_ssize_t pos = 0;
+    _PyCodeBlock b;
+    int i, found = -1;
+
+    /* Blocks are sorted by start, so the last one containing offset is
+       the innermost. */
+    for (i = 0; i != limit && _PyCode_NextBlock(co, &pos, &b); i++) {
+        if (b.cb_start > offset)
+            break;
+        if (offset < b.cb_end) {
+            *block = b;
+            found = i;
+        }
+    }
+    return found;
+}
+
+/* Allocate the quickened copy of the bytecode that the eval loop runs
+   once the code object is hot.  It starts out identical to co_code: the
+   instructions that have specialized forms rewrite themselves in it when
+   they run, and are restored from co_code when their guard fails. */
+int
+_PyCode_Quicken(PyCodeObject *co)
+{
+    Py_ssize_t size = PyBytes_GET_SIZE(co->co_code);
+
+    assert(co->co_quickened == NULL);
+    co->co_quickened = (_Py_CODEUNIT *)PyMem_MALLOC(size);
+    co->co_quickened_counters = (unsigned char *)PyMem_Calloc(
+        size / sizeof(_Py_CODEUNIT), 1);
+    if (co->co_quickened == NULL || co->co_quickened_counters == NULL) {
+        PyMem_FREE(co->co_quickened);
+        PyMem_FREE(co->co_quickened_counters);
+        co->co_quickened = NULL;
+        co->co_quickened_counters = NULL;
+        PyErr_NoMemory();
+        return -1;
+    }
+    memcpy(co->co_quickened, PyBytes_AS_STRING(co->co_code), size);
+    return 0;
+}
+
+/* Report the events of the frames of co to callback, or stop if events is
+   0.  The line number of each instruction, and which ones start a line, are
+   computed once here, so that the eval loop doesn't have to decode
+   co_lnotab for every instruction it runs. */
+int
+_PyCode_SetMonitor(PyCodeObject *co, int events, PyObject *callback)
+{
+    _PyCodeMonitor *mon = co->co_monitor;
+    Py_ssize_t n, size, i;
+    unsigned char *p;
+    int addr, line;
+
+    if (events == 0) {
+        co->co_monitor = NULL;
+        PyObject_GC_UnTrack(co);
+        if (mon != NULL) {
+            Py_DECREF(mon->callback);
+            PyMem_FREE(mon->lines);
+            PyMem_FREE(mon->flags);
+            PyMem_FREE(mon);
+        }
+        return 0;
+    }
+    n = PyBytes_GET_SIZE(co->co_code) / sizeof(_Py_CODEUNIT);
+    if (mon != NULL) {
+        /* Keep the disabled locations of the same callback */
+        if (mon->callback != callback)
+            memset(mon->flags, 0, n);
+    }
+    else {
+        mon = (_PyCodeMonitor *)PyMem_MALLOC(sizeof(_PyCodeMonitor));
+        if (mon == NULL) {
+            PyErr_NoMemory();
+            return -1;
+        }
+        mon->callback = NULL;
+        mon->lines = (int *)PyMem_MALLOC(n * sizeof(int));
+        mon->flags = (unsigned char *)PyMem_Calloc(n, 1);
+        if (mon->lines == NULL || mon->flags == NULL) {
+            PyMem_FREE(mon->lines);
+            PyMem_FREE(mon->flags);
+            PyMem_FREE(mon);
+            PyErr_NoMemory();
+            return -1;
+        }
+        co->co_monitor = mon;
+    }
+    for (i = 0; i < n; i++)
+        mon->flags[i] &= ~_PyMonitor_LINE_START;
+
+    /* See lnotab_notes.txt for the format of co_lnotab */
+    p = (unsigned char *)PyBytes_AS_STRING(co->co_lnotab);
+    size = PyBytes_GET_SIZE(co->co_lnotab) / 2;
+    addr = 0;
+    line = co->co_firstlineno;
+    i = 0;
+    if (n > 0)
+        mon->flags[0] |= _PyMonitor_LINE_START;
+    while (size-- > 0) {
+        addr += *p++;
+        for (; i < n && i * (int)sizeof(_Py_CODEUNIT) < addr; i++)
+            mon->lines[i] = line;
+        if (*p && i < n)
+            mon->flags[i] |= _PyMonitor_LINE_START;
+        line += *p++;
+    }
+    for (; i < n; i++)
+        mon->lines[i] = line;
+
+    mon->events = events;
+    Py_INCREF(callback);
+    Py_XDECREF(mon->callback);
+    mon->callback = callback;
+    if (!_PyObject_GC_IS_TRACKED(co))
+        PyObject_GC_Track(co);
+    return 0;
+}
+
+int
+_PyCode_GetExtra(PyObject *code, Py_ssize_t index, void **extra)
+{
+    _PyCodeObjectExtra *co_extra;
+
+    if (!PyCode_Check(code) || index < 0 || index >= MAX_CO_EXTRA_USERS) {
+        PyErr_BadInternalCall();
+        return -1;
+    }
+    co_extra = ((PyCodeObject *)code)->co_extra;
+    if (co_extra == NULL || index >= co_extra->ce_size)
+        *extra = NULL;
+    else
+        *extra = co_extra->ce_extras[index];
+    return 0;
+}
+
+int
+_PyCode_SetExtra(PyObject *code, Py_ssize_t index, void *extra)
+{
+    PyInterpreterState *interp = PyThreadState_GET()->interp;
+    PyCodeObject *co = (PyCodeObject *)code;
+    _PyCodeObjectExtra *co_extra;
+
+    if (!PyCode_Check(code) || index < 0
+        || index >= interp->co_extra_user_count) {
+        PyErr_BadInternalCall();
+        return -1;
+    }
+    co_extra = co->co_extra;
+    if (co_extra == NULL || index >= co_extra->ce_size) {
+        /* Grow the slots up to index, the other users keep theirs */
+        Py_ssize_t i = co_extra == NULL ? 0 : co_extra->ce_size;
+
+        co_extra = PyMem_Realloc(co_extra, sizeof(_PyCodeObjectExtra)
+                                           + index * sizeof(void *));
+        if (co_extra == NULL) {
+            PyErr_NoMemory();
+            return -1;
+        }
+        for (; i <= index; i++)
+            co_extra->ce_extras[i] = NULL;
+        co_extra->ce_size = index + 1;
+        co->co_extra = co_extra;
+    }
+    else if (co_extra->ce_extras[index] != NULL
+             && co_extra->ce_extras[index] != extra
+             && interp->co_extra_freefuncs[index] != NULL) {
+        interp->co_extra_freefuncs[index](co_extra->ce_extras[index]);
+    }
+    co_extra->ce_extras[index] = extra;
+    return 0;
+}
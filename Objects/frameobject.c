@@ -56,7 +56,38 @@ frame_getlineno(PyFrameObject *f, void *closure)
  *  o 'try'/'for'/'while' blocks can't be jumped into because the blockstack
  *    needs to be set up before their code runs, and for 'for' loops the
  *    iterator needs to be on the stack.
+ *
+ * The blocks of co_exceptiontable are treated as if they were set up and
+ * popped by the SETUP_* and POP_BLOCK instructions the compiler left out:
+ * at each address, the blocks that end there are popped (innermost first),
+ * then the blocks that start there are set up (outermost first), and then
+ * the instruction at the address runs.
  */
+
+/* Return the non-empty blocks of co_exceptiontable in a new array, or NULL
+   with an exception set. */
+static _PyCodeBlock *
+get_static_blocks(PyCodeObject *co, int *pn)
+{
+    _PyCodeBlock *blocks, b;
+    Py_ssize_t pos = 0;
+    int n = 0;
+
+    /* Every block takes at least five bytes of the table */
+    blocks = PyMem_New(_PyCodeBlock,
+                       PyBytes_GET_SIZE(co->co_exceptiontable) / 5 + 1);
+    if (blocks == NULL) {
+        PyErr_NoMemory();
+        return NULL;
+    }
+    while (_PyCode_NextBlock(co, &pos, &b)) {
+        if (b.cb_start < b.cb_end)
+            blocks[n++] = b;
+    }
+    *pn = n;
+    return blocks;
+}
+
 static int
 frame_setlineno(PyFrameObject *f, PyObject* p_new_lineno)
 {
@@ -81,8 +112,12 @@ frame_setlineno(PyFrameObject *f, PyObject* p_new_lineno)
     int new_lasti_setup_addr = 0;       /* (ditto) */
     int blockstack[CO_MAXBLOCKS];       /* Walking the 'finally' blocks */
     int in_finally[CO_MAXBLOCKS];       /* (ditto) */
+    int is_finally[CO_MAXBLOCKS];       /* (ditto) */
     int blockstack_top = 0;             /* (ditto) */
-    unsigned char setup_op = 0;         /* (ditto) */
+    _PyCodeBlock *static_blocks = NULL; /* co_exceptiontable */
+    int n_static = 0;                   /* (ditto) */
+    int cur_iblock = 0;                 /* Blocks the frame is in */
+    int i = 0;
 
     /* f_lineno must be an integer. */
     if (!PyLong_CheckExact(p_new_lineno)) {
@@ -158,6 +193,9 @@ frame_setlineno(PyFrameObject *f, PyObject* p_new_lineno)
     PyBytes_AsStringAndSize(f->f_code->co_code, (char **)&code, &code_len);
     min_addr = Py_MIN(new_lasti, f->f_lasti);
     max_addr = Py_MAX(new_lasti, f->f_lasti);
+    static_blocks = get_static_blocks(f->f_code, &n_static);
+    if (static_blocks == NULL)
+        return -1;
 
     /* You can't jump onto a line with an 'except' statement on it -
      * they expect to have an exception on the top of the stack, which
@@ -172,7 +210,7 @@ frame_setlineno(PyFrameObject *f, PyObject* p_new_lineno)
     if (code[new_lasti] == DUP_TOP || code[new_lasti] == POP_TOP) {
         PyErr_SetString(PyExc_ValueError,
             "can't jump to 'except' line as there's no exception");
-        return -1;
+        goto error;
     }
 
     /* You can't jump into or out of a 'finally' block because the 'try'
@@ -189,23 +227,46 @@ frame_setlineno(PyFrameObject *f, PyObject* p_new_lineno)
     memset(blockstack, '\0', sizeof(blockstack));
     memset(in_finally, '\0', sizeof(in_finally));
     blockstack_top = 0;
-    for (addr = 0; addr < code_len; addr++) {
+    for (addr = 0; addr < code_len; addr += sizeof(_Py_CODEUNIT)) {
         unsigned char op = code[addr];
+
+        /* The blocks of co_exceptiontable are told apart from the
+         * others by an address past the end of the code. */
+        for (i = n_static - 1; i >= 0; i--) {
+            if (static_blocks[i].cb_end != addr)
+                continue;
+            assert(blockstack_top > 0);
+            assert(blockstack[blockstack_top-1] == code_len + i);
+            if (is_finally[blockstack_top-1])
+                in_finally[blockstack_top-1] = 1;
+            else
+                blockstack_top--;
+        }
+        for (i = 0; i < n_static; i++) {
+            if (static_blocks[i].cb_start != addr)
+                continue;
+            blockstack[blockstack_top] = (int)code_len + i;
+            is_finally[blockstack_top] =
+                static_blocks[i].cb_type == SETUP_FINALLY;
+            in_finally[blockstack_top++] = 0;
+        }
+
         switch (op) {
         case SETUP_LOOP:
         case SETUP_EXCEPT:
         case SETUP_FINALLY:
         case SETUP_WITH:
         case SETUP_ASYNC_WITH:
-            blockstack[blockstack_top++] = addr;
-            in_finally[blockstack_top-1] = 0;
+            blockstack[blockstack_top] = addr;
+            is_finally[blockstack_top] = (op == SETUP_FINALLY ||
+                                          op == SETUP_WITH ||
+                                          op == SETUP_ASYNC_WITH);
+            in_finally[blockstack_top++] = 0;
             break;
 
         case POP_BLOCK:
             assert(blockstack_top > 0);
-            setup_op = code[blockstack[blockstack_top-1]];
-            if (setup_op == SETUP_FINALLY || setup_op == SETUP_WITH
-                                    || setup_op == SETUP_ASYNC_WITH) {
+            if (is_finally[blockstack_top-1]) {
                 in_finally[blockstack_top-1] = 1;
             }
             else {
@@ -216,14 +277,11 @@ frame_setlineno(PyFrameObject *f, PyObject* p_new_lineno)
         case END_FINALLY:
             /* Ignore END_FINALLYs for SETUP_EXCEPTs - they exist
              * in the bytecode but don't correspond to an actual
-             * 'finally' block.  (If blockstack_top is 0, we must
+             * 'finally' block.  (If blockstack_top is 0, or the
+             * innermost block is still in its 'try' part, we must
              * be seeing such an END_FINALLY.) */
-            if (blockstack_top > 0) {
-                setup_op = code[blockstack[blockstack_top-1]];
-                if (setup_op == SETUP_FINALLY || setup_op == SETUP_WITH
-                                    || setup_op == SETUP_ASYNC_WITH) {
-                    blockstack_top--;
-                }
+            if (blockstack_top > 0 && in_finally[blockstack_top-1]) {
+                blockstack_top--;
             }
             break;
         }
@@ -251,10 +309,6 @@ frame_setlineno(PyFrameObject *f, PyObject* p_new_lineno)
                 }
             }
         }
-
-        if (op >= HAVE_ARGUMENT) {
-            addr += 2;
-        }
     }
 
     /* Verify that the blockstack tracking code didn't get lost. */
@@ -264,7 +318,7 @@ frame_setlineno(PyFrameObject *f, PyObject* p_new_lineno)
     if (new_lasti_setup_addr != f_lasti_setup_addr) {
         PyErr_SetString(PyExc_ValueError,
                     "can't jump into or out of a 'finally' block");
-        return -1;
+        goto error;
     }
 
 
@@ -275,10 +329,33 @@ frame_setlineno(PyFrameObject *f, PyObject* p_new_lineno)
      * one, and keep track of how many blocks we drop out of on the way.
      * By also keeping track of the lowest blockstack position we see, we
      * can tell whether the jump goes into any blocks without coming out
-     * again - in that case we raise an exception below. */
+     * again - in that case we raise an exception below.
+     *
+     * The blocks of co_exceptiontable that end at max_addr are popped
+     * before the instruction there, so they count.  Those that start at
+     * the old address are already set up, and those that start at the
+     * new address are set up after the jump: both count only for a
+     * backwards jump, which goes through them. */
     delta_iblock = 0;
-    for (addr = min_addr; addr < max_addr; addr++) {
+    for (addr = min_addr; addr <= max_addr && min_addr < max_addr;
+         addr += sizeof(_Py_CODEUNIT)) {
         unsigned char op = code[addr];
+
+        for (i = n_static - 1; i >= 0 && addr > min_addr; i--) {
+            if (static_blocks[i].cb_end == addr) {
+                delta_iblock--;
+                min_delta_iblock = Py_MIN(min_delta_iblock, delta_iblock);
+            }
+        }
+        if ((addr > min_addr && addr < max_addr) || new_lasti < f->f_lasti) {
+            for (i = 0; i < n_static; i++) {
+                if (static_blocks[i].cb_start == addr)
+                    delta_iblock++;
+            }
+        }
+        if (addr == max_addr)
+            break;
+
         switch (op) {
         case SETUP_LOOP:
         case SETUP_EXCEPT:
@@ -294,43 +371,64 @@ frame_setlineno(PyFrameObject *f, PyObject* p_new_lineno)
         }
 
         min_delta_iblock = Py_MIN(min_delta_iblock, delta_iblock);
-
-        if (op >= HAVE_ARGUMENT) {
-            addr += 2;
-        }
     }
 
     /* Derive the absolute iblock values from the deltas. */
-    min_iblock = f->f_iblock + min_delta_iblock;
+    cur_iblock = f->f_iblock;
+    for (i = 0; i < n_static; i++) {
+        if (static_blocks[i].cb_start <= f->f_lasti &&
+            f->f_lasti < static_blocks[i].cb_end)
+            cur_iblock++;
+    }
+    min_iblock = cur_iblock + min_delta_iblock;
     if (new_lasti > f->f_lasti) {
         /* Forwards jump. */
-        new_iblock = f->f_iblock + delta_iblock;
+        new_iblock = cur_iblock + delta_iblock;
     }
     else {
         /* Backwards jump. */
-        new_iblock = f->f_iblock - delta_iblock;
+        new_iblock = cur_iblock - delta_iblock;
     }
 
     /* Are we jumping into a block? */
     if (new_iblock > min_iblock) {
         PyErr_SetString(PyExc_ValueError,
                         "can't jump into the middle of a block");
-        return -1;
+        goto error;
     }
 
-    /* Pop any blocks that we're jumping out of. */
-    while (f->f_iblock > new_iblock) {
+    /* Pop any blocks that we're jumping out of: first the ones on the
+     * block stack, then the blocks of co_exceptiontable that contain
+     * f_lasti, innermost first, which only leaves the value stack to
+     * unwind to the level of the outermost of them. */
+    while (cur_iblock > new_iblock && f->f_iblock > 0) {
         PyTryBlock *b = &f->f_blockstack[--f->f_iblock];
         while ((f->f_stacktop - f->f_valuestack) > b->b_level) {
             PyObject *v = (*--f->f_stacktop);
-            Py_DECREF(v);
+            Py_XDECREF(v);
         }
+        cur_iblock--;
     }
+    for (i = n_static - 1; i >= 0 && cur_iblock > new_iblock; i--) {
+        _PyCodeBlock *b = &static_blocks[i];
+        if (b->cb_start > f->f_lasti || f->f_lasti >= b->cb_end)
+            continue;
+        while ((f->f_stacktop - f->f_valuestack) > b->cb_level) {
+            PyObject *v = (*--f->f_stacktop);
+            Py_XDECREF(v);
+        }
+        cur_iblock--;
+    }
+    PyMem_Free(static_blocks);
 
     /* Finally set the new f_lineno and f_lasti and return OK. */
     f->f_lineno = new_lineno;
     f->f_lasti = new_lasti;
     return 0;
+
+  error:
+    PyMem_Free(static_blocks);
+    return -1;
 }
 
 static PyObject *
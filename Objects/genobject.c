@@ -262,7 +262,15 @@ gen_yf(PyGenObject *gen)
         PyObject *bytecode = f->f_code->co_code;
         unsigned char *code = (unsigned char *)PyBytes_AS_STRING(bytecode);
 
-        if (code[f->f_lasti + 1] != YIELD_FROM)
+        if (f->f_lasti < 0) {
+            /* Return immediately if the frame didn't start yet. YIELD_FROM
+               always come after LOAD_CONST: a code object should not start
+               with YIELD_FROM */
+            assert(code[0] != YIELD_FROM);
+            return NULL;
+        }
+
+        if (code[f->f_lasti + sizeof(_Py_CODEUNIT)] != YIELD_FROM)
             return NULL;
         yf = f->f_stacktop[-1];
         Py_INCREF(yf);
@@ -359,7 +367,7 @@ gen_throw(PyGenObject *gen, PyObject *args)
             assert(ret == yf);
             Py_DECREF(ret);
             /* Termination repetition of YIELD_FROM */
-            gen->gi_frame->f_lasti++;
+            gen->gi_frame->f_lasti += sizeof(_Py_CODEUNIT);
             if (_PyGen_FetchStopIterationValue(&val) == 0) {
                 ret = gen_send_ex(gen, val, 0);
                 Py_DECREF(val);
@@ -693,6 +701,19 @@ PyGen_NeedsFinalizing(PyGenObject *gen)
         if (f->f_blockstack[i].b_type != SETUP_LOOP)
             return 1;
 
+    /* The same goes for the blocks of co_exceptiontable that contain
+       the instruction the generator is suspended at. */
+    if (f->f_lasti >= 0) {
+        Py_ssize_t pos = 0;
+        _PyCodeBlock b;
+        while (_PyCode_NextBlock(f->f_code, &pos, &b)) {
+            if (b.cb_start > f->f_lasti)
+                break;
+            if (f->f_lasti < b.cb_end && b.cb_type != SETUP_LOOP)
+                return 1;
+        }
+    }
+
     /* No blocks except loops, it's safe to skip finalization. */
     return 0;
 }
@@ -1031,11 +1031,82 @@ sortslice_advance(sortslice *slice, Py_ssize_t n)
         slice->values += n;
 }
 
-/* Comparison function: PyObject_RichCompareBool with Py_LT.
+/* The maximum number of entries in a MergeState's pending-runs stack.
+ * This is enough to sort arrays of size up to about
+ *     32 * phi ** MAX_MERGE_PENDING
+ * where phi ~= 1.618.  85 is ridiculouslylarge enough, good for an array
+ * with 2**64 elements.
+ */
+#define MAX_MERGE_PENDING 85
+
+/* When we get into galloping mode, we stay there until both runs win less
+ * often than MIN_GALLOP consecutive times.  See listsort.txt for more info.
+ */
+#define MIN_GALLOP 7
+
+/* Avoid malloc for small temp arrays. */
+#define MERGESTATE_TEMP_SIZE 256
+
+/* One MergeState exists on the stack per invocation of mergesort.  It's just
+ * a convenient way to pass state around among the helper functions.
+ */
+struct s_slice {
+    sortslice base;
+    Py_ssize_t len;
+};
+
+typedef struct s_MergeState MergeState;
+struct s_MergeState {
+    /* This controls when we get *into* galloping mode.  It's initialized
+     * to MIN_GALLOP.  merge_lo and merge_hi tend to nudge it higher for
+     * random data, and lower for highly structured data.
+     */
+    Py_ssize_t min_gallop;
+
+    /* 'a' is temp storage to help with merges.  It contains room for
+     * alloced entries.
+     */
+    sortslice a;        /* may point to temparray below */
+    Py_ssize_t alloced;
+
+    /* A stack of n pending runs yet to be merged.  Run #i starts at
+     * address base[i] and extends for len[i] elements.  It's always
+     * true (so long as the indices are in bounds) that
+     *
+     *     pending[i].base + pending[i].len == pending[i+1].base
+     *
+     * so we could cut the storage for this, but it's a minor amount,
+     * and keeping all the info explicit simplifies the code.
+     */
+    int n;
+    struct s_slice pending[MAX_MERGE_PENDING];
+
+    /* 'a' points to this when possible, rather than muck with malloc. */
+    PyObject *temparray[MERGESTATE_TEMP_SIZE];
+
+    /* The function used to compare two keys, chosen by listsort() after
+     * checking the types of all the keys.  safe_object_compare() is always
+     * correct, the other ones assume something about the keys.
+     */
+    int (*key_compare)(PyObject *, PyObject *, MergeState *);
+
+    /* The tp_richcompare slot shared by all the keys, used by
+     * unsafe_object_compare().
+     */
+    PyObject *(*key_richcompare)(PyObject *, PyObject *, int);
+
+    /* The function used by unsafe_tuple_compare() to compare the first
+     * items of tuples.
+     */
+    int (*tuple_elem_compare)(PyObject *, PyObject *, MergeState *);
+};
+
+/* Comparison function: ms->key_compare, which is PyObject_RichCompareBool
+ * with Py_LT, or a faster equivalent for the types of the keys.
  * Returns -1 on error, 1 if x < y, 0 if x >= y.
  */
 
-#define ISLT(X, Y) (PyObject_RichCompareBool(X, Y, Py_LT))
+#define ISLT(X, Y) (*(ms->key_compare))(X, Y, ms)
 
 /* Compare X to Y via "<".  Goto "fail" if the comparison raises an
    error.  Else "k" is set to true iff X<Y, and an "if (k)" block is
@@ -1056,7 +1127,7 @@ sortslice_advance(sortslice *slice, Py_ssize_t n)
    the input (nothing is lost or duplicated).
 */
 static int
-binarysort(sortslice lo, PyObject **hi, PyObject **start)
+binarysort(MergeState *ms, sortslice lo, PyObject **hi, PyObject **start)
 {
     Py_ssize_t k;
     PyObject **l, **p, **r;
@@ -1130,7 +1201,7 @@ elements to get out of order).
 Returns -1 in case of error.
 */
 static Py_ssize_t
-count_run(PyObject **lo, PyObject **hi, int *descending)
+count_run(MergeState *ms, PyObject **lo, PyObject **hi, int *descending)
 {
     Py_ssize_t k;
     Py_ssize_t n;
@@ -1185,7 +1256,8 @@ key, and the last n-k should follow key.
 Returns -1 on error.  See listsort.txt for info on the method.
 */
 static Py_ssize_t
-gallop_left(PyObject *key, PyObject **a, Py_ssize_t n, Py_ssize_t hint)
+gallop_left(MergeState *ms, PyObject *key, PyObject **a, Py_ssize_t n,
+            Py_ssize_t hint)
 {
     Py_ssize_t ofs;
     Py_ssize_t lastofs;
@@ -1276,7 +1348,8 @@ we're sticking to "<" comparisons that it's much harder to follow if
 written as one routine with yet another "left or right?" flag.
 */
 static Py_ssize_t
-gallop_right(PyObject *key, PyObject **a, Py_ssize_t n, Py_ssize_t hint)
+gallop_right(MergeState *ms, PyObject *key, PyObject **a, Py_ssize_t n,
+             Py_ssize_t hint)
 {
     Py_ssize_t ofs;
     Py_ssize_t lastofs;
@@ -1352,58 +1425,6 @@ fail:
     return -1;
 }
 
-/* The maximum number of entries in a MergeState's pending-runs stack.
- * This is enough to sort arrays of size up to about
- *     32 * phi ** MAX_MERGE_PENDING
- * where phi ~= 1.618.  85 is ridiculouslylarge enough, good for an array
- * with 2**64 elements.
- */
-#define MAX_MERGE_PENDING 85
-
-/* When we get into galloping mode, we stay there until both runs win less
- * often than MIN_GALLOP consecutive times.  See listsort.txt for more info.
- */
-#define MIN_GALLOP 7
-
-/* Avoid malloc for small temp arrays. */
-#define MERGESTATE_TEMP_SIZE 256
-
-/* One MergeState exists on the stack per invocation of mergesort.  It's just
- * a convenient way to pass state around among the helper functions.
- */
-struct s_slice {
-    sortslice base;
-    Py_ssize_t len;
-};
-
-typedef struct s_MergeState {
-    /* This controls when we get *into* galloping mode.  It's initialized
-     * to MIN_GALLOP.  merge_lo and merge_hi tend to nudge it higher for
-     * random data, and lower for highly structured data.
-     */
-    Py_ssize_t min_gallop;
-
-    /* 'a' is temp storage to help with merges.  It contains room for
-     * alloced entries.
-     */
-    sortslice a;        /* may point to temparray below */
-    Py_ssize_t alloced;
-
-    /* A stack of n pending runs yet to be merged.  Run #i starts at
-     * address base[i] and extends for len[i] elements.  It's always
-     * true (so long as the indices are in bounds) that
-     *
-     *     pending[i].base + pending[i].len == pending[i+1].base
-     *
-     * so we could cut the storage for this, but it's a minor amount,
-     * and keeping all the info explicit simplifies the code.
-     */
-    int n;
-    struct s_slice pending[MAX_MERGE_PENDING];
-
-    /* 'a' points to this when possible, rather than muck with malloc. */
-    PyObject *temparray[MERGESTATE_TEMP_SIZE];
-} MergeState;
 
 /* Conceptually a MergeState's constructor. */
 static void
@@ -1557,7 +1578,7 @@ merge_lo(MergeState *ms, sortslice ssa, Py_ssize_t na,
             assert(na > 1 && nb > 0);
             min_gallop -= min_gallop > 1;
             ms->min_gallop = min_gallop;
-            k = gallop_right(ssb.keys[0], ssa.keys, na, 0);
+            k = gallop_right(ms, ssb.keys[0], ssa.keys, na, 0);
             acount = k;
             if (k) {
                 if (k < 0)
@@ -1580,7 +1601,7 @@ merge_lo(MergeState *ms, sortslice ssa, Py_ssize_t na,
             if (nb == 0)
                 goto Succeed;
 
-            k = gallop_left(ssa.keys[0], ssb.keys, nb, 0);
+            k = gallop_left(ms, ssa.keys[0], ssb.keys, nb, 0);
             bcount = k;
             if (k) {
                 if (k < 0)
@@ -1695,7 +1716,7 @@ merge_hi(MergeState *ms, sortslice ssa, Py_ssize_t na,
             assert(na > 0 && nb > 1);
             min_gallop -= min_gallop > 1;
             ms->min_gallop = min_gallop;
-            k = gallop_right(ssb.keys[0], basea.keys, na, na-1);
+            k = gallop_right(ms, ssb.keys[0], basea.keys, na, na-1);
             if (k < 0)
                 goto Fail;
             k = na - k;
@@ -1713,7 +1734,7 @@ merge_hi(MergeState *ms, sortslice ssa, Py_ssize_t na,
             if (nb == 1)
                 goto CopyA;
 
-            k = gallop_left(ssa.keys[0], baseb.keys, nb, nb-1);
+            k = gallop_left(ms, ssa.keys[0], baseb.keys, nb, nb-1);
             if (k < 0)
                 goto Fail;
             k = nb - k;
@@ -1790,7 +1811,7 @@ merge_at(MergeState *ms, Py_ssize_t i)
     /* Where does b start in a?  Elements in a before that can be
      * ignored (already in place).
      */
-    k = gallop_right(*ssb.keys, ssa.keys, na, 0);
+    k = gallop_right(ms, *ssb.keys, ssa.keys, na, 0);
     if (k < 0)
         return -1;
     sortslice_advance(&ssa, k);
@@ -1801,7 +1822,7 @@ merge_at(MergeState *ms, Py_ssize_t i)
     /* Where does a end in b?  Elements in b after that can be
      * ignored (already in place).
      */
-    nb = gallop_left(ssa.keys[na-1], ssb.keys, nb, nb-1);
+    nb = gallop_left(ms, ssa.keys[na-1], ssb.keys, nb, nb-1);
     if (nb <= 0)
         return nb;
 
@@ -1901,6 +1922,213 @@ reverse_sortslice(sortslice *s, Py_ssize_t n)
         reverse_slice(s->values, &s->values[n]);
 }
 
+/* Key compare functions for ms->key_compare.  listsort() checks the keys
+ * once before sorting; when they all have the same type, it picks one of
+ * the unsafe_*_compare() functions below, which skip the type checks and
+ * dispatching of PyObject_RichCompareBool() and rely on what it found.
+ */
+
+/* The generic compare, always correct. */
+static int
+safe_object_compare(PyObject *v, PyObject *w, MergeState *ms)
+{
+    return PyObject_RichCompareBool(v, w, Py_LT);
+}
+
+/* All the keys have the same type, whose tp_richcompare slot is
+ * ms->key_richcompare: call it directly.
+ */
+static int
+unsafe_object_compare(PyObject *v, PyObject *w, MergeState *ms)
+{
+    PyObject *res_obj;
+    int res;
+
+    /* The type of a key can still change by __class__ assignment */
+    if (Py_TYPE(v)->tp_richcompare != ms->key_richcompare)
+        return PyObject_RichCompareBool(v, w, Py_LT);
+
+    assert(ms->key_richcompare != NULL);
+    res_obj = (*(ms->key_richcompare))(v, w, Py_LT);
+    if (res_obj == Py_NotImplemented) {
+        Py_DECREF(res_obj);
+        return PyObject_RichCompareBool(v, w, Py_LT);
+    }
+    if (res_obj == NULL)
+        return -1;
+    if (PyBool_Check(res_obj))
+        res = (res_obj == Py_True);
+    else
+        res = PyObject_IsTrue(res_obj);
+    Py_DECREF(res_obj);
+    return res;
+}
+
+/* All the keys are exact str of the 1-byte kind: compare their bytes. */
+static int
+unsafe_latin_compare(PyObject *v, PyObject *w, MergeState *ms)
+{
+    Py_ssize_t len;
+    int res;
+
+    assert(PyUnicode_CheckExact(v) && PyUnicode_CheckExact(w));
+    assert(PyUnicode_KIND(v) == PyUnicode_KIND(w));
+    assert(PyUnicode_KIND(v) == PyUnicode_1BYTE_KIND);
+
+    len = Py_MIN(PyUnicode_GET_LENGTH(v), PyUnicode_GET_LENGTH(w));
+    res = memcmp(PyUnicode_DATA(v), PyUnicode_DATA(w), len);
+    if (res != 0)
+        return res < 0;
+    return PyUnicode_GET_LENGTH(v) < PyUnicode_GET_LENGTH(w);
+}
+
+/* All the keys are exact str. */
+static int
+unsafe_unicode_compare(PyObject *v, PyObject *w, MergeState *ms)
+{
+    int res;
+
+    assert(PyUnicode_CheckExact(v) && PyUnicode_CheckExact(w));
+    res = PyUnicode_Compare(v, w);
+    if (res == -1 && PyErr_Occurred())
+        return -1;
+    return res < 0;
+}
+
+/* All the keys are exact int of at most one digit. */
+static int
+unsafe_long_compare(PyObject *v, PyObject *w, MergeState *ms)
+{
+    PyLongObject *vl = (PyLongObject *)v, *wl = (PyLongObject *)w;
+    sdigit v0, w0;
+
+    assert(PyLong_CheckExact(v) && PyLong_CheckExact(w));
+    assert(Py_ABS(Py_SIZE(v)) <= 1 && Py_ABS(Py_SIZE(w)) <= 1);
+
+    v0 = Py_SIZE(vl) == 0 ? 0 : (sdigit)vl->ob_digit[0];
+    w0 = Py_SIZE(wl) == 0 ? 0 : (sdigit)wl->ob_digit[0];
+    if (Py_SIZE(vl) < 0)
+        v0 = -v0;
+    if (Py_SIZE(wl) < 0)
+        w0 = -w0;
+    return v0 < w0;
+}
+
+/* All the keys are exact float. */
+static int
+unsafe_float_compare(PyObject *v, PyObject *w, MergeState *ms)
+{
+    assert(PyFloat_CheckExact(v) && PyFloat_CheckExact(w));
+    return PyFloat_AS_DOUBLE(v) < PyFloat_AS_DOUBLE(w);
+}
+
+/* All the keys are non-empty exact tuples, whose first items are compared
+ * with ms->tuple_elem_compare.  Like tuplerichcompare(), the first
+ * different items decide.
+ */
+static int
+unsafe_tuple_compare(PyObject *v, PyObject *w, MergeState *ms)
+{
+    PyTupleObject *vt = (PyTupleObject *)v, *wt = (PyTupleObject *)w;
+    Py_ssize_t i, vlen, wlen;
+    int k;
+
+    assert(PyTuple_CheckExact(v) && PyTuple_CheckExact(w));
+    assert(Py_SIZE(v) > 0 && Py_SIZE(w) > 0);
+
+    vlen = Py_SIZE(vt);
+    wlen = Py_SIZE(wt);
+    for (i = 0; i < vlen && i < wlen; i++) {
+        k = PyObject_RichCompareBool(vt->ob_item[i], wt->ob_item[i], Py_EQ);
+        if (k < 0)
+            return -1;
+        if (!k)
+            break;
+    }
+
+    if (i >= vlen || i >= wlen)
+        return vlen < wlen;
+
+    if (i == 0)
+        return (*(ms->tuple_elem_compare))(vt->ob_item[0], wt->ob_item[0],
+                                           ms);
+    return PyObject_RichCompareBool(vt->ob_item[i], wt->ob_item[i], Py_LT);
+}
+
+/* Check the n keys once and set ms->key_compare to the fastest compare
+ * which is correct for all of them.  Tuples are checked by their first
+ * item, which decides most of the compares.
+ */
+static void
+merge_choose_compare(MergeState *ms, PyObject **keys, Py_ssize_t n)
+{
+    int keys_are_in_tuples, keys_are_all_same_type = 1;
+    int strings_are_latin = 1, ints_are_bounded = 1;
+    PyTypeObject *key_type;
+    Py_ssize_t i;
+
+    ms->key_compare = safe_object_compare;
+    ms->key_richcompare = NULL;
+    ms->tuple_elem_compare = safe_object_compare;
+    if (n < 2)
+        return;
+
+    /* Assume the first key is representative of the whole list */
+    keys_are_in_tuples = (PyTuple_CheckExact(keys[0]) &&
+                          Py_SIZE(keys[0]) > 0);
+    key_type = Py_TYPE(keys_are_in_tuples ? PyTuple_GET_ITEM(keys[0], 0)
+                                          : keys[0]);
+
+    /* and prove it */
+    for (i = 0; i < n; i++) {
+        PyObject *key;
+
+        if (keys_are_in_tuples &&
+            !(PyTuple_CheckExact(keys[i]) && Py_SIZE(keys[i]) > 0)) {
+            keys_are_in_tuples = 0;
+            keys_are_all_same_type = 0;
+            break;
+        }
+        key = keys_are_in_tuples ? PyTuple_GET_ITEM(keys[i], 0) : keys[i];
+        if (Py_TYPE(key) != key_type) {
+            keys_are_all_same_type = 0;
+            /* all the keys must still be checked to be tuples */
+            if (!keys_are_in_tuples)
+                break;
+        }
+        if (keys_are_all_same_type) {
+            if (key_type == &PyLong_Type) {
+                if (Py_ABS(Py_SIZE(key)) > 1)
+                    ints_are_bounded = 0;
+            }
+            else if (key_type == &PyUnicode_Type) {
+                if (!PyUnicode_IS_READY(key) ||
+                    PyUnicode_KIND(key) != PyUnicode_1BYTE_KIND)
+                    strings_are_latin = 0;
+            }
+        }
+    }
+
+    if (keys_are_all_same_type) {
+        if (key_type == &PyUnicode_Type)
+            ms->key_compare = strings_are_latin ? unsafe_latin_compare
+                                                : unsafe_unicode_compare;
+        else if (key_type == &PyLong_Type && ints_are_bounded)
+            ms->key_compare = unsafe_long_compare;
+        else if (key_type == &PyFloat_Type)
+            ms->key_compare = unsafe_float_compare;
+        else if ((ms->key_richcompare = key_type->tp_richcompare) != NULL)
+            ms->key_compare = unsafe_object_compare;
+    }
+    if (keys_are_in_tuples) {
+        /* the first items are compared by the fast compare, unless they
+           are tuples too: their own items haven't been checked */
+        if (key_type != &PyTuple_Type)
+            ms->tuple_elem_compare = ms->key_compare;
+        ms->key_compare = unsafe_tuple_compare;
+    }
+}
+
 /* An adaptive, stable, natural mergesort.  See listsort.txt.
  * Returns Py_None on success, NULL on error.  Even in case of error, the
  * list will be some permutation of its input state (nothing is lost or
@@ -1984,6 +2212,7 @@ listsort(PyListObject *self, PyObject *args, PyObject *kwds)
     }
 
     merge_init(&ms, saved_ob_size, keys != NULL);
+    merge_choose_compare(&ms, lo.keys, saved_ob_size);
 
     nremaining = saved_ob_size;
     if (nremaining < 2)
@@ -2006,7 +2235,7 @@ listsort(PyListObject *self, PyObject *args, PyObject *kwds)
         Py_ssize_t n;
 
         /* Identify next run. */
-        n = count_run(lo.keys, lo.keys + nremaining, &descending);
+        n = count_run(&ms, lo.keys, lo.keys + nremaining, &descending);
         if (n < 0)
             goto fail;
         if (descending)
@@ -2015,7 +2244,7 @@ listsort(PyListObject *self, PyObject *args, PyObject *kwds)
         if (n < minrun) {
             const Py_ssize_t force = nremaining <= minrun ?
                               nremaining : minrun;
-            if (binarysort(lo, lo.keys + force, lo.keys + n) < 0)
+            if (binarysort(&ms, lo, lo.keys + force, lo.keys + n) < 0)
                 goto fail;
             n = force;
         }
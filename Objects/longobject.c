@@ -1575,6 +1575,132 @@ divrem1(PyLongObject *a, digit n, digit *prem)
     return long_normalize(z);
 }
 
+/* forward */
+static int long_divrem(PyLongObject *, PyLongObject *,
+                       PyLongObject **, PyLongObject **);
+static PyLongObject *k_mul(PyLongObject *, PyLongObject *);
+
+/* Convert the size_a digits of pin to base _PyLong_DECIMAL_BASE digits in
+   pout, following Knuth (TAOCP, Volume 2 (3rd edn), section 4.4, Method
+   1b).  pout needs room for 1 + size_a * PyLong_SHIFT /
+   (3 * _PyLong_DECIMAL_SHIFT) digits, or for the actual number of digits
+   if that is known to be smaller.  Return that number, or -1 on error. */
+
+static Py_ssize_t
+decimal_digits(digit *pin, Py_ssize_t size_a, digit *pout)
+{
+    Py_ssize_t size, i, j;
+
+    size = 0;
+    for (i = size_a; --i >= 0; ) {
+        digit hi = pin[i];
+        for (j = 0; j < size; j++) {
+            twodigits z = (twodigits)pout[j] << PyLong_SHIFT | hi;
+            hi = (digit)(z / _PyLong_DECIMAL_BASE);
+            pout[j] = (digit)(z - (twodigits)hi *
+                              _PyLong_DECIMAL_BASE);
+        }
+        while (hi) {
+            pout[size++] = hi % _PyLong_DECIMAL_BASE;
+            hi /= _PyLong_DECIMAL_BASE;
+        }
+        /* check for keyboard interrupt */
+        SIGCHECK({
+                return -1;
+            });
+    }
+    return size;
+}
+
+/* Method 1b is quadratic.  From DECIMAL_DC_CUTOFF digits, the conversion is
+   done by divide and conquer instead: a is split into the quotient and the
+   remainder of its division by a power of _PyLong_DECIMAL_BASE, which are
+   converted recursively.  The divisions are large enough for bz_divrem(). */
+
+#define DECIMAL_DC_CUTOFF 200
+/* number of base _PyLong_DECIMAL_BASE digits made by Method 1b at the
+   leaves */
+#define DECIMAL_DC_LEAF 32
+
+/* Store the 2**(k+1) base _PyLong_DECIMAL_BASE digits of a in pout, where
+   0 <= a < pow10[k]**2 and pow10[i] = _PyLong_DECIMAL_BASE**(2**i). */
+static int
+decimal_digits_rec(PyLongObject *a, PyLongObject **pow10, int k,
+                   digit *pout)
+{
+    PyLongObject *q, *r;
+    Py_ssize_t n = (Py_ssize_t)2 << k;
+    int err;
+
+    if (n <= DECIMAL_DC_LEAF) {
+        Py_ssize_t size = decimal_digits(a->ob_digit, Py_SIZE(a), pout);
+        if (size < 0)
+            return -1;
+        memset(pout + size, 0, (n - size) * sizeof(digit));
+        return 0;
+    }
+    if (long_divrem(a, pow10[k], &q, &r) < 0)
+        return -1;
+    err = decimal_digits_rec(r, pow10, k - 1, pout);
+    if (err == 0)
+        err = decimal_digits_rec(q, pow10, k - 1, pout + n / 2);
+    Py_DECREF(q);
+    Py_DECREF(r);
+    return err;
+}
+
+/* Convert |a| to base _PyLong_DECIMAL_BASE digits, stored in a new
+   *pscratch.  Return their number, or -1 on error. */
+static Py_ssize_t
+decimal_digits_dc(PyLongObject *a, PyLongObject **pscratch)
+{
+    PyLongObject *pow10[8 * SIZEOF_SIZE_T];
+    PyLongObject *scratch = NULL;
+    Py_ssize_t size, size_a = Py_ABS(Py_SIZE(a));
+    int i, k = 0;
+
+    /* upper bound of the number of digits, see
+       long_to_decimal_string_internal() */
+    size = 1 + size_a * PyLong_SHIFT / (3 * _PyLong_DECIMAL_SHIFT);
+    pow10[0] = (PyLongObject *)PyLong_FromLong(_PyLong_DECIMAL_BASE);
+    if (pow10[0] == NULL)
+        return -1;
+    while (((Py_ssize_t)2 << k) < size) {
+        pow10[k + 1] = k_mul(pow10[k], pow10[k]);
+        if (pow10[k + 1] == NULL)
+            goto error;
+        k++;
+    }
+    scratch = _PyLong_New((Py_ssize_t)2 << k);
+    if (scratch == NULL)
+        goto error;
+    if (Py_SIZE(a) < 0) {
+        a = (PyLongObject *)_PyLong_Copy(a);
+        if (a == NULL)
+            goto error;
+        Py_SIZE(a) = size_a;
+    }
+    else
+        Py_INCREF(a);
+    i = decimal_digits_rec(a, pow10, k, scratch->ob_digit);
+    Py_DECREF(a);
+    if (i < 0)
+        goto error;
+    size = (Py_ssize_t)2 << k;
+    while (size > 0 && scratch->ob_digit[size - 1] == 0)
+        size--;
+    for (i = 0; i <= k; i++)
+        Py_DECREF(pow10[i]);
+    *pscratch = scratch;
+    return size;
+
+  error:
+    for (i = 0; i <= k; i++)
+        Py_XDECREF(pow10[i]);
+    Py_XDECREF(scratch);
+    return -1;
+}
+
 /* Convert an integer to a base 10 string.  Returns a new non-shared
    string.  (Return value is non-shared so that callers can modify the
    returned value if necessary.) */
@@ -1587,7 +1713,7 @@ long_to_decimal_string_internal(PyObject *aa,
     PyLongObject *scratch, *a;
     PyObject *str;
     Py_ssize_t size, strlen, size_a, i, j;
-    digit *pout, *pin, rem, tenpow;
+    digit *pout, rem, tenpow;
     int negative;
     enum PyUnicode_Kind kind;
 
@@ -1614,35 +1740,23 @@ long_to_decimal_string_internal(PyObject *aa,
         return -1;
     }
     /* the expression size_a * PyLong_SHIFT is now safe from overflow */
-    size = 1 + size_a * PyLong_SHIFT / (3 * _PyLong_DECIMAL_SHIFT);
-    scratch = _PyLong_New(size);
-    if (scratch == NULL)
-        return -1;
-
-    /* convert array of base _PyLong_BASE digits in pin to an array of
-       base _PyLong_DECIMAL_BASE digits in pout, following Knuth (TAOCP,
-       Volume 2 (3rd edn), section 4.4, Method 1b). */
-    pin = a->ob_digit;
-    pout = scratch->ob_digit;
-    size = 0;
-    for (i = size_a; --i >= 0; ) {
-        digit hi = pin[i];
-        for (j = 0; j < size; j++) {
-            twodigits z = (twodigits)pout[j] << PyLong_SHIFT | hi;
-            hi = (digit)(z / _PyLong_DECIMAL_BASE);
-            pout[j] = (digit)(z - (twodigits)hi *
-                              _PyLong_DECIMAL_BASE);
-        }
-        while (hi) {
-            pout[size++] = hi % _PyLong_DECIMAL_BASE;
-            hi /= _PyLong_DECIMAL_BASE;
+    if (size_a < DECIMAL_DC_CUTOFF) {
+        size = 1 + size_a * PyLong_SHIFT / (3 * _PyLong_DECIMAL_SHIFT);
+        scratch = _PyLong_New(size);
+        if (scratch == NULL)
+            return -1;
+        size = decimal_digits(a->ob_digit, size_a, scratch->ob_digit);
+        if (size < 0) {
+            Py_DECREF(scratch);
+            return -1;
         }
-        /* check for keyboard interrupt */
-        SIGCHECK({
-                Py_DECREF(scratch);
-                return -1;
-            });
     }
+    else {
+        size = decimal_digits_dc(a, &scratch);
+        if (size < 0)
+            return -1;
+    }
+    pout = scratch->ob_digit;
     /* pout should have at least one digit, so that the case when a = 0
        works correctly */
     if (size == 0)
@@ -2008,66 +2122,12 @@ long_from_binary_base(const char **str, int base)
     return long_normalize(z);
 }
 
-/* Parses an int from a bytestring. Leading and trailing whitespace will be
- * ignored.
- *
- * If successful, a PyLong object will be returned and 'pend' will be pointing
- * to the first unused byte unless it's NULL.
- *
- * If unsuccessful, NULL will be returned.
- */
-PyObject *
-PyLong_FromString(const char *str, char **pend, int base)
-{
-    int sign = 1, error_if_nonzero = 0;
-    const char *start, *orig_str = str;
-    PyLongObject *z = NULL;
-    PyObject *strobj;
-    Py_ssize_t slen;
-
-    if ((base != 0 && base < 2) || base > 36) {
-        PyErr_SetString(PyExc_ValueError,
-                        "int() arg 2 must be >= 2 and <= 36");
-        return NULL;
-    }
-    while (*str != '\0' && Py_ISSPACE(Py_CHARMASK(*str)))
-        str++;
-    if (*str == '+')
-        ++str;
-    else if (*str == '-') {
-        ++str;
-        sign = -1;
-    }
-    if (base == 0) {
-        if (str[0] != '0')
-            base = 10;
-        else if (str[1] == 'x' || str[1] == 'X')
-            base = 16;
-        else if (str[1] == 'o' || str[1] == 'O')
-            base = 8;
-        else if (str[1] == 'b' || str[1] == 'B')
-            base = 2;
-        else {
-            /* "old" (C-style) octal literal, now invalid.
-               it might still be zero though */
-            error_if_nonzero = 1;
-            base = 10;
-        }
-    }
-    if (str[0] == '0' &&
-        ((base == 16 && (str[1] == 'x' || str[1] == 'X')) ||
-         (base == 8  && (str[1] == 'o' || str[1] == 'O')) ||
-         (base == 2  && (str[1] == 'b' || str[1] == 'B'))))
-        str += 2;
-
-    start = str;
-    if ((base & (base - 1)) == 0)
-        z = long_from_binary_base(&str, base);
-    else {
 /***
 Binary bases can be converted in time linear in the number of digits, because
 Python's representation base is binary.  Other bases (including decimal!) use
 the simple quadratic-time algorithm below, complicated by some speed tricks.
+Long strings are split by long_from_digits_dc() so that this algorithm only
+sees short pieces.
 
 First some math:  the largest integer that can be expressed in N base-B digits
 is B**N-1.  Consequently, if we have an N-digit input in base B, the worst-
@@ -2149,116 +2209,267 @@ that triggers it(!).  Instead the code was tested by artificially allocating
 just 1 digit at the start, so that the copying code was exercised for every
 digit beyond the first.
 ***/
-        twodigits c;           /* current input character */
-        Py_ssize_t size_z;
-        int i;
-        int convwidth;
-        twodigits convmultmax, convmult;
-        digit *pz, *pzstop;
-        const char* scan;
-
-        static double log_base_BASE[37] = {0.0e0,};
-        static int convwidth_base[37] = {0,};
-        static twodigits convmultmax_base[37] = {0,};
-
-        if (log_base_BASE[base] == 0.0) {
-            twodigits convmax = base;
-            int i = 1;
-
-            log_base_BASE[base] = (log((double)base) /
-                                   log((double)PyLong_BASE));
-            for (;;) {
-                twodigits next = convmax * base;
-                if (next > PyLong_BASE)
-                    break;
-                convmax = next;
-                ++i;
-            }
-            convmultmax_base[base] = convmax;
-            assert(i > 0);
-            convwidth_base[base] = i;
+
+static PyLongObject *
+long_from_non_binary_base(const char *str, Py_ssize_t len, int base)
+{
+    PyLongObject *z;
+    twodigits c;           /* current input character */
+    Py_ssize_t size_z;
+    int i;
+    int convwidth;
+    twodigits convmultmax, convmult;
+    digit *pz, *pzstop;
+    const char *end = str + len;
+
+    static double log_base_BASE[37] = {0.0e0,};
+    static int convwidth_base[37] = {0,};
+    static twodigits convmultmax_base[37] = {0,};
+
+    if (log_base_BASE[base] == 0.0) {
+        twodigits convmax = base;
+        int i = 1;
+
+        log_base_BASE[base] = (log((double)base) /
+                               log((double)PyLong_BASE));
+        for (;;) {
+            twodigits next = convmax * base;
+            if (next > PyLong_BASE)
+                break;
+            convmax = next;
+            ++i;
         }
+        convmultmax_base[base] = convmax;
+        assert(i > 0);
+        convwidth_base[base] = i;
+    }
 
-        /* Find length of the string of numeric characters. */
-        scan = str;
-        while (_PyLong_DigitValue[Py_CHARMASK(*scan)] < base)
-            ++scan;
+    /* Create an int object that can contain the largest possible
+     * integer with this base and length.  Note that there's no
+     * need to initialize z->ob_digit -- no slot is read up before
+     * being stored into.
+     */
+    size_z = (Py_ssize_t)(len * log_base_BASE[base]) + 1;
+    /* Uncomment next line to test exceedingly rare copy code */
+    /* size_z = 1; */
+    assert(size_z > 0);
+    z = _PyLong_New(size_z);
+    if (z == NULL)
+        return NULL;
+    Py_SIZE(z) = 0;
 
-        /* Create an int object that can contain the largest possible
-         * integer with this base and length.  Note that there's no
-         * need to initialize z->ob_digit -- no slot is read up before
-         * being stored into.
-         */
-        size_z = (Py_ssize_t)((scan - str) * log_base_BASE[base]) + 1;
-        /* Uncomment next line to test exceedingly rare copy code */
-        /* size_z = 1; */
-        assert(size_z > 0);
-        z = _PyLong_New(size_z);
-        if (z == NULL)
-            return NULL;
-        Py_SIZE(z) = 0;
+    /* `convwidth` consecutive input digits are treated as a single
+     * digit in base `convmultmax`.
+     */
+    convwidth = convwidth_base[base];
+    convmultmax = convmultmax_base[base];
+
+    /* Work ;-) */
+    while (str < end) {
+        /* grab up to convwidth digits from the input string */
+        c = (digit)_PyLong_DigitValue[Py_CHARMASK(*str++)];
+        for (i = 1; i < convwidth && str != end; ++i, ++str) {
+            c = (twodigits)(c *  base +
+                            (int)_PyLong_DigitValue[Py_CHARMASK(*str)]);
+            assert(c < PyLong_BASE);
+        }
 
-        /* `convwidth` consecutive input digits are treated as a single
-         * digit in base `convmultmax`.
+        convmult = convmultmax;
+        /* Calculate the shift only if we couldn't get
+         * convwidth digits.
          */
-        convwidth = convwidth_base[base];
-        convmultmax = convmultmax_base[base];
-
-        /* Work ;-) */
-        while (str < scan) {
-            /* grab up to convwidth digits from the input string */
-            c = (digit)_PyLong_DigitValue[Py_CHARMASK(*str++)];
-            for (i = 1; i < convwidth && str != scan; ++i, ++str) {
-                c = (twodigits)(c *  base +
-                                (int)_PyLong_DigitValue[Py_CHARMASK(*str)]);
-                assert(c < PyLong_BASE);
-            }
-
-            convmult = convmultmax;
-            /* Calculate the shift only if we couldn't get
-             * convwidth digits.
-             */
-            if (i != convwidth) {
-                convmult = base;
-                for ( ; i > 1; --i)
-                    convmult *= base;
-            }
+        if (i != convwidth) {
+            convmult = base;
+            for ( ; i > 1; --i)
+                convmult *= base;
+        }
 
-            /* Multiply z by convmult, and add c. */
-            pz = z->ob_digit;
-            pzstop = pz + Py_SIZE(z);
-            for (; pz < pzstop; ++pz) {
-                c += (twodigits)*pz * convmult;
-                *pz = (digit)(c & PyLong_MASK);
-                c >>= PyLong_SHIFT;
+        /* Multiply z by convmult, and add c. */
+        pz = z->ob_digit;
+        pzstop = pz + Py_SIZE(z);
+        for (; pz < pzstop; ++pz) {
+            c += (twodigits)*pz * convmult;
+            *pz = (digit)(c & PyLong_MASK);
+            c >>= PyLong_SHIFT;
+        }
+        /* carry off the current end? */
+        if (c) {
+            assert(c < PyLong_BASE);
+            if (Py_SIZE(z) < size_z) {
+                *pz = (digit)c;
+                ++Py_SIZE(z);
             }
-            /* carry off the current end? */
-            if (c) {
-                assert(c < PyLong_BASE);
-                if (Py_SIZE(z) < size_z) {
-                    *pz = (digit)c;
-                    ++Py_SIZE(z);
-                }
-                else {
-                    PyLongObject *tmp;
-                    /* Extremely rare.  Get more space. */
-                    assert(Py_SIZE(z) == size_z);
-                    tmp = _PyLong_New(size_z + 1);
-                    if (tmp == NULL) {
-                        Py_DECREF(z);
-                        return NULL;
-                    }
-                    memcpy(tmp->ob_digit,
-                           z->ob_digit,
-                           sizeof(digit) * size_z);
+            else {
+                PyLongObject *tmp;
+                /* Extremely rare.  Get more space. */
+                assert(Py_SIZE(z) == size_z);
+                tmp = _PyLong_New(size_z + 1);
+                if (tmp == NULL) {
                     Py_DECREF(z);
-                    z = tmp;
-                    z->ob_digit[size_z] = (digit)c;
-                    ++size_z;
+                    return NULL;
                 }
+                memcpy(tmp->ob_digit,
+                       z->ob_digit,
+                       sizeof(digit) * size_z);
+                Py_DECREF(z);
+                z = tmp;
+                z->ob_digit[size_z] = (digit)c;
+                ++size_z;
             }
         }
     }
+    return z;
+}
+
+/* forward */
+static PyLongObject *x_add(PyLongObject *, PyLongObject *);
+static PyObject *long_pow(PyObject *, PyObject *, PyObject *);
+
+/* Strings of more than DIGITS_DC_CUTOFF digits are converted by divide and
+   conquer: the value of the digits is hi * base**m + lo, where lo is the
+   value of the last m digits.  m is the largest DIGITS_DC_LEAF * 2**k not
+   above len / 2, so that hi and lo have similar sizes and the same powers
+   of base are used at every level of the recursion.  The work is dominated
+   by the Karatsuba multiplications of the last levels. */
+
+#define DIGITS_DC_CUTOFF 4000
+#define DIGITS_DC_LEAF 1000
+
+static PyLongObject *
+digits_dc(const char *str, Py_ssize_t len, int base,
+          PyLongObject **pow_base, int k)
+{
+    PyLongObject *hi, *lo, *z;
+    Py_ssize_t m;
+
+    while (k >= 0 && ((Py_ssize_t)DIGITS_DC_LEAF << k) > len / 2)
+        k--;
+    if (k < 0)
+        return long_from_non_binary_base(str, len, base);
+
+    m = (Py_ssize_t)DIGITS_DC_LEAF << k;
+    hi = digits_dc(str, len - m, base, pow_base, k);
+    if (hi == NULL)
+        return NULL;
+    lo = digits_dc(str + len - m, m, base, pow_base, k - 1);
+    if (lo == NULL) {
+        Py_DECREF(hi);
+        return NULL;
+    }
+    z = k_mul(hi, pow_base[k]);
+    Py_DECREF(hi);
+    if (z == NULL) {
+        Py_DECREF(lo);
+        return NULL;
+    }
+    hi = z;
+    z = x_add(hi, lo);
+    Py_DECREF(hi);
+    Py_DECREF(lo);
+    return z;
+}
+
+static PyLongObject *
+long_from_digits_dc(const char *str, Py_ssize_t len, int base)
+{
+    /* pow_base[i] = base**(DIGITS_DC_LEAF * 2**i) */
+    PyLongObject *pow_base[8 * SIZEOF_SIZE_T];
+    PyLongObject *z = NULL;
+    PyObject *b, *e;
+    int i, k = 0;
+
+    b = PyLong_FromLong(base);
+    e = PyLong_FromLong(DIGITS_DC_LEAF);
+    if (b == NULL || e == NULL) {
+        Py_XDECREF(b);
+        Py_XDECREF(e);
+        return NULL;
+    }
+    pow_base[0] = (PyLongObject *)long_pow(b, e, Py_None);
+    Py_DECREF(b);
+    Py_DECREF(e);
+    if (pow_base[0] == NULL)
+        return NULL;
+    while (((Py_ssize_t)DIGITS_DC_LEAF << (k + 1)) <= len / 2) {
+        pow_base[k + 1] = k_mul(pow_base[k], pow_base[k]);
+        if (pow_base[k + 1] == NULL)
+            goto error;
+        k++;
+    }
+    z = digits_dc(str, len, base, pow_base, k);
+  error:
+    for (i = 0; i <= k; i++)
+        Py_XDECREF(pow_base[i]);
+    return z;
+}
+
+/* Parses an int from a bytestring. Leading and trailing whitespace will be
+ * ignored.
+ *
+ * If successful, a PyLong object will be returned and 'pend' will be pointing
+ * to the first unused byte unless it's NULL.
+ *
+ * If unsuccessful, NULL will be returned.
+ */
+PyObject *
+PyLong_FromString(const char *str, char **pend, int base)
+{
+    int sign = 1, error_if_nonzero = 0;
+    const char *start, *orig_str = str;
+    PyLongObject *z = NULL;
+    PyObject *strobj;
+    Py_ssize_t slen;
+
+    if ((base != 0 && base < 2) || base > 36) {
+        PyErr_SetString(PyExc_ValueError,
+                        "int() arg 2 must be >= 2 and <= 36");
+        return NULL;
+    }
+    while (*str != '\0' && Py_ISSPACE(Py_CHARMASK(*str)))
+        str++;
+    if (*str == '+')
+        ++str;
+    else if (*str == '-') {
+        ++str;
+        sign = -1;
+    }
+    if (base == 0) {
+        if (str[0] != '0')
+            base = 10;
+        else if (str[1] == 'x' || str[1] == 'X')
+            base = 16;
+        else if (str[1] == 'o' || str[1] == 'O')
+            base = 8;
+        else if (str[1] == 'b' || str[1] == 'B')
+            base = 2;
+        else {
+            /* "old" (C-style) octal literal, now invalid.
+               it might still be zero though */
+            error_if_nonzero = 1;
+            base = 10;
+        }
+    }
+    if (str[0] == '0' &&
+        ((base == 16 && (str[1] == 'x' || str[1] == 'X')) ||
+         (base == 8  && (str[1] == 'o' || str[1] == 'O')) ||
+         (base == 2  && (str[1] == 'b' || str[1] == 'B'))))
+        str += 2;
+
+    start = str;
+    if ((base & (base - 1)) == 0)
+        z = long_from_binary_base(&str, base);
+    else {
+        const char *scan = str;
+
+        /* Find length of the string of numeric characters. */
+        while (_PyLong_DigitValue[Py_CHARMASK(*scan)] < base)
+            ++scan;
+        if (scan - str > DIGITS_DC_CUTOFF)
+            z = long_from_digits_dc(str, scan - str, base);
+        else
+            z = long_from_non_binary_base(str, scan - str, base);
+        str = scan;
+    }
     if (z == NULL)
         return NULL;
     if (error_if_nonzero) {
@@ -2371,6 +2582,14 @@ PyLong_FromUnicodeObject(PyObject *u, int base)
 /* forward */
 static PyLongObject *x_divrem
     (PyLongObject *, PyLongObject *, PyLongObject **);
+static PyLongObject *bz_divrem
+    (PyLongObject *, PyLongObject *, PyLongObject **);
+static PyObject *long_add(PyLongObject *, PyLongObject *);
+static PyObject *long_sub(PyLongObject *, PyLongObject *);
+
+/* Below this number of divisor digits, x_divrem() is faster than
+   bz_divrem() */
+#define BZ_CUTOFF (2 * KARATSUBA_CUTOFF)
 static PyObject *long_long(PyObject *v);
 
 /* Int division with remainder, top-level routine */
@@ -2410,7 +2629,10 @@ long_divrem(PyLongObject *a, PyLongObject *b,
         }
     }
     else {
-        z = x_divrem(a, b, prem);
+        if (size_b > BZ_CUTOFF && size_a - size_b > BZ_CUTOFF)
+            z = bz_divrem(a, b, prem);
+        else
+            z = x_divrem(a, b, prem);
         if (z == NULL)
             return -1;
     }
@@ -2564,6 +2786,308 @@ x_divrem(PyLongObject *v1, PyLongObject *w1, PyLongObject **prem)
     return long_normalize(a);
 }
 
+/* Divide-and-conquer division, following Burnikel and Ziegler, "Fast
+   Recursive Division" (MPI-I-98-1-022, 1998).  Dividing 2n digits by n
+   digits is done by two divisions of 3n/2 by n digits, each of which does
+   one division of n by n/2 digits and one n/2 by n/2 digits multiplication.
+   With Karatsuba multiplication, the cost is O(n**1.58 log n) instead of
+   the O(n**2) of x_divrem().
+
+   All the values here are nonnegative, and the splits are done at digit
+   boundaries so that shifts are digit copies. */
+
+/* Return the digits lo <= i < hi of |a| as a new int. */
+static PyLongObject *
+bz_slice(PyLongObject *a, Py_ssize_t lo, Py_ssize_t hi)
+{
+    Py_ssize_t size_a = Py_ABS(Py_SIZE(a));
+    PyLongObject *z;
+
+    if (hi > size_a)
+        hi = size_a;
+    if (lo > hi)
+        lo = hi;
+    z = _PyLong_New(hi - lo);
+    if (z == NULL)
+        return NULL;
+    memcpy(z->ob_digit, a->ob_digit + lo, (hi - lo) * sizeof(digit));
+    return long_normalize(z);
+}
+
+/* Return |a| * PyLong_BASE**n + |b|, where |b| < PyLong_BASE**n.  b may
+   be NULL for 0. */
+static PyLongObject *
+bz_join(PyLongObject *a, PyLongObject *b, Py_ssize_t n)
+{
+    Py_ssize_t size_a = Py_ABS(Py_SIZE(a));
+    Py_ssize_t size_b = b == NULL ? 0 : Py_ABS(Py_SIZE(b));
+    PyLongObject *z;
+
+    assert(size_b <= n);
+    if (size_a == 0)
+        return bz_slice(b == NULL ? a : b, 0, size_b);
+    z = _PyLong_New(size_a + n);
+    if (z == NULL)
+        return NULL;
+    if (size_b)
+        memcpy(z->ob_digit, b->ob_digit, size_b * sizeof(digit));
+    memset(z->ob_digit + size_b, 0, (n - size_b) * sizeof(digit));
+    memcpy(z->ob_digit + n, a->ob_digit, size_a * sizeof(digit));
+    return z;
+}
+
+static int bz_div2n1n(PyLongObject *, PyLongObject *, Py_ssize_t,
+                      PyLongObject **, PyLongObject **);
+
+/* Divide a12 * PyLong_BASE**n + a3 by b = b1 * PyLong_BASE**n + b2, where
+   b1 has n normalized digits and the quotient is less than
+   PyLong_BASE**n. */
+static int
+bz_div3n2n(PyLongObject *a12, PyLongObject *a3, PyLongObject *b,
+           PyLongObject *b1, PyLongObject *b2, Py_ssize_t n,
+           PyLongObject **pq, PyLongObject **pr)
+{
+    PyLongObject *q = NULL, *r = NULL, *t = NULL, *u;
+    Py_ssize_t size_a12 = Py_ABS(Py_SIZE(a12));
+
+    if (size_a12 - n == Py_SIZE(b1) &&
+        memcmp(a12->ob_digit + n, b1->ob_digit,
+               Py_SIZE(b1) * sizeof(digit)) == 0) {
+        /* a12 // b1 would be PyLong_BASE**n: the quotient is
+           PyLong_BASE**n - 1 at most, with remainder
+           a12 - b1 * PyLong_BASE**n + b1. */
+        Py_ssize_t i;
+        q = _PyLong_New(n);
+        if (q == NULL)
+            goto error;
+        for (i = 0; i < n; i++)
+            q->ob_digit[i] = PyLong_MASK;
+        t = bz_join(b1, NULL, n);
+        if (t == NULL)
+            goto error;
+        r = (PyLongObject *)long_sub(a12, t);
+        Py_CLEAR(t);
+        if (r == NULL)
+            goto error;
+        u = r;
+        r = (PyLongObject *)long_add(u, b1);
+        Py_DECREF(u);
+        if (r == NULL)
+            goto error;
+    }
+    else if (bz_div2n1n(a12, b1, n, &q, &r) < 0)
+        goto error;
+
+    /* r * PyLong_BASE**n + a3 - q * b2 is the remainder of the estimate q,
+       which is at most 2 too large since b1 is normalized */
+    u = r;
+    r = bz_join(u, a3, n);
+    Py_DECREF(u);
+    if (r == NULL)
+        goto error;
+    t = k_mul(q, b2);
+    if (t == NULL)
+        goto error;
+    u = r;
+    r = (PyLongObject *)long_sub(u, t);
+    Py_DECREF(u);
+    Py_CLEAR(t);
+    if (r == NULL)
+        goto error;
+    while (Py_SIZE(r) < 0) {
+        u = r;
+        r = (PyLongObject *)long_add(u, b);
+        Py_DECREF(u);
+        if (r == NULL)
+            goto error;
+        t = (PyLongObject *)PyLong_FromLong(1);
+        if (t == NULL)
+            goto error;
+        u = q;
+        q = (PyLongObject *)long_sub(u, t);
+        Py_DECREF(u);
+        Py_CLEAR(t);
+        if (q == NULL)
+            goto error;
+    }
+    *pq = q;
+    *pr = r;
+    return 0;
+
+  error:
+    Py_XDECREF(q);
+    Py_XDECREF(r);
+    Py_XDECREF(t);
+    return -1;
+}
+
+/* Divide a by b, where b has n digits, its top digit is normalized as in
+   x_divrem(), and a < b * PyLong_BASE**n. */
+static int
+bz_div2n1n(PyLongObject *a, PyLongObject *b, Py_ssize_t n,
+           PyLongObject **pq, PyLongObject **pr)
+{
+    PyLongObject *b1 = NULL, *b2 = NULL, *a12 = NULL, *a3 = NULL;
+    PyLongObject *q1 = NULL, *q2 = NULL, *r = NULL, *t;
+    Py_ssize_t half;
+    int pad = n & 1;
+
+    if (n <= BZ_CUTOFF)
+        return long_divrem(a, b, pq, pr);
+
+    /* Make n even by shifting both a and b by a digit */
+    if (pad) {
+        a = bz_join(a, NULL, 1);
+        if (a == NULL)
+            return -1;
+        b = bz_join(b, NULL, 1);
+        if (b == NULL) {
+            Py_DECREF(a);
+            return -1;
+        }
+        n++;
+    }
+    half = n >> 1;
+    b1 = bz_slice(b, half, n);
+    b2 = bz_slice(b, 0, half);
+    a12 = bz_slice(a, n, PY_SSIZE_T_MAX);
+    a3 = bz_slice(a, half, n);
+    if (b1 == NULL || b2 == NULL || a12 == NULL || a3 == NULL)
+        goto error;
+    if (bz_div3n2n(a12, a3, b, b1, b2, half, &q1, &r) < 0)
+        goto error;
+    Py_DECREF(a3);
+    a3 = bz_slice(a, 0, half);
+    if (a3 == NULL)
+        goto error;
+    t = r;
+    r = NULL;
+    if (bz_div3n2n(t, a3, b, b1, b2, half, &q2, &r) < 0) {
+        Py_DECREF(t);
+        goto error;
+    }
+    Py_DECREF(t);
+    t = bz_join(q1, q2, half);
+    if (t == NULL)
+        goto error;
+    *pq = t;
+    if (pad) {
+        /* the remainder was shifted too */
+        t = bz_slice(r, 1, PY_SSIZE_T_MAX);
+        Py_DECREF(r);
+        r = t;
+        if (r == NULL) {
+            Py_CLEAR(*pq);
+            goto error;
+        }
+    }
+    *pr = r;
+    r = NULL;
+    Py_DECREF(b1);
+    Py_DECREF(b2);
+    Py_DECREF(a12);
+    Py_DECREF(a3);
+    Py_DECREF(q1);
+    Py_DECREF(q2);
+    if (pad) {
+        Py_DECREF(a);
+        Py_DECREF(b);
+    }
+    return 0;
+
+  error:
+    Py_XDECREF(b1);
+    Py_XDECREF(b2);
+    Py_XDECREF(a12);
+    Py_XDECREF(a3);
+    Py_XDECREF(q1);
+    Py_XDECREF(q2);
+    Py_XDECREF(r);
+    if (pad) {
+        Py_DECREF(a);
+        Py_DECREF(b);
+    }
+    return -1;
+}
+
+/* Unsigned int division with remainder by divide and conquer.  Like
+   x_divrem(), but the arguments should satisfy
+   BZ_CUTOFF < Py_ABS(Py_SIZE(w1)) <= Py_ABS(Py_SIZE(v1)). */
+
+static PyLongObject *
+bz_divrem(PyLongObject *v1, PyLongObject *w1, PyLongObject **prem)
+{
+    PyLongObject *v = NULL, *w = NULL, *a = NULL, *r = NULL, *q = NULL;
+    PyLongObject *chunk, *qi;
+    Py_ssize_t i, n, size_v, size_qi, chunks;
+    int d;
+    digit carry;
+
+    size_v = Py_ABS(Py_SIZE(v1));
+    n = Py_ABS(Py_SIZE(w1));
+    assert(size_v >= n && n > BZ_CUTOFF);
+
+    /* normalize w1 and v1 like x_divrem() */
+    d = PyLong_SHIFT - bits_in_digit(w1->ob_digit[n-1]);
+    w = _PyLong_New(n);
+    v = _PyLong_New(size_v + 1);
+    if (w == NULL || v == NULL)
+        goto error;
+    carry = v_lshift(w->ob_digit, w1->ob_digit, n, d);
+    assert(carry == 0);
+    v->ob_digit[size_v] = v_lshift(v->ob_digit, v1->ob_digit, size_v, d);
+    v = long_normalize(v);
+    size_v = Py_SIZE(v);
+
+    /* divide the n digit chunks of v from the top, each with the remainder
+       of the previous one, giving n digits of quotient each time */
+    chunks = (size_v + n - 1) / n;
+    q = _PyLong_New(chunks * n);
+    r = (PyLongObject *)PyLong_FromLong(0);
+    if (q == NULL || r == NULL)
+        goto error;
+    for (i = chunks; i-- > 0; ) {
+        chunk = bz_slice(v, i * n, (i + 1) * n);
+        if (chunk == NULL)
+            goto error;
+        a = bz_join(r, chunk, n);
+        Py_DECREF(chunk);
+        Py_CLEAR(r);
+        if (a == NULL)
+            goto error;
+        if (bz_div2n1n(a, w, n, &qi, &r) < 0)
+            goto error;
+        Py_CLEAR(a);
+        size_qi = Py_ABS(Py_SIZE(qi));
+        assert(size_qi <= n);
+        memcpy(q->ob_digit + i * n, qi->ob_digit, size_qi * sizeof(digit));
+        memset(q->ob_digit + i * n + size_qi, 0,
+               (n - size_qi) * sizeof(digit));
+        Py_DECREF(qi);
+    }
+
+    /* unshift remainder */
+    a = _PyLong_New(Py_SIZE(r));
+    if (a == NULL)
+        goto error;
+    carry = v_rshift(a->ob_digit, r->ob_digit, Py_SIZE(r), d);
+    assert(carry == 0);
+    Py_DECREF(r);
+    Py_DECREF(v);
+    Py_DECREF(w);
+    *prem = long_normalize(a);
+    return long_normalize(q);
+
+  error:
+    Py_XDECREF(v);
+    Py_XDECREF(w);
+    Py_XDECREF(a);
+    Py_XDECREF(r);
+    Py_XDECREF(q);
+    *prem = NULL;
+    return NULL;
+}
+
 /* For a nonzero PyLong a, express a in the form x * 2**e, with 0.5 <=
    abs(x) < 1.0 and e >= 0; return x and put e in *e.  Here x is
    rounded to DBL_MANT_DIG significant bits using round-half-to-even.
@@ -77,6 +77,47 @@ PyCFunction_GetFlags(PyObject *op)
     return PyCFunction_GET_FLAGS(op);
 }
 
+/* Call the METH_FASTCALL function meth with the args tuple and the kwds
+   dict (which may be NULL): the items of the tuple are used in place, but
+   the keyword arguments have to be copied after them. */
+static PyObject *
+fastcall_dict(PyCFunction meth, PyObject *self, PyObject *args,
+              PyObject *kwds)
+{
+    PyObject **stack, *kwnames, *key, *value, *res;
+    Py_ssize_t nargs, nkwargs, pos, i;
+
+    nargs = PyTuple_GET_SIZE(args);
+    nkwargs = (kwds == NULL) ? 0 : PyDict_Size(kwds);
+    if (nkwargs == 0)
+        return (*(_PyCFunctionFast)meth)(self, &PyTuple_GET_ITEM(args, 0),
+                                         nargs, NULL);
+
+    stack = PyMem_New(PyObject *, nargs + nkwargs);
+    if (stack == NULL)
+        return PyErr_NoMemory();
+    kwnames = PyTuple_New(nkwargs);
+    if (kwnames == NULL) {
+        PyMem_Free(stack);
+        return NULL;
+    }
+    for (i = 0; i < nargs; i++)
+        stack[i] = PyTuple_GET_ITEM(args, i);
+    /* The values are borrowed from kwds, which the caller keeps alive */
+    pos = i = 0;
+    while (PyDict_Next(kwds, &pos, &key, &value)) {
+        Py_INCREF(key);
+        PyTuple_SET_ITEM(kwnames, i, key);
+        stack[nargs + i] = value;
+        i++;
+    }
+
+    res = (*(_PyCFunctionFast)meth)(self, stack, nargs, kwnames);
+    Py_DECREF(kwnames);
+    PyMem_Free(stack);
+    return res;
+}
+
 PyObject *
 PyCFunction_Call(PyObject *func, PyObject *args, PyObject *kwds)
 {
@@ -97,6 +138,9 @@ PyCFunction_Call(PyObject *func, PyObject *args, PyObject *kwds)
     if (flags == (METH_VARARGS | METH_KEYWORDS)) {
         res = (*(PyCFunctionWithKeywords)meth)(self, args, kwds);
     }
+    else if (flags == METH_FASTCALL) {
+        res = fastcall_dict(meth, self, args, kwds);
+    }
     else {
         if (kwds != NULL && PyDict_Size(kwds) != 0) {
             PyErr_Format(PyExc_TypeError, "%.200s() takes no keyword arguments",
@@ -145,6 +189,141 @@ PyCFunction_Call(PyObject *func, PyObject *args, PyObject *kwds)
     return _Py_CheckFunctionResult(func, res, NULL);
 }
 
+static PyObject *
+stack_as_tuple(PyObject *const *stack, Py_ssize_t nargs)
+{
+    PyObject *args;
+    Py_ssize_t i;
+
+    args = PyTuple_New(nargs);
+    if (args == NULL)
+        return NULL;
+    for (i = 0; i < nargs; i++) {
+        PyObject *item = stack[i];
+        Py_INCREF(item);
+        PyTuple_SET_ITEM(args, i, item);
+    }
+    return args;
+}
+
+static PyObject *
+stack_as_dict(PyObject *const *values, PyObject *kwnames)
+{
+    PyObject *kwdict;
+    Py_ssize_t i, nkwargs;
+
+    nkwargs = PyTuple_GET_SIZE(kwnames);
+    kwdict = _PyDict_NewPresized(nkwargs);
+    if (kwdict == NULL)
+        return NULL;
+    for (i = 0; i < nkwargs; i++) {
+        if (PyDict_SetItem(kwdict, PyTuple_GET_ITEM(kwnames, i),
+                           values[i]) < 0) {
+            Py_DECREF(kwdict);
+            return NULL;
+        }
+    }
+    return kwdict;
+}
+
+PyObject *
+_PyMethodDef_RawFastCallKeywords(PyMethodDef *method, PyObject *self,
+                                 PyObject *const *args, Py_ssize_t nargs,
+                                 PyObject *kwnames)
+{
+    PyCFunction meth = method->ml_meth;
+    int flags;
+    Py_ssize_t nkwargs;
+    PyObject *argstuple, *kwdict, *res;
+
+    /* _PyMethodDef_RawFastCallKeywords() must not be called with an
+       exception set, for the same reason as PyCFunction_Call() */
+    assert(!PyErr_Occurred());
+    assert(nargs >= 0);
+    assert(nargs == 0 || args != NULL);
+    assert(kwnames == NULL || PyTuple_CheckExact(kwnames));
+
+    flags = method->ml_flags & ~(METH_CLASS | METH_STATIC | METH_COEXIST);
+    nkwargs = (kwnames == NULL) ? 0 : PyTuple_GET_SIZE(kwnames);
+
+    switch (flags) {
+    case METH_FASTCALL:
+        return (*(_PyCFunctionFast)meth)(self, args, nargs, kwnames);
+
+    case METH_VARARGS | METH_KEYWORDS:
+        argstuple = stack_as_tuple(args, nargs);
+        if (argstuple == NULL)
+            return NULL;
+        kwdict = NULL;
+        if (nkwargs) {
+            kwdict = stack_as_dict(args + nargs, kwnames);
+            if (kwdict == NULL) {
+                Py_DECREF(argstuple);
+                return NULL;
+            }
+        }
+        res = (*(PyCFunctionWithKeywords)meth)(self, argstuple, kwdict);
+        Py_DECREF(argstuple);
+        Py_XDECREF(kwdict);
+        return res;
+    }
+
+    if (nkwargs) {
+        PyErr_Format(PyExc_TypeError, "%.200s() takes no keyword arguments",
+                     method->ml_name);
+        return NULL;
+    }
+
+    switch (flags) {
+    case METH_NOARGS:
+        if (nargs != 0) {
+            PyErr_Format(PyExc_TypeError,
+                "%.200s() takes no arguments (%zd given)",
+                method->ml_name, nargs);
+            return NULL;
+        }
+        return (*meth)(self, NULL);
+
+    case METH_O:
+        if (nargs != 1) {
+            PyErr_Format(PyExc_TypeError,
+                "%.200s() takes exactly one argument (%zd given)",
+                method->ml_name, nargs);
+            return NULL;
+        }
+        return (*meth)(self, args[0]);
+
+    case METH_VARARGS:
+        argstuple = stack_as_tuple(args, nargs);
+        if (argstuple == NULL)
+            return NULL;
+        res = (*meth)(self, argstuple);
+        Py_DECREF(argstuple);
+        return res;
+
+    default:
+        PyErr_SetString(PyExc_SystemError,
+                        "Bad call flags in "
+                        "_PyMethodDef_RawFastCallKeywords. "
+                        "METH_OLDARGS is no longer supported!");
+        return NULL;
+    }
+}
+
+PyObject *
+_PyCFunction_FastCallKeywords(PyObject *func, PyObject *const *args,
+                              Py_ssize_t nargs, PyObject *kwnames)
+{
+    PyObject *res;
+
+    assert(PyCFunction_Check(func));
+
+    res = _PyMethodDef_RawFastCallKeywords(((PyCFunctionObject *)func)->m_ml,
+                                           PyCFunction_GET_SELF(func),
+                                           args, nargs, kwnames);
+    return _Py_CheckFunctionResult(func, res, NULL);
+}
+
 /* Methods (the standard built-in methods, that is) */
 
 static void
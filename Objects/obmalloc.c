@@ -1596,11 +1596,19 @@ _PyObject_Free(void *ctx, void *p)
          * This mimics LRU pool usage for new allocations and
          * targets optimal filling when several pools contain
          * blocks of the same size class.
+         *
+         * If the pool lives in a mostly empty arena, link it to the
+         * back instead, so that pools of fuller arenas are filled
+         * first.  Like the sorting of usable_arenas, this lets the
+         * nearly empty arenas drain and be returned to the system.
          */
         --pool->ref.count;
         assert(pool->ref.count > 0);            /* else the pool is empty */
         size = pool->szidx;
         next = usedpools[size + size];
+        if (arenas[pool->arenaindex].nfreepools >
+                arenas[pool->arenaindex].ntotalpools / 2)
+            next = next->prevpool;      /* the list header */
         prev = next->prevpool;
         /* insert pool before next:   prev <-> pool <-> next */
         pool->nextpool = next;
@@ -2160,45 +2168,29 @@ _PyDebugAllocatorStats(FILE *out,
 
 #ifdef WITH_PYMALLOC
 
-/* Print summary info to "out" about the state of pymalloc's structures.
- * In Py_DEBUG mode, also perform some expensive internal consistency
- * checks.
+#define NUMCLASSES (SMALL_REQUEST_THRESHOLD >> ALIGNMENT_SHIFT)
+
+#if NUMCLASSES > _PyObject_MALLOC_MAX_CLASSES
+#error "_PyObject_MALLOC_MAX_CLASSES is too small"
+#endif
+
+/* Walk all the arenas and fill in *stats.  This doesn't allocate memory,
+ * so the counters are a consistent snapshot.
  */
 void
-_PyObject_DebugMallocStats(FILE *out)
+_PyObject_GetMallocStats(_PyObject_MallocStats *stats)
 {
     uint i;
-    const uint numclasses = SMALL_REQUEST_THRESHOLD >> ALIGNMENT_SHIFT;
-    /* # of pools, allocated blocks, and free blocks per class index */
-    size_t numpools[SMALL_REQUEST_THRESHOLD >> ALIGNMENT_SHIFT];
-    size_t numblocks[SMALL_REQUEST_THRESHOLD >> ALIGNMENT_SHIFT];
-    size_t numfreeblocks[SMALL_REQUEST_THRESHOLD >> ALIGNMENT_SHIFT];
-    /* total # of allocated bytes in used and full pools */
-    size_t allocated_bytes = 0;
-    /* total # of available bytes in used pools */
-    size_t available_bytes = 0;
-    /* # of free pools + pools not yet carved out of current arena */
-    uint numfreepools = 0;
-    /* # of bytes for arena alignment padding */
-    size_t arena_alignment = 0;
-    /* # of bytes in used and full pools used for pool_headers */
-    size_t pool_header_bytes = 0;
-    /* # of bytes in used and full pools wasted due to quantization,
-     * i.e. the necessarily leftover space at the ends of used and
-     * full pools.
-     */
-    size_t quantization = 0;
-    /* # of arenas actually allocated. */
-    size_t narenas = 0;
-    /* running total -- should equal narenas * ARENA_SIZE */
-    size_t total;
-    char buf[128];
+    /* index + 1 of the last arena counted in classes[].arenas */
+    uint lastarena[NUMCLASSES];
 
-    fprintf(out, "Small block threshold = %d, in %u size classes.\n",
-            SMALL_REQUEST_THRESHOLD, numclasses);
-
-    for (i = 0; i < numclasses; ++i)
-        numpools[i] = numblocks[i] = numfreeblocks[i] = 0;
+    memset(stats, 0, sizeof(*stats));
+    memset(lastarena, 0, sizeof(lastarena));
+    stats->nclasses = NUMCLASSES;
+    for (i = 0; i < NUMCLASSES; ++i)
+        stats->classes[i].size = INDEX2SIZE(i);
+    stats->narenas_total = ntimes_arena_allocated;
+    stats->narenas_highwater = narenas_highwater;
 
     /* Because full pools aren't linked to from anything, it's easiest
      * to march over all the arenas.  If we're lucky, most of the memory
@@ -2211,13 +2203,13 @@ _PyObject_DebugMallocStats(FILE *out)
         /* Skip arenas which are not allocated. */
         if (arenas[i].address == (uptr)NULL)
             continue;
-        narenas += 1;
+        stats->narenas += 1;
 
-        numfreepools += arenas[i].nfreepools;
+        stats->nfreepools += arenas[i].nfreepools;
 
         /* round up to pool alignment */
         if (base & (uptr)POOL_SIZE_MASK) {
-            arena_alignment += POOL_SIZE;
+            stats->arena_alignment += POOL_SIZE;
             base &= ~(uptr)POOL_SIZE_MASK;
             base += POOL_SIZE;
         }
@@ -2236,17 +2228,54 @@ _PyObject_DebugMallocStats(FILE *out)
                 assert(pool_is_in_list(p, arenas[i].freepools));
                 continue;
             }
-            ++numpools[sz];
-            numblocks[sz] += p->ref.count;
+            ++stats->classes[sz].pools;
+            stats->classes[sz].blocks_used += p->ref.count;
             freeblocks = NUMBLOCKS(sz) - p->ref.count;
-            numfreeblocks[sz] += freeblocks;
+            stats->classes[sz].blocks_free += freeblocks;
+            if (lastarena[sz] != i + 1) {
+                lastarena[sz] = i + 1;
+                ++stats->classes[sz].arenas;
+            }
 #ifdef Py_DEBUG
             if (freeblocks > 0)
                 assert(pool_is_in_list(p, usedpools[sz + sz]));
 #endif
         }
     }
-    assert(narenas == narenas_currently_allocated);
+    assert(stats->narenas == narenas_currently_allocated);
+}
+
+/* Print summary info to "out" about the state of pymalloc's structures.
+ * In Py_DEBUG mode, also perform some expensive internal consistency
+ * checks.
+ */
+void
+_PyObject_DebugMallocStats(FILE *out)
+{
+    uint i;
+    const uint numclasses = NUMCLASSES;
+    _PyObject_MallocStats stats;
+    /* total # of allocated bytes in used and full pools */
+    size_t allocated_bytes = 0;
+    /* total # of available bytes in used pools */
+    size_t available_bytes = 0;
+    /* # of bytes in used and full pools used for pool_headers */
+    size_t pool_header_bytes = 0;
+    /* # of bytes in used and full pools wasted due to quantization,
+     * i.e. the necessarily leftover space at the ends of used and
+     * full pools.
+     */
+    size_t quantization = 0;
+    size_t narenas;
+    /* running total -- should equal narenas * ARENA_SIZE */
+    size_t total;
+    char buf[128];
+
+    fprintf(out, "Small block threshold = %d, in %u size classes.\n",
+            SMALL_REQUEST_THRESHOLD, numclasses);
+
+    _PyObject_GetMallocStats(&stats);
+    narenas = stats.narenas;
 
     fputc('\n', out);
     fputs("class   size   num pools   blocks in use  avail blocks\n"
@@ -2254,9 +2283,9 @@ _PyObject_DebugMallocStats(FILE *out)
           out);
 
     for (i = 0; i < numclasses; ++i) {
-        size_t p = numpools[i];
-        size_t b = numblocks[i];
-        size_t f = numfreeblocks[i];
+        size_t p = stats.classes[i].pools;
+        size_t b = stats.classes[i].blocks_used;
+        size_t f = stats.classes[i].blocks_free;
         uint size = INDEX2SIZE(i);
         if (p == 0) {
             assert(b == 0 && f == 0);
@@ -2292,12 +2321,14 @@ _PyObject_DebugMallocStats(FILE *out)
     total += printone(out, "# bytes in available blocks", available_bytes);
 
     PyOS_snprintf(buf, sizeof(buf),
-        "%u unused pools * %d bytes", numfreepools, POOL_SIZE);
-    total += printone(out, buf, (size_t)numfreepools * POOL_SIZE);
+        "%" PY_FORMAT_SIZE_T "u unused pools * %d bytes",
+        stats.nfreepools, POOL_SIZE);
+    total += printone(out, buf, stats.nfreepools * POOL_SIZE);
 
     total += printone(out, "# bytes lost to pool headers", pool_header_bytes);
     total += printone(out, "# bytes lost to quantization", quantization);
-    total += printone(out, "# bytes lost to arena alignment", arena_alignment);
+    total += printone(out, "# bytes lost to arena alignment",
+                      stats.arena_alignment);
     (void)printone(out, "Total", total);
 }
 
@@ -39,19 +39,21 @@ we've considered:
    __getitem__(), get(), etc. accordingly.
 
 The approach with the least performance impact (time and space) is #2,
-mirroring the key order of dict's dk_enties with an array of node pointers.
-While lookdict() and friends (dk_lookup) don't give us the index into the
-array, we make use of pointer arithmetic to get that index.  An alternative
-would be to refactor lookdict() to provide the index, explicitly exposing
-the implementation detail.  We could even just use a custom lookup function
-for OrderedDict that facilitates our need.  However, both approaches are
-significantly more complicated than just using pointer arithmetic.
-
-The catch with mirroring the hash table ordering is that we have to keep
-the ordering in sync through any dict resizes.  However, that order only
+mirroring the key order of dict's dk_entries with an array of node pointers.
+lookdict() and friends (dk_lookup) return the index of the entry in that
+array, which we use directly.
+
+The catch with mirroring the entry ordering is that we have to keep
+the ordering in sync through any dict resizes.  A resize compacts the
+entries, so it may move them even when the table size stays the same;
+we detect it by watching the keys object itself.  However, that order only
 matters during node lookup.  We can simply defer any potential resizing
 until we need to do a lookup.
 
+Now that dict itself preserves insertion order, the linked list could in
+principle go away.  It is kept because move_to_end(last=False) needs to
+prepend, which the dense entry array cannot do in O(1).
+
 Linked-List Nodes
 -----------------
 
@@ -488,6 +490,8 @@ struct _odictobject {
     _ODictNode *od_last;
     /* od_size is the number of entries in od_fast_nodes. */
     Py_ssize_t od_size;  /* managed by _odict_resize() */
+    /* od_resize_sentinel is the keys object od_fast_nodes mirrors. */
+    PyDictKeysObject *od_resize_sentinel;  /* managed by _odict_resize() */
     /* od_fast_nodes is a hash table that mirrors the dict table. */
     _ODictNode **od_fast_nodes;  /* managed by _odict_resize() */
     /* od_inst_dict is OrderedDict().__dict__. */
@@ -536,9 +540,11 @@ static int
 _odict_resize(PyODictObject *od) {
     Py_ssize_t size, prev_size, i;
     _ODictNode **fast_nodes, *node;
+    PyDictKeysObject *keys, *prev_keys;
 
     /* Initialize a new "fast nodes" table. */
-    size = ((PyDictObject *)od)->ma_keys->dk_size;
+    keys = ((PyDictObject *)od)->ma_keys;
+    size = keys->dk_size;
     fast_nodes = PyMem_NEW(_ODictNode *, size);
     if (fast_nodes == NULL) {
         PyErr_NoMemory();
@@ -549,18 +555,23 @@ _odict_resize(PyODictObject *od) {
 
     /* Copy the current nodes into the table. */
     prev_size = od->od_size;
+    prev_keys = od->od_resize_sentinel;
     od->od_size = size;
+    od->od_resize_sentinel = keys;
     _odict_FOREACH(od, node) {
         assert(node != NULL);
         i = _odict_get_index(od, _odictnode_KEY(node));
         if (i < 0) {
             od->od_size = prev_size;
+            od->od_resize_sentinel = prev_keys;
             PyMem_FREE(fast_nodes);
+            if (!PyErr_Occurred())
+                PyErr_SetObject(PyExc_KeyError, _odictnode_KEY(node));
             return -1;
         }
         fast_nodes[i] = node;
     }
-    if (size != ((PyDictObject *)od)->ma_keys->dk_size) {
+    if (keys != ((PyDictObject *)od)->ma_keys) {
         /* If _odict_get_index triggered a resize then we are already done. */
         PyMem_FREE(fast_nodes);
         return 0;
@@ -578,13 +589,14 @@ _odict_get_index(PyODictObject *od, PyObject *key)
 {
     Py_hash_t hash;
     PyObject **value_addr = NULL;
-    PyDictKeyEntry *ep;
+    Py_ssize_t ix;
     PyDictKeysObject *keys = ((PyDictObject *)od)->ma_keys;
 
     assert(key != NULL);
     do {
         /* Ensure od_fast_nodes and dk_entries are in sync. */
-        if (keys->dk_size != od->od_size) {
+        if (od->od_resize_sentinel != keys ||
+            keys->dk_size != od->od_size) {
             int resize_res = _odict_resize(od);
             if (resize_res < 0)
                 return -1;
@@ -596,13 +608,14 @@ _odict_get_index(PyODictObject *od, PyObject *key)
             return -1;
         /* May have resized during the PyObject_Hash() call. */
         keys = ((PyDictObject *)od)->ma_keys;
-    } while (keys->dk_size != od->od_size);
+    } while (od->od_resize_sentinel != keys ||
+             keys->dk_size != od->od_size);
 
-    ep = (keys->dk_lookup)((PyDictObject *)od, key, hash, &value_addr);
-    if (ep == NULL)
+    ix = (keys->dk_lookup)((PyDictObject *)od, key, hash, &value_addr, NULL);
+    /* A missing key gives -1 without an exception set. */
+    if (ix < 0)
         return -1;
-    /* We use pointer arithmetic to get the entry's index into the table. */
-    return ep - keys->dk_entries;
+    return ix;
 }
 
 static int
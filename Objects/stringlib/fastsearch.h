@@ -6,6 +6,14 @@
    moore and horspool, with a few more bells and whistles on the top.
    for some more background, see: http://effbot.org/zone/stringlib.htm */
 
+/* forward searches first look for the first character of the needle
+   with memchr(), which the C library implements with vector instructions
+   picked for the running CPU, and only fall back to the boyer-moore-
+   horspool loop when the candidates are too frequent.  when the number of
+   compared characters shows that the search is going quadratic, the rest
+   of the haystack is handed over to the two-way algorithm, which runs in
+   linear time. */
+
 /* note: fastsearch may access s[n], which isn't a problem when using
    Python's ordinary string types, but may cause problems if you're
    using this code in other contexts.  also, the count mode returns -1
@@ -80,6 +88,136 @@ STRINGLIB(fastsearch_memchr_1char)(const STRINGLIB_CHAR* s, Py_ssize_t n,
 #undef DO_MEMCHR
 }
 
+/* two-way string matching (crochemore and perrin, 1991).  the needle is
+   split as p[:cut] + p[cut:] at a critical factorization: the right part
+   is compared from left to right, the left part from right to left, and
+   the needle is shifted past a mismatch in the right part, or by its
+   period after a mismatch in the left part.  no character of the haystack
+   is compared more than twice.  the last character of each window is
+   first looked up in a compressed boyer-moore delta 1 table, so that the
+   common case still skips most of the haystack. */
+
+#define STRINGLIB_SHIFT_TABLE_SIZE 64
+#define STRINGLIB_MAX_SHIFT 255
+
+Py_LOCAL_INLINE(Py_ssize_t)
+STRINGLIB(two_way_max_suffix)(const STRINGLIB_CHAR* p, Py_ssize_t m,
+                              int reverse, Py_ssize_t *period)
+{
+    /* return i such that p[i+1:] is the largest suffix of p, for the
+       order of the characters or its reverse, and store the period of
+       that suffix in *period */
+    Py_ssize_t max_suffix = -1, j = 0, k = 1, per = 1;
+
+    while (j + k < m) {
+        STRINGLIB_CHAR a = p[j + k];
+        STRINGLIB_CHAR b = p[max_suffix + k];
+        if (reverse ? a > b : a < b) {
+            /* smaller suffix: the period is the whole prefix so far */
+            j += k;
+            k = 1;
+            per = j - max_suffix;
+        }
+        else if (a == b) {
+            /* advance through the repetition of the current period */
+            if (k != per)
+                k++;
+            else {
+                j += per;
+                k = 1;
+            }
+        }
+        else {
+            /* larger suffix: start over from here */
+            max_suffix = j++;
+            k = per = 1;
+        }
+    }
+    *period = per;
+    return max_suffix;
+}
+
+static Py_ssize_t
+STRINGLIB(two_way_search)(const STRINGLIB_CHAR* s, Py_ssize_t n,
+                          const STRINGLIB_CHAR* p, Py_ssize_t m,
+                          Py_ssize_t maxcount, int mode)
+{
+    unsigned char table[STRINGLIB_SHIFT_TABLE_SIZE];
+    Py_ssize_t cut, period, suffix_rev, period_rev;
+    Py_ssize_t i, j, shift, memory, count = 0;
+    int periodic;
+
+    /* critical factorization: the later of the two maximal suffixes */
+    cut = STRINGLIB(two_way_max_suffix)(p, m, 0, &period);
+    suffix_rev = STRINGLIB(two_way_max_suffix)(p, m, 1, &period_rev);
+    if (cut < suffix_rev) {
+        cut = suffix_rev;
+        period = period_rev;
+    }
+    cut++;
+
+    /* if p[:cut] repeats in p[period:], the needle has period "period",
+       and the matched periods are remembered across shifts; otherwise no
+       alignment closer than the largest part can match */
+    periodic = (memcmp(p, p + period, cut * sizeof(STRINGLIB_CHAR)) == 0);
+    if (!periodic)
+        period = Py_MAX(cut, m - cut) + 1;
+
+    /* shifts are computed modulo the table size, so colliding characters
+       keep the smallest one */
+    shift = Py_MIN(m, STRINGLIB_MAX_SHIFT);
+    memset(table, (int)shift, sizeof(table));
+    for (i = m - shift; i < m; i++)
+        table[p[i] & (STRINGLIB_SHIFT_TABLE_SIZE - 1)] =
+            (unsigned char)(m - 1 - i);
+
+    j = 0;
+    memory = 0;
+    while (j <= n - m) {
+        shift = table[s[j + m - 1] & (STRINGLIB_SHIFT_TABLE_SIZE - 1)];
+        if (shift > 0) {
+            /* the last character does not match */
+            if (memory && shift < period)
+                shift = m - period;
+            memory = 0;
+            j += shift;
+            continue;
+        }
+        /* scan the right part */
+        i = Py_MAX(cut, memory);
+        while (i < m && p[i] == s[j + i])
+            i++;
+        if (i < m) {
+            j += i - cut + 1;
+            memory = 0;
+            continue;
+        }
+        /* scan the left part, down to what the last shift remembers */
+        i = cut - 1;
+        while (i >= memory && p[i] == s[j + i])
+            i--;
+        if (i < memory) {
+            /* got a match! */
+            if (mode != FAST_COUNT)
+                return j;
+            count++;
+            if (count == maxcount)
+                return maxcount;
+            j += m;
+            memory = 0;
+        }
+        else {
+            j += period;
+            if (periodic)
+                memory = m - period;
+        }
+    }
+
+    if (mode != FAST_COUNT)
+        return -1;
+    return count;
+}
+
 Py_LOCAL_INLINE(Py_ssize_t)
 FASTSEARCH(const STRINGLIB_CHAR* s, Py_ssize_t n,
            const STRINGLIB_CHAR* p, Py_ssize_t m,
@@ -144,6 +282,8 @@ FASTSEARCH(const STRINGLIB_CHAR* s, Py_ssize_t n,
     if (mode != FAST_RSEARCH) {
         const STRINGLIB_CHAR *ss = s + m - 1;
         const STRINGLIB_CHAR *pp = p + m - 1;
+        /* number of characters compared so far */
+        Py_ssize_t hits = 0;
 
         /* create compressed boyer-moore delta 1 table */
 
@@ -156,7 +296,47 @@ FASTSEARCH(const STRINGLIB_CHAR* s, Py_ssize_t n,
         /* process pattern[-1] outside the loop */
         STRINGLIB_BLOOM_ADD(mask, p[mlast]);
 
-        for (i = 0; i <= w; i++) {
+        i = 0;
+#if STRINGLIB_SIZEOF_CHAR > 1
+        /* same false positives issue as for 1-character strings */
+        if (n > 10 && (p[0] & 0xff) != 0) {
+#else
+        if (n > 10) {
+#endif
+            /* look for the first character with memchr() */
+            unsigned char needle = p[0] & 0xff;
+            const STRINGLIB_CHAR *ptr = s;
+            const STRINGLIB_CHAR *e = s + w + 1;
+            while (ptr < e) {
+                void *candidate = memchr((const void *) ptr, needle, (e - ptr) * sizeof(STRINGLIB_CHAR));
+                if (candidate == NULL)
+                    return (mode == FAST_COUNT) ? count : -1;
+                ptr = (const STRINGLIB_CHAR *) _Py_ALIGN_DOWN(candidate, sizeof(STRINGLIB_CHAR));
+                for (j = 0; j < m; j++)
+                    if (ptr[j] != p[j])
+                        break;
+                if (j == m) {
+                    /* got a match! */
+                    if (mode != FAST_COUNT)
+                        return (ptr - s);
+                    count++;
+                    if (count == maxcount)
+                        return maxcount;
+                    ptr += m;
+                }
+                else
+                    ptr++;
+                /* a memchr() call costs about as much as comparing 8
+                   characters: give up once the candidates cost more than
+                   a quarter of the scanned characters */
+                hits += j + 8;
+                if (hits > ((ptr - s) >> 2) + 4 * m)
+                    break;
+            }
+            i = ptr - s;
+        }
+
+        for (; i <= w; i++) {
             /* note: using mlast in the skip path slows things down on x86 */
             if (ss[i] == pp[0]) {
                 /* candidate match */
@@ -173,6 +353,16 @@ FASTSEARCH(const STRINGLIB_CHAR* s, Py_ssize_t n,
                     i = i + mlast;
                     continue;
                 }
+                hits += j + 1;
+                if (hits > 2 * i + 4 * m) {
+                    /* going quadratic: switch to two-way for the rest */
+                    i++;
+                    j = STRINGLIB(two_way_search)(s + i, n - i, p, m,
+                                                  maxcount - count, mode);
+                    if (mode == FAST_COUNT)
+                        return count + j;
+                    return (j == -1) ? -1 : i + j;
+                }
                 /* miss: check if next character is part of pattern */
                 if (!STRINGLIB_BLOOM(mask, ss[i+1]))
                     i = i + m;
@@ -722,6 +722,11 @@ resize_compact(PyObject *unicode, Py_ssize_t length)
     }
     new_size = (struct_size + (length + 1) * char_size);
 
+    if (_PyUnicode_HAS_UTF8_MEMORY(unicode)) {
+        PyObject_DEL(_PyUnicode_UTF8(unicode));
+        _PyUnicode_UTF8(unicode) = NULL;
+        _PyUnicode_UTF8_LENGTH(unicode) = 0;
+    }
     _Py_DEC_REFTOTAL;
     _Py_ForgetReference(unicode);
 
@@ -4669,6 +4674,124 @@ ascii_decode(const char *start, const char *end, Py_UCS1 *dest)
     return p - start;
 }
 
+/* Count the characters of UTF-8 data, that is the bytes which are not
+   continuation bytes, reading a C 'long' at a time.  For valid data, it is
+   the length of the decoded string. */
+static Py_ssize_t
+utf8_count_chars(const char *start, const char *end)
+{
+    const unsigned char *p = (const unsigned char *) start;
+    const unsigned char *e = (const unsigned char *) end;
+    const unsigned char *aligned_end =
+        (const unsigned char *) _Py_ALIGN_DOWN(end, SIZEOF_LONG);
+    /* the low byte of each pair of bytes */
+    const unsigned long low_bytes = ~0UL / 0x101;
+    /* the low bit of each pair of bytes */
+    const unsigned long pair_ones = ~0UL / 0xFFFF;
+    unsigned long cont;
+    Py_ssize_t continuations = 0;
+
+/* Count the continuation bytes (10xxxxxx) of value in the low bit of each
+   byte of cont */
+#define COUNT_CONTINUATIONS(value, mask) \
+    (cont += ((value) & (mask) & ~((value) << 1)) >> 7)
+
+    cont = 0;
+    while (p < e && !_Py_IS_ALIGNED(p, SIZEOF_LONG)) {
+        unsigned long value = *p++;
+        COUNT_CONTINUATIONS(value, 0x80);
+    }
+    continuations += cont;
+
+    /* Skip ASCII quickly */
+    while (aligned_end - p >= 4 * SIZEOF_LONG) {
+        const unsigned long *w = (const unsigned long *) p;
+        if ((w[0] | w[1] | w[2] | w[3]) & ASCII_CHAR_MASK)
+            break;
+        p += 4 * SIZEOF_LONG;
+    }
+
+    while (p < aligned_end) {
+        /* Sum up the counts before a byte of cont overflows */
+        const unsigned char *block_end =
+            p + Py_MIN(aligned_end - p, 255 * SIZEOF_LONG);
+        cont = 0;
+        for (; p < block_end; p += SIZEOF_LONG) {
+            unsigned long value = *(const unsigned long *) p;
+            COUNT_CONTINUATIONS(value, ASCII_CHAR_MASK);
+        }
+        /* The bytes of cont add up to 8 * 255 at most: add them pairwise
+           into 16-bit counts, then sum these in the top 16 bits */
+        cont = (cont & low_bytes) + ((cont >> 8) & low_bytes);
+        continuations += (Py_ssize_t) ((cont * pair_ones)
+                                       >> (8 * SIZEOF_LONG - 16));
+    }
+
+    cont = 0;
+    while (p < e) {
+        unsigned long value = *p++;
+        COUNT_CONTINUATIONS(value, 0x80);
+    }
+    continuations += cont;
+#undef COUNT_CONTINUATIONS
+
+    return (end - start) - continuations;
+}
+
+/* Return the start of an incomplete sequence ending UTF-8 data, that is a
+   start byte followed by fewer continuation bytes than it announces, or
+   end if there is none. */
+static const char *
+utf8_incomplete_end(const char *start, const char *end)
+{
+    const char *p = end;
+
+    while (p > start && end - p < 3) {
+        unsigned char ch = (unsigned char) *--p;
+        if (ch < 0x80)
+            break;
+        if (ch >= 0xC0) {
+            Py_ssize_t seqlen = (ch < 0xE0) ? 2 : (ch < 0xF0) ? 3 : 4;
+            return (end - p < seqlen) ? p : end;
+        }
+    }
+    return end;
+}
+
+/* Keep a copy of the valid UTF-8 data in the strings decoded from it */
+static int unicode_utf8_cache = 0;
+
+void
+_PyUnicode_SetUTF8Cache(int enabled)
+{
+    unicode_utf8_cache = enabled;
+}
+
+int
+_PyUnicode_GetUTF8Cache(void)
+{
+    return unicode_utf8_cache;
+}
+
+/* Store a copy of s[0:size], the UTF-8 encoding of unicode, as its UTF-8
+   representation.  Steal the reference to unicode. */
+static PyObject *
+unicode_keep_utf8(PyObject *unicode, const char *s, Py_ssize_t size)
+{
+    /* ASCII strings are their own UTF-8 representation */
+    if (unicode == NULL || PyUnicode_UTF8(unicode) != NULL)
+        return unicode;
+    _PyUnicode_UTF8(unicode) = PyObject_MALLOC(size + 1);
+    if (_PyUnicode_UTF8(unicode) == NULL) {
+        Py_DECREF(unicode);
+        return PyErr_NoMemory();
+    }
+    _PyUnicode_UTF8_LENGTH(unicode) = size;
+    Py_MEMCPY(_PyUnicode_UTF8(unicode), s, size);
+    _PyUnicode_UTF8(unicode)[size] = '\0';
+    return unicode;
+}
+
 PyObject *
 PyUnicode_DecodeUTF8Stateful(const char *s,
                              Py_ssize_t size,
@@ -4705,6 +4828,25 @@ PyUnicode_DecodeUTF8Stateful(const char *s,
 
     writer.pos = ascii_decode(s, end, writer.data);
     s += writer.pos;
+    if (end - s >= 65536) {
+        /* For large data, count the characters left, to decode valid data
+           into a string of the right length, instead of one character per
+           byte.  Smaller data, like the 8 KiB chunks decoded by
+           TextIOWrapper (see Tools/iobench/textread.py), gets an oversized
+           buffer which costs less than the count. */
+        Py_ssize_t length = writer.pos +
+            utf8_count_chars(s, utf8_incomplete_end(s, end));
+        /* length is 0 if the data is only made of continuation bytes */
+        length = Py_MAX(length, 1);
+        if (length < writer.size) {
+            PyObject *buffer = resize_compact(writer.buffer, length);
+            if (buffer == NULL)
+                goto onError;
+            writer.buffer = buffer;
+            writer.size = length;
+            writer.data = PyUnicode_DATA(buffer);
+        }
+    }
     while (s < end) {
         Py_UCS4 ch;
         int kind = writer.kind;
@@ -4746,6 +4888,11 @@ PyUnicode_DecodeUTF8Stateful(const char *s,
             continue;
         }
 
+        /* The string was sized for valid data: make room for one
+           character per remaining byte */
+        if (_PyUnicodeWriter_Prepare(&writer, end - s, 127) == -1)
+            goto onError;
+
         if (unicode_decode_call_errorhandler_writer(
                 errors, &errorHandler,
                 "utf-8", errmsg,
@@ -4759,6 +4906,11 @@ End:
         *consumed = s - starts;
 
     Py_XDECREF(errorHandler);
+    if (exc == NULL && unicode_utf8_cache) {
+        /* No error: the data is the UTF-8 encoding of the string */
+        return unicode_keep_utf8(_PyUnicodeWriter_Finish(&writer),
+                                 starts, s - starts);
+    }
     Py_XDECREF(exc);
     return _PyUnicodeWriter_Finish(&writer);
 
@@ -15013,7 +15165,8 @@ PyUnicode_InternInPlace(PyObject **p)
     PyThreadState_GET()->recursion_critical = 0;
     /* The two references in interned are not counted by refcnt.
        The deallocator will take care of this */
-    Py_REFCNT(s) -= 2;
+    if (!_Py_IsImmortal(s))
+        Py_REFCNT(s) -= 2;
     _PyUnicode_STATE(s).interned = SSTATE_INTERNED_MORTAL;
 }
 
@@ -14,21 +14,24 @@ PyDoc_STRVAR(winsound_PlaySound__doc__,
 "    Flag values, ored together.  See module documentation.");
 
 #define WINSOUND_PLAYSOUND_METHODDEF    \
-    {"PlaySound", (PyCFunction)winsound_PlaySound, METH_VARARGS, winsound_PlaySound__doc__},
+    {"PlaySound", (PyCFunction)winsound_PlaySound, METH_FASTCALL, winsound_PlaySound__doc__},
 
 static PyObject *
 winsound_PlaySound_impl(PyModuleDef *module, Py_UNICODE *sound, int flags);
 
 static PyObject *
-winsound_PlaySound(PyModuleDef *module, PyObject *args)
+winsound_PlaySound(PyModuleDef *module, PyObject *const *args, Py_ssize_t nargs, PyObject *kwnames)
 {
     PyObject *return_value = NULL;
     Py_UNICODE *sound;
     int flags;
 
-    if (!PyArg_ParseTuple(args, "Zi:PlaySound",
+    if (!_PyArg_ParseStack(args, nargs, "Zi:PlaySound",
         &sound, &flags))
         goto exit;
+
+    if (!_PyArg_NoStackKeywords("PlaySound", kwnames))
+        goto exit;
     return_value = winsound_PlaySound_impl(module, sound, flags);
 
 exit:
@@ -48,21 +51,24 @@ PyDoc_STRVAR(winsound_Beep__doc__,
 "    How long the sound should play, in milliseconds.");
 
 #define WINSOUND_BEEP_METHODDEF    \
-    {"Beep", (PyCFunction)winsound_Beep, METH_VARARGS, winsound_Beep__doc__},
+    {"Beep", (PyCFunction)winsound_Beep, METH_FASTCALL, winsound_Beep__doc__},
 
 static PyObject *
 winsound_Beep_impl(PyModuleDef *module, int frequency, int duration);
 
 static PyObject *
-winsound_Beep(PyModuleDef *module, PyObject *args)
+winsound_Beep(PyModuleDef *module, PyObject *const *args, Py_ssize_t nargs, PyObject *kwnames)
 {
     PyObject *return_value = NULL;
     int frequency;
     int duration;
 
-    if (!PyArg_ParseTuple(args, "ii:Beep",
+    if (!_PyArg_ParseStack(args, nargs, "ii:Beep",
         &frequency, &duration))
         goto exit;
+
+    if (!_PyArg_NoStackKeywords("Beep", kwnames))
+        goto exit;
     return_value = winsound_Beep_impl(module, frequency, duration);
 
 exit:
@@ -78,23 +84,26 @@ PyDoc_STRVAR(winsound_MessageBeep__doc__,
 "x defaults to MB_OK.");
 
 #define WINSOUND_MESSAGEBEEP_METHODDEF    \
-    {"MessageBeep", (PyCFunction)winsound_MessageBeep, METH_VARARGS, winsound_MessageBeep__doc__},
+    {"MessageBeep", (PyCFunction)winsound_MessageBeep, METH_FASTCALL, winsound_MessageBeep__doc__},
 
 static PyObject *
 winsound_MessageBeep_impl(PyModuleDef *module, int x);
 
 static PyObject *
-winsound_MessageBeep(PyModuleDef *module, PyObject *args)
+winsound_MessageBeep(PyModuleDef *module, PyObject *const *args, Py_ssize_t nargs, PyObject *kwnames)
 {
     PyObject *return_value = NULL;
     int x = MB_OK;
 
-    if (!PyArg_ParseTuple(args, "|i:MessageBeep",
+    if (!_PyArg_ParseStack(args, nargs, "|i:MessageBeep",
         &x))
         goto exit;
+
+    if (!_PyArg_NoStackKeywords("MessageBeep", kwnames))
+        goto exit;
     return_value = winsound_MessageBeep_impl(module, x);
 
 exit:
     return return_value;
 }
-/*[clinic end generated code: output=c5b018ac9dc1f500 input=a9049054013a1b77]*/
+/*[clinic end generated code: output=24d384a53d2fd5f0 input=a9049054013a1b77]*/
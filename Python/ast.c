@@ -131,6 +131,40 @@ validate_arguments(arguments_ty args)
     return validate_exprs(args->defaults, Load, 0) && validate_exprs(args->kw_defaults, Load, 1);
 }
 
+static int
+validate_constant(PyObject *value)
+{
+    if (value == Py_None || value == Py_Ellipsis)
+        return 1;
+
+    if (PyLong_CheckExact(value)
+            || PyFloat_CheckExact(value)
+            || PyComplex_CheckExact(value)
+            || PyBool_Check(value)
+            || PyUnicode_CheckExact(value)
+            || PyBytes_CheckExact(value))
+        return 1;
+
+    if (PyTuple_CheckExact(value) || PyFrozenSet_CheckExact(value)) {
+        PyObject *it, *item;
+        int valid = 1;
+
+        it = PyObject_GetIter(value);
+        if (it == NULL)
+            return -1;
+        while (valid && (item = PyIter_Next(it)) != NULL) {
+            valid = validate_constant(item);
+            Py_DECREF(item);
+        }
+        Py_DECREF(it);
+        if (PyErr_Occurred())
+            return -1;
+        return valid;
+    }
+
+    return 0;
+}
+
 static int
 validate_expr(expr_ty exp, expr_context_ty ctx)
 {
@@ -263,6 +297,14 @@ validate_expr(expr_ty exp, expr_context_ty ctx)
         }
         return 1;
     }
+    case Constant_kind: {
+        int valid = validate_constant(exp->v.Constant.value);
+        if (valid == 0)
+            PyErr_Format(PyExc_TypeError,
+                         "got an invalid type in Constant: %.200s",
+                         Py_TYPE(exp->v.Constant.value)->tp_name);
+        return valid == 1;
+    }
     case Attribute_kind:
         return validate_expr(exp->v.Attribute.value, Load);
     case Subscript_kind:
@@ -984,6 +1026,7 @@ set_context(struct compiling *c, expr_ty e, expr_context_ty ctx, const node *n)
         case Num_kind:
         case Str_kind:
         case Bytes_kind:
+        case Constant_kind:
             expr_name = "literal";
             break;
         case NameConstant_kind:
@@ -0,0 +1,921 @@
+/* AST Optimizer
+
+   Runs on the AST of a module between the parser and the compiler (and, with
+   the PyCF_OPTIMIZED_AST flag of compile(), before the AST is handed back to
+   Python code).  It replaces operations on constants by Constant nodes and
+   removes the statements that can never run.
+
+   Folding:
+
+   - unary and binary operators and subscripts whose operands are constants,
+     as long as the result is not too large (see MAX_INT_SIZE and
+     MAX_SEQ_SIZE): 2 * 3 ** 4, -(1, 2)[1], "abc" + "def";
+   - tuples whose items are constants, nested ones included;
+   - lists and sets of constants used by an "in" test or as the iterable of
+     a for loop or a comprehension, which become tuples and frozensets;
+   - __debug__, which is always True or False for a given optimization
+     level.
+
+   Unreachable code:
+
+   - the branch of an if statement or an if expression, the body of a while
+     loop and the else clause of a while loop that a constant test never
+     selects;
+   - conditions of comprehensions that are always true;
+   - statements following a return, raise, break or continue statement in
+     the same block, or following a live branch which ends with one.
+
+   Removing code must not change the meaning of the code that remains: a
+   function with a yield in a dead branch is still a generator, and a name
+   assigned in a dead branch is still local to its function.  So code is
+   only removed if it binds no names, declares none global or nonlocal,
+   contains no yield and does not use super() or __class__.  The compiler
+   does not generate code for the dead branches the optimizer has to keep
+   anyway.
+
+   The symbol table is built from the optimized AST, so a name only used in
+   removed code is not a free variable of the function any more: after
+   "if 0: return x", x is not in co_freevars, nor a cell of the enclosing
+   function.
+*/
+#include "Python.h"
+#include "Python-ast.h"
+
+/* Folded ints are limited to that many bits, and folded str, bytes and
+   tuples to that many items, to keep code objects small and the compiler
+   fast in the presence of code like 2 ** 10000000 or (None,) * 10000. */
+#define MAX_INT_SIZE 128
+#define MAX_SEQ_SIZE 20
+
+typedef struct {
+    int optimize;       /* optimization level, which gives __debug__ */
+    Py_ssize_t unsafe;  /* number of constructs seen that forbid removing
+                           the code around them, see above */
+    int has_live;       /* set by an if or while statement which can be
+                           replaced by the statements in live */
+    asdl_seq *live;
+} optimizer;
+
+/* Return the value of e if it is a constant, or NULL (without an exception
+   set) if it is not. */
+static PyObject *
+get_const_value(expr_ty e)
+{
+    switch (e->kind) {
+    case Constant_kind:
+        return e->v.Constant.value;
+    case Num_kind:
+        return e->v.Num.n;
+    case Str_kind:
+        return e->v.Str.s;
+    case Bytes_kind:
+        return e->v.Bytes.s;
+    case NameConstant_kind:
+        return e->v.NameConstant.value;
+    case Ellipsis_kind:
+        return Py_Ellipsis;
+    default:
+        return NULL;
+    }
+}
+
+/* Return the truth value of e if it is a constant, or -1. */
+static int
+const_truth(expr_ty e)
+{
+    PyObject *v = get_const_value(e);
+    int r;
+
+    if (v == NULL)
+        return -1;
+    r = PyObject_IsTrue(v);
+    if (r < 0)
+        PyErr_Clear();
+    return r;
+}
+
+/* Turn node into a Constant node holding val, stealing the reference.  If
+   val is NULL, because it is too large or computing it raised an exception
+   that the expression raises at run time, leave node alone.  Return 0 on
+   other errors, like MemoryError or exceeding the recursion limit. */
+static int
+make_const(expr_ty node, PyObject *val, PyArena *arena)
+{
+    if (val == NULL) {
+        if (PyErr_Occurred()) {
+            if (!PyErr_ExceptionMatches(PyExc_ArithmeticError) &&
+                !PyErr_ExceptionMatches(PyExc_TypeError) &&
+                !PyErr_ExceptionMatches(PyExc_ValueError) &&
+                !PyErr_ExceptionMatches(PyExc_LookupError) &&
+                !PyErr_ExceptionMatches(PyExc_Warning))
+                return 0;
+            PyErr_Clear();
+        }
+        return 1;
+    }
+    if (PyArena_AddPyObject(arena, val) < 0) {
+        Py_DECREF(val);
+        return 0;
+    }
+    node->kind = Constant_kind;
+    node->v.Constant.value = val;
+    return 1;
+}
+
+static int
+is_sequence(PyObject *v)
+{
+    return PyUnicode_Check(v) || PyBytes_Check(v) || PyTuple_Check(v);
+}
+
+/* Drop v (returning NULL without an exception) if it is a sequence too long
+   to be folded. */
+static PyObject *
+check_size(PyObject *v)
+{
+    if (v != NULL && is_sequence(v) && PyObject_Size(v) > MAX_SEQ_SIZE) {
+        Py_DECREF(v);
+        return NULL;
+    }
+    return v;
+}
+
+static PyObject *
+safe_multiply(PyObject *v, PyObject *w)
+{
+    if (PyLong_Check(v) && PyLong_Check(w) &&
+        Py_SIZE(v) != 0 && Py_SIZE(w) != 0) {
+        size_t vbits = _PyLong_NumBits(v);
+        size_t wbits = _PyLong_NumBits(w);
+        if (vbits == (size_t)-1 || wbits == (size_t)-1)
+            return NULL;
+        if (vbits + wbits > MAX_INT_SIZE)
+            return NULL;
+    }
+    else if (PyLong_Check(v) && is_sequence(w)) {
+        Py_ssize_t size = PyObject_Size(w);
+        Py_ssize_t n = PyLong_AsSsize_t(v);
+        if (size < 0 || (n == -1 && PyErr_Occurred()))
+            return NULL;
+        if (size != 0 && n > MAX_SEQ_SIZE / size)
+            return NULL;
+    }
+    else if (PyLong_Check(w) && is_sequence(v)) {
+        return safe_multiply(w, v);
+    }
+    return PyNumber_Multiply(v, w);
+}
+
+static PyObject *
+safe_power(PyObject *v, PyObject *w)
+{
+    if (PyLong_Check(v) && PyLong_Check(w) &&
+        Py_SIZE(v) != 0 && Py_SIZE(w) > 0) {
+        size_t vbits = _PyLong_NumBits(v);
+        size_t wval = PyLong_AsSize_t(w);
+        if (vbits == (size_t)-1 || wval == (size_t)-1)
+            return NULL;
+        if (vbits > MAX_INT_SIZE / wval)
+            return NULL;
+    }
+    return PyNumber_Power(v, w, Py_None);
+}
+
+static PyObject *
+safe_lshift(PyObject *v, PyObject *w)
+{
+    if (PyLong_Check(v) && PyLong_Check(w) &&
+        Py_SIZE(v) != 0 && Py_SIZE(w) != 0) {
+        size_t vbits = _PyLong_NumBits(v);
+        size_t wval = PyLong_AsSize_t(w);
+        if (vbits == (size_t)-1 || wval == (size_t)-1)
+            return NULL;
+        if (wval > MAX_INT_SIZE || vbits > MAX_INT_SIZE - wval)
+            return NULL;
+    }
+    return PyNumber_Lshift(v, w);
+}
+
+static PyObject *
+safe_mod(PyObject *v, PyObject *w)
+{
+    /* Formatting may build a string of any size: "%*s" % (10**9, "") */
+    if (PyUnicode_Check(v) || PyBytes_Check(v))
+        return NULL;
+    return PyNumber_Remainder(v, w);
+}
+
+static int
+fold_unaryop(expr_ty node, PyArena *arena, optimizer *state)
+{
+    PyObject *arg = get_const_value(node->v.UnaryOp.operand);
+    PyObject *newval;
+    int r;
+
+    if (arg == NULL)
+        return 1;
+    switch (node->v.UnaryOp.op) {
+    case Invert:
+        newval = PyNumber_Invert(arg);
+        break;
+    case Not:
+        r = PyObject_Not(arg);
+        newval = r < 0 ? NULL : PyBool_FromLong(r);
+        break;
+    case UAdd:
+        newval = PyNumber_Positive(arg);
+        break;
+    case USub:
+        newval = PyNumber_Negative(arg);
+        break;
+    default:
+        return 1;
+    }
+    return make_const(node, newval, arena);
+}
+
+static int
+fold_binop(expr_ty node, PyArena *arena, optimizer *state)
+{
+    PyObject *lv = get_const_value(node->v.BinOp.left);
+    PyObject *rv = get_const_value(node->v.BinOp.right);
+    PyObject *newval;
+
+    if (lv == NULL || rv == NULL)
+        return 1;
+    switch (node->v.BinOp.op) {
+    case Add:
+        newval = PyNumber_Add(lv, rv);
+        break;
+    case Sub:
+        newval = PyNumber_Subtract(lv, rv);
+        break;
+    case Mult:
+        newval = safe_multiply(lv, rv);
+        break;
+    case Div:
+        newval = PyNumber_TrueDivide(lv, rv);
+        break;
+    case FloorDiv:
+        newval = PyNumber_FloorDivide(lv, rv);
+        break;
+    case Mod:
+        newval = safe_mod(lv, rv);
+        break;
+    case Pow:
+        newval = safe_power(lv, rv);
+        break;
+    case LShift:
+        newval = safe_lshift(lv, rv);
+        break;
+    case RShift:
+        newval = PyNumber_Rshift(lv, rv);
+        break;
+    case BitOr:
+        newval = PyNumber_Or(lv, rv);
+        break;
+    case BitXor:
+        newval = PyNumber_Xor(lv, rv);
+        break;
+    case BitAnd:
+        newval = PyNumber_And(lv, rv);
+        break;
+    default:
+        /* MatMult: no constant implements it */
+        return 1;
+    }
+    return make_const(node, check_size(newval), arena);
+}
+
+/* Build a tuple of the values of elts, or return NULL (without an exception
+   set) if they are not all constants. */
+static PyObject *
+make_const_tuple(asdl_seq *elts)
+{
+    PyObject *newval, *v;
+    int i;
+
+    for (i = 0; i < asdl_seq_LEN(elts); i++) {
+        if (get_const_value((expr_ty)asdl_seq_GET(elts, i)) == NULL)
+            return NULL;
+    }
+    newval = PyTuple_New(asdl_seq_LEN(elts));
+    if (newval == NULL)
+        return NULL;
+    for (i = 0; i < asdl_seq_LEN(elts); i++) {
+        v = get_const_value((expr_ty)asdl_seq_GET(elts, i));
+        Py_INCREF(v);
+        PyTuple_SET_ITEM(newval, i, v);
+    }
+    return newval;
+}
+
+static int
+fold_tuple(expr_ty node, PyArena *arena, optimizer *state)
+{
+    if (node->v.Tuple.ctx != Load)
+        return 1;
+    return make_const(node, make_const_tuple(node->v.Tuple.elts), arena);
+}
+
+static int
+fold_subscr(expr_ty node, PyArena *arena, optimizer *state)
+{
+    PyObject *v, *w;
+    slice_ty slice = node->v.Subscript.slice;
+
+    if (node->v.Subscript.ctx != Load || slice->kind != Index_kind)
+        return 1;
+    v = get_const_value(node->v.Subscript.value);
+    w = get_const_value(slice->v.Index.value);
+    if (v == NULL || w == NULL)
+        return 1;
+    return make_const(node, check_size(PyObject_GetItem(v, w)), arena);
+}
+
+/* Change a list or set of constants, which is only iterated over or
+   searched, into a tuple or a frozenset. */
+static int
+fold_iter(expr_ty arg, PyArena *arena, optimizer *state)
+{
+    PyObject *newval;
+
+    if (arg->kind == List_kind) {
+        return make_const(arg, make_const_tuple(arg->v.List.elts), arena);
+    }
+    else if (arg->kind == Set_kind) {
+        PyObject *tuple = make_const_tuple(arg->v.Set.elts);
+        if (tuple == NULL)
+            return make_const(arg, NULL, arena);
+        newval = PyFrozenSet_New(tuple);
+        Py_DECREF(tuple);
+        return make_const(arg, newval, arena);
+    }
+    return 1;
+}
+
+static int
+fold_compare(expr_ty node, PyArena *arena, optimizer *state)
+{
+    asdl_int_seq *ops = node->v.Compare.ops;
+    asdl_seq *args = node->v.Compare.comparators;
+    int i = asdl_seq_LEN(ops) - 1;
+    int op = asdl_seq_GET(ops, i);
+
+    /* Only the last comparator: in "a in [b] == c", [b] is also compared
+       with c. */
+    if (op == In || op == NotIn)
+        return fold_iter((expr_ty)asdl_seq_GET(args, i), arena, state);
+    return 1;
+}
+
+
+static int astfold_body(asdl_seq **pstmts, PyArena *arena, optimizer *state);
+static int astfold_stmt(stmt_ty node, PyArena *arena, optimizer *state);
+static int astfold_expr(expr_ty node, PyArena *arena, optimizer *state);
+static int astfold_arguments(arguments_ty node, PyArena *arena,
+                             optimizer *state);
+static int astfold_comprehension(comprehension_ty node, PyArena *arena,
+                                 optimizer *state);
+static int astfold_keyword(keyword_ty node, PyArena *arena,
+                           optimizer *state);
+static int astfold_slice(slice_ty node, PyArena *arena, optimizer *state);
+static int astfold_arg(arg_ty node, PyArena *arena, optimizer *state);
+static int astfold_withitem(withitem_ty node, PyArena *arena,
+                            optimizer *state);
+static int astfold_excepthandler(excepthandler_ty node, PyArena *arena,
+                                 optimizer *state);
+
+#define CALL(FUNC, ARG) \
+    if (!FUNC((ARG), arena, state)) \
+        return 0;
+
+#define CALL_OPT(FUNC, ARG) \
+    if ((ARG) != NULL && !FUNC((ARG), arena, state)) \
+        return 0;
+
+#define CALL_SEQ(FUNC, TYPE, ARG) { \
+    int i; \
+    asdl_seq *seq = (ARG); /* avoid variable capture */ \
+    for (i = 0; i < asdl_seq_LEN(seq); i++) { \
+        TYPE elt = (TYPE)asdl_seq_GET(seq, i); \
+        if (elt != NULL && !FUNC(elt, arena, state)) \
+            return 0; \
+    } \
+}
+
+/* Fold a block of statements, and set SAFE to whether it can be removed */
+#define CALL_BODY(ARG, SAFE) { \
+    Py_ssize_t unsafe = state->unsafe; \
+    if (!astfold_body(&(ARG), arena, state)) \
+        return 0; \
+    (SAFE) = state->unsafe == unsafe; \
+}
+
+static int
+astfold_mod(mod_ty node, PyArena *arena, optimizer *state)
+{
+    switch (node->kind) {
+    case Module_kind:
+        return astfold_body(&node->v.Module.body, arena, state);
+    case Interactive_kind:
+        return astfold_body(&node->v.Interactive.body, arena, state);
+    case Expression_kind:
+        return astfold_expr(node->v.Expression.body, arena, state);
+    case Suite_kind:
+        return astfold_body(&node->v.Suite.body, arena, state);
+    default:
+        return 1;
+    }
+}
+
+static int
+is_docstring(stmt_ty s)
+{
+    return s->kind == Expr_kind && s->v.Expr.value->kind == Str_kind;
+}
+
+static int
+is_jump(stmt_ty s)
+{
+    return (s->kind == Return_kind || s->kind == Raise_kind ||
+            s->kind == Break_kind || s->kind == Continue_kind);
+}
+
+/* Fold a block of statements, splicing into it the live branch of the if
+   and while statements with a constant test, and removing the statements
+   that follow a jump, including a jump which ends a spliced branch. */
+static int
+astfold_body(asdl_seq **pstmts, PyArena *arena, optimizer *state)
+{
+    asdl_seq *stmts = *pstmts, *newstmts, *live;
+    asdl_seq **branches;
+    stmt_ty st, last;
+    Py_ssize_t len = asdl_seq_LEN(stmts), end = len, newlen = 0, unsafe;
+    Py_ssize_t i, j, k;
+    int changed = 0, pad;
+
+    if (len == 0)
+        return 1;
+    /* branches[i] is the live branch of stmts[i] (which may be empty), or
+       stmts itself if stmts[i] stays. */
+    branches = PyMem_New(asdl_seq *, len);
+    if (branches == NULL) {
+        PyErr_NoMemory();
+        return 0;
+    }
+    for (i = 0; i < len; i++) {
+        st = (stmt_ty)asdl_seq_GET(stmts, i);
+        state->has_live = 0;
+        if (!astfold_stmt(st, arena, state))
+            goto error;
+        last = st;
+        if (state->has_live) {
+            branches[i] = state->live;
+            newlen += asdl_seq_LEN(state->live);
+            changed = 1;
+            /* The live branch is already folded: a jump can only be its
+               last statement */
+            last = asdl_seq_LEN(state->live) == 0 ? NULL :
+                (stmt_ty)asdl_seq_GET(state->live,
+                                      asdl_seq_LEN(state->live) - 1);
+        }
+        else {
+            branches[i] = stmts;
+            newlen++;
+        }
+        if (last != NULL && is_jump(last) && i + 1 < len) {
+            /* The rest of the block is unreachable */
+            unsafe = state->unsafe;
+            for (k = i + 1; k < len; k++) {
+                if (!astfold_stmt((stmt_ty)asdl_seq_GET(stmts, k),
+                                  arena, state))
+                    goto error;
+                branches[k] = stmts;
+            }
+            if (state->unsafe == unsafe) {
+                end = i + 1;
+                changed = 1;
+            }
+            else {
+                newlen += len - i - 1;
+            }
+            break;
+        }
+    }
+    state->has_live = 0;
+
+    if (changed) {
+        /* Do not leave the block empty, nor turn a string into its
+           docstring. */
+        st = (stmt_ty)asdl_seq_GET(stmts, 0);
+        pad = newlen == 0;
+        if (!pad && !is_docstring(st) && branches[0] != stmts) {
+            for (i = 0; i < end; i++) {
+                if (branches[i] == stmts) {
+                    pad = is_docstring((stmt_ty)asdl_seq_GET(stmts, i));
+                    break;
+                }
+                if (asdl_seq_LEN(branches[i]) > 0) {
+                    pad = is_docstring((stmt_ty)asdl_seq_GET(branches[i], 0));
+                    break;
+                }
+            }
+        }
+        newstmts = _Py_asdl_seq_new(newlen + pad, arena);
+        if (newstmts == NULL)
+            goto error;
+        k = 0;
+        if (pad) {
+            stmt_ty pass = Pass(st->lineno, st->col_offset, arena);
+            if (pass == NULL)
+                goto error;
+            asdl_seq_SET(newstmts, k++, pass);
+        }
+        for (i = 0; i < end; i++) {
+            live = branches[i];
+            if (live == stmts) {
+                asdl_seq_SET(newstmts, k++, asdl_seq_GET(stmts, i));
+                continue;
+            }
+            for (j = 0; j < asdl_seq_LEN(live); j++)
+                asdl_seq_SET(newstmts, k++, asdl_seq_GET(live, j));
+        }
+        assert(k == asdl_seq_LEN(newstmts));
+        *pstmts = newstmts;
+    }
+    PyMem_Free(branches);
+    return 1;
+
+error:
+    PyMem_Free(branches);
+    return 0;
+}
+
+static int
+astfold_stmt(stmt_ty node, PyArena *arena, optimizer *state)
+{
+    int body_safe, orelse_safe, truth;
+
+    switch (node->kind) {
+    case FunctionDef_kind:
+        CALL(astfold_arguments, node->v.FunctionDef.args);
+        CALL(astfold_body, &node->v.FunctionDef.body);
+        CALL_SEQ(astfold_expr, expr_ty, node->v.FunctionDef.decorator_list);
+        CALL_OPT(astfold_expr, node->v.FunctionDef.returns);
+        state->unsafe++;
+        break;
+    case AsyncFunctionDef_kind:
+        CALL(astfold_arguments, node->v.AsyncFunctionDef.args);
+        CALL(astfold_body, &node->v.AsyncFunctionDef.body);
+        CALL_SEQ(astfold_expr, expr_ty,
+                 node->v.AsyncFunctionDef.decorator_list);
+        CALL_OPT(astfold_expr, node->v.AsyncFunctionDef.returns);
+        state->unsafe++;
+        break;
+    case ClassDef_kind:
+        CALL_SEQ(astfold_expr, expr_ty, node->v.ClassDef.bases);
+        CALL_SEQ(astfold_keyword, keyword_ty, node->v.ClassDef.keywords);
+        CALL(astfold_body, &node->v.ClassDef.body);
+        CALL_SEQ(astfold_expr, expr_ty, node->v.ClassDef.decorator_list);
+        state->unsafe++;
+        break;
+    case Return_kind:
+        CALL_OPT(astfold_expr, node->v.Return.value);
+        break;
+    case Delete_kind:
+        CALL_SEQ(astfold_expr, expr_ty, node->v.Delete.targets);
+        break;
+    case Assign_kind:
+        CALL_SEQ(astfold_expr, expr_ty, node->v.Assign.targets);
+        CALL(astfold_expr, node->v.Assign.value);
+        break;
+    case AugAssign_kind:
+        CALL(astfold_expr, node->v.AugAssign.target);
+        CALL(astfold_expr, node->v.AugAssign.value);
+        break;
+    case For_kind:
+        CALL(astfold_expr, node->v.For.target);
+        CALL(astfold_expr, node->v.For.iter);
+        CALL(fold_iter, node->v.For.iter);
+        CALL(astfold_body, &node->v.For.body);
+        CALL(astfold_body, &node->v.For.orelse);
+        break;
+    case AsyncFor_kind:
+        CALL(astfold_expr, node->v.AsyncFor.target);
+        CALL(astfold_expr, node->v.AsyncFor.iter);
+        CALL(astfold_body, &node->v.AsyncFor.body);
+        CALL(astfold_body, &node->v.AsyncFor.orelse);
+        break;
+    case While_kind:
+        CALL(astfold_expr, node->v.While.test);
+        CALL_BODY(node->v.While.body, body_safe);
+        CALL_BODY(node->v.While.orelse, orelse_safe);
+        state->has_live = 0;
+        truth = const_truth(node->v.While.test);
+        if (truth == 0 && body_safe) {
+            state->live = node->v.While.orelse;
+            state->has_live = 1;
+        }
+        else if (truth == 1 && orelse_safe) {
+            /* The else clause of an endless loop never runs */
+            node->v.While.orelse = NULL;
+        }
+        return 1;
+    case If_kind:
+        CALL(astfold_expr, node->v.If.test);
+        CALL_BODY(node->v.If.body, body_safe);
+        CALL_BODY(node->v.If.orelse, orelse_safe);
+        state->has_live = 0;
+        truth = const_truth(node->v.If.test);
+        if ((truth == 1 && orelse_safe) || (truth == 0 && body_safe)) {
+            state->live = truth ? node->v.If.body : node->v.If.orelse;
+            state->has_live = 1;
+        }
+        return 1;
+    case With_kind:
+        CALL_SEQ(astfold_withitem, withitem_ty, node->v.With.items);
+        CALL(astfold_body, &node->v.With.body);
+        break;
+    case AsyncWith_kind:
+        CALL_SEQ(astfold_withitem, withitem_ty, node->v.AsyncWith.items);
+        CALL(astfold_body, &node->v.AsyncWith.body);
+        break;
+    case Raise_kind:
+        CALL_OPT(astfold_expr, node->v.Raise.exc);
+        CALL_OPT(astfold_expr, node->v.Raise.cause);
+        break;
+    case Try_kind:
+        CALL(astfold_body, &node->v.Try.body);
+        CALL_SEQ(astfold_excepthandler, excepthandler_ty,
+                 node->v.Try.handlers);
+        CALL(astfold_body, &node->v.Try.orelse);
+        CALL(astfold_body, &node->v.Try.finalbody);
+        break;
+    case Assert_kind:
+        CALL(astfold_expr, node->v.Assert.test);
+        CALL_OPT(astfold_expr, node->v.Assert.msg);
+        break;
+    case Import_kind:
+    case ImportFrom_kind:
+    case Global_kind:
+    case Nonlocal_kind:
+        state->unsafe++;
+        break;
+    case Expr_kind:
+        CALL(astfold_expr, node->v.Expr.value);
+        break;
+    default:
+        break;
+    }
+    state->has_live = 0;
+    return 1;
+}
+
+static int
+astfold_expr(expr_ty node, PyArena *arena, optimizer *state)
+{
+    Py_ssize_t unsafe;
+    int body_safe, orelse_safe, truth;
+
+    switch (node->kind) {
+    case BoolOp_kind:
+        CALL_SEQ(astfold_expr, expr_ty, node->v.BoolOp.values);
+        break;
+    case BinOp_kind:
+        CALL(astfold_expr, node->v.BinOp.left);
+        CALL(astfold_expr, node->v.BinOp.right);
+        CALL(fold_binop, node);
+        break;
+    case UnaryOp_kind:
+        CALL(astfold_expr, node->v.UnaryOp.operand);
+        CALL(fold_unaryop, node);
+        break;
+    case Lambda_kind:
+        CALL(astfold_arguments, node->v.Lambda.args);
+        CALL(astfold_expr, node->v.Lambda.body);
+        break;
+    case IfExp_kind:
+        CALL(astfold_expr, node->v.IfExp.test);
+        unsafe = state->unsafe;
+        CALL(astfold_expr, node->v.IfExp.body);
+        body_safe = state->unsafe == unsafe;
+        unsafe = state->unsafe;
+        CALL(astfold_expr, node->v.IfExp.orelse);
+        orelse_safe = state->unsafe == unsafe;
+        truth = const_truth(node->v.IfExp.test);
+        if (truth == 1 && orelse_safe)
+            *node = *node->v.IfExp.body;
+        else if (truth == 0 && body_safe)
+            *node = *node->v.IfExp.orelse;
+        break;
+    case Dict_kind:
+        CALL_SEQ(astfold_expr, expr_ty, node->v.Dict.keys);
+        CALL_SEQ(astfold_expr, expr_ty, node->v.Dict.values);
+        break;
+    case Set_kind:
+        CALL_SEQ(astfold_expr, expr_ty, node->v.Set.elts);
+        break;
+    case ListComp_kind:
+        CALL(astfold_expr, node->v.ListComp.elt);
+        CALL_SEQ(astfold_comprehension, comprehension_ty,
+                 node->v.ListComp.generators);
+        break;
+    case SetComp_kind:
+        CALL(astfold_expr, node->v.SetComp.elt);
+        CALL_SEQ(astfold_comprehension, comprehension_ty,
+                 node->v.SetComp.generators);
+        break;
+    case DictComp_kind:
+        CALL(astfold_expr, node->v.DictComp.key);
+        CALL(astfold_expr, node->v.DictComp.value);
+        CALL_SEQ(astfold_comprehension, comprehension_ty,
+                 node->v.DictComp.generators);
+        break;
+    case GeneratorExp_kind:
+        CALL(astfold_expr, node->v.GeneratorExp.elt);
+        CALL_SEQ(astfold_comprehension, comprehension_ty,
+                 node->v.GeneratorExp.generators);
+        break;
+    case Await_kind:
+        CALL(astfold_expr, node->v.Await.value);
+        break;
+    case Yield_kind:
+        CALL_OPT(astfold_expr, node->v.Yield.value);
+        state->unsafe++;
+        break;
+    case YieldFrom_kind:
+        CALL(astfold_expr, node->v.YieldFrom.value);
+        state->unsafe++;
+        break;
+    case Compare_kind:
+        CALL(astfold_expr, node->v.Compare.left);
+        CALL_SEQ(astfold_expr, expr_ty, node->v.Compare.comparators);
+        CALL(fold_compare, node);
+        break;
+    case Call_kind:
+        CALL(astfold_expr, node->v.Call.func);
+        CALL_SEQ(astfold_expr, expr_ty, node->v.Call.args);
+        CALL_SEQ(astfold_keyword, keyword_ty, node->v.Call.keywords);
+        break;
+    case Attribute_kind:
+        CALL(astfold_expr, node->v.Attribute.value);
+        break;
+    case Subscript_kind:
+        CALL(astfold_expr, node->v.Subscript.value);
+        CALL(astfold_slice, node->v.Subscript.slice);
+        CALL(fold_subscr, node);
+        break;
+    case Starred_kind:
+        CALL(astfold_expr, node->v.Starred.value);
+        break;
+    case Name_kind:
+        if (node->v.Name.ctx != Load) {
+            state->unsafe++;
+        }
+        else if (PyUnicode_CompareWithASCIIString(node->v.Name.id,
+                                                  "__debug__") == 0) {
+            return make_const(node, PyBool_FromLong(!state->optimize),
+                              arena);
+        }
+        else if (PyUnicode_CompareWithASCIIString(node->v.Name.id,
+                                                  "super") == 0 ||
+                 PyUnicode_CompareWithASCIIString(node->v.Name.id,
+                                                  "__class__") == 0) {
+            /* Makes the compiler create the __class__ cell */
+            state->unsafe++;
+        }
+        break;
+    case List_kind:
+        CALL_SEQ(astfold_expr, expr_ty, node->v.List.elts);
+        break;
+    case Tuple_kind:
+        CALL_SEQ(astfold_expr, expr_ty, node->v.Tuple.elts);
+        CALL(fold_tuple, node);
+        break;
+    default:
+        break;
+    }
+    return 1;
+}
+
+static int
+astfold_slice(slice_ty node, PyArena *arena, optimizer *state)
+{
+    switch (node->kind) {
+    case Slice_kind:
+        CALL_OPT(astfold_expr, node->v.Slice.lower);
+        CALL_OPT(astfold_expr, node->v.Slice.upper);
+        CALL_OPT(astfold_expr, node->v.Slice.step);
+        break;
+    case ExtSlice_kind:
+        CALL_SEQ(astfold_slice, slice_ty, node->v.ExtSlice.dims);
+        break;
+    case Index_kind:
+        CALL(astfold_expr, node->v.Index.value);
+        break;
+    default:
+        break;
+    }
+    return 1;
+}
+
+static int
+astfold_keyword(keyword_ty node, PyArena *arena, optimizer *state)
+{
+    CALL(astfold_expr, node->value);
+    return 1;
+}
+
+static int
+astfold_comprehension(comprehension_ty node, PyArena *arena,
+                      optimizer *state)
+{
+    asdl_seq *ifs;
+    Py_ssize_t i, k, n;
+
+    CALL(astfold_expr, node->target);
+    CALL(astfold_expr, node->iter);
+    CALL(fold_iter, node->iter);
+    CALL_SEQ(astfold_expr, expr_ty, node->ifs);
+
+    /* Drop the conditions which always hold */
+    n = 0;
+    for (i = 0; i < asdl_seq_LEN(node->ifs); i++) {
+        if (const_truth((expr_ty)asdl_seq_GET(node->ifs, i)) != 1)
+            n++;
+    }
+    if (n == asdl_seq_LEN(node->ifs))
+        return 1;
+    ifs = _Py_asdl_seq_new(n, arena);
+    if (ifs == NULL)
+        return 0;
+    for (i = 0, k = 0; i < asdl_seq_LEN(node->ifs); i++) {
+        expr_ty e = (expr_ty)asdl_seq_GET(node->ifs, i);
+        if (const_truth(e) != 1)
+            asdl_seq_SET(ifs, k++, e);
+    }
+    node->ifs = ifs;
+    return 1;
+}
+
+static int
+astfold_arguments(arguments_ty node, PyArena *arena, optimizer *state)
+{
+    CALL_SEQ(astfold_arg, arg_ty, node->args);
+    CALL_OPT(astfold_arg, node->vararg);
+    CALL_SEQ(astfold_arg, arg_ty, node->kwonlyargs);
+    CALL_SEQ(astfold_expr, expr_ty, node->kw_defaults);
+    CALL_OPT(astfold_arg, node->kwarg);
+    CALL_SEQ(astfold_expr, expr_ty, node->defaults);
+    return 1;
+}
+
+static int
+astfold_arg(arg_ty node, PyArena *arena, optimizer *state)
+{
+    CALL_OPT(astfold_expr, node->annotation);
+    return 1;
+}
+
+static int
+astfold_excepthandler(excepthandler_ty node, PyArena *arena,
+                      optimizer *state)
+{
+    switch (node->kind) {
+    case ExceptHandler_kind:
+        CALL_OPT(astfold_expr, node->v.ExceptHandler.type);
+        CALL(astfold_body, &node->v.ExceptHandler.body);
+        if (node->v.ExceptHandler.name != NULL)
+            state->unsafe++;
+        break;
+    default:
+        break;
+    }
+    return 1;
+}
+
+static int
+astfold_withitem(withitem_ty node, PyArena *arena, optimizer *state)
+{
+    CALL(astfold_expr, node->context_expr);
+    CALL_OPT(astfold_expr, node->optional_vars);
+    return 1;
+}
+
+#undef CALL
+#undef CALL_OPT
+#undef CALL_SEQ
+#undef CALL_BODY
+
+int
+_PyAST_Optimize(mod_ty mod, PyArena *arena, int optimize)
+{
+    optimizer state;
+
+    state.optimize = optimize;
+    state.unsafe = 0;
+    state.live = NULL;
+    state.has_live = 0;
+    return astfold_mod(mod, arena, &state);
+}
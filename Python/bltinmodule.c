@@ -671,7 +671,8 @@ builtin_compile_impl(PyModuleDef *module, PyObject *source,
     cf.cf_flags = flags | PyCF_SOURCE_IS_UTF8;
 
     if (flags &
-        ~(PyCF_MASK | PyCF_MASK_OBSOLETE | PyCF_DONT_IMPLY_DEDENT | PyCF_ONLY_AST))
+        ~(PyCF_MASK | PyCF_MASK_OBSOLETE | PyCF_DONT_IMPLY_DEDENT |
+          PyCF_OPTIMIZED_AST))
     {
         PyErr_SetString(PyExc_ValueError,
                         "compile(): unrecognised flags");
@@ -705,7 +706,7 @@ builtin_compile_impl(PyModuleDef *module, PyObject *source,
     if (is_ast == -1)
         goto error;
     if (is_ast) {
-        if (flags & PyCF_ONLY_AST) {
+        if ((flags & PyCF_OPTIMIZED_AST) == PyCF_ONLY_AST) {
             Py_INCREF(source);
             result = source;
         }
@@ -725,8 +726,18 @@ builtin_compile_impl(PyModuleDef *module, PyObject *source,
                 PyArena_Free(arena);
                 goto error;
             }
-            result = (PyObject*)PyAST_CompileObject(mod, filename,
-                                                    &cf, optimize, arena);
+            if (flags & PyCF_ONLY_AST) {
+                /* PyCF_OPTIMIZED_AST */
+                if (_PyAST_Optimize(mod, arena, optimize == -1 ?
+                                    Py_OptimizeFlag : optimize))
+                    result = PyAST_mod2obj(mod);
+                else
+                    result = NULL;
+            }
+            else {
+                result = (PyObject*)PyAST_CompileObject(mod, filename,
+                                                        &cf, optimize, arena);
+            }
             PyArena_Free(arena);
         }
         goto finally;
@@ -966,12 +977,15 @@ builtin_exec_impl(PyModuleDef *module, PyObject *source, PyObject *globals,
 
 /* AC: cannot convert yet, as needs PEP 457 group support in inspect */
 static PyObject *
-builtin_getattr(PyObject *self, PyObject *args)
+builtin_getattr(PyObject *self, PyObject *const *args, Py_ssize_t nargs,
+                PyObject *kwnames)
 {
     PyObject *v, *result, *dflt = NULL;
     PyObject *name;
 
-    if (!PyArg_UnpackTuple(args, "getattr", 2, 3, &v, &name, &dflt))
+    if (!_PyArg_UnpackStack(args, nargs, "getattr", 2, 3, &v, &name, &dflt))
+        return NULL;
+    if (!_PyArg_NoStackKeywords("getattr", kwnames))
         return NULL;
 
     if (!PyUnicode_Check(name)) {
@@ -2582,7 +2596,7 @@ static PyMethodDef builtin_methods[] = {
     BUILTIN_EVAL_METHODDEF
     BUILTIN_EXEC_METHODDEF
     BUILTIN_FORMAT_METHODDEF
-    {"getattr",         builtin_getattr,    METH_VARARGS, getattr_doc},
+    {"getattr",         (PyCFunction)builtin_getattr, METH_FASTCALL, getattr_doc},
     BUILTIN_GLOBALS_METHODDEF
     BUILTIN_HASATTR_METHODDEF
     BUILTIN_HASH_METHODDEF
@@ -14,6 +14,7 @@
 #include "code.h"
 #include "dictobject.h"
 #include "frameobject.h"
+#include "longintrepr.h"
 #include "opcode.h"
 #include "setobject.h"
 #include "structmember.h"
@@ -114,6 +115,8 @@ static PyObject * call_function(PyObject ***, int, uint64*, uint64*);
 static PyObject * call_function(PyObject ***, int);
 #endif
 static PyObject * fast_function(PyObject *, PyObject ***, int, int, int);
+static int call_method_descr(PyObject *, PyObject **, int, PyObject **);
+static PyObject * stack_kwnames(PyObject ***, int, int);
 static PyObject * do_call(PyObject *, PyObject ***, int, int);
 static PyObject * ext_do_call(PyObject *, PyObject ***, int, int, int);
 static PyObject * update_keyword_args(PyObject *, int, PyObject ***,
@@ -144,8 +147,17 @@ static int import_all_from(PyObject *, PyObject *);
 static void format_exc_check_arg(PyObject *, const char *, PyObject *);
 static void format_exc_unbound(PyCodeObject *co, int oparg);
 static PyObject * unicode_concatenate(PyObject *, PyObject *,
-                                      PyFrameObject *, unsigned char *);
+                                      PyFrameObject *, const _Py_CODEUNIT *);
 static PyObject * special_lookup(PyObject *, _Py_Identifier *);
+static void opcache_fill_attr(_PyOpcache *, PyObject *, PyObject *, int);
+static int warm_up_code(PyCodeObject *);
+static void new_code_stats(PyCodeObject *);
+static int call_monitor(PyThreadState *, PyFrameObject *, int, PyObject *,
+                        int, int);
+static int maybe_call_monitor(PyThreadState *, PyFrameObject *, int *);
+static void specialize(PyCodeObject *, Py_ssize_t, int, int,
+                       PyObject *, PyObject *);
+static int deoptimize(PyCodeObject *, Py_ssize_t);
 
 #define NAME_ERROR_MSG \
     "name '%.200s' is not defined"
@@ -155,6 +167,90 @@ static PyObject * special_lookup(PyObject *, _Py_Identifier *);
     "free variable '%.200s' referenced before assignment" \
     " in enclosing scope"
 
+/* Number of times a code object must be run, or loop, before its inline
+   caches (co_opcache, see code.h) and quickened code are allocated.  Cold
+   code never pays for them. */
+#define OPCACHE_MIN_RUNS 1024
+
+/* Number of times an instruction of quickened code runs generic before it
+   tries to specialize again, after it saw operands that no specialized
+   form handles, or after its specialized form was deoptimized. */
+#define QUICKEN_BACKOFF 64
+
+/* Exact ints of at most one digit, and their value.  The sum or the
+   difference of two of them always fits in a C long. */
+#define INT_IS_SMALL(op) (Py_SIZE(op) >= -1 && Py_SIZE(op) <= 1)
+#define SMALL_INT_VALUE(op) \
+    (Py_SIZE(op) == 0 ? 0L : \
+     (long)Py_SIZE(op) * (long)((PyLongObject *)(op))->ob_digit[0])
+
+/* Outcome of the comparison op (PyCmp_LT to PyCmp_GE) of two C numbers */
+#define COMPARE_VALUES(a, b, op) \
+    ((op) == PyCmp_LT ? (a) < (b) : \
+     (op) == PyCmp_LE ? (a) <= (b) : \
+     (op) == PyCmp_EQ ? (a) == (b) : \
+     (op) == PyCmp_NE ? (a) != (b) : \
+     (op) == PyCmp_GT ? (a) > (b) : (a) >= (b))
+
+/* Number of times an attribute cache may be (re)filled before the
+   instruction gives up on it, e.g. because it sees objects of many
+   different types. */
+#define OPCACHE_MAX_MISSES 32
+
+/* Return the cached attribute value of owner (a borrowed reference) if
+   the LOAD_ATTR / STORE_ATTR cache entry la matches it, else NULL.  A
+   matching tp_version_tag means the type is the one seen when the entry
+   was filled, and that nothing on it shadows the attribute since. */
+#define OPCACHE_ATTR_DICT(la, owner) \
+    ((Py_TYPE(owner)->tp_version_tag == (la)->tp_version_tag && \
+      PyType_HasFeature(Py_TYPE(owner), Py_TPFLAGS_VALID_VERSION_TAG)) ? \
+     *(PyObject **)((char *)(owner) + Py_TYPE(owner)->tp_dictoffset) : NULL)
+
+/* Opcode statistics, collected while enabled by sys._stats_on().  When
+   they are, _Py_TracingPossible is incremented so that the computed gotos
+   go through fast_next_opcode, where the instructions are counted; the
+   eval loop doesn't pay for them otherwise. */
+typedef struct {
+    Py_ssize_t opcodes[256];
+    /* pairs[a][b] counts the times b ran right after a.  Row 0 counts the
+       first instruction run by each frame evaluation. */
+    Py_ssize_t pairs[256][256];
+    /* Instructions with an inline cache (co_opcache) which was used, or
+       which had to be looked up the slow way */
+    Py_ssize_t cache_hits[256];
+    Py_ssize_t cache_misses[256];
+    /* Attempts of the adaptive instructions to specialize, by generic
+       opcode, and deoptimizations, by specialized opcode */
+    Py_ssize_t specialization_success[256];
+    Py_ssize_t specialization_failure[256];
+    Py_ssize_t deopts[256];
+} eval_stats_t;
+
+/* Per-code object statistics, kept in a list to be reported */
+typedef struct _PyCodeStats {
+    struct _PyCodeStats *prev;
+    struct _PyCodeStats *next;
+    PyCodeObject *code;         /* borrowed: the code object frees it */
+    Py_ssize_t calls;           /* evaluations started, not resumed */
+    Py_ssize_t opcodes[256];
+} code_stats_t;
+
+static eval_stats_t *eval_stats_data = NULL;
+/* eval_stats_data if statistics are enabled, NULL otherwise */
+static eval_stats_t *eval_stats = NULL;
+static code_stats_t *code_stats_head = NULL;
+
+#define OPCACHE_STAT_HIT() \
+    do { \
+        if (eval_stats != NULL) \
+            eval_stats->cache_hits[opcode]++; \
+    } while (0)
+#define OPCACHE_STAT_MISS() \
+    do { \
+        if (eval_stats != NULL) \
+            eval_stats->cache_misses[opcode]++; \
+    } while (0)
+
 /* Dynamic execution profile */
 #ifdef DYNAMIC_EXECUTION_PROFILE
 #ifdef DXPAIRS
@@ -311,7 +407,7 @@ PyEval_InitThreads(void)
     if (gil_created())
         return;
     create_gil();
-    take_gil(PyThreadState_GET());
+    take_gil(PyThreadState_GET(), 0);
     main_thread = PyThread_get_thread_ident();
     if (!pending_lock)
         pending_lock = PyThread_allocate_lock();
@@ -332,7 +428,7 @@ PyEval_AcquireLock(void)
     PyThreadState *tstate = PyThreadState_GET();
     if (tstate == NULL)
         Py_FatalError("PyEval_AcquireLock: current thread state is NULL");
-    take_gil(tstate);
+    take_gil(tstate, 0);
 }
 
 void
@@ -353,7 +449,7 @@ PyEval_AcquireThread(PyThreadState *tstate)
         Py_FatalError("PyEval_AcquireThread: NULL new thread state");
     /* Check someone has called PyEval_InitThreads() to create the lock */
     assert(gil_created());
-    take_gil(tstate);
+    take_gil(tstate, 0);
     if (PyThreadState_Swap(tstate) != NULL)
         Py_FatalError(
             "PyEval_AcquireThread: non-NULL old thread state");
@@ -385,7 +481,7 @@ PyEval_ReInitThreads(void)
         return;
     recreate_gil();
     pending_lock = PyThread_allocate_lock();
-    take_gil(current_tstate);
+    take_gil(current_tstate, 0);
     main_thread = PyThread_get_thread_ident();
 
     /* Update the threading module with the new state.
@@ -447,7 +543,7 @@ PyEval_RestoreThread(PyThreadState *tstate)
 #ifdef WITH_THREAD
     if (gil_created()) {
         int err = errno;
-        take_gil(tstate);
+        take_gil(tstate, 1);
         /* _Py_Finalizing is protected by the GIL */
         if (_Py_Finalizing && tstate != _Py_Finalizing) {
             drop_gil(tstate);
@@ -795,15 +891,51 @@ PyEval_EvalFrame(PyFrameObject *f) {
 
 PyObject *
 PyEval_EvalFrameEx(PyFrameObject *f, int throwflag)
+{
+    PyThreadState *tstate = PyThreadState_GET();
+    _PyFrameEvalFunction eval_frame = tstate->interp->eval_frame;
+
+    /* Unless it was replaced, make a direct call, which the compiler
+       turns into a jump, rather than an indirect one */
+    if (eval_frame == _PyEval_EvalFrameDefault)
+        return _PyEval_EvalFrameDefault(f, throwflag);
+    return eval_frame(f, throwflag);
+}
+
+Py_ssize_t
+_PyEval_RequestCodeExtraIndex(freefunc free)
+{
+    PyInterpreterState *interp = PyThreadState_GET()->interp;
+    Py_ssize_t index;
+
+    if (interp->co_extra_user_count == MAX_CO_EXTRA_USERS)
+        return -1;
+    index = interp->co_extra_user_count++;
+    interp->co_extra_freefuncs[index] = free;
+    return index;
+}
+
+PyObject *
+_PyEval_EvalFrameDefault(PyFrameObject *f, int throwflag)
 {
 #ifdef DXPAIRS
     int lastopcode = 0;
 #endif
+    /* eval_stats when the frame was entered or resumed: enabling the
+       statistics only counts the frames entered afterwards */
+    eval_stats_t *stats = NULL;
+    int prevopcode = 0;  /* Last opcode run, for stats->pairs */
+    /* Whether the frame counts statistics or its code object had a
+       co_monitor when it was entered; only then does the frame leave the
+       computed-goto fast path */
+    int monitored = 0;
+    int monitor_prev = -1;  /* Last instruction index run while monitored */
     PyObject **stack_pointer;  /* Next free slot in value stack */
-    unsigned char *next_instr;
+    const _Py_CODEUNIT *next_instr;
     int opcode;        /* Current opcode */
     int oparg;         /* Current opcode argument, if any */
     enum why_code why; /* Reason for block stack unwind */
+    int static_limit;  /* Blocks of co_exceptiontable left to unwind */
     PyObject **fastlocals, **freevars;
     PyObject *retval = NULL;            /* Return value */
     PyThreadState *tstate = PyThreadState_GET();
@@ -818,9 +950,10 @@ PyEval_EvalFrameEx(PyFrameObject *f, int throwflag)
        time it is tested. */
     int instr_ub = -1, instr_lb = 0, instr_prev = -1;
 
-    unsigned char *first_instr;
+    const _Py_CODEUNIT *first_instr;
     PyObject *names;
     PyObject *consts;
+    _PyOpcache *co_opcache;
 
 #ifdef LLTRACE
     _Py_IDENTIFIER(__ltrace__);
@@ -890,17 +1023,11 @@ PyEval_EvalFrameEx(PyFrameObject *f, int throwflag)
    (e.g. SETUP_LOOP, SETUP_FINALLY) */
 #define TARGET_WITH_IMPL(op, impl) \
     TARGET_##op: \
-        opcode = op; \
-        if (HAS_ARG(op)) \
-            oparg = NEXTARG(); \
     case op: \
         goto impl; \
 
 #define TARGET(op) \
     TARGET_##op: \
-        opcode = op; \
-        if (HAS_ARG(op)) \
-            oparg = NEXTARG(); \
     case op:
 
 
@@ -915,18 +1042,20 @@ PyEval_EvalFrameEx(PyFrameObject *f, int throwflag)
 #ifdef LLTRACE
 #define FAST_DISPATCH() \
     { \
-        if (!lltrace && !_Py_TracingPossible) { \
+        if (!lltrace && !_Py_TracingPossible && !monitored) { \
             f->f_lasti = INSTR_OFFSET(); \
-            goto *opcode_targets[*next_instr++]; \
+            NEXTOPARG(); \
+            goto *opcode_targets[opcode]; \
         } \
         goto fast_next_opcode; \
     }
 #else
 #define FAST_DISPATCH() \
     { \
-        if (!_Py_TracingPossible) { \
+        if (!_Py_TracingPossible && !monitored) { \
             f->f_lasti = INSTR_OFFSET(); \
-            goto *opcode_targets[*next_instr++]; \
+            NEXTOPARG(); \
+            goto *opcode_targets[opcode]; \
         } \
         goto fast_next_opcode; \
     }
@@ -994,12 +1123,52 @@ PyEval_EvalFrameEx(PyFrameObject *f, int throwflag)
 
 /* Code access macros */
 
-#define INSTR_OFFSET()  ((int)(next_instr - first_instr))
-#define NEXTOP()        (*next_instr++)
-#define NEXTARG()       (next_instr += 2, (next_instr[-1]<<8) + next_instr[-2])
-#define PEEKARG()       ((next_instr[2]<<8) + next_instr[1])
-#define JUMPTO(x)       (next_instr = first_instr + (x))
-#define JUMPBY(x)       (next_instr += (x))
+/* Instructions are code units; f_lasti, jump arguments and block handlers
+   are byte offsets in co_code. */
+#define INSTR_OFFSET()  \
+    ((int)(sizeof(_Py_CODEUNIT) * (next_instr - first_instr)))
+#define NEXTOPARG()  do { \
+        _Py_CODEUNIT word = *next_instr; \
+        opcode = _Py_OPCODE(word); \
+        oparg = _Py_OPARG(word); \
+        next_instr++; \
+    } while (0)
+#define JUMPTO(x)       (next_instr = first_instr + (x) / sizeof(_Py_CODEUNIT))
+
+/* Inline cache access.  OPCACHE_CHECK() must be used by instructions
+   that take an argument, after it has been decoded: it sets co_opcache
+   to the cache entry of the current instruction, or to NULL. */
+
+#define OPCACHE_CHECK() \
+    do { \
+        co_opcache = NULL; \
+        if (co->co_opcache != NULL) { \
+            unsigned char co_opt_offset = \
+                co->co_opcache_map[next_instr - first_instr - 1]; \
+            if (co_opt_offset > 0) { \
+                assert(co_opt_offset <= co->co_opcache_size); \
+                co_opcache = &co->co_opcache[co_opt_offset - 1]; \
+            } \
+        } \
+    } while (0)
+#define JUMPBY(x)       (next_instr += (x) / sizeof(_Py_CODEUNIT))
+
+/* Adaptive instructions.  When running quickened code, the generic
+   instructions which have specialized forms call ADAPT() with their
+   operands to replace themselves by the form that matches them.  The
+   specialized forms check their operands and DEOPT() back to the generic
+   instruction, which then runs as usual, when they don't match. */
+#define ADAPT(left, right) \
+    do { \
+        if (first_instr == co->co_quickened) \
+            specialize(co, next_instr - first_instr - 1, opcode, oparg, \
+                       (left), (right)); \
+    } while (0)
+#define DEOPT() \
+    do { \
+        opcode = deoptimize(co, next_instr - first_instr - 1); \
+        goto dispatch_opcode; \
+    } while (0)
 
 /* OpCode prediction macros
     Some opcodes tend to come in pairs thus making it possible to
@@ -1012,10 +1181,10 @@ PyEval_EvalFrameEx(PyFrameObject *f, int throwflag)
     processor's own internal branch predication has a high likelihood of
     success, resulting in a nearly zero-overhead transition to the
     next opcode.  A successful prediction saves a trip through the eval-loop
-    including its two unpredictable branches, the HAS_ARG test and the
-    switch-case.  Combined with the processor's internal branch prediction,
-    a successful PREDICT has the effect of making the two opcodes run as if
-    they were a single new opcode with the bodies combined.
+    including its unpredictable switch-case branch.  Combined with the
+    processor's internal branch prediction, a successful PREDICT has the
+    effect of making the two opcodes run as if they were a single new opcode
+    with the bodies combined.
 
     If collecting opcode statistics, your choices are to either keep the
     predictions turned-on and interpret the results as if some opcodes
@@ -1030,13 +1199,19 @@ PyEval_EvalFrameEx(PyFrameObject *f, int throwflag)
 
 #if defined(DYNAMIC_EXECUTION_PROFILE) || USE_COMPUTED_GOTOS
 #define PREDICT(op)             if (0) goto PRED_##op
-#define PREDICTED(op)           PRED_##op:
-#define PREDICTED_WITH_ARG(op)  PRED_##op:
 #else
-#define PREDICT(op)             if (*next_instr == op) goto PRED_##op
-#define PREDICTED(op)           PRED_##op: next_instr++
-#define PREDICTED_WITH_ARG(op)  PRED_##op: oparg = PEEKARG(); next_instr += 3
+#define PREDICT(op) \
+    do { \
+        _Py_CODEUNIT word = *next_instr; \
+        opcode = _Py_OPCODE(word); \
+        if (opcode == op && !monitored) { \
+            oparg = _Py_OPARG(word); \
+            next_instr++; \
+            goto PRED_##op; \
+        } \
+    } while (0)
 #endif
+#define PREDICTED(op)           PRED_##op:
 
 
 /* Stack manipulation macros */
@@ -1161,11 +1336,35 @@ PyEval_EvalFrameEx(PyFrameObject *f, int throwflag)
     }
 
     co = f->f_code;
+    if (co->co_opcache_flag < OPCACHE_MIN_RUNS && warm_up_code(co) < 0)
+        goto exit_eval_frame;
+    stats = eval_stats;
+    if (stats != NULL) {
+        monitored = 1;
+        if (co->co_stats == NULL)
+            new_code_stats(co);
+        if (co->co_stats != NULL && f->f_lasti < 0)
+            co->co_stats->calls++;
+    }
+    if (co->co_monitor != NULL) {
+        monitored = 1;
+        if ((co->co_monitor->events & _PyMonitor_CALL) &&
+            call_monitor(tstate, f, _PyMonitor_CALL, Py_None, -1, 0) < 0)
+            goto exit_eval_frame;
+    }
     names = co->co_names;
     consts = co->co_consts;
     fastlocals = f->f_localsplus;
     freevars = f->f_localsplus + co->co_nlocals;
-    first_instr = (unsigned char*) PyBytes_AS_STRING(co->co_code);
+    assert(PyBytes_Check(co->co_code));
+    assert(PyBytes_GET_SIZE(co->co_code) <= INT_MAX);
+    assert(PyBytes_GET_SIZE(co->co_code) % sizeof(_Py_CODEUNIT) == 0);
+    assert(_Py_IS_ALIGNED(PyBytes_AS_STRING(co->co_code),
+                          sizeof(_Py_CODEUNIT)));
+    if (co->co_quickened != NULL)
+        first_instr = co->co_quickened;
+    else
+        first_instr = (_Py_CODEUNIT *) PyBytes_AS_STRING(co->co_code);
     /* An explanation is in order for the next line.
 
        f->f_lasti now refers to the index of the last instruction
@@ -1185,7 +1384,11 @@ PyEval_EvalFrameEx(PyFrameObject *f, int throwflag)
        FOR_ITER is effectively a single opcode and f->f_lasti will point
        at to the beginning of the combined pair.)
     */
-    next_instr = first_instr + f->f_lasti + 1;
+    next_instr = first_instr;
+    if (f->f_lasti >= 0) {
+        assert(f->f_lasti % sizeof(_Py_CODEUNIT) == 0);
+        next_instr += f->f_lasti / sizeof(_Py_CODEUNIT) + 1;
+    }
     stack_pointer = f->f_stacktop;
     assert(stack_pointer != NULL);
     f->f_stacktop = NULL;       /* remains NULL unless yield suspends frame */
@@ -1249,7 +1452,7 @@ PyEval_EvalFrameEx(PyFrameObject *f, int throwflag)
            Py_MakePendingCalls() above. */
 
         if (_Py_atomic_load_relaxed(&eval_breaker)) {
-            if (*next_instr == SETUP_FINALLY) {
+            if (_Py_OPCODE(*next_instr) == SETUP_FINALLY) {
                 /* Make the last opcode before
                    a try: finally: block uninterruptible. */
                 goto fast_next_opcode;
@@ -1270,7 +1473,7 @@ PyEval_EvalFrameEx(PyFrameObject *f, int throwflag)
 
                 /* Other threads may run now */
 
-                take_gil(tstate);
+                take_gil(tstate, 0);
 
                 /* Check if we should make a quick exit. */
                 if (_Py_Finalizing && _Py_Finalizing != tstate) {
@@ -1320,13 +1523,20 @@ PyEval_EvalFrameEx(PyFrameObject *f, int throwflag)
                 goto error;
         }
 
+        if (monitored && co->co_monitor != NULL &&
+            maybe_call_monitor(tstate, f, &monitor_prev) < 0)
+            goto error;
+
         /* Extract opcode and argument */
 
-        opcode = NEXTOP();
-        oparg = 0;   /* allows oparg to be stored in a register because
-            it doesn't have to be remembered across a full loop */
-        if (HAS_ARG(opcode))
-            oparg = NEXTARG();
+        NEXTOPARG();
+        if (stats != NULL) {
+            stats->opcodes[opcode]++;
+            stats->pairs[prevopcode][opcode]++;
+            prevopcode = opcode;
+            if (co->co_stats != NULL)
+                co->co_stats->opcodes[opcode]++;
+        }
     dispatch_opcode:
 #ifdef DYNAMIC_EXECUTION_PROFILE
 #ifdef DXPAIRS
@@ -1384,7 +1594,7 @@ PyEval_EvalFrameEx(PyFrameObject *f, int throwflag)
             FAST_DISPATCH();
         }
 
-        PREDICTED_WITH_ARG(STORE_FAST);
+        PREDICTED(STORE_FAST);
         TARGET(STORE_FAST) {
             PyObject *value = POP();
             SETLOCAL(oparg, value);
@@ -1497,7 +1707,9 @@ PyEval_EvalFrameEx(PyFrameObject *f, int throwflag)
         TARGET(BINARY_MULTIPLY) {
             PyObject *right = POP();
             PyObject *left = TOP();
-            PyObject *res = PyNumber_Multiply(left, right);
+            PyObject *res;
+            ADAPT(left, right);
+            res = PyNumber_Multiply(left, right);
             Py_DECREF(left);
             Py_DECREF(right);
             SET_TOP(res);
@@ -1560,6 +1772,7 @@ PyEval_EvalFrameEx(PyFrameObject *f, int throwflag)
             PyObject *right = POP();
             PyObject *left = TOP();
             PyObject *sum;
+            ADAPT(left, right);
             if (PyUnicode_CheckExact(left) &&
                      PyUnicode_CheckExact(right)) {
                 sum = unicode_concatenate(left, right, f, next_instr);
@@ -1579,7 +1792,9 @@ PyEval_EvalFrameEx(PyFrameObject *f, int throwflag)
         TARGET(BINARY_SUBTRACT) {
             PyObject *right = POP();
             PyObject *left = TOP();
-            PyObject *diff = PyNumber_Subtract(left, right);
+            PyObject *diff;
+            ADAPT(left, right);
+            diff = PyNumber_Subtract(left, right);
             Py_DECREF(right);
             Py_DECREF(left);
             SET_TOP(diff);
@@ -1591,7 +1806,9 @@ PyEval_EvalFrameEx(PyFrameObject *f, int throwflag)
         TARGET(BINARY_SUBSCR) {
             PyObject *sub = POP();
             PyObject *container = TOP();
-            PyObject *res = PyObject_GetItem(container, sub);
+            PyObject *res;
+            ADAPT(container, sub);
+            res = PyObject_GetItem(container, sub);
             Py_DECREF(container);
             Py_DECREF(sub);
             SET_TOP(res);
@@ -1699,7 +1916,9 @@ PyEval_EvalFrameEx(PyFrameObject *f, int throwflag)
         TARGET(INPLACE_MULTIPLY) {
             PyObject *right = POP();
             PyObject *left = TOP();
-            PyObject *res = PyNumber_InPlaceMultiply(left, right);
+            PyObject *res;
+            ADAPT(left, right);
+            res = PyNumber_InPlaceMultiply(left, right);
             Py_DECREF(left);
             Py_DECREF(right);
             SET_TOP(res);
@@ -1760,6 +1979,7 @@ PyEval_EvalFrameEx(PyFrameObject *f, int throwflag)
             PyObject *right = POP();
             PyObject *left = TOP();
             PyObject *sum;
+            ADAPT(left, right);
             if (PyUnicode_CheckExact(left) && PyUnicode_CheckExact(right)) {
                 sum = unicode_concatenate(left, right, f, next_instr);
                 /* unicode_concatenate consumed the ref to v */
@@ -1778,7 +1998,9 @@ PyEval_EvalFrameEx(PyFrameObject *f, int throwflag)
         TARGET(INPLACE_SUBTRACT) {
             PyObject *right = POP();
             PyObject *left = TOP();
-            PyObject *diff = PyNumber_InPlaceSubtract(left, right);
+            PyObject *diff;
+            ADAPT(left, right);
+            diff = PyNumber_InPlaceSubtract(left, right);
             Py_DECREF(left);
             Py_DECREF(right);
             SET_TOP(diff);
@@ -2078,7 +2300,7 @@ PyEval_EvalFrameEx(PyFrameObject *f, int throwflag)
             f->f_stacktop = stack_pointer;
             why = WHY_YIELD;
             /* and repeat... */
-            f->f_lasti--;
+            f->f_lasti -= sizeof(_Py_CODEUNIT);
             goto fast_yield;
         }
 
@@ -2216,7 +2438,7 @@ PyEval_EvalFrameEx(PyFrameObject *f, int throwflag)
             DISPATCH();
         }
 
-        PREDICTED_WITH_ARG(UNPACK_SEQUENCE);
+        PREDICTED(UNPACK_SEQUENCE);
         TARGET(UNPACK_SEQUENCE) {
             PyObject *seq = POP(), *item, **items;
             if (PyTuple_CheckExact(seq) &&
@@ -2267,8 +2489,26 @@ PyEval_EvalFrameEx(PyFrameObject *f, int throwflag)
             PyObject *owner = TOP();
             PyObject *v = SECOND();
             int err;
+            OPCACHE_CHECK();
+            if (co_opcache != NULL && co_opcache->optimized) {
+                _PyOpcache_Attr *la = &co_opcache->u.attr;
+                PyObject *dict = OPCACHE_ATTR_DICT(la, owner);
+                if (dict != NULL &&
+                    _PyDict_SetSplitItemAt((PyDictObject *)dict, la->keys,
+                                           la->index, name, v)) {
+                    OPCACHE_STAT_HIT();
+                    STACKADJ(-2);
+                    Py_DECREF(v);
+                    Py_DECREF(owner);
+                    DISPATCH();
+                }
+            }
+            if (co_opcache != NULL)
+                OPCACHE_STAT_MISS();
             STACKADJ(-2);
             err = PyObject_SetAttr(owner, name, v);
+            if (err == 0 && co_opcache != NULL)
+                opcache_fill_attr(co_opcache, owner, name, 1);
             Py_DECREF(v);
             Py_DECREF(owner);
             if (err != 0)
@@ -2366,15 +2606,37 @@ PyEval_EvalFrameEx(PyFrameObject *f, int throwflag)
             PyObject *v;
             if (PyDict_CheckExact(f->f_globals)
                 && PyDict_CheckExact(f->f_builtins)) {
-                v = _PyDict_LoadGlobal((PyDictObject *)f->f_globals,
-                                       (PyDictObject *)f->f_builtins,
-                                       name);
+                PyDictObject *globals = (PyDictObject *)f->f_globals;
+                PyDictObject *builtins = (PyDictObject *)f->f_builtins;
+                OPCACHE_CHECK();
+                if (co_opcache != NULL && co_opcache->optimized) {
+                    _PyOpcache_LoadGlobal *lg = &co_opcache->u.lg;
+                    if (lg->globals_ver == globals->ma_version_tag
+                        && lg->builtins_ver == builtins->ma_version_tag) {
+                        /* Neither dict changed since the value was
+                           cached, so the borrowed reference is alive. */
+                        v = lg->ptr;
+                        OPCACHE_STAT_HIT();
+                        Py_INCREF(v);
+                        PUSH(v);
+                        DISPATCH();
+                    }
+                }
+                v = _PyDict_LoadGlobal(globals, builtins, name);
                 if (v == NULL) {
                     if (!_PyErr_OCCURRED())
                         format_exc_check_arg(PyExc_NameError,
                                              NAME_ERROR_MSG, name);
                     goto error;
                 }
+                if (co_opcache != NULL) {
+                    _PyOpcache_LoadGlobal *lg = &co_opcache->u.lg;
+                    OPCACHE_STAT_MISS();
+                    co_opcache->optimized = 1;
+                    lg->globals_ver = globals->ma_version_tag;
+                    lg->builtins_ver = builtins->ma_version_tag;
+                    lg->ptr = v; /* borrowed */
+                }
                 Py_INCREF(v);
             }
             else {
@@ -2700,7 +2962,28 @@ PyEval_EvalFrameEx(PyFrameObject *f, int throwflag)
         TARGET(LOAD_ATTR) {
             PyObject *name = GETITEM(names, oparg);
             PyObject *owner = TOP();
-            PyObject *res = PyObject_GetAttr(owner, name);
+            PyObject *res;
+            OPCACHE_CHECK();
+            if (co_opcache != NULL && co_opcache->optimized) {
+                _PyOpcache_Attr *la = &co_opcache->u.attr;
+                PyObject *dict = OPCACHE_ATTR_DICT(la, owner);
+                if (dict != NULL) {
+                    res = _PyDict_GetSplitItemAt((PyDictObject *)dict,
+                                                 la->keys, la->index, name);
+                    if (res != NULL) {
+                        OPCACHE_STAT_HIT();
+                        Py_INCREF(res);
+                        SET_TOP(res);
+                        Py_DECREF(owner);
+                        DISPATCH();
+                    }
+                }
+            }
+            if (co_opcache != NULL)
+                OPCACHE_STAT_MISS();
+            res = PyObject_GetAttr(owner, name);
+            if (res != NULL && co_opcache != NULL)
+                opcache_fill_attr(co_opcache, owner, name, 0);
             Py_DECREF(owner);
             SET_TOP(res);
             if (res == NULL)
@@ -2711,7 +2994,9 @@ PyEval_EvalFrameEx(PyFrameObject *f, int throwflag)
         TARGET(COMPARE_OP) {
             PyObject *right = POP();
             PyObject *left = TOP();
-            PyObject *res = cmp_outcome(oparg, left, right);
+            PyObject *res;
+            ADAPT(left, right);
+            res = cmp_outcome(oparg, left, right);
             Py_DECREF(left);
             Py_DECREF(right);
             SET_TOP(res);
@@ -2808,7 +3093,7 @@ PyEval_EvalFrameEx(PyFrameObject *f, int throwflag)
             FAST_DISPATCH();
         }
 
-        PREDICTED_WITH_ARG(POP_JUMP_IF_FALSE);
+        PREDICTED(POP_JUMP_IF_FALSE);
         TARGET(POP_JUMP_IF_FALSE) {
             PyObject *cond = POP();
             int err;
@@ -2832,7 +3117,7 @@ PyEval_EvalFrameEx(PyFrameObject *f, int throwflag)
             DISPATCH();
         }
 
-        PREDICTED_WITH_ARG(POP_JUMP_IF_TRUE);
+        PREDICTED(POP_JUMP_IF_TRUE);
         TARGET(POP_JUMP_IF_TRUE) {
             PyObject *cond = POP();
             int err;
@@ -2909,9 +3194,21 @@ PyEval_EvalFrameEx(PyFrameObject *f, int throwflag)
             DISPATCH();
         }
 
-        PREDICTED_WITH_ARG(JUMP_ABSOLUTE);
+        PREDICTED(JUMP_ABSOLUTE);
         TARGET(JUMP_ABSOLUTE) {
             JUMPTO(oparg);
+            if (co->co_opcache_flag < OPCACHE_MIN_RUNS) {
+                /* Loop iterations count as runs, so that a long loop
+                   gets quickened even if its function runs only once.
+                   Quickened code has the same layout: switch to it in
+                   the middle of the frame. */
+                if (warm_up_code(co) < 0)
+                    goto error;
+                if (co->co_quickened != NULL) {
+                    next_instr = co->co_quickened + (next_instr - first_instr);
+                    first_instr = co->co_quickened;
+                }
+            }
 #if FAST_LOOPS
             /* Enabling this path speeds-up all while and for-loops by bypassing
                the per-loop checks for signals.  By default, this should be turned-off
@@ -2953,7 +3250,7 @@ PyEval_EvalFrameEx(PyFrameObject *f, int throwflag)
             DISPATCH();
         }
 
-        PREDICTED_WITH_ARG(FOR_ITER);
+        PREDICTED(FOR_ITER);
         TARGET(FOR_ITER) {
             /* before: [iter]; after: [iter, iter()] *or* [] */
             PyObject *iter = TOP();
@@ -2998,6 +3295,10 @@ PyEval_EvalFrameEx(PyFrameObject *f, int throwflag)
             /* NOTE: If you add any new block-setup opcodes that
                are not try/except/finally handlers, you may need
                to update the PyGen_NeedsFinalizing() function.
+
+               The compiler only emits the SETUP_* instructions in
+               handler code; elsewhere the blocks are found in
+               co_exceptiontable when the stack is unwound.
                */
 
             PyFrame_BlockSetup(f, opcode, INSTR_OFFSET() + oparg,
@@ -3038,7 +3339,9 @@ PyEval_EvalFrameEx(PyFrameObject *f, int throwflag)
             DISPATCH();
         }
 
-        TARGET(SETUP_WITH) {
+        TARGET_WITH_IMPL(BEFORE_WITH, _setup_with)
+        TARGET(SETUP_WITH)
+        _setup_with: {
             _Py_IDENTIFIER(__exit__);
             _Py_IDENTIFIER(__enter__);
             PyObject *mgr = TOP();
@@ -3056,9 +3359,11 @@ PyEval_EvalFrameEx(PyFrameObject *f, int throwflag)
             if (res == NULL)
                 goto error;
             /* Setup the finally block before pushing the result
-               of __enter__ on the stack. */
-            PyFrame_BlockSetup(f, SETUP_FINALLY, INSTR_OFFSET() + oparg,
-                               STACK_LEVEL());
+               of __enter__ on the stack.  BEFORE_WITH leaves it to
+               co_exceptiontable. */
+            if (opcode == SETUP_WITH)
+                PyFrame_BlockSetup(f, SETUP_FINALLY, INSTR_OFFSET() + oparg,
+                                   STACK_LEVEL());
 
             PUSH(res);
             DISPATCH();
@@ -3189,6 +3494,113 @@ PyEval_EvalFrameEx(PyFrameObject *f, int throwflag)
             DISPATCH();
         }
 
+        TARGET(LOAD_METHOD) {
+            /* Designed to work in tandem with CALL_METHOD. */
+            PyObject *name = GETITEM(names, oparg);
+            PyObject *obj = TOP();
+            PyObject *meth = NULL;
+
+            int meth_found = _PyObject_GetMethod(obj, name, &meth);
+
+            if (meth == NULL) {
+                /* Most likely attribute wasn't found. */
+                goto error;
+            }
+
+            if (meth_found && tstate->use_tracing &&
+                Py_TYPE(meth) == &PyMethodDescr_Type) {
+                /* Profilers only report C functions called through a
+                   builtin method object, so bind the method after all. */
+                PyObject *bound = Py_TYPE(meth)->tp_descr_get(
+                    meth, obj, (PyObject *)Py_TYPE(obj));
+                Py_DECREF(meth);
+                if (bound == NULL)
+                    goto error;
+                meth = bound;
+                meth_found = 0;
+            }
+
+            if (meth_found) {
+                /* We can bypass temporary bound method object.
+                   meth is unbound method and obj is self.
+
+                   meth | self | arg1 | ... | argN
+                 */
+                SET_TOP(meth);
+                PUSH(obj);  /* self */
+            }
+            else {
+                /* meth is not an unbound method (but a regular attr, or
+                   something was returned by a descriptor protocol).  Set
+                   the second element of the stack to NULL, to signal
+                   CALL_METHOD that it's not a method call.
+
+                   NULL | meth | arg1 | ... | argN
+                */
+                SET_TOP(NULL);
+                Py_DECREF(obj);
+                PUSH(meth);
+            }
+            DISPATCH();
+        }
+
+        TARGET(CALL_METHOD) {
+            /* Designed to work in tandem with LOAD_METHOD. */
+            PyObject **sp, *res, *meth;
+
+            PCALL(PCALL_ALL);
+            sp = stack_pointer;
+
+            meth = PEEK(oparg + 2);
+            if (meth == NULL) {
+                /* meth is NULL when LOAD_METHOD thinks that it's not
+                   a method call.
+
+                   Stack layout:
+
+                       ... | NULL | callable | arg1 | ... | argN
+                                                            ^- TOP()
+                                               ^- (-oparg)
+                                    ^- (-oparg-1)
+                             ^- (-oparg-2)
+
+                   callable will be POPed by call_function.
+                   NULL will will be POPed manually later.
+                */
+#ifdef WITH_TSC
+                res = call_function(&sp, oparg, &intr0, &intr1);
+#else
+                res = call_function(&sp, oparg);
+#endif
+                stack_pointer = sp;
+                (void)POP(); /* POP the NULL. */
+            }
+            else {
+                /* This is a method call.  Stack layout:
+
+                     ... | method | self | arg1 | ... | argN
+                                                        ^- TOP()
+                                           ^- (-oparg)
+                                    ^- (-oparg-1)
+                           ^- (-oparg-2)
+
+                  self is passed as the first argument, so the callable
+                  sees oparg + 1 positional arguments.
+                */
+#ifdef WITH_TSC
+                res = call_function(&sp, oparg + 1, &intr0, &intr1);
+#else
+                res = call_function(&sp, oparg + 1);
+#endif
+                stack_pointer = sp;
+            }
+
+            PUSH(res);
+            if (res == NULL)
+                goto error;
+            DISPATCH();
+        }
+
         TARGET_WITH_IMPL(CALL_FUNCTION_VAR, _call_function_var_kw)
         TARGET_WITH_IMPL(CALL_FUNCTION_KW, _call_function_var_kw)
         TARGET(CALL_FUNCTION_VAR_KW)
@@ -3365,9 +3777,198 @@ PyEval_EvalFrameEx(PyFrameObject *f, int throwflag)
             DISPATCH();
         }
 
+        /* Specialized forms of the adaptive instructions, see ADAPT().
+           The arithmetic ones replace both the BINARY_ and the INPLACE_
+           instruction, which are the same for these immutable types. */
+
+        TARGET(BINARY_ADD_INT) {
+            PyObject *right = TOP();
+            PyObject *left = SECOND();
+            PyObject *res;
+            if (!PyLong_CheckExact(left) || !PyLong_CheckExact(right))
+                DEOPT();
+            if (INT_IS_SMALL(left) && INT_IS_SMALL(right))
+                res = PyLong_FromLong(SMALL_INT_VALUE(left) +
+                                      SMALL_INT_VALUE(right));
+            else
+                res = PyNumber_Add(left, right);
+            STACKADJ(-1);
+            Py_DECREF(left);
+            Py_DECREF(right);
+            SET_TOP(res);
+            if (res == NULL)
+                goto error;
+            DISPATCH();
+        }
+
+        TARGET(BINARY_ADD_FLOAT) {
+            PyObject *right = TOP();
+            PyObject *left = SECOND();
+            PyObject *res;
+            if (!PyFloat_CheckExact(left) || !PyFloat_CheckExact(right))
+                DEOPT();
+            res = PyFloat_FromDouble(PyFloat_AS_DOUBLE(left) +
+                                     PyFloat_AS_DOUBLE(right));
+            STACKADJ(-1);
+            Py_DECREF(left);
+            Py_DECREF(right);
+            SET_TOP(res);
+            if (res == NULL)
+                goto error;
+            DISPATCH();
+        }
+
+        TARGET(BINARY_SUBTRACT_INT) {
+            PyObject *right = TOP();
+            PyObject *left = SECOND();
+            PyObject *res;
+            if (!PyLong_CheckExact(left) || !PyLong_CheckExact(right))
+                DEOPT();
+            if (INT_IS_SMALL(left) && INT_IS_SMALL(right))
+                res = PyLong_FromLong(SMALL_INT_VALUE(left) -
+                                      SMALL_INT_VALUE(right));
+            else
+                res = PyNumber_Subtract(left, right);
+            STACKADJ(-1);
+            Py_DECREF(left);
+            Py_DECREF(right);
+            SET_TOP(res);
+            if (res == NULL)
+                goto error;
+            DISPATCH();
+        }
+
+        TARGET(BINARY_SUBTRACT_FLOAT) {
+            PyObject *right = TOP();
+            PyObject *left = SECOND();
+            PyObject *res;
+            if (!PyFloat_CheckExact(left) || !PyFloat_CheckExact(right))
+                DEOPT();
+            res = PyFloat_FromDouble(PyFloat_AS_DOUBLE(left) -
+                                     PyFloat_AS_DOUBLE(right));
+            STACKADJ(-1);
+            Py_DECREF(left);
+            Py_DECREF(right);
+            SET_TOP(res);
+            if (res == NULL)
+                goto error;
+            DISPATCH();
+        }
+
+        TARGET(BINARY_MULTIPLY_FLOAT) {
+            PyObject *right = TOP();
+            PyObject *left = SECOND();
+            PyObject *res;
+            if (!PyFloat_CheckExact(left) || !PyFloat_CheckExact(right))
+                DEOPT();
+            res = PyFloat_FromDouble(PyFloat_AS_DOUBLE(left) *
+                                     PyFloat_AS_DOUBLE(right));
+            STACKADJ(-1);
+            Py_DECREF(left);
+            Py_DECREF(right);
+            SET_TOP(res);
+            if (res == NULL)
+                goto error;
+            DISPATCH();
+        }
+
+        TARGET(BINARY_SUBSCR_LIST_INT) {
+            PyObject *sub = TOP();
+            PyObject *list = SECOND();
+            PyObject *res;
+            Py_ssize_t i = -1;
+            if (!PyList_CheckExact(list) || !PyLong_CheckExact(sub))
+                DEOPT();
+            if (INT_IS_SMALL(sub)) {
+                i = SMALL_INT_VALUE(sub);
+                if (i < 0)
+                    i += PyList_GET_SIZE(list);
+            }
+            if (i >= 0 && i < PyList_GET_SIZE(list)) {
+                res = PyList_GET_ITEM(list, i);
+                Py_INCREF(res);
+            }
+            else {
+                /* Out of range, or too large for the fast path */
+                res = PyObject_GetItem(list, sub);
+            }
+            STACKADJ(-1);
+            Py_DECREF(list);
+            Py_DECREF(sub);
+            SET_TOP(res);
+            if (res == NULL)
+                goto error;
+            DISPATCH();
+        }
+
+        TARGET(COMPARE_OP_INT) {
+            PyObject *right = TOP();
+            PyObject *left = SECOND();
+            PyObject *res;
+            if (!PyLong_CheckExact(left) || !PyLong_CheckExact(right))
+                DEOPT();
+            if (INT_IS_SMALL(left) && INT_IS_SMALL(right)) {
+                res = COMPARE_VALUES(SMALL_INT_VALUE(left),
+                                     SMALL_INT_VALUE(right), oparg) ?
+                      Py_True : Py_False;
+                Py_INCREF(res);
+            }
+            else
+                res = PyObject_RichCompare(left, right, oparg);
+            STACKADJ(-1);
+            Py_DECREF(left);
+            Py_DECREF(right);
+            SET_TOP(res);
+            if (res == NULL)
+                goto error;
+            PREDICT(POP_JUMP_IF_FALSE);
+            PREDICT(POP_JUMP_IF_TRUE);
+            DISPATCH();
+        }
+
+        TARGET(COMPARE_OP_FLOAT) {
+            PyObject *right = TOP();
+            PyObject *left = SECOND();
+            PyObject *res;
+            if (!PyFloat_CheckExact(left) || !PyFloat_CheckExact(right))
+                DEOPT();
+            res = COMPARE_VALUES(PyFloat_AS_DOUBLE(left),
+                                 PyFloat_AS_DOUBLE(right), oparg) ?
+                  Py_True : Py_False;
+            Py_INCREF(res);
+            STACKADJ(-1);
+            Py_DECREF(left);
+            Py_DECREF(right);
+            SET_TOP(res);
+            if (res == NULL)
+                goto error;
+            PREDICT(POP_JUMP_IF_FALSE);
+            PREDICT(POP_JUMP_IF_TRUE);
+            DISPATCH();
+        }
+
+        TARGET(COMPARE_OP_STR) {
+            PyObject *right = TOP();
+            PyObject *left = SECOND();
+            PyObject *res;
+            if (!PyUnicode_CheckExact(left) || !PyUnicode_CheckExact(right))
+                DEOPT();
+            res = PyUnicode_RichCompare(left, right, oparg);
+            STACKADJ(-1);
+            Py_DECREF(left);
+            Py_DECREF(right);
+            SET_TOP(res);
+            if (res == NULL)
+                goto error;
+            PREDICT(POP_JUMP_IF_FALSE);
+            PREDICT(POP_JUMP_IF_TRUE);
+            DISPATCH();
+        }
+
         TARGET(EXTENDED_ARG) {
-            opcode = NEXTOP();
-            oparg = oparg<<16 | NEXTARG();
+            int oldoparg = oparg;
+            NEXTOPARG();
+            oparg |= oldoparg << 8;
             goto dispatch_opcode;
         }
 
@@ -3398,6 +3999,8 @@ error:
 
         assert(why == WHY_NOT);
         why = WHY_EXCEPTION;
+        /* Jumping to a handler is not a branch */
+        monitor_prev = -1;
 
         /* Double-check exception status. */
 #ifdef NDEBUG
@@ -3418,10 +4021,29 @@ error:
 fast_block_end:
         assert(why != WHY_NOT);
 
-        /* Unwind stacks if a (pseudo) exception occurred */
-        while (why != WHY_NOT && f->f_iblock > 0) {
+        /* Unwind stacks if a (pseudo) exception occurred.  The blocks
+           on the block stack were set up in handler code, so they are
+           inside the blocks of co_exceptiontable that contain the
+           current instruction, which are unwound next: popping one of
+           them just restricts the search to the blocks before it. */
+        static_limit = -1;
+        while (why != WHY_NOT) {
+            PyTryBlock *b, static_block;
+
             /* Peek at the current block. */
-            PyTryBlock *b = &f->f_blockstack[f->f_iblock - 1];
+            if (f->f_iblock > 0)
+                b = &f->f_blockstack[f->f_iblock - 1];
+            else {
+                _PyCodeBlock cb;
+                static_limit = _PyCode_FindBlock(co, f->f_lasti,
+                                                 static_limit, &cb);
+                if (static_limit < 0)
+                    break;
+                static_block.b_type = cb.cb_type;
+                static_block.b_handler = cb.cb_handler;
+                static_block.b_level = cb.cb_level;
+                b = &static_block;
+            }
 
             assert(why != WHY_YIELD);
             if (b->b_type == SETUP_LOOP && why == WHY_CONTINUE) {
@@ -3431,7 +4053,8 @@ fast_block_end:
                 break;
             }
             /* Now we have to pop the block. */
-            f->f_iblock--;
+            if (b != &static_block)
+                f->f_iblock--;
 
             if (b->b_type == EXCEPT_HANDLER) {
                 UNWIND_EXCEPT_HANDLER(b);
@@ -3569,6 +4192,15 @@ fast_yield:
         }
     }
 
+    if (monitored && co->co_monitor != NULL &&
+        (co->co_monitor->events & _PyMonitor_RETURN) &&
+        (why == WHY_RETURN || why == WHY_YIELD)) {
+        if (call_monitor(tstate, f, _PyMonitor_RETURN, retval, -1, 0) < 0) {
+            Py_CLEAR(retval);
+            why = WHY_EXCEPTION;
+        }
+    }
+
     /* pop frame */
 exit_eval_frame:
     Py_LeaveRecursiveCall();
@@ -3985,6 +4617,133 @@ special_lookup(PyObject *o, _Py_Identifier *id)
     return res;
 }
 
+/* (Re)fill the LOAD_ATTR (store == 0) or STORE_ATTR (store != 0) cache
+   entry of an instruction that just went through the generic path for
+   attribute name of owner.  Only plain instance attributes are cached:
+   the type must use the generic getattr/setattr, define nothing named
+   name, and keep the attribute in a split-table __dict__. */
+static void
+opcache_fill_attr(_PyOpcache *co_opcache, PyObject *owner, PyObject *name,
+                  int store)
+{
+    _PyOpcache_Attr *la = &co_opcache->u.attr;
+    PyTypeObject *tp = Py_TYPE(owner);
+    PyObject *dict;
+    Py_ssize_t ix;
+
+    co_opcache->optimized = 0;
+    if (la->misses >= OPCACHE_MAX_MISSES)
+        return;
+    la->misses++;
+
+    if (tp->tp_dictoffset <= 0)
+        return;
+    if (store ? tp->tp_setattro != PyObject_GenericSetAttr
+              : tp->tp_getattro != PyObject_GenericGetAttr)
+        return;
+    if (_PyType_Lookup(tp, name) != NULL)
+        return;
+    if (!PyType_HasFeature(tp, Py_TPFLAGS_VALID_VERSION_TAG))
+        return;
+    dict = *(PyObject **)((char *)owner + tp->tp_dictoffset);
+    if (dict == NULL || !PyDict_CheckExact(dict))
+        return;
+    ix = _PyDict_GetSplitIndex((PyDictObject *)dict, name);
+    if (ix < 0)
+        return;
+
+    la->tp_version_tag = tp->tp_version_tag;
+    la->keys = ((PyDictObject *)dict)->ma_keys;
+    la->index = ix;
+    co_opcache->optimized = 1;
+}
+
+/* Count a run or a loop iteration of co.  The one that reaches
+   OPCACHE_MIN_RUNS allocates its inline caches and quickened code. */
+static int
+warm_up_code(PyCodeObject *co)
+{
+    co->co_opcache_flag++;
+    if (co->co_opcache_flag == OPCACHE_MIN_RUNS) {
+        if (_PyCode_InitOpcache(co) < 0 || _PyCode_Quicken(co) < 0)
+            return -1;
+    }
+    return 0;
+}
+
+/* Replace the generic instruction at index i of the quickened code of co
+   by its form specialized for the types of left and right, if there is
+   one.  Instructions keep running generic while their backoff counter
+   runs down. */
+static void
+specialize(PyCodeObject *co, Py_ssize_t i, int opcode, int oparg,
+           PyObject *left, PyObject *right)
+{
+    unsigned char *counter = &co->co_quickened_counters[i];
+    int ints = PyLong_CheckExact(left) && PyLong_CheckExact(right);
+    int floats = PyFloat_CheckExact(left) && PyFloat_CheckExact(right);
+    int specialized = 0;
+
+    if (*counter > 0) {
+        (*counter)--;
+        return;
+    }
+    switch (opcode) {
+    case BINARY_ADD:
+    case INPLACE_ADD:
+        specialized = ints ? BINARY_ADD_INT :
+                      floats ? BINARY_ADD_FLOAT : 0;
+        break;
+    case BINARY_SUBTRACT:
+    case INPLACE_SUBTRACT:
+        specialized = ints ? BINARY_SUBTRACT_INT :
+                      floats ? BINARY_SUBTRACT_FLOAT : 0;
+        break;
+    case BINARY_MULTIPLY:
+    case INPLACE_MULTIPLY:
+        specialized = floats ? BINARY_MULTIPLY_FLOAT : 0;
+        break;
+    case BINARY_SUBSCR:
+        if (PyList_CheckExact(left) && PyLong_CheckExact(right))
+            specialized = BINARY_SUBSCR_LIST_INT;
+        break;
+    case COMPARE_OP:
+        if (oparg > PyCmp_GE)
+            break;
+        if (ints)
+            specialized = COMPARE_OP_INT;
+        else if (floats)
+            specialized = COMPARE_OP_FLOAT;
+        else if (PyUnicode_CheckExact(left) && PyUnicode_CheckExact(right))
+            specialized = COMPARE_OP_STR;
+        break;
+    }
+    if (specialized)
+        co->co_quickened[i] = _Py_MAKECODEUNIT(specialized, oparg);
+    else
+        *counter = QUICKEN_BACKOFF;
+    if (eval_stats != NULL) {
+        if (specialized)
+            eval_stats->specialization_success[opcode]++;
+        else
+            eval_stats->specialization_failure[opcode]++;
+    }
+}
+
+/* Put back the generic instruction at index i of the quickened code of co,
+   whose specialized form saw operands it doesn't handle, and return its
+   opcode. */
+static int
+deoptimize(PyCodeObject *co, Py_ssize_t i)
+{
+    _Py_CODEUNIT word = ((_Py_CODEUNIT *)PyBytes_AS_STRING(co->co_code))[i];
+
+    if (eval_stats != NULL)
+        eval_stats->deopts[_Py_OPCODE(co->co_quickened[i])]++;
+    co->co_quickened[i] = word;
+    co->co_quickened_counters[i] = QUICKEN_BACKOFF;
+    return _Py_OPCODE(word);
+}
 
 /* These 3 functions deal with the exception state of generators. */
 
@@ -4353,6 +5112,127 @@ maybe_call_line_trace(Py_tracefunc func, PyObject *obj,
     return result;
 }
 
+/* Returned by a monitoring callback to stop reporting the event at the
+   location it was reported for */
+static PyObject *monitor_disable = NULL;
+
+PyObject *
+_PyEval_GetMonitorDisable(void)
+{
+    if (monitor_disable == NULL)
+        monitor_disable = PyObject_CallObject((PyObject *)&PyBaseObject_Type,
+                                              NULL);
+    return monitor_disable;
+}
+
+/* Call the monitoring callback of the code object of frame.  If it returns
+   sys.monitor_disable, set the disable flag of instruction index. */
+static int
+call_monitor(PyThreadState *tstate, PyFrameObject *frame, int event,
+             PyObject *arg, int index, int disable)
+{
+    _Py_IDENTIFIER(call);
+    _Py_IDENTIFIER(return);
+    _Py_IDENTIFIER(line);
+    _Py_IDENTIFIER(branch);
+    _PyCodeMonitor *mon;
+    PyObject *callback, *name, *res;
+
+    if (tstate->tracing)
+        return 0;
+    switch (event) {
+    case _PyMonitor_CALL: name = _PyUnicode_FromId(&PyId_call); break;
+    case _PyMonitor_RETURN: name = _PyUnicode_FromId(&PyId_return); break;
+    case _PyMonitor_LINE: name = _PyUnicode_FromId(&PyId_line); break;
+    default: name = _PyUnicode_FromId(&PyId_branch); break;
+    }
+    if (name == NULL)
+        return -1;
+
+    /* The callback may replace or remove the monitor */
+    callback = frame->f_code->co_monitor->callback;
+    Py_INCREF(callback);
+    tstate->tracing++;
+    tstate->use_tracing = 0;
+    res = PyObject_CallFunctionObjArgs(callback, (PyObject *)frame, name, arg,
+                                       NULL);
+    tstate->use_tracing = ((tstate->c_tracefunc != NULL)
+                           || (tstate->c_profilefunc != NULL));
+    tstate->tracing--;
+    Py_DECREF(callback);
+    if (res == NULL)
+        return -1;
+    mon = frame->f_code->co_monitor;
+    if (res == monitor_disable && disable && mon != NULL &&
+        mon->callback == callback)
+        mon->flags[index] |= disable;
+    Py_DECREF(res);
+    return 0;
+}
+
+/* Report the branch from the previous instruction *prev, if it was a
+   conditional jump, and the line of the current one if it starts a line or
+   is reached by a jump backwards, like maybe_call_line_trace() does. */
+static int
+maybe_call_monitor(PyThreadState *tstate, PyFrameObject *frame, int *prev)
+{
+    PyCodeObject *co = frame->f_code;
+    _PyCodeMonitor *mon = co->co_monitor;
+    const _Py_CODEUNIT *code = (_Py_CODEUNIT *)PyBytes_AS_STRING(co->co_code);
+    int i = frame->f_lasti / sizeof(_Py_CODEUNIT);
+    int p = *prev;
+    int err;
+
+    *prev = i;
+    if (p >= 0 && (mon->events & _PyMonitor_BRANCH)) {
+        PyObject *arg;
+        int disable, src = p;
+
+        /* EXTENDED_ARG runs the instruction it prefixes without coming
+           back here */
+        while (_Py_OPCODE(code[src]) == EXTENDED_ARG)
+            src++;
+        switch (_Py_OPCODE(code[src])) {
+        case POP_JUMP_IF_FALSE:
+        case POP_JUMP_IF_TRUE:
+        case JUMP_IF_FALSE_OR_POP:
+        case JUMP_IF_TRUE_OR_POP:
+        case FOR_ITER:
+            disable = (i == src + 1) ? _PyMonitor_NO_FALLTHROUGH
+                                     : _PyMonitor_NO_JUMP;
+            if (mon->flags[src] & disable)
+                break;
+            arg = Py_BuildValue("(ii)", src * (int)sizeof(_Py_CODEUNIT),
+                                frame->f_lasti);
+            if (arg == NULL)
+                return -1;
+            err = call_monitor(tstate, frame, _PyMonitor_BRANCH, arg,
+                               src, disable);
+            Py_DECREF(arg);
+            if (err < 0)
+                return -1;
+            mon = co->co_monitor;
+            if (mon == NULL)
+                return 0;
+            break;
+        }
+    }
+    if ((mon->events & _PyMonitor_LINE) &&
+        !(mon->flags[i] & _PyMonitor_NO_LINE) &&
+        ((mon->flags[i] & _PyMonitor_LINE_START) || i < p)) {
+        PyObject *line = PyLong_FromLong(mon->lines[i]);
+
+        if (line == NULL)
+            return -1;
+        err = call_monitor(tstate, frame, _PyMonitor_LINE, line,
+                           i, _PyMonitor_NO_LINE);
+        Py_DECREF(line);
+        if (err < 0)
+            return -1;
+    }
+    return 0;
+}
+
 void
 PyEval_SetProfile(Py_tracefunc func, PyObject *arg)
 {
@@ -4542,21 +5422,6 @@ PyEval_GetFuncDesc(PyObject *func)
         return " object";
 }
 
-static void
-err_args(PyObject *func, int flags, int nargs)
-{
-    if (flags & METH_NOARGS)
-        PyErr_Format(PyExc_TypeError,
-                     "%.200s() takes no arguments (%d given)",
-                     ((PyCFunctionObject *)func)->m_ml->ml_name,
-                     nargs);
-    else
-        PyErr_Format(PyExc_TypeError,
-                     "%.200s() takes exactly one argument (%d given)",
-                     ((PyCFunctionObject *)func)->m_ml->ml_name,
-                     nargs);
-}
-
 #define C_TRACE(x, call) \
 if (tstate->use_tracing && tstate->c_profilefunc) { \
     if (call_trace(tstate->c_profilefunc, tstate->c_profileobj, \
@@ -4602,46 +5467,32 @@ call_function(PyObject ***pp_stack, int oparg
     PyObject *func = *pfunc;
     PyObject *x, *w;
 
+    /* Method descriptors are only found here after LOAD_METHOD, with
+       self as their first argument: call them without binding. */
+    if (Py_TYPE(func) == &PyMethodDescr_Type && nk == 0 &&
+        call_method_descr(func, pfunc + 1, na, &x)) {
+        PCALL(PCALL_CFUNCTION);
+    }
     /* Always dispatch PyCFunction first, because these are
-       presumed to be the most frequent callable object.
+       presumed to be the most frequent callable object.  The arguments
+       are passed straight from the stack, an argument tuple is only
+       built for METH_VARARGS functions.
     */
-    if (PyCFunction_Check(func) && nk == 0) {
-        int flags = PyCFunction_GET_FLAGS(func);
+    else if (PyCFunction_Check(func) &&
+             (nk == 0 || PyCFunction_GET_FLAGS(func) & METH_FASTCALL)) {
         PyThreadState *tstate = PyThreadState_GET();
+        PyObject *kwnames = NULL;
 
         PCALL(PCALL_CFUNCTION);
-        if (flags & (METH_NOARGS | METH_O)) {
-            PyCFunction meth = PyCFunction_GET_FUNCTION(func);
-            PyObject *self = PyCFunction_GET_SELF(func);
-            if (flags & METH_NOARGS && na == 0) {
-                C_TRACE(x, (*meth)(self,NULL));
-
-                x = _Py_CheckFunctionResult(func, x, NULL);
-            }
-            else if (flags & METH_O && na == 1) {
-                PyObject *arg = EXT_POP(*pp_stack);
-                C_TRACE(x, (*meth)(self,arg));
-                Py_DECREF(arg);
-
-                x = _Py_CheckFunctionResult(func, x, NULL);
-            }
-            else {
-                err_args(func, flags, na);
-                x = NULL;
-            }
+        if (nk == 0 || (kwnames = stack_kwnames(pp_stack, na, nk)) != NULL) {
+            READ_TIMESTAMP(*pintr0);
+            C_TRACE(x, _PyCFunction_FastCallKeywords(func, pfunc + 1, na,
+                                                     kwnames));
+            READ_TIMESTAMP(*pintr1);
+            Py_XDECREF(kwnames);
         }
         else {
-            PyObject *callargs;
-            callargs = load_args(pp_stack, na);
-            if (callargs != NULL) {
-                READ_TIMESTAMP(*pintr0);
-                C_TRACE(x, PyCFunction_Call(func,callargs,NULL));
-                READ_TIMESTAMP(*pintr1);
-                Py_XDECREF(callargs);
-            }
-            else {
-                x = NULL;
-            }
+            x = NULL;
         }
     }
     else {
@@ -4672,7 +5523,7 @@ call_function(PyObject ***pp_stack, int oparg
 
     /* Clear the stack of the function object.  Also removes
        the arguments in case they weren't consumed already
-       (fast_function() and err_args() leave them on the stack).
+       (fast_function() and C functions leave them on the stack).
      */
     while ((*pp_stack) > pfunc) {
         w = EXT_POP(*pp_stack);
@@ -4684,6 +5535,48 @@ call_function(PyObject ***pp_stack, int oparg
     return x;
 }
 
+/* Call the method descriptor func directly with the na arguments at args,
+   self being the first one, and store the result in *result.  Return 0,
+   leaving the call to the generic path, for a self of the wrong type (the
+   generic path reports the error). */
+static int
+call_method_descr(PyObject *func, PyObject **args, int na, PyObject **result)
+{
+    PyObject *res;
+
+    if (na < 1 || !PyObject_TypeCheck(args[0], PyDescr_TYPE(func)))
+        return 0;
+    res = _PyMethodDef_RawFastCallKeywords(
+        ((PyMethodDescrObject *)func)->d_method, args[0],
+        args + 1, na - 1, NULL);
+    *result = _Py_CheckFunctionResult(func, res, NULL);
+    return 1;
+}
+
+/* Turn the nk (name, value) pairs following the na positional arguments
+   at the top of the stack into the layout expected by METH_FASTCALL
+   functions: the values are moved right after the positional arguments
+   and the names, whose references are stolen, into the returned tuple.
+   The stack is shrunk accordingly.  On error, return NULL and leave the
+   stack untouched. */
+static PyObject *
+stack_kwnames(PyObject ***pp_stack, int na, int nk)
+{
+    PyObject **kwstack = (*pp_stack) - 2 * nk;
+    PyObject *kwnames;
+    int i;
+
+    kwnames = PyTuple_New(nk);
+    if (kwnames == NULL)
+        return NULL;
+    for (i = 0; i < nk; i++) {
+        PyTuple_SET_ITEM(kwnames, i, kwstack[2 * i]);
+        kwstack[i] = kwstack[2 * i + 1];
+    }
+    *pp_stack -= nk;
+    return kwnames;
+}
+
 /* The fast_function() function optimize calls for which no argument
    tuple is necessary; the objects are passed directly from the stack.
    For the simplest case -- a function that takes only positional
@@ -5188,7 +6081,7 @@ format_exc_unbound(PyCodeObject *co, int oparg)
 
 static PyObject *
 unicode_concatenate(PyObject *v, PyObject *w,
-                    PyFrameObject *f, unsigned char *next_instr)
+                    PyFrameObject *f, const _Py_CODEUNIT *next_instr)
 {
     PyObject *res;
     if (Py_REFCNT(v) == 2) {
@@ -5198,10 +6091,11 @@ unicode_concatenate(PyObject *v, PyObject *w,
          * 'variable'.  We try to delete the variable now to reduce
          * the refcnt to 1.
          */
-        switch (*next_instr) {
+        int opcode, oparg;
+        NEXTOPARG();
+        switch (opcode) {
         case STORE_FAST:
         {
-            int oparg = PEEKARG();
             PyObject **fastlocals = f->f_localsplus;
             if (GETLOCAL(oparg) == v)
                 SETLOCAL(oparg, NULL);
@@ -5211,7 +6105,7 @@ unicode_concatenate(PyObject *v, PyObject *w,
         {
             PyObject **freevars = (f->f_localsplus +
                                    f->f_code->co_nlocals);
-            PyObject *c = freevars[PEEKARG()];
+            PyObject *c = freevars[oparg];
             if (PyCell_GET(c) == v)
                 PyCell_Set(c, NULL);
             break;
@@ -5219,7 +6113,7 @@ unicode_concatenate(PyObject *v, PyObject *w,
         case STORE_NAME:
         {
             PyObject *names = f->f_code->co_names;
-            PyObject *name = GETITEM(names, PEEKARG());
+            PyObject *name = GETITEM(names, oparg);
             PyObject *locals = f->f_locals;
             if (PyDict_CheckExact(locals) &&
                 PyDict_GetItem(locals, name) == v) {
@@ -5279,3 +6173,221 @@ _Py_GetDXProfile(PyObject *self, PyObject *args)
 }
 
 #endif
+
+/* Opcode statistics */
+
+/* Enable the collection of the statistics.  Return -1 with an exception
+   set on memory error. */
+int
+_PyEval_StatsOn(void)
+{
+    if (eval_stats != NULL)
+        return 0;
+    if (eval_stats_data == NULL) {
+        eval_stats_data = PyMem_Calloc(1, sizeof(eval_stats_t));
+        if (eval_stats_data == NULL) {
+            PyErr_NoMemory();
+            return -1;
+        }
+    }
+    eval_stats = eval_stats_data;
+    _Py_TracingPossible++;
+    return 0;
+}
+
+void
+_PyEval_StatsOff(void)
+{
+    if (eval_stats == NULL)
+        return;
+    eval_stats = NULL;
+    _Py_TracingPossible--;
+}
+
+void
+_PyEval_StatsClear(void)
+{
+    if (eval_stats_data != NULL)
+        memset(eval_stats_data, 0, sizeof(eval_stats_t));
+    while (code_stats_head != NULL)
+        _PyEval_FreeCodeStats(code_stats_head->code);
+}
+
+/* Attach statistics to co.  On memory error, co is just not counted. */
+static void
+new_code_stats(PyCodeObject *co)
+{
+    code_stats_t *stats = PyMem_Calloc(1, sizeof(code_stats_t));
+
+    if (stats == NULL)
+        return;
+    stats->code = co;
+    stats->next = code_stats_head;
+    if (code_stats_head != NULL)
+        code_stats_head->prev = stats;
+    code_stats_head = stats;
+    co->co_stats = stats;
+}
+
+/* Called when co is deallocated, or when the statistics are cleared */
+void
+_PyEval_FreeCodeStats(PyCodeObject *co)
+{
+    code_stats_t *stats = co->co_stats;
+
+    if (stats == NULL)
+        return;
+    if (stats->prev != NULL)
+        stats->prev->next = stats->next;
+    else
+        code_stats_head = stats->next;
+    if (stats->next != NULL)
+        stats->next->prev = stats->prev;
+    co->co_stats = NULL;
+    PyMem_Free(stats);
+}
+
+/* Return a dict mapping the opcodes whose count is not zero to it */
+static PyObject *
+opcode_counts(Py_ssize_t counts[256])
+{
+    PyObject *dict = PyDict_New();
+    int i;
+
+    if (dict == NULL)
+        return NULL;
+    for (i = 0; i < 256; i++) {
+        PyObject *key, *value;
+        int err;
+
+        if (counts[i] == 0)
+            continue;
+        key = PyLong_FromLong(i);
+        value = PyLong_FromSsize_t(counts[i]);
+        err = key == NULL || value == NULL ||
+              PyDict_SetItem(dict, key, value) < 0;
+        Py_XDECREF(key);
+        Py_XDECREF(value);
+        if (err) {
+            Py_DECREF(dict);
+            return NULL;
+        }
+    }
+    return dict;
+}
+
+/* Set dict[opcode] = {name_a: a[opcode], name_b: b[opcode]} for each
+   opcode for which a or b is not zero */
+static int
+add_opcode_counters(PyObject *dict, const char *name_a, Py_ssize_t a[256],
+                    const char *name_b, Py_ssize_t b[256])
+{
+    int i;
+
+    for (i = 0; i < 256; i++) {
+        PyObject *key, *value;
+        int err;
+
+        if (a[i] == 0 && b[i] == 0)
+            continue;
+        key = PyLong_FromLong(i);
+        value = Py_BuildValue("{snsn}", name_a, a[i], name_b, b[i]);
+        err = key == NULL || value == NULL ||
+              PyDict_SetItem(dict, key, value) < 0;
+        Py_XDECREF(key);
+        Py_XDECREF(value);
+        if (err)
+            return -1;
+    }
+    return 0;
+}
+
+/* Return the statistics collected so far as a dict, or None if they were
+   never enabled. */
+PyObject *
+_PyEval_GetStats(void)
+{
+    eval_stats_t *stats = eval_stats_data;
+    PyObject *result, *item;
+    code_stats_t *cs;
+    int i, j;
+
+    if (stats == NULL)
+        Py_RETURN_NONE;
+    result = PyDict_New();
+    if (result == NULL)
+        return NULL;
+
+    item = opcode_counts(stats->opcodes);
+    if (item == NULL || PyDict_SetItemString(result, "opcodes", item) < 0)
+        goto error;
+    Py_DECREF(item);
+
+    item = PyDict_New();
+    if (item == NULL || PyDict_SetItemString(result, "pairs", item) < 0)
+        goto error;
+    for (i = 0; i < 256; i++) {
+        for (j = 0; j < 256; j++) {
+            PyObject *key, *value;
+            int err;
+
+            if (stats->pairs[i][j] == 0)
+                continue;
+            key = Py_BuildValue("(ii)", i, j);
+            value = PyLong_FromSsize_t(stats->pairs[i][j]);
+            err = key == NULL || value == NULL ||
+                  PyDict_SetItem(item, key, value) < 0;
+            Py_XDECREF(key);
+            Py_XDECREF(value);
+            if (err)
+                goto error;
+        }
+    }
+    Py_DECREF(item);
+
+    item = PyDict_New();
+    if (item == NULL || PyDict_SetItemString(result, "cache", item) < 0 ||
+        add_opcode_counters(item, "hits", stats->cache_hits,
+                            "misses", stats->cache_misses) < 0)
+        goto error;
+    Py_DECREF(item);
+
+    item = PyDict_New();
+    if (item == NULL ||
+        PyDict_SetItemString(result, "specialization", item) < 0 ||
+        add_opcode_counters(item, "success", stats->specialization_success,
+                            "failure", stats->specialization_failure) < 0)
+        goto error;
+    Py_DECREF(item);
+
+    item = opcode_counts(stats->deopts);
+    if (item == NULL || PyDict_SetItemString(result, "deopts", item) < 0)
+        goto error;
+    Py_DECREF(item);
+
+    item = PyDict_New();
+    if (item == NULL || PyDict_SetItemString(result, "code", item) < 0)
+        goto error;
+    for (cs = code_stats_head; cs != NULL; cs = cs->next) {
+        /* Equal code objects are distinct entries: key on the identity of
+           the code object, which is alive as long as its statistics */
+        PyObject *key = PyLong_FromVoidPtr(cs->code);
+        PyObject *value = Py_BuildValue("{sOsnsN}", "code", cs->code,
+                                        "calls", cs->calls,
+                                        "opcodes",
+                                        opcode_counts(cs->opcodes));
+        int err = key == NULL || value == NULL ||
+                  PyDict_SetItem(item, key, value) < 0;
+        Py_XDECREF(key);
+        Py_XDECREF(value);
+        if (err)
+            goto error;
+    }
+    Py_DECREF(item);
+    return result;
+
+error:
+    Py_XDECREF(item);
+    Py_DECREF(result);
+    return NULL;
+}
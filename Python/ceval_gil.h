@@ -57,6 +57,17 @@ static unsigned long gil_interval = DEFAULT_INTERVAL;
      run and end up being the first to re-acquire it, making the "timeslices"
      much longer than expected.
      (Note: this mechanism is enabled with FORCE_SWITCHING above)
+
+   - With the "io" switch policy, a thread coming back from a blocking call
+     (PyEval_RestoreThread()) doesn't wait for `interval` before setting
+     gil_drop_request: it sets it at once, so that the holder drops the
+     GIL at its next eval loop check. It is also counted in
+     gil_priority_waiters for as long as it waits, and the other waiters
+     let the GIL go to it, so a CPU-bound thread cannot delay every syscall
+     of an I/O-bound thread by a full interval (the "convoy effect").
+
+     The policy is available for the user to read and modify using the
+     Python API `sys.{get,set}switchpolicy()`.
 */
 
 #include "condvar.h"
@@ -88,6 +99,9 @@ static unsigned long gil_interval = DEFAULT_INTERVAL;
 #define COND_SIGNAL(cond) \
     if (PyCOND_SIGNAL(&(cond))) { \
         Py_FatalError("PyCOND_SIGNAL(" #cond ") failed"); };
+#define COND_BROADCAST(cond) \
+    if (PyCOND_BROADCAST(&(cond))) { \
+        Py_FatalError("PyCOND_BROADCAST(" #cond ") failed"); };
 #define COND_WAIT(cond, mut) \
     if (PyCOND_WAIT(&(cond), &(mut))) { \
         Py_FatalError("PyCOND_WAIT(" #cond ") failed"); };
@@ -112,6 +126,10 @@ static unsigned long gil_switch_number = 0;
 /* Last PyThreadState holding / having held the GIL. This helps us know
    whether anyone else was scheduled after we dropped the GIL. */
 static _Py_atomic_address gil_last_holder = {NULL};
+/* Thread switch policy, _Py_SWITCH_INTERVAL or _Py_SWITCH_IO. */
+static int gil_policy = _Py_SWITCH_INTERVAL;
+/* Number of threads waiting for the GIL with priority (the "io" policy). */
+static int gil_priority_waiters = 0;
 
 /* This condition variable allows one or several threads to wait until
    the GIL is released. In addition, the mutex also protects the above
@@ -143,6 +161,7 @@ static void create_gil(void)
     COND_INIT(switch_cond);
 #endif
     _Py_atomic_store_relaxed(&gil_last_holder, NULL);
+    gil_priority_waiters = 0;
     _Py_ANNOTATE_RWLOCK_CREATE(&gil_locked);
     _Py_atomic_store_explicit(&gil_locked, 0, _Py_memory_order_release);
 }
@@ -184,7 +203,14 @@ static void drop_gil(PyThreadState *tstate)
     MUTEX_LOCK(gil_mutex);
     _Py_ANNOTATE_RWLOCK_RELEASED(&gil_locked, /*is_write=*/1);
     _Py_atomic_store_relaxed(&gil_locked, 0);
-    COND_SIGNAL(gil_cond);
+    /* A single signal could wake up a waiter which has to let the GIL go
+       to a priority waiter */
+    if (gil_priority_waiters > 0) {
+        COND_BROADCAST(gil_cond);
+    }
+    else {
+        COND_SIGNAL(gil_cond);
+    }
     MUTEX_UNLOCK(gil_mutex);
 
 #ifdef FORCE_SWITCHING
@@ -204,7 +230,9 @@ static void drop_gil(PyThreadState *tstate)
 #endif
 }
 
-static void take_gil(PyThreadState *tstate)
+/* If priority is true, the thread is coming back from a blocking call and
+   is scheduled first under the "io" switch policy. */
+static void take_gil(PyThreadState *tstate, int priority)
 {
     int err;
     if (tstate == NULL)
@@ -213,13 +241,22 @@ static void take_gil(PyThreadState *tstate)
     err = errno;
     MUTEX_LOCK(gil_mutex);
 
-    if (!_Py_atomic_load_relaxed(&gil_locked))
+    priority = priority && gil_policy == _Py_SWITCH_IO;
+    if (!_Py_atomic_load_relaxed(&gil_locked) &&
+        (priority || gil_priority_waiters == 0))
         goto _ready;
 
-    while (_Py_atomic_load_relaxed(&gil_locked)) {
+    if (priority)
+        gil_priority_waiters++;
+    while (_Py_atomic_load_relaxed(&gil_locked) ||
+           (!priority && gil_priority_waiters > 0)) {
         int timed_out = 0;
         unsigned long saved_switchnum;
 
+        if (priority && _Py_atomic_load_relaxed(&gil_locked)) {
+            /* Don't wait for the interval to elapse */
+            SET_GIL_DROP_REQUEST();
+        }
         saved_switchnum = gil_switch_number;
         COND_TIMED_WAIT(gil_cond, gil_mutex, INTERVAL, timed_out);
         /* If we timed out and no switch occurred in the meantime, it is time
@@ -230,6 +267,8 @@ static void take_gil(PyThreadState *tstate)
             SET_GIL_DROP_REQUEST();
         }
     }
+    if (priority)
+        gil_priority_waiters--;
 _ready:
 #ifdef FORCE_SWITCHING
     /* This mutex must be taken before modifying gil_last_holder (see drop_gil()). */
@@ -268,3 +307,14 @@ unsigned long _PyEval_GetSwitchInterval()
 {
     return gil_interval;
 }
+
+void _PyEval_SetSwitchPolicy(int policy)
+{
+    /* Threads already waiting keep the policy they started with */
+    gil_policy = policy;
+}
+
+int _PyEval_GetSwitchPolicy(void)
+{
+    return gil_policy;
+}
@@ -29,6 +29,7 @@
 #include "code.h"
 #include "symtable.h"
 #include "opcode.h"
+#include "wordcode_helpers.h"
 
 #define DEFAULT_BLOCK_SIZE 16
 #define DEFAULT_BLOCKS 8
@@ -44,6 +45,7 @@ struct instr {
     unsigned i_jabs : 1;
     unsigned i_jrel : 1;
     unsigned i_hasarg : 1;
+    unsigned i_static : 1; /* block setup recorded in co_exceptiontable */
     unsigned char i_opcode;
     int i_oparg;
     struct basicblock_ *i_target; /* target block (if jump instruction) */
@@ -129,6 +131,11 @@ struct compiler_unit {
     int u_nfblocks;
     struct fblockinfo u_fblock[CO_MAXBLOCKS];
 
+    int u_handlers;    /* > 0 while compiling the code of a handler, whose
+                          blocks must still be set up at run time */
+    int u_stacklevel;  /* values left on the stack by the enclosing for
+                          and with statements */
+
     int u_firstlineno; /* the first lineno of the block */
     int u_lineno;          /* the lineno for the current stmt */
     int u_col_offset;      /* the offset of the current stmt */
@@ -321,6 +328,9 @@ PyAST_CompileObject(mod_ty mod, PyObject *filename, PyCompilerFlags *flags,
     c.c_optimize = (optimize == -1) ? Py_OptimizeFlag : optimize;
     c.c_nestlevel = 0;
 
+    if (!_PyAST_Optimize(mod, arena, c.c_optimize))
+        goto finally;
+
     c.c_st = PySymtable_BuildObject(mod, filename, c.c_future);
     if (c.c_st == NULL) {
         if (!PyErr_Occurred())
@@ -859,6 +869,8 @@ int
 PyCompile_OpcodeStackEffect(int opcode, int oparg)
 {
     switch (opcode) {
+        case NOP:
+            return 0;
         case POP_TOP:
             return -1;
         case ROT_TWO:
@@ -931,6 +943,8 @@ PyCompile_OpcodeStackEffect(int opcode, int oparg)
             return 0;
         case SETUP_WITH:
             return 7;
+        case BEFORE_WITH:
+            return 1;
         case WITH_CLEANUP_START:
             return 1;
         case WITH_CLEANUP_FINISH:
@@ -1029,6 +1043,10 @@ PyCompile_OpcodeStackEffect(int opcode, int oparg)
 #define NARGS(o) (((o) % 256) + 2*(((o) / 256) % 256))
         case CALL_FUNCTION:
             return -NARGS(oparg);
+        case LOAD_METHOD:
+            return 1;
+        case CALL_METHOD:
+            return -oparg-1;
         case CALL_FUNCTION_VAR:
         case CALL_FUNCTION_KW:
             return -NARGS(oparg)-1;
@@ -1086,6 +1104,7 @@ compiler_addop(struct compiler *c, int opcode)
     b = c->u->u_curblock;
     i = &b->b_instr[off];
     i->i_opcode = opcode;
+    i->i_oparg = 0;
     i->i_hasarg = 0;
     if (opcode == RETURN_VALUE)
         b->b_return = 1;
@@ -1093,11 +1112,12 @@ compiler_addop(struct compiler *c, int opcode)
     return 1;
 }
 
-static Py_ssize_t
-compiler_add_o(struct compiler *c, PyObject *dict, PyObject *o)
+/* Return the key of o in the dicts of compiler_add_o(): a tuple whose first
+   item is o itself, followed by what is needed to tell apart objects which
+   compare equal but must not be merged. */
+static PyObject *
+const_key(PyObject *o)
 {
-    PyObject *t, *v;
-    Py_ssize_t arg;
     double d;
 
     /* necessary to make sure types aren't coerced (e.g., float and complex) */
@@ -1108,9 +1128,9 @@ compiler_add_o(struct compiler *c, PyObject *dict, PyObject *o)
          * or -0.0 case from all others, just to avoid the "coercion".
          */
         if (d == 0.0 && copysign(1.0, d) < 0.0)
-            t = PyTuple_Pack(3, o, o->ob_type, Py_None);
+            return PyTuple_Pack(3, o, o->ob_type, Py_None);
         else
-            t = PyTuple_Pack(2, o, o->ob_type);
+            return PyTuple_Pack(2, o, o->ob_type);
     }
     else if (PyComplex_Check(o)) {
         Py_complex z;
@@ -1123,22 +1143,74 @@ compiler_add_o(struct compiler *c, PyObject *dict, PyObject *o)
         real_negzero = z.real == 0.0 && copysign(1.0, z.real) < 0.0;
         imag_negzero = z.imag == 0.0 && copysign(1.0, z.imag) < 0.0;
         if (real_negzero && imag_negzero) {
-            t = PyTuple_Pack(5, o, o->ob_type,
-                             Py_None, Py_None, Py_None);
+            return PyTuple_Pack(5, o, o->ob_type,
+                                Py_None, Py_None, Py_None);
         }
         else if (imag_negzero) {
-            t = PyTuple_Pack(4, o, o->ob_type, Py_None, Py_None);
+            return PyTuple_Pack(4, o, o->ob_type, Py_None, Py_None);
         }
         else if (real_negzero) {
-            t = PyTuple_Pack(3, o, o->ob_type, Py_None);
+            return PyTuple_Pack(3, o, o->ob_type, Py_None);
+        }
+        else {
+            return PyTuple_Pack(2, o, o->ob_type);
+        }
+    }
+    else if (PyTuple_CheckExact(o) || PyFrozenSet_CheckExact(o)) {
+        /* Folded constants: (0.0,) and (-0.0,), or (1,) and (True,), must
+           stay apart too, so add the keys of the items. */
+        PyObject *keys, *it, *item, *key, *t;
+        int isset = PyFrozenSet_CheckExact(o);
+
+        keys = isset ? PySet_New(NULL) : PyList_New(0);
+        if (keys == NULL)
+            return NULL;
+        it = PyObject_GetIter(o);
+        if (it == NULL) {
+            Py_DECREF(keys);
+            return NULL;
+        }
+        while ((item = PyIter_Next(it)) != NULL) {
+            int err;
+            key = const_key(item);
+            Py_DECREF(item);
+            if (key == NULL)
+                break;
+            err = isset ? PySet_Add(keys, key) : PyList_Append(keys, key);
+            Py_DECREF(key);
+            if (err < 0)
+                break;
+        }
+        Py_DECREF(it);
+        if (PyErr_Occurred()) {
+            Py_DECREF(keys);
+            return NULL;
+        }
+        if (isset) {
+            t = PyFrozenSet_New(keys);
         }
         else {
-            t = PyTuple_Pack(2, o, o->ob_type);
+            t = PyList_AsTuple(keys);
         }
+        Py_DECREF(keys);
+        if (t == NULL)
+            return NULL;
+        key = PyTuple_Pack(3, o, o->ob_type, t);
+        Py_DECREF(t);
+        return key;
     }
     else {
-        t = PyTuple_Pack(2, o, o->ob_type);
+        return PyTuple_Pack(2, o, o->ob_type);
     }
+}
+
+static Py_ssize_t
+compiler_add_o(struct compiler *c, PyObject *dict, PyObject *o)
+{
+    PyObject *t, *v;
+    Py_ssize_t arg;
+
+    t = const_key(o);
     if (t == NULL)
         return -1;
 
@@ -1200,8 +1272,8 @@ compiler_addop_i(struct compiler *c, int opcode, Py_ssize_t oparg)
     struct instr *i;
     int off;
 
-    /* Integer arguments are limit to 16-bit. There is an extension for 32-bit
-       integer arguments. */
+    /* Integer arguments are limited to 8 bits.  EXTENDED_ARG prefixes
+       extend them to 32 bits. */
     assert((-2147483647-1) <= oparg);
     assert(oparg <= 2147483647);
 
@@ -1238,6 +1310,81 @@ compiler_addop_j(struct compiler *c, int opcode, basicblock *b, int absolute)
     return 1;
 }
 
+/* Set up a block for a try, with or loop statement.  Outside of handler
+   code, the block is not set up at run time: the instruction is kept in
+   the graph as a marker that emits no code, with the value stack level
+   of the block as its argument, and the assembler turns it and the
+   matching POP_BLOCK into an entry of co_exceptiontable.  A with
+   statement still needs BEFORE_WITH to call __enter__().
+
+   Handler code (except clauses and finally bodies) runs with an
+   EXCEPT_HANDLER block on the run-time block stack, which must stay
+   above any block set up within it, so those blocks are set up by the
+   usual instructions.
+*/
+
+static int
+compiler_setup_block(struct compiler *c, int opcode, basicblock *b)
+{
+    struct instr *i;
+    int level = c->u->u_stacklevel;
+    int lineno_set;
+
+    if (c->u->u_handlers)
+        return compiler_addop_j(c, opcode, b, 0);
+    if (opcode == SETUP_WITH) {
+        if (!compiler_addop(c, BEFORE_WITH))
+            return 0;
+        opcode = SETUP_FINALLY;
+        level++;
+    }
+    else if (opcode == SETUP_ASYNC_WITH) {
+        opcode = SETUP_FINALLY;
+        level++;
+    }
+    /* The marker must not take the line number of the statement from
+       the first instruction that is actually emitted. */
+    lineno_set = c->u->u_lineno_set;
+    if (!compiler_addop_j(c, opcode, b, 0))
+        return 0;
+    i = &c->u->u_curblock->b_instr[c->u->u_curblock->b_iused - 1];
+    i->i_static = 1;
+    i->i_oparg = level;
+    i->i_lineno = 0;
+    c->u->u_lineno_set = lineno_set;
+    return 1;
+}
+
+/* A statement whose block is only recorded in co_exceptiontable may have
+   no code before its body (try, while 1).  Emit a NOP to carry its line
+   number, which the peephole optimizer keeps, so it is still traced. */
+
+static int
+compiler_mark_line(struct compiler *c)
+{
+    if (c->u->u_handlers || c->u->u_lineno_set)
+        return 1;
+    return compiler_addop(c, NOP);
+}
+
+static int
+compiler_pop_block(struct compiler *c)
+{
+    struct instr *i;
+    int lineno_set;
+
+    if (c->u->u_handlers)
+        return compiler_addop(c, POP_BLOCK);
+    lineno_set = c->u->u_lineno_set;
+    if (!compiler_addop(c, POP_BLOCK))
+        return 0;
+    i = &c->u->u_curblock->b_instr[c->u->u_curblock->b_iused - 1];
+    i->i_static = 1;
+    i->i_lineno = 0;
+    c->u->u_lineno_set = lineno_set;
+    return 1;
+}
+
 /* The distinction between NEW_BLOCK and NEXT_BLOCK is subtle.  (I'd
    like to find better names.)  NEW_BLOCK() creates a new block and sets
    it as the current block.  NEXT_BLOCK() also creates an implicit jump
@@ -1296,6 +1443,16 @@ compiler_addop_j(struct compiler *c, int opcode, basicblock *b, int absolute)
         return 0; \
 }
 
+#define ADDOP_SETUP(C, OP, O) { \
+    if (!compiler_setup_block((C), (OP), (O))) \
+        return 0; \
+}
+
+#define ADDOP_POP_BLOCK(C) { \
+    if (!compiler_pop_block((C))) \
+        return 0; \
+}
+
 /* VISIT and VISIT_SEQ takes an ASDL type as their second argument.  They use
    the ASDL name to synthesize the name of the C type and the visit function.
 */
@@ -2018,18 +2175,20 @@ compiler_for(struct compiler *c, stmt_ty s)
     end = compiler_new_block(c);
     if (start == NULL || end == NULL || cleanup == NULL)
         return 0;
-    ADDOP_JREL(c, SETUP_LOOP, end);
+    ADDOP_SETUP(c, SETUP_LOOP, end);
     if (!compiler_push_fblock(c, LOOP, start))
         return 0;
     VISIT(c, expr, s->v.For.iter);
     ADDOP(c, GET_ITER);
     compiler_use_next_block(c, start);
     ADDOP_JREL(c, FOR_ITER, cleanup);
+    c->u->u_stacklevel++;
     VISIT(c, expr, s->v.For.target);
     VISIT_SEQ(c, stmt, s->v.For.body);
+    c->u->u_stacklevel--;
     ADDOP_JABS(c, JUMP_ABSOLUTE, start);
     compiler_use_next_block(c, cleanup);
-    ADDOP(c, POP_BLOCK);
+    ADDOP_POP_BLOCK(c);
     compiler_pop_fblock(c, LOOP, start);
     VISIT_SEQ(c, stmt, s->v.For.orelse);
     compiler_use_next_block(c, end);
@@ -2062,6 +2221,9 @@ compiler_async_for(struct compiler *c, stmt_ty s)
             || after_try == NULL || try_cleanup == NULL)
         return 0;
 
+    /* The handler for StopAsyncIteration pops the blocks of both the
+       loop and the try statement, so they are set up at run time. */
+    c->u->u_handlers++;
     ADDOP_JREL(c, SETUP_LOOP, after_loop);
     if (!compiler_push_fblock(c, LOOP, try))
         return 0;
@@ -2115,6 +2277,7 @@ compiler_async_for(struct compiler *c, stmt_ty s)
     ADDOP_JABS(c, JUMP_ABSOLUTE, end);
 
     compiler_use_next_block(c, after_loop_else);
+    c->u->u_handlers--;
     VISIT_SEQ(c, stmt, s->v.For.orelse);
 
     compiler_use_next_block(c, end);
@@ -2150,7 +2313,9 @@ compiler_while(struct compiler *c, stmt_ty s)
     else
         orelse = NULL;
 
-    ADDOP_JREL(c, SETUP_LOOP, end);
+    if (constant == 1 && !compiler_mark_line(c))
+        return 0;
+    ADDOP_SETUP(c, SETUP_LOOP, end);
     compiler_use_next_block(c, loop);
     if (!compiler_push_fblock(c, LOOP, loop))
         return 0;
@@ -2167,7 +2332,7 @@ compiler_while(struct compiler *c, stmt_ty s)
 
     if (constant == -1)
         compiler_use_next_block(c, anchor);
-    ADDOP(c, POP_BLOCK);
+    ADDOP_POP_BLOCK(c);
     compiler_pop_fblock(c, LOOP, loop);
     if (orelse != NULL) /* what if orelse is just pass? */
         VISIT_SEQ(c, stmt, s->v.While.orelse);
@@ -2241,6 +2406,11 @@ compiler_continue(struct compiler *c)
    onto the value stack (and the exception condition is cleared),
    and the interpreter jumps to the label gotten from the block
    stack.
+
+   Unless the statement is in handler code, SETUP_FINALLY and POP_BLOCK
+   are not actually emitted: the assembler records the block they delimit
+   in co_exceptiontable, and the interpreter only looks it up while
+   unwinding (see compiler_setup_block()).
 */
 
 static int
@@ -2252,7 +2422,9 @@ compiler_try_finally(struct compiler *c, stmt_ty s)
     if (body == NULL || end == NULL)
         return 0;
 
-    ADDOP_JREL(c, SETUP_FINALLY, end);
+    if (!compiler_mark_line(c))
+        return 0;
+    ADDOP_SETUP(c, SETUP_FINALLY, end);
     compiler_use_next_block(c, body);
     if (!compiler_push_fblock(c, FINALLY_TRY, body))
         return 0;
@@ -2263,15 +2435,17 @@ compiler_try_finally(struct compiler *c, stmt_ty s)
     else {
         VISIT_SEQ(c, stmt, s->v.Try.body);
     }
-    ADDOP(c, POP_BLOCK);
+    ADDOP_POP_BLOCK(c);
     compiler_pop_fblock(c, FINALLY_TRY, body);
 
     ADDOP_O(c, LOAD_CONST, Py_None, consts);
     compiler_use_next_block(c, end);
     if (!compiler_push_fblock(c, FINALLY_END, end))
         return 0;
+    c->u->u_handlers++;
     VISIT_SEQ(c, stmt, s->v.Try.finalbody);
     ADDOP(c, END_FINALLY);
+    c->u->u_handlers--;
     compiler_pop_fblock(c, FINALLY_END, end);
 
     return 1;
@@ -2320,16 +2494,19 @@ compiler_try_except(struct compiler *c, stmt_ty s)
     end = compiler_new_block(c);
     if (body == NULL || except == NULL || orelse == NULL || end == NULL)
         return 0;
-    ADDOP_JREL(c, SETUP_EXCEPT, except);
+    if (!compiler_mark_line(c))
+        return 0;
+    ADDOP_SETUP(c, SETUP_EXCEPT, except);
     compiler_use_next_block(c, body);
     if (!compiler_push_fblock(c, EXCEPT, body))
         return 0;
     VISIT_SEQ(c, stmt, s->v.Try.body);
-    ADDOP(c, POP_BLOCK);
+    ADDOP_POP_BLOCK(c);
     compiler_pop_fblock(c, EXCEPT, body);
     ADDOP_JREL(c, JUMP_FORWARD, orelse);
     n = asdl_seq_LEN(s->v.Try.handlers);
     compiler_use_next_block(c, except);
+    c->u->u_handlers++;
     for (i = 0; i < n; i++) {
         excepthandler_ty handler = (excepthandler_ty)asdl_seq_GET(
             s->v.Try.handlers, i);
@@ -2418,6 +2595,7 @@ compiler_try_except(struct compiler *c, stmt_ty s)
         compiler_use_next_block(c, except);
     }
     ADDOP(c, END_FINALLY);
+    c->u->u_handlers--;
     compiler_use_next_block(c, orelse);
     VISIT_SEQ(c, stmt, s->v.Try.orelse);
     compiler_use_next_block(c, end);
@@ -2711,7 +2889,8 @@ compiler_visit_stmt(struct compiler *c, stmt_ty s)
             ADDOP(c, PRINT_EXPR);
         }
         else if (s->v.Expr.value->kind != Str_kind &&
-                 s->v.Expr.value->kind != Num_kind) {
+                 s->v.Expr.value->kind != Num_kind &&
+                 s->v.Expr.value->kind != Constant_kind) {
             VISIT(c, expr, s->v.Expr.value);
             ADDOP(c, POP_TOP);
         }
@@ -3202,9 +3381,44 @@ compiler_compare(struct compiler *c, expr_ty e)
     return 1;
 }
 
+/* Compile obj.meth(args) as LOAD_METHOD/CALL_METHOD, which avoids
+   creating a bound method object.  Only plain positional calls qualify.
+   Return -1 if the call has to be compiled the usual way. */
+static int
+maybe_optimize_method_call(struct compiler *c, expr_ty e)
+{
+    Py_ssize_t argsl, i;
+    expr_ty meth = e->v.Call.func;
+    asdl_seq *args = e->v.Call.args;
+
+    if (meth->kind != Attribute_kind || meth->v.Attribute.ctx != Load ||
+            asdl_seq_LEN(e->v.Call.keywords))
+        return -1;
+
+    /* self takes one of the 255 positional argument slots of oparg */
+    argsl = asdl_seq_LEN(args);
+    if (argsl >= 255)
+        return -1;
+    for (i = 0; i < argsl; i++) {
+        expr_ty elt = asdl_seq_GET(args, i);
+        if (elt->kind == Starred_kind)
+            return -1;
+    }
+
+    VISIT(c, expr, meth->v.Attribute.value);
+    ADDOP_NAME(c, LOAD_METHOD, meth->v.Attribute.attr, names);
+    VISIT_SEQ(c, expr, args);
+    ADDOP_I(c, CALL_METHOD, argsl);
+    return 1;
+}
+
 static int
 compiler_call(struct compiler *c, expr_ty e)
 {
+    int ret = maybe_optimize_method_call(c, e);
+    if (ret >= 0)
+        return ret;
+
     VISIT(c, expr, e->v.Call.func);
     return compiler_call_helper(c, 0,
                                 e->v.Call.args,
@@ -3597,6 +3811,8 @@ expr_constant(struct compiler *c, expr_ty e)
         if (id && strcmp(id, "__debug__") == 0)
             return !c->c_optimize;
         return -1;
+    case Constant_kind:
+        return PyObject_IsTrue(e->v.Constant.value);
     case NameConstant_kind: {
         PyObject *o = e->v.NameConstant.value;
         if (o == Py_None)
@@ -3657,7 +3873,7 @@ compiler_async_with(struct compiler *c, stmt_ty s, int pos)
     ADDOP_O(c, LOAD_CONST, Py_None, consts);
     ADDOP(c, YIELD_FROM);
 
-    ADDOP_JREL(c, SETUP_ASYNC_WITH, finally);
+    ADDOP_SETUP(c, SETUP_ASYNC_WITH, finally);
 
     /* SETUP_ASYNC_WITH pushes a finally block. */
     compiler_use_next_block(c, block);
@@ -3665,6 +3881,7 @@ compiler_async_with(struct compiler *c, stmt_ty s, int pos)
         return 0;
     }
 
+    c->u->u_stacklevel++;
     if (item->optional_vars) {
         VISIT(c, expr, item->optional_vars);
     }
@@ -3679,9 +3896,10 @@ compiler_async_with(struct compiler *c, stmt_ty s, int pos)
         VISIT_SEQ(c, stmt, s->v.AsyncWith.body)
     else if (!compiler_async_with(c, s, pos))
             return 0;
+    c->u->u_stacklevel--;
 
     /* End of try block; start the finally block */
-    ADDOP(c, POP_BLOCK);
+    ADDOP_POP_BLOCK(c);
     compiler_pop_fblock(c, FINALLY_TRY, block);
 
     ADDOP_O(c, LOAD_CONST, Py_None, consts);
@@ -3745,7 +3963,7 @@ compiler_with(struct compiler *c, stmt_ty s, int pos)
 
     /* Evaluate EXPR */
     VISIT(c, expr, item->context_expr);
-    ADDOP_JREL(c, SETUP_WITH, finally);
+    ADDOP_SETUP(c, SETUP_WITH, finally);
 
     /* SETUP_WITH pushes a finally block. */
     compiler_use_next_block(c, block);
@@ -3753,6 +3971,7 @@ compiler_with(struct compiler *c, stmt_ty s, int pos)
         return 0;
     }
 
+    c->u->u_stacklevel++;
     if (item->optional_vars) {
         VISIT(c, expr, item->optional_vars);
     }
@@ -3767,9 +3986,10 @@ compiler_with(struct compiler *c, stmt_ty s, int pos)
         VISIT_SEQ(c, stmt, s->v.With.body)
     else if (!compiler_with(c, s, pos))
             return 0;
+    c->u->u_stacklevel--;
 
     /* End of try block; start the finally block */
-    ADDOP(c, POP_BLOCK);
+    ADDOP_POP_BLOCK(c);
     compiler_pop_fblock(c, FINALLY_TRY, block);
 
     ADDOP_O(c, LOAD_CONST, Py_None, consts);
@@ -3886,6 +4106,9 @@ compiler_visit_expr(struct compiler *c, expr_ty e)
     case NameConstant_kind:
         ADDOP_O(c, LOAD_CONST, e->v.NameConstant.value, consts);
         break;
+    case Constant_kind:
+        ADDOP_O(c, LOAD_CONST, e->v.Constant.value, consts);
+        break;
     /* The following exprs can be assignment targets. */
     case Attribute_kind:
         if (e->v.Attribute.ctx != AugStore)
@@ -4208,6 +4431,11 @@ struct assembler {
     int a_lnotab_off;      /* offset into lnotab */
     int a_lineno;              /* last lineno of emitted instruction */
     int a_lineno_off;      /* bytecode offset of last lineno */
+    _PyCodeBlock *a_blocks;    /* blocks of the exception table */
+    int a_nexcblocks;          /* number of entries in a_blocks */
+    int a_allocblocks;         /* number of entries allocated */
+    int a_open[CO_MAXBLOCKS];  /* indices in a_blocks of the open blocks */
+    int a_nopen;               /* number of entries in a_open */
 };
 
 static void
@@ -4328,29 +4556,23 @@ assemble_free(struct assembler *a)
     Py_XDECREF(a->a_lnotab);
     if (a->a_postorder)
         PyObject_Free(a->a_postorder);
+    if (a->a_blocks)
+        PyObject_Free(a->a_blocks);
 }
 
 /* Return the size of a basic block in bytes. */
 
-static int
-instrsize(struct instr *instr)
-{
-    if (!instr->i_hasarg)
-        return 1;               /* 1 byte for the opcode*/
-    if (instr->i_oparg > 0xffff)
-        return 6;               /* 1 (opcode) + 1 (EXTENDED_ARG opcode) + 2 (oparg) + 2(oparg extended) */
-    return 3;                   /* 1 (opcode) + 2 (oparg) */
-}
-
 static int
 blocksize(basicblock *b)
 {
     int i;
     int size = 0;
 
-    for (i = 0; i < b->b_iused; i++)
-        size += instrsize(&b->b_instr[i]);
-    return size;
+    for (i = 0; i < b->b_iused; i++) {
+        if (!b->b_instr[i].i_static)
+            size += instrsize(b->b_instr[i].i_oparg);
+    }
+    return size * sizeof(_Py_CODEUNIT);
 }
 
 /* Appends a pair to the end of the line number table, a_lnotab, representing
@@ -4455,41 +4677,69 @@ assemble_lnotab(struct assembler *a, struct instr *i)
    Update lnotab if necessary.
 */
 
+/* Record the block of a static SETUP_* instruction in the exception table,
+   or close the innermost open block at a static POP_BLOCK. */
+
+static int
+assemble_block(struct assembler *a, struct instr *i)
+{
+    _PyCodeBlock *b;
+
+    if (i->i_opcode == POP_BLOCK) {
+        assert(a->a_nopen > 0);
+        a->a_blocks[a->a_open[--a->a_nopen]].cb_end = a->a_offset;
+        return 1;
+    }
+    if (a->a_nexcblocks >= a->a_allocblocks) {
+        int n = a->a_allocblocks ? a->a_allocblocks * 2 : 8;
+        _PyCodeBlock *tmp;
+        if ((size_t)n > PY_SIZE_MAX / sizeof(_PyCodeBlock)) {
+            PyErr_NoMemory();
+            return 0;
+        }
+        tmp = (_PyCodeBlock *)PyObject_Realloc(a->a_blocks,
+                                               n * sizeof(_PyCodeBlock));
+        if (tmp == NULL) {
+            PyErr_NoMemory();
+            return 0;
+        }
+        a->a_blocks = tmp;
+        a->a_allocblocks = n;
+    }
+    assert(a->a_nopen < CO_MAXBLOCKS);
+    a->a_open[a->a_nopen++] = a->a_nexcblocks;
+    b = &a->a_blocks[a->a_nexcblocks++];
+    b->cb_start = a->a_offset;
+    b->cb_end = a->a_offset;
+    b->cb_type = i->i_opcode;
+    b->cb_handler = i->i_target->b_offset;
+    b->cb_level = i->i_oparg;
+    return 1;
+}
+
 static int
 assemble_emit(struct assembler *a, struct instr *i)
 {
-    int size, arg = 0, ext = 0;
+    int size;
+    unsigned int arg = i->i_oparg;
     Py_ssize_t len = PyBytes_GET_SIZE(a->a_bytecode);
-    char *code;
+    _Py_CODEUNIT *code;
 
-    size = instrsize(i);
-    if (i->i_hasarg) {
-        arg = i->i_oparg;
-        ext = arg >> 16;
-    }
+    if (i->i_static)
+        return assemble_block(a, i);
+    size = instrsize(arg);
     if (i->i_lineno && !assemble_lnotab(a, i))
         return 0;
-    if (a->a_offset + size >= len) {
+    if (a->a_offset + size * (Py_ssize_t)sizeof(_Py_CODEUNIT) >= len) {
         if (len > PY_SSIZE_T_MAX / 2)
             return 0;
         if (_PyBytes_Resize(&a->a_bytecode, len * 2) < 0)
             return 0;
     }
-    code = PyBytes_AS_STRING(a->a_bytecode) + a->a_offset;
-    a->a_offset += size;
-    if (size == 6) {
-        assert(i->i_hasarg);
-        *code++ = (char)EXTENDED_ARG;
-        *code++ = ext & 0xff;
-        *code++ = ext >> 8;
-        arg &= 0xffff;
-    }
-    *code++ = i->i_opcode;
-    if (i->i_hasarg) {
-        assert(size == 3 || size == 6);
-        *code++ = arg & 0xff;
-        *code++ = arg >> 8;
-    }
+    code = (_Py_CODEUNIT *)PyBytes_AS_STRING(a->a_bytecode) +
+        a->a_offset / sizeof(_Py_CODEUNIT);
+    a->a_offset += size * sizeof(_Py_CODEUNIT);
+    write_op_arg(code, i->i_opcode, arg, size);
     return 1;
 }
 
@@ -4497,7 +4747,7 @@ static void
 assemble_jump_offsets(struct assembler *a, struct compiler *c)
 {
     basicblock *b;
-    int bsize, totsize, extended_arg_count = 0, last_extended_arg_count;
+    int bsize, totsize, extended_arg_recompile;
     int i;
 
     /* Compute the size of each block and fixup jump args.
@@ -4510,45 +4760,39 @@ assemble_jump_offsets(struct assembler *a, struct compiler *c)
             b->b_offset = totsize;
             totsize += bsize;
         }
-        last_extended_arg_count = extended_arg_count;
-        extended_arg_count = 0;
+        extended_arg_recompile = 0;
         for (b = c->u->u_blocks; b != NULL; b = b->b_list) {
             bsize = b->b_offset;
             for (i = 0; i < b->b_iused; i++) {
                 struct instr *instr = &b->b_instr[i];
+                int isize;
+                /* Static blocks keep their stack level as argument. */
+                if (instr->i_static)
+                    continue;
+                isize = instrsize(instr->i_oparg);
                 /* Relative jumps are computed relative to
                    the instruction pointer after fetching
                    the jump instruction.
                 */
-                bsize += instrsize(instr);
+                bsize += isize * sizeof(_Py_CODEUNIT);
                 if (instr->i_jabs)
                     instr->i_oparg = instr->i_target->b_offset;
-                else if (instr->i_jrel) {
-                    int delta = instr->i_target->b_offset - bsize;
-                    instr->i_oparg = delta;
-                }
+                else if (instr->i_jrel)
+                    instr->i_oparg = instr->i_target->b_offset - bsize;
                 else
                     continue;
-                if (instr->i_oparg > 0xffff)
-                    extended_arg_count++;
+                if (instrsize(instr->i_oparg) != isize)
+                    extended_arg_recompile = 1;
             }
         }
 
-    /* XXX: This is an awful hack that could hurt performance, but
-        on the bright side it should work until we come up
-        with a better solution.
-
-        The issue is that in the first loop blocksize() is called
-        which calls instrsize() which requires i_oparg be set
-        appropriately.          There is a bootstrap problem because
-        i_oparg is calculated in the second loop above.
-
-        So we loop until we stop seeing new EXTENDED_ARGs.
-        The only EXTENDED_ARGs that could be popping up are
-        ones in jump instructions.  So this should converge
-        fairly quickly.
+    /* The sizes of the blocks computed in the first loop depend on the
+       jump arguments, which are only set in the second loop.  So loop
+       until no jump needs a different number of EXTENDED_ARG prefixes
+       than the size it was given.  Only jumps can change size, so this
+       converges quickly.
     */
-    } while (last_extended_arg_count != extended_arg_count);
+    } while (extended_arg_recompile);
 }
 
 static PyObject *
@@ -4621,6 +4865,7 @@ makecode(struct compiler *c, struct assembler *a)
     PyObject *freevars = NULL;
     PyObject *cellvars = NULL;
     PyObject *bytecode = NULL;
+    PyObject *exceptiontable = NULL;
     Py_ssize_t nlocals;
     int nlocals_int;
     int flags;
@@ -4652,9 +4897,14 @@ makecode(struct compiler *c, struct assembler *a)
     if (flags < 0)
         goto error;
 
-    bytecode = PyCode_Optimize(a->a_bytecode, consts, names, a->a_lnotab);
+    bytecode = _PyCode_Optimize(a->a_bytecode, consts, names, a->a_lnotab,
+                                a->a_blocks, a->a_nexcblocks);
     if (!bytecode)
         goto error;
+    exceptiontable = _PyCode_MakeExceptionTable(a->a_blocks,
+                                                a->a_nexcblocks);
+    if (!exceptiontable)
+        goto error;
 
     tmp = PyList_AsTuple(consts); /* PyCode_New requires a tuple */
     if (!tmp)
@@ -4671,6 +4921,11 @@ makecode(struct compiler *c, struct assembler *a)
                     c->c_filename, c->u->u_name,
                     c->u->u_firstlineno,
                     a->a_lnotab);
+    if (co != NULL) {
+        Py_DECREF(co->co_exceptiontable);
+        co->co_exceptiontable = exceptiontable;
+        exceptiontable = NULL;
+    }
  error:
     Py_XDECREF(consts);
     Py_XDECREF(names);
@@ -4679,6 +4934,7 @@ makecode(struct compiler *c, struct assembler *a)
     Py_XDECREF(freevars);
     Py_XDECREF(cellvars);
     Py_XDECREF(bytecode);
+    Py_XDECREF(exceptiontable);
     return co;
 }
 
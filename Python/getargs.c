@@ -22,8 +22,13 @@ int PyArg_VaParseTupleAndKeywords(PyObject *, PyObject *,
 /* Export functions */
 PyAPI_FUNC(int) _PyArg_Parse_SizeT(PyObject *, char *, ...);
 PyAPI_FUNC(int) _PyArg_ParseTuple_SizeT(PyObject *, char *, ...);
+PyAPI_FUNC(int) _PyArg_ParseStack_SizeT(PyObject *const *, Py_ssize_t,
+                                        const char *, ...);
 PyAPI_FUNC(int) _PyArg_ParseTupleAndKeywords_SizeT(PyObject *, PyObject *,
                                                   const char *, char **, ...);
+PyAPI_FUNC(int) _PyArg_ParseStackAndKeywords_SizeT(PyObject *const *,
+                                                   Py_ssize_t, PyObject *,
+                                                   const char *, char **, ...);
 PyAPI_FUNC(PyObject *) _Py_BuildValue_SizeT(const char *, ...);
 PyAPI_FUNC(int) _PyArg_VaParse_SizeT(PyObject *, char *, va_list);
 PyAPI_FUNC(int) _PyArg_VaParseTupleAndKeywords_SizeT(PyObject *, PyObject *,
@@ -54,6 +59,8 @@ typedef struct {
 #define STATIC_FREELIST_ENTRIES 8
 
 /* Forward */
+static int vgetargs1_impl(PyObject *, PyObject *const *, Py_ssize_t,
+                          const char *, va_list *, int);
 static int vgetargs1(PyObject *, const char *, va_list *, int);
 static void seterror(Py_ssize_t, const char *, int *, const char *, const char *);
 static char *convertitem(PyObject *, const char **, va_list *, int, int *,
@@ -65,6 +72,9 @@ static char *convertsimple(PyObject *, const char **, va_list *, int, char *,
 static Py_ssize_t convertbuffer(PyObject *, void **p, char **);
 static int getbuffer(PyObject *, Py_buffer *, char**);
 
+static int vgetargskeywords_impl(PyObject *const *, Py_ssize_t, PyObject *,
+                                 PyObject *, const char *, char **,
+                                 va_list *, int);
 static int vgetargskeywords(PyObject *, PyObject *,
                             const char *, char **, va_list *, int);
 static char *skipitem(const char **, va_list *, int);
@@ -119,6 +129,35 @@ _PyArg_ParseTuple_SizeT(PyObject *args, char *format, ...)
 }
 
 
+/* Like PyArg_ParseTuple(), but parse the nargs positional arguments
+   found at args instead of a tuple (METH_FASTCALL functions). */
+int
+_PyArg_ParseStack(PyObject *const *args, Py_ssize_t nargs,
+                  const char *format, ...)
+{
+    int retval;
+    va_list va;
+
+    va_start(va, format);
+    retval = vgetargs1_impl(NULL, args, nargs, format, &va, 0);
+    va_end(va);
+    return retval;
+}
+
+int
+_PyArg_ParseStack_SizeT(PyObject *const *args, Py_ssize_t nargs,
+                        const char *format, ...)
+{
+    int retval;
+    va_list va;
+
+    va_start(va, format);
+    retval = vgetargs1_impl(NULL, args, nargs, format, &va, FLAG_SIZE_T);
+    va_end(va);
+    return retval;
+}
+
+
 int
 PyArg_VaParse(PyObject *args, const char *format, va_list va)
 {
@@ -196,7 +235,9 @@ cleanreturn(int retval, freelist_t *freelist)
 
 
 static int
-vgetargs1(PyObject *args, const char *format, va_list *p_va, int flags)
+vgetargs1_impl(PyObject *compat_args, PyObject *const *stack,
+               Py_ssize_t nargs, const char *format, va_list *p_va,
+               int flags)
 {
     char msgbuf[256];
     int levels[32];
@@ -207,7 +248,7 @@ vgetargs1(PyObject *args, const char *format, va_list *p_va, int flags)
     int level = 0;
     int endfmt = 0;
     const char *formatsave = format;
-    Py_ssize_t i, len;
+    Py_ssize_t i;
     char *msg;
     int compat = flags & FLAG_COMPAT;
     freelistentry_t static_entries[STATIC_FREELIST_ENTRIES];
@@ -217,7 +258,7 @@ vgetargs1(PyObject *args, const char *format, va_list *p_va, int flags)
     freelist.first_available = 0;
     freelist.entries_malloced = 0;
 
-    assert(compat || (args != (PyObject*)NULL));
+    assert(nargs == 0 || stack != NULL);
     flags = flags & ~FLAG_COMPAT;
 
     while (endfmt == 0) {
@@ -281,7 +322,7 @@ vgetargs1(PyObject *args, const char *format, va_list *p_va, int flags)
 
     if (compat) {
         if (max == 0) {
-            if (args == NULL)
+            if (compat_args == NULL)
                 return 1;
             PyErr_Format(PyExc_TypeError,
                          "%.200s%s takes no arguments",
@@ -290,14 +331,14 @@ vgetargs1(PyObject *args, const char *format, va_list *p_va, int flags)
             return cleanreturn(0, &freelist);
         }
         else if (min == 1 && max == 1) {
-            if (args == NULL) {
+            if (compat_args == NULL) {
                 PyErr_Format(PyExc_TypeError,
                              "%.200s%s takes at least one argument",
                              fname==NULL ? "function" : fname,
                              fname==NULL ? "" : "()");
                 return cleanreturn(0, &freelist);
             }
-            msg = convertitem(args, &format, p_va, flags, levels,
+            msg = convertitem(compat_args, &format, p_va, flags, levels,
                               msgbuf, sizeof(msgbuf), &freelist);
             if (msg == NULL)
                 return cleanreturn(1, &freelist);
@@ -311,34 +352,26 @@ vgetargs1(PyObject *args, const char *format, va_list *p_va, int flags)
         }
     }
 
-    if (!PyTuple_Check(args)) {
-        PyErr_SetString(PyExc_SystemError,
-            "new style getargs format but argument is not a tuple");
-        return cleanreturn(0, &freelist);
-    }
-
-    len = PyTuple_GET_SIZE(args);
-
-    if (len < min || max < len) {
+    if (nargs < min || max < nargs) {
         if (message == NULL)
             PyErr_Format(PyExc_TypeError,
                          "%.150s%s takes %s %d argument%s (%ld given)",
                          fname==NULL ? "function" : fname,
                          fname==NULL ? "" : "()",
                          min==max ? "exactly"
-                         : len < min ? "at least" : "at most",
-                         len < min ? min : max,
-                         (len < min ? min : max) == 1 ? "" : "s",
-                         Py_SAFE_DOWNCAST(len, Py_ssize_t, long));
+                         : nargs < min ? "at least" : "at most",
+                         nargs < min ? min : max,
+                         (nargs < min ? min : max) == 1 ? "" : "s",
+                         Py_SAFE_DOWNCAST(nargs, Py_ssize_t, long));
         else
             PyErr_SetString(PyExc_TypeError, message);
         return cleanreturn(0, &freelist);
     }
 
-    for (i = 0; i < len; i++) {
+    for (i = 0; i < nargs; i++) {
         if (*format == '|')
             format++;
-        msg = convertitem(PyTuple_GET_ITEM(args, i), &format, p_va,
+        msg = convertitem(stack[i], &format, p_va,
                           flags, levels, msgbuf,
                           sizeof(msgbuf), &freelist);
         if (msg) {
@@ -358,6 +391,22 @@ vgetargs1(PyObject *args, const char *format, va_list *p_va, int flags)
     return cleanreturn(1, &freelist);
 }
 
+static int
+vgetargs1(PyObject *args, const char *format, va_list *p_va, int flags)
+{
+    if (!(flags & FLAG_COMPAT)) {
+        assert(args != NULL);
+
+        if (!PyTuple_Check(args)) {
+            PyErr_SetString(PyExc_SystemError,
+                "new style getargs format but argument is not a tuple");
+            return 0;
+        }
+        return vgetargs1_impl(NULL, &PyTuple_GET_ITEM(args, 0),
+                              PyTuple_GET_SIZE(args), format, p_va, flags);
+    }
+    return vgetargs1_impl(args, NULL, 0, format, p_va, flags);
+}
 
 
 static void
@@ -1365,6 +1414,58 @@ _PyArg_ParseTupleAndKeywords_SizeT(PyObject *args,
 }
 
 
+/* Like PyArg_ParseTupleAndKeywords(), but for METH_FASTCALL functions:
+   the nargs positional arguments are found at args, followed by the
+   values of the keyword arguments named by the kwnames tuple. */
+int
+_PyArg_ParseStackAndKeywords(PyObject *const *args, Py_ssize_t nargs,
+                             PyObject *kwnames, const char *format,
+                             char **kwlist, ...)
+{
+    int retval;
+    va_list va;
+
+    if ((args == NULL && nargs != 0) ||
+        (kwnames != NULL && !PyTuple_Check(kwnames)) ||
+        format == NULL ||
+        kwlist == NULL)
+    {
+        PyErr_BadInternalCall();
+        return 0;
+    }
+
+    va_start(va, kwlist);
+    retval = vgetargskeywords_impl(args, nargs, NULL, kwnames, format,
+                                   kwlist, &va, 0);
+    va_end(va);
+    return retval;
+}
+
+int
+_PyArg_ParseStackAndKeywords_SizeT(PyObject *const *args, Py_ssize_t nargs,
+                                   PyObject *kwnames, const char *format,
+                                   char **kwlist, ...)
+{
+    int retval;
+    va_list va;
+
+    if ((args == NULL && nargs != 0) ||
+        (kwnames != NULL && !PyTuple_Check(kwnames)) ||
+        format == NULL ||
+        kwlist == NULL)
+    {
+        PyErr_BadInternalCall();
+        return 0;
+    }
+
+    va_start(va, kwlist);
+    retval = vgetargskeywords_impl(args, nargs, NULL, kwnames, format,
+                                   kwlist, &va, FLAG_SIZE_T);
+    va_end(va);
+    return retval;
+}
+
+
 int
 PyArg_VaParseTupleAndKeywords(PyObject *args,
                               PyObject *keywords,
@@ -1434,6 +1535,42 @@ PyArg_ValidateKeywordArguments(PyObject *kwargs)
 static int
 vgetargskeywords(PyObject *args, PyObject *keywords, const char *format,
                  char **kwlist, va_list *p_va, int flags)
+{
+    assert(args != NULL && PyTuple_Check(args));
+    assert(keywords == NULL || PyDict_Check(keywords));
+
+    return vgetargskeywords_impl(&PyTuple_GET_ITEM(args, 0),
+                                 PyTuple_GET_SIZE(args), keywords, NULL,
+                                 format, kwlist, p_va, flags);
+}
+
+/* Return the value of the keyword argument key from the kwnames tuple,
+   the values being stored at kwstack, or NULL if it was not given. */
+static PyObject *
+find_keyword(PyObject *kwnames, PyObject *const *kwstack, const char *key)
+{
+    Py_ssize_t i, nkwargs;
+
+    nkwargs = PyTuple_GET_SIZE(kwnames);
+    for (i = 0; i < nkwargs; i++) {
+        PyObject *kwname = PyTuple_GET_ITEM(kwnames, i);
+
+        if (PyUnicode_Check(kwname) &&
+            !PyUnicode_CompareWithASCIIString(kwname, key))
+            return kwstack[i];
+    }
+    return NULL;
+}
+
+/* Parse the nargs positional arguments at args, and the keyword
+   arguments given either as the keywords dict or as the kwnames tuple
+   whose values follow the positional arguments (at most one of them is
+   non-NULL). */
+static int
+vgetargskeywords_impl(PyObject *const *args, Py_ssize_t nargs,
+                      PyObject *keywords, PyObject *kwnames,
+                      const char *format, char **kwlist, va_list *p_va,
+                      int flags)
 {
     char msgbuf[512];
     int levels[32];
@@ -1441,8 +1578,9 @@ vgetargskeywords(PyObject *args, PyObject *keywords, const char *format,
     int min = INT_MAX;
     int max = INT_MAX;
     int i, len;
-    Py_ssize_t nargs, nkeywords;
+    Py_ssize_t nkeywords;
     PyObject *current_arg;
+    PyObject *const *kwstack = args + nargs;
     freelistentry_t static_entries[STATIC_FREELIST_ENTRIES];
     freelist_t freelist;
 
@@ -1450,8 +1588,9 @@ vgetargskeywords(PyObject *args, PyObject *keywords, const char *format,
     freelist.first_available = 0;
     freelist.entries_malloced = 0;
 
-    assert(args != NULL && PyTuple_Check(args));
     assert(keywords == NULL || PyDict_Check(keywords));
+    assert(kwnames == NULL || PyTuple_Check(kwnames));
+    assert(keywords == NULL || kwnames == NULL);
     assert(format != NULL);
     assert(kwlist != NULL);
     assert(p_va != NULL);
@@ -1481,8 +1620,12 @@ vgetargskeywords(PyObject *args, PyObject *keywords, const char *format,
         freelist.entries_malloced = 1;
     }
 
-    nargs = PyTuple_GET_SIZE(args);
-    nkeywords = (keywords == NULL) ? 0 : PyDict_Size(keywords);
+    if (keywords != NULL)
+        nkeywords = PyDict_Size(keywords);
+    else if (kwnames != NULL)
+        nkeywords = PyTuple_GET_SIZE(kwnames);
+    else
+        nkeywords = 0;
     if (nargs + nkeywords > len) {
         PyErr_Format(PyExc_TypeError,
                      "%s%s takes at most %d argument%s (%zd given)",
@@ -1540,7 +1683,10 @@ vgetargskeywords(PyObject *args, PyObject *keywords, const char *format,
         }
         current_arg = NULL;
         if (nkeywords) {
-            current_arg = PyDict_GetItemString(keywords, keyword);
+            if (keywords != NULL)
+                current_arg = PyDict_GetItemString(keywords, keyword);
+            else
+                current_arg = find_keyword(kwnames, kwstack, keyword);
         }
         if (current_arg) {
             --nkeywords;
@@ -1556,7 +1702,7 @@ vgetargskeywords(PyObject *args, PyObject *keywords, const char *format,
         else if (nkeywords && PyErr_Occurred())
             return cleanreturn(0, &freelist);
         else if (i < nargs)
-            current_arg = PyTuple_GET_ITEM(args, i);
+            current_arg = args[i];
 
         if (current_arg) {
             msg = convertitem(current_arg, &format, p_va, flags,
@@ -1602,8 +1748,12 @@ vgetargskeywords(PyObject *args, PyObject *keywords, const char *format,
     if (nkeywords > 0) {
         PyObject *key, *value;
         Py_ssize_t pos = 0;
-        while (PyDict_Next(keywords, &pos, &key, &value)) {
+        while (keywords != NULL ?
+               PyDict_Next(keywords, &pos, &key, &value) :
+               pos < PyTuple_GET_SIZE(kwnames)) {
             int match = 0;
+            if (keywords == NULL)
+                key = PyTuple_GET_ITEM(kwnames, pos++);
             if (!PyUnicode_Check(key)) {
                 PyErr_SetString(PyExc_TypeError,
                                 "keywords must be strings");
@@ -1751,28 +1901,16 @@ err:
 }
 
 
-int
-PyArg_UnpackTuple(PyObject *args, const char *name, Py_ssize_t min, Py_ssize_t max, ...)
+static int
+unpack_stack(PyObject *const *args, Py_ssize_t l, const char *name,
+             Py_ssize_t min, Py_ssize_t max, va_list vargs)
 {
-    Py_ssize_t i, l;
+    Py_ssize_t i;
     PyObject **o;
-    va_list vargs;
-
-#ifdef HAVE_STDARG_PROTOTYPES
-    va_start(vargs, max);
-#else
-    va_start(vargs);
-#endif
 
     assert(min >= 0);
     assert(min <= max);
-    if (!PyTuple_Check(args)) {
-        va_end(vargs);
-        PyErr_SetString(PyExc_SystemError,
-            "PyArg_UnpackTuple() argument list is not a tuple");
-        return 0;
-    }
-    l = PyTuple_GET_SIZE(args);
+
     if (l < min) {
         if (name != NULL)
             PyErr_Format(
@@ -1785,7 +1923,6 @@ PyArg_UnpackTuple(PyObject *args, const char *name, Py_ssize_t min, Py_ssize_t m
                 "unpacked tuple should have %s%zd elements,"
                 " but has %zd",
                 (min == max ? "" : "at least "), min, l);
-        va_end(vargs);
         return 0;
     }
     if (l > max) {
@@ -1800,17 +1937,57 @@ PyArg_UnpackTuple(PyObject *args, const char *name, Py_ssize_t min, Py_ssize_t m
                 "unpacked tuple should have %s%zd elements,"
                 " but has %zd",
                 (min == max ? "" : "at most "), max, l);
-        va_end(vargs);
         return 0;
     }
     for (i = 0; i < l; i++) {
         o = va_arg(vargs, PyObject **);
-        *o = PyTuple_GET_ITEM(args, i);
+        *o = args[i];
     }
-    va_end(vargs);
     return 1;
 }
 
+int
+PyArg_UnpackTuple(PyObject *args, const char *name, Py_ssize_t min, Py_ssize_t max, ...)
+{
+    int retval;
+    va_list vargs;
+
+    if (!PyTuple_Check(args)) {
+        PyErr_SetString(PyExc_SystemError,
+            "PyArg_UnpackTuple() argument list is not a tuple");
+        return 0;
+    }
+
+#ifdef HAVE_STDARG_PROTOTYPES
+    va_start(vargs, max);
+#else
+    va_start(vargs);
+#endif
+    retval = unpack_stack(&PyTuple_GET_ITEM(args, 0), PyTuple_GET_SIZE(args),
+                          name, min, max, vargs);
+    va_end(vargs);
+    return retval;
+}
+
+/* Like PyArg_UnpackTuple(), but for the nargs positional arguments of a
+   METH_FASTCALL function. */
+int
+_PyArg_UnpackStack(PyObject *const *args, Py_ssize_t nargs, const char *name,
+                   Py_ssize_t min, Py_ssize_t max, ...)
+{
+    int retval;
+    va_list vargs;
+
+#ifdef HAVE_STDARG_PROTOTYPES
+    va_start(vargs, max);
+#else
+    va_start(vargs);
+#endif
+    retval = unpack_stack(args, nargs, name, min, max, vargs);
+    va_end(vargs);
+    return retval;
+}
+
 
 /* For type constructors that don't take keyword args
  *
@@ -1835,6 +2012,27 @@ _PyArg_NoKeywords(const char *funcname, PyObject *kw)
 }
 
 
+/* Likewise for METH_FASTCALL functions: kwnames is the tuple of keyword
+   argument names passed along with the arguments, or NULL.  The message
+   is the one PyCFunction_Call() gives for other calling conventions. */
+int
+_PyArg_NoStackKeywords(const char *funcname, PyObject *kwnames)
+{
+    if (kwnames == NULL)
+        return 1;
+    if (!PyTuple_CheckExact(kwnames)) {
+        PyErr_BadInternalCall();
+        return 0;
+    }
+    if (PyTuple_GET_SIZE(kwnames) == 0)
+        return 1;
+
+    PyErr_Format(PyExc_TypeError, "%.200s() takes no keyword arguments",
+                 funcname);
+    return 0;
+}
+
+
 int
 _PyArg_NoPositional(const char *funcname, PyObject *args)
 {
@@ -547,6 +547,7 @@ w_complex_object(PyObject *v, char flag, WFILE *p)
         w_object(co->co_name, p);
         w_long(co->co_firstlineno, p);
         w_object(co->co_lnotab, p);
+        w_object(co->co_exceptiontable, p);
     }
     else if (PyObject_CheckBuffer(v)) {
         /* Write unknown bytes-like objects as a byte string */
@@ -1318,6 +1319,7 @@ r_object(RFILE *p)
             PyObject *name = NULL;
             int firstlineno;
             PyObject *lnotab = NULL;
+            PyObject *exceptiontable = NULL;
 
             idx = r_ref_reserve(flag, p);
             if (idx < 0)
@@ -1383,6 +1385,14 @@ r_object(RFILE *p)
             lnotab = r_object(p);
             if (lnotab == NULL)
                 goto code_error;
+            exceptiontable = r_object(p);
+            if (exceptiontable == NULL)
+                goto code_error;
+            if (!PyBytes_Check(exceptiontable)) {
+                PyErr_SetString(PyExc_ValueError,
+                    "bad marshal data (exception table)");
+                goto code_error;
+            }
 
             v = (PyObject *) PyCode_New(
                             argcount, kwonlyargcount,
@@ -1390,6 +1400,12 @@ r_object(RFILE *p)
                             code, consts, names, varnames,
                             freevars, cellvars, filename, name,
                             firstlineno, lnotab);
+            if (v != NULL) {
+                PyCodeObject *co = (PyCodeObject *)v;
+                Py_DECREF(co->co_exceptiontable);
+                Py_INCREF(exceptiontable);
+                co->co_exceptiontable = exceptiontable;
+            }
             v = r_ref_insert(v, idx, flag, p);
 
           code_error:
@@ -1402,6 +1418,7 @@ r_object(RFILE *p)
             Py_XDECREF(filename);
             Py_XDECREF(name);
             Py_XDECREF(lnotab);
+            Py_XDECREF(exceptiontable);
         }
         retval = v;
         break;
@@ -52,7 +52,7 @@ static void *opcode_targets[256] = {
     &&TARGET_GET_AITER,
     &&TARGET_GET_ANEXT,
     &&TARGET_BEFORE_ASYNC_WITH,
-    &&_unknown_opcode,
+    &&TARGET_BEFORE_WITH,
     &&_unknown_opcode,
     &&TARGET_INPLACE_ADD,
     &&TARGET_INPLACE_SUBTRACT,
@@ -159,6 +159,8 @@ static void *opcode_targets[256] = {
     &&_unknown_opcode,
     &&_unknown_opcode,
     &&_unknown_opcode,
+    &&TARGET_LOAD_METHOD,
+    &&TARGET_CALL_METHOD,
     &&_unknown_opcode,
     &&_unknown_opcode,
     &&_unknown_opcode,
@@ -197,17 +199,15 @@ static void *opcode_targets[256] = {
     &&_unknown_opcode,
     &&_unknown_opcode,
     &&_unknown_opcode,
-    &&_unknown_opcode,
-    &&_unknown_opcode,
-    &&_unknown_opcode,
-    &&_unknown_opcode,
-    &&_unknown_opcode,
-    &&_unknown_opcode,
-    &&_unknown_opcode,
-    &&_unknown_opcode,
-    &&_unknown_opcode,
-    &&_unknown_opcode,
-    &&_unknown_opcode,
+    &&TARGET_BINARY_ADD_INT,
+    &&TARGET_BINARY_ADD_FLOAT,
+    &&TARGET_BINARY_SUBTRACT_INT,
+    &&TARGET_BINARY_SUBTRACT_FLOAT,
+    &&TARGET_BINARY_MULTIPLY_FLOAT,
+    &&TARGET_BINARY_SUBSCR_LIST_INT,
+    &&TARGET_COMPARE_OP_INT,
+    &&TARGET_COMPARE_OP_FLOAT,
+    &&TARGET_COMPARE_OP_STR,
     &&_unknown_opcode,
     &&_unknown_opcode,
     &&_unknown_opcode,
@@ -316,6 +316,7 @@ _Py_InitializeEx_Private(int install_sigs, int install_importlib)
         Py_HashRandomizationFlag = add_flag(Py_HashRandomizationFlag, p);
 
     _PyRandom_Init();
+    _PyGC_Init();
 
     interp = PyInterpreterState_New();
     if (interp == NULL)
@@ -1025,7 +1025,11 @@ Py_CompileStringObject(const char *str, PyObject *filename, int start,
         return NULL;
     }
     if (flags && (flags->cf_flags & PyCF_ONLY_AST)) {
-        PyObject *result = PyAST_mod2obj(mod);
+        PyObject *result = NULL;
+        if ((flags->cf_flags & PyCF_OPTIMIZED_AST) != PyCF_OPTIMIZED_AST ||
+            _PyAST_Optimize(mod, arena, optimize == -1 ?
+                            Py_OptimizeFlag : optimize))
+            result = PyAST_mod2obj(mod);
         PyArena_Free(arena);
         return result;
     }
@@ -1069,7 +1073,8 @@ Py_SymtableStringObject(const char *str, PyObject *filename, int start)
 
     flags.cf_flags = 0;
     mod = PyParser_ASTFromStringObject(str, filename, start, &flags, arena);
-    if (mod == NULL) {
+    /* Like the compiler, build the table from the optimized AST */
+    if (mod == NULL || !_PyAST_Optimize(mod, arena, Py_OptimizeFlag)) {
         PyArena_Free(arena);
         return NULL;
     }
@@ -1444,6 +1444,7 @@ symtable_visit_expr(struct symtable *st, expr_ty e)
     case Bytes_kind:
     case Ellipsis_kind:
     case NameConstant_kind:
+    case Constant_kind:
         /* Nothing to do here. */
         break;
     /* The following exprs can be assignment targets. */
@@ -523,6 +523,110 @@ Return the profiling function set with sys.setprofile.\n\
 See the profiler chapter in the library manual."
 );
 
+static const struct {
+    const char *name;
+    int event;
+} monitor_events[] = {
+    {"call", _PyMonitor_CALL},
+    {"return", _PyMonitor_RETURN},
+    {"line", _PyMonitor_LINE},
+    {"branch", _PyMonitor_BRANCH},
+};
+
+#define NMONITOR_EVENTS \
+    ((int)(sizeof(monitor_events) / sizeof(monitor_events[0])))
+
+static PyObject *
+sys_setmonitor(PyObject *self, PyObject *args)
+{
+    PyObject *code, *events, *callback, *iter, *item;
+    int mask = 0, i;
+
+    if (!PyArg_ParseTuple(args, "O!OO:setmonitor",
+                          &PyCode_Type, &code, &events, &callback))
+        return NULL;
+    iter = PyObject_GetIter(events);
+    if (iter == NULL)
+        return NULL;
+    while ((item = PyIter_Next(iter)) != NULL) {
+        for (i = 0; i < NMONITOR_EVENTS; i++) {
+            if (PyUnicode_Check(item) &&
+                PyUnicode_CompareWithASCIIString(item,
+                                                 monitor_events[i].name) == 0)
+                break;
+        }
+        if (i == NMONITOR_EVENTS) {
+            PyErr_Format(PyExc_ValueError, "unknown event %R", item);
+            Py_DECREF(item);
+            Py_DECREF(iter);
+            return NULL;
+        }
+        mask |= monitor_events[i].event;
+        Py_DECREF(item);
+    }
+    Py_DECREF(iter);
+    if (PyErr_Occurred())
+        return NULL;
+    if (callback == Py_None)
+        mask = 0;
+    else if (mask != 0 && !PyCallable_Check(callback)) {
+        PyErr_SetString(PyExc_TypeError, "callback must be callable");
+        return NULL;
+    }
+    if (_PyCode_SetMonitor((PyCodeObject *)code, mask, callback) < 0)
+        return NULL;
+    Py_RETURN_NONE;
+}
+
+PyDoc_STRVAR(setmonitor_doc,
+"setmonitor(code, events, callback)\n\
+\n\
+Report the events of the frames of a code object by calling\n\
+callback(frame, event, arg).  events is an iterable of event names:\n\
+'call', 'return', 'line' and 'branch'.  Empty events or a None callback\n\
+stop the monitoring of the code object.  Code objects which are not\n\
+monitored run at full speed.  A callback returning sys.monitor_disable\n\
+for a 'line' or 'branch' event is not called again for that location."
+);
+
+static PyObject *
+sys_getmonitor(PyObject *self, PyObject *code)
+{
+    _PyCodeMonitor *mon;
+    PyObject *events, *name;
+    int i;
+
+    if (!PyCode_Check(code)) {
+        PyErr_SetString(PyExc_TypeError, "expected a code object");
+        return NULL;
+    }
+    mon = ((PyCodeObject *)code)->co_monitor;
+    if (mon == NULL)
+        Py_RETURN_NONE;
+    events = PyFrozenSet_New(NULL);
+    if (events == NULL)
+        return NULL;
+    for (i = 0; i < NMONITOR_EVENTS; i++) {
+        if (!(mon->events & monitor_events[i].event))
+            continue;
+        name = PyUnicode_FromString(monitor_events[i].name);
+        if (name == NULL || PySet_Add(events, name) < 0) {
+            Py_XDECREF(name);
+            Py_DECREF(events);
+            return NULL;
+        }
+        Py_DECREF(name);
+    }
+    return Py_BuildValue("NO", events, mon->callback);
+}
+
+PyDoc_STRVAR(getmonitor_doc,
+"getmonitor(code) -> (events, callback) or None\n\
+\n\
+Return the frozenset of events and the callback set with setmonitor()\n\
+for a code object, or None if it is not monitored."
+);
+
 static int _check_interval = 100;
 
 static PyObject *
@@ -600,8 +704,78 @@ PyDoc_STRVAR(getswitchinterval_doc,
 "getswitchinterval() -> current thread switch interval; see setswitchinterval()."
 );
 
+static PyObject *
+sys_setswitchpolicy(PyObject *self, PyObject *args)
+{
+    const char *policy;
+    if (!PyArg_ParseTuple(args, "s:setswitchpolicy", &policy))
+        return NULL;
+    if (strcmp(policy, "interval") == 0)
+        _PyEval_SetSwitchPolicy(_Py_SWITCH_INTERVAL);
+    else if (strcmp(policy, "io") == 0)
+        _PyEval_SetSwitchPolicy(_Py_SWITCH_IO);
+    else {
+        PyErr_Format(PyExc_ValueError,
+                     "unknown switch policy: %R", PyTuple_GET_ITEM(args, 0));
+        return NULL;
+    }
+    Py_INCREF(Py_None);
+    return Py_None;
+}
+
+PyDoc_STRVAR(setswitchpolicy_doc,
+"setswitchpolicy(policy)\n\
+\n\
+Set how the Python interpreter schedules threads waiting for the GIL.\n\
+With 'interval' (the default), a waiting thread asks the running thread\n\
+to switch after the switch interval.  With 'io', a thread coming back\n\
+from a blocking call, such as I/O, asks for the switch at once and gets\n\
+the GIL before the other waiting threads."
+);
+
+static PyObject *
+sys_getswitchpolicy(PyObject *self, PyObject *args)
+{
+    if (_PyEval_GetSwitchPolicy() == _Py_SWITCH_IO)
+        return PyUnicode_FromString("io");
+    return PyUnicode_FromString("interval");
+}
+
+PyDoc_STRVAR(getswitchpolicy_doc,
+"getswitchpolicy() -> current thread switch policy; see setswitchpolicy()."
+);
+
 #endif /* WITH_THREAD */
 
+static PyObject *
+sys_setutf8cache(PyObject *self, PyObject *args)
+{
+    int enabled;
+    if (!PyArg_ParseTuple(args, "p:setutf8cache", &enabled))
+        return NULL;
+    _PyUnicode_SetUTF8Cache(enabled);
+    Py_INCREF(Py_None);
+    return Py_None;
+}
+
+PyDoc_STRVAR(setutf8cache_doc,
+"setutf8cache(enabled)\n\
+\n\
+If enabled is true, the strings decoded from valid UTF-8 keep a copy of\n\
+the data, so that encoding them back to UTF-8 is a copy instead of a\n\
+conversion.  This costs memory for every non-ASCII string decoded."
+);
+
+static PyObject *
+sys_getutf8cache(PyObject *self, PyObject *args)
+{
+    return PyBool_FromLong(_PyUnicode_GetUTF8Cache());
+}
+
+PyDoc_STRVAR(getutf8cache_doc,
+"getutf8cache() -> True if the UTF-8 cache is enabled; see setutf8cache()."
+);
+
 #ifdef WITH_TSC
 static PyObject *
 sys_settscdump(PyObject *self, PyObject *args)
@@ -1146,6 +1320,120 @@ In Py_DEBUG mode, also perform some expensive internal consistency\n\
 checks.\n\
 ");
 
+#ifdef WITH_PYMALLOC
+static PyObject *
+sys_getmallocstats(PyObject *self, PyObject *args)
+{
+    _PyObject_MallocStats stats;
+    PyObject *classes;
+    unsigned int i;
+
+    /* Take the snapshot before allocating the result */
+    _PyObject_GetMallocStats(&stats);
+
+    classes = PyList_New(0);
+    if (classes == NULL)
+        return NULL;
+    for (i = 0; i < stats.nclasses; i++) {
+        size_t nused = stats.classes[i].blocks_used;
+        size_t nfree = stats.classes[i].blocks_free;
+        PyObject *item;
+        int err;
+
+        if (stats.classes[i].pools == 0)
+            continue;
+        item = Py_BuildValue("{snsnsnsnsnsd}",
+                             "size", (Py_ssize_t)stats.classes[i].size,
+                             "pools", (Py_ssize_t)stats.classes[i].pools,
+                             "blocks_used", (Py_ssize_t)nused,
+                             "blocks_free", (Py_ssize_t)nfree,
+                             "arenas", (Py_ssize_t)stats.classes[i].arenas,
+                             "fragmentation",
+                             (double)nfree / (double)(nused + nfree));
+        if (item == NULL) {
+            Py_DECREF(classes);
+            return NULL;
+        }
+        err = PyList_Append(classes, item);
+        Py_DECREF(item);
+        if (err < 0) {
+            Py_DECREF(classes);
+            return NULL;
+        }
+    }
+
+    return Py_BuildValue("{snsnsnsnsN}",
+                         "arenas", (Py_ssize_t)stats.narenas,
+                         "arenas_allocated_total",
+                         (Py_ssize_t)stats.narenas_total,
+                         "arenas_highwater",
+                         (Py_ssize_t)stats.narenas_highwater,
+                         "free_pools", (Py_ssize_t)stats.nfreepools,
+                         "size_classes", classes);
+}
+PyDoc_STRVAR(getmallocstats_doc,
+"_getmallocstats() -> dict\n\
+\n\
+Return a dictionary describing the state of pymalloc's structures:\n\
+arena counters, and a list with the pools, blocks, arenas and\n\
+fragmentation of each size class in use.\n\
+");
+#endif
+
+static PyObject *
+sys_stats_on(PyObject *self, PyObject *args)
+{
+    if (_PyEval_StatsOn() < 0)
+        return NULL;
+    Py_RETURN_NONE;
+}
+PyDoc_STRVAR(stats_on_doc,
+"_stats_on()\n\
+\n\
+Start counting the bytecode instructions run by the interpreter.\n\
+");
+
+static PyObject *
+sys_stats_off(PyObject *self, PyObject *args)
+{
+    _PyEval_StatsOff();
+    Py_RETURN_NONE;
+}
+PyDoc_STRVAR(stats_off_doc,
+"_stats_off()\n\
+\n\
+Stop counting the bytecode instructions, keeping the counts so far.\n\
+");
+
+static PyObject *
+sys_stats_clear(PyObject *self, PyObject *args)
+{
+    _PyEval_StatsClear();
+    Py_RETURN_NONE;
+}
+PyDoc_STRVAR(stats_clear_doc,
+"_stats_clear()\n\
+\n\
+Reset all the counts collected by _stats_on() to zero.\n\
+");
+
+static PyObject *
+sys_stats(PyObject *self, PyObject *args)
+{
+    return _PyEval_GetStats();
+}
+PyDoc_STRVAR(stats_doc,
+"_stats() -> dict or None\n\
+\n\
+Return the statistics collected since _stats_on() was first called,\n\
+or None if it never was.  The dictionary maps 'opcodes' to the count\n\
+of each opcode, 'pairs' to the count of each (opcode, next opcode)\n\
+pair, 'cache' to the inline cache hits and misses, 'specialization'\n\
+to the successes and failures of the adaptive instructions, 'deopts'\n\
+to the deoptimizations of each specialized opcode, and 'code' to the\n\
+calls and opcode counts of each code object run meanwhile.\n\
+");
+
 #ifdef Py_TRACE_REFS
 /* Defined in objects.c because it uses static globals if that file */
 extern PyObject *_Py_GetObjects(PyObject *, PyObject *);
@@ -1240,7 +1528,15 @@ static PyMethodDef sys_methods[] = {
      setswitchinterval_doc},
     {"getswitchinterval",       sys_getswitchinterval, METH_NOARGS,
      getswitchinterval_doc},
+    {"setswitchpolicy",         sys_setswitchpolicy, METH_VARARGS,
+     setswitchpolicy_doc},
+    {"getswitchpolicy",         sys_getswitchpolicy, METH_NOARGS,
+     getswitchpolicy_doc},
 #endif
+    {"setutf8cache",    sys_setutf8cache, METH_VARARGS,
+     setutf8cache_doc},
+    {"getutf8cache",    sys_getutf8cache, METH_NOARGS,
+     getutf8cache_doc},
 #ifdef HAVE_DLOPEN
     {"setdlopenflags", sys_setdlopenflags, METH_VARARGS,
      setdlopenflags_doc},
@@ -1254,9 +1550,19 @@ static PyMethodDef sys_methods[] = {
 #endif
     {"settrace",        sys_settrace, METH_O, settrace_doc},
     {"gettrace",        sys_gettrace, METH_NOARGS, gettrace_doc},
+    {"setmonitor",      sys_setmonitor, METH_VARARGS, setmonitor_doc},
+    {"getmonitor",      sys_getmonitor, METH_O, getmonitor_doc},
     {"call_tracing", sys_call_tracing, METH_VARARGS, call_tracing_doc},
     {"_debugmallocstats", sys_debugmallocstats, METH_NOARGS,
      debugmallocstats_doc},
+#ifdef WITH_PYMALLOC
+    {"_getmallocstats", sys_getmallocstats, METH_NOARGS,
+     getmallocstats_doc},
+#endif
+    {"_stats_on",       sys_stats_on, METH_NOARGS, stats_on_doc},
+    {"_stats_off",      sys_stats_off, METH_NOARGS, stats_off_doc},
+    {"_stats_clear",    sys_stats_clear, METH_NOARGS, stats_clear_doc},
+    {"_stats",          sys_stats, METH_NOARGS, stats_doc},
     {"set_coroutine_wrapper", sys_set_coroutine_wrapper, METH_O,
      set_coroutine_wrapper_doc},
     {"get_coroutine_wrapper", sys_get_coroutine_wrapper, METH_NOARGS,
@@ -1470,6 +1776,7 @@ getsizeof() -- return the size of an object in bytes\n\
 gettrace() -- get the global debug tracing function\n\
 setcheckinterval() -- control how often the interpreter checks for events\n\
 setdlopenflags() -- set the flags to be used for dlopen() calls\n\
+setmonitor() -- report the events of a code object to a callback\n\
 setprofile() -- set the global profiling function\n\
 setrecursionlimit() -- set the max recursion depth for the interpreter\n\
 settrace() -- set the global debug tracing function\n\
@@ -1780,6 +2087,8 @@ _PySys_Init(void)
                         PyUnicode_FromWideChar(Py_GetExecPrefix(), -1));
     SET_SYS_FROM_STRING("maxsize",
                         PyLong_FromSsize_t(PY_SSIZE_T_MAX));
+    SET_SYS_FROM_STRING_BORROW("monitor_disable",
+                               _PyEval_GetMonitorDisable());
     SET_SYS_FROM_STRING("float_info",
                         PyFloat_GetInfo());
     SET_SYS_FROM_STRING("int_info",
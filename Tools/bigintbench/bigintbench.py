@@ -0,0 +1,99 @@
+#!/usr/bin/env python3
+"""Benchmark for the arithmetic of big integers which is not linear time:
+division and the conversions between int and decimal str.
+
+For each number of decimal digits, the time of str(n), int(s) and of the
+division of a 2n-digit int by an n-digit int is printed.  Once an
+operation takes longer than the time limit, it is skipped for the larger
+sizes, so that quadratic implementations don't run for hours.
+"""
+
+import platform
+import random
+import sys
+import time
+from optparse import OptionParser
+
+
+def timeit(func, *args):
+    t0 = time.perf_counter()
+    func(*args)
+    return time.perf_counter() - t0
+
+def best_of(repeat, func, *args):
+    return min(timeit(func, *args) for i in range(repeat))
+
+def random_digits(ndigits, rand):
+    # Built without int <-> str conversions of big numbers, whose time is
+    # what we measure
+    pieces = ['%09d' % rand.randrange(10 ** 9)
+              for i in range(ndigits // 9 + 1)]
+    return str(rand.randrange(1, 10)) + ''.join(pieces)[:ndigits - 1]
+
+def random_int(ndigits, rand):
+    # 3.33 bits per decimal digit
+    nbits = ndigits * 3322 // 1000
+    return rand.getrandbits(nbits) | (1 << (nbits - 1))
+
+
+def run(sizes, repeat, limit):
+    rand = random.Random(42)
+    ops = ["str(n)", "int(s)", "divmod(2n, n)"]
+    skipped = set()
+    print("%10s" % "digits" + "".join("%16s" % op for op in ops))
+    for ndigits in sizes:
+        s = random_digits(ndigits, rand)
+        n = random_int(ndigits, rand)
+        a = random_int(2 * ndigits, rand)
+        b = random_int(ndigits, rand)
+        funcs = [(str, n), (int, s), (divmod, a, b)]
+        line = "%10d" % ndigits
+        for op, (func, *args) in zip(ops, funcs):
+            if op in skipped:
+                line += "%16s" % "-"
+                continue
+            t = best_of(repeat, func, *args)
+            if t > limit:
+                skipped.add(op)
+            line += "%14.4f s" % t
+        print(line)
+        sys.stdout.flush()
+
+
+def main():
+    parser = OptionParser(usage="%prog [options]")
+    parser.add_option("-m", "--max-digits",
+                      action="store", type="int", dest="max_digits",
+                      default=10 ** 7,
+                      help="largest number of decimal digits (default 10**7)")
+    parser.add_option("-r", "--repeat",
+                      action="store", type="int", dest="repeat", default=1,
+                      help="keep the best of this number of runs")
+    parser.add_option("-t", "--time-limit",
+                      action="store", type="float", dest="limit",
+                      default=30.0,
+                      help="don't run an operation on larger sizes once it "
+                           "takes longer than this number of seconds "
+                           "(default 30)")
+    options, args = parser.parse_args()
+    if args:
+        parser.error("unexpected arguments")
+
+    sizes = []
+    ndigits = 1000
+    while ndigits <= options.max_digits:
+        for mult in (1, 3):
+            if ndigits * mult <= options.max_digits:
+                sizes.append(ndigits * mult)
+        ndigits *= 10
+
+    print("== %s %s (%s) ==" % (
+        platform.python_implementation(),
+        platform.python_version(),
+        platform.python_build()[0],
+    ))
+    print()
+    run(sizes, options.repeat, options.limit)
+
+if __name__ == "__main__":
+    main()
@@ -545,6 +545,10 @@ def main():
     parser.add_option("-I", "--switch-interval",
                       action="store", type="float", dest="switch_interval", default=None,
                       help="sys.setswitchinterval() value")
+    parser.add_option("-P", "--switch-policy",
+                      action="store", type="choice", dest="switch_policy",
+                      choices=["interval", "io"], default=None,
+                      help="sys.setswitchpolicy() value")
     parser.add_option("-n", "--num-threads",
                       action="store", type="int", dest="nthreads", default=4,
                       help="max number of threads in tests")
@@ -577,6 +581,8 @@ def main():
         sys.setcheckinterval(options.check_interval)
     if options.switch_interval:
         sys.setswitchinterval(options.switch_interval)
+    if options.switch_policy:
+        sys.setswitchpolicy(options.switch_policy)
 
     print("== %s %s (%s) ==" % (
         platform.python_implementation(),
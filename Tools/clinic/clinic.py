@@ -703,6 +703,11 @@ class CLanguage(Language):
             {c_basename}({self_type}{self_name}, PyObject *args)
             """)
 
+        parser_prototype_fastcall = normalize_snippet("""
+            static PyObject *
+            {c_basename}({self_type}{self_name}, PyObject *const *args, Py_ssize_t nargs, PyObject *kwnames)
+            """)
+
         # parser_body_fields remembers the fields passed in to the
         # previous call to parser_body. this is used for an awful hack.
         parser_body_fields = ()
@@ -809,45 +814,79 @@ class CLanguage(Language):
             # and nothing but normal objects:
             # PyArg_UnpackTuple!
 
-            flags = "METH_VARARGS"
-            parser_prototype = parser_prototype_varargs
+            if new_or_init:
+                flags = "METH_VARARGS"
+                parser_prototype = parser_prototype_varargs
 
-            parser_definition = parser_body(parser_prototype, normalize_snippet("""
-                if (!PyArg_UnpackTuple(args, "{name}",
-                    {unpack_min}, {unpack_max},
-                    {parse_arguments}))
-                    goto exit;
-                """, indent=4))
+                parser_definition = parser_body(parser_prototype, normalize_snippet("""
+                    if (!PyArg_UnpackTuple(args, "{name}",
+                        {unpack_min}, {unpack_max},
+                        {parse_arguments}))
+                        goto exit;
+                    """, indent=4))
+            else:
+                # METH_FASTCALL: _PyArg_UnpackStack!
+                flags = "METH_FASTCALL"
+                parser_prototype = parser_prototype_fastcall
+
+                parser_definition = parser_body(parser_prototype, normalize_snippet("""
+                    if (!_PyArg_UnpackStack(args, nargs, "{name}",
+                        {unpack_min}, {unpack_max},
+                        {parse_arguments}))
+                        goto exit;
+
+                    if (!_PyArg_NoStackKeywords("{name}", kwnames))
+                        goto exit;
+                    """, indent=4))
 
         elif positional:
             # positional-only, but no option groups
             # we only need one call to PyArg_ParseTuple
 
-            flags = "METH_VARARGS"
-            parser_prototype = parser_prototype_varargs
+            if new_or_init:
+                flags = "METH_VARARGS"
+                parser_prototype = parser_prototype_varargs
 
-            parser_definition = parser_body(parser_prototype, normalize_snippet("""
-                if (!PyArg_ParseTuple(args, "{format_units}:{name}",
-                    {parse_arguments}))
-                    goto exit;
-                """, indent=4))
+                parser_definition = parser_body(parser_prototype, normalize_snippet("""
+                    if (!PyArg_ParseTuple(args, "{format_units}:{name}",
+                        {parse_arguments}))
+                        goto exit;
+                    """, indent=4))
+            else:
+                # METH_FASTCALL: _PyArg_ParseStack!
+                flags = "METH_FASTCALL"
+                parser_prototype = parser_prototype_fastcall
+
+                parser_definition = parser_body(parser_prototype, normalize_snippet("""
+                    if (!_PyArg_ParseStack(args, nargs, "{format_units}:{name}",
+                        {parse_arguments}))
+                        goto exit;
+
+                    if (!_PyArg_NoStackKeywords("{name}", kwnames))
+                        goto exit;
+                    """, indent=4))
 
         else:
             # positional-or-keyword arguments
-            flags = "METH_VARARGS|METH_KEYWORDS"
-
-            parser_prototype = parser_prototype_keyword
-
-            body = normalize_snippet("""
-                if (!PyArg_ParseTupleAndKeywords(args, kwargs, "{format_units}:{name}", _keywords,
-                    {parse_arguments}))
-                    goto exit;
-            """, indent=4)
-            parser_definition = parser_body(parser_prototype, normalize_snippet("""
-                if (!PyArg_ParseTupleAndKeywords(args, kwargs, "{format_units}:{name}", _keywords,
-                    {parse_arguments}))
-                    goto exit;
-                """, indent=4))
+            if new_or_init:
+                flags = "METH_VARARGS|METH_KEYWORDS"
+                parser_prototype = parser_prototype_keyword
+
+                parser_definition = parser_body(parser_prototype, normalize_snippet("""
+                    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "{format_units}:{name}", _keywords,
+                        {parse_arguments}))
+                        goto exit;
+                    """, indent=4))
+            else:
+                # METH_FASTCALL: _PyArg_ParseStackAndKeywords!
+                flags = "METH_FASTCALL"
+                parser_prototype = parser_prototype_fastcall
+
+                parser_definition = parser_body(parser_prototype, normalize_snippet("""
+                    if (!_PyArg_ParseStackAndKeywords(args, nargs, kwnames, "{format_units}:{name}", _keywords,
+                        {parse_arguments}))
+                        goto exit;
+                    """, indent=4))
             parser_definition = insert_keywords(parser_definition)
 
 
@@ -866,6 +905,7 @@ class CLanguage(Language):
             fields = list(parser_body_fields)
             parses_positional = 'METH_NOARGS' not in flags
             parses_keywords = 'METH_KEYWORDS' in flags
+            assert 'METH_FASTCALL' not in flags
             if parses_keywords:
                 assert parses_positional
 
@@ -0,0 +1,149 @@
+#!/usr/bin/env python3
+"""Benchmark for the memory shared by a parent and its forked workers.
+
+The parent builds a dataset of small dicts, then forks workers which scan
+it and run a garbage collection.  Reading an object writes to its reference
+count, and a collection writes to the GC header of every tracked object, so
+each worker ends up copying the pages of the dataset it touched.  For each
+way of preparing the dataset before the fork, the memory which became
+private to a worker during the scan (Private_Dirty in /proc/self/smaps) is
+printed:
+
+    none        nothing is done
+    freeze      gc.freeze(): collections no longer touch the dataset
+    immortal    gc.immortalize_heap(): reference counts no longer change
+                either; only in builds configured with
+                --with-immortal-objects
+
+Linux only.
+"""
+
+import gc
+import os
+import platform
+import sys
+from optparse import OptionParser
+
+MODES = ["none", "freeze", "immortal"]
+
+
+def private_dirty():
+    """Return the private dirty memory of this process, in kB."""
+    try:
+        f = open("/proc/self/smaps_rollup")
+    except FileNotFoundError:
+        f = open("/proc/self/smaps")
+    total = 0
+    with f:
+        for line in f:
+            if line.startswith("Private_Dirty:"):
+                total += int(line.split()[1])
+    return total
+
+def rss():
+    """Return the resident memory of this process, in kB."""
+    with open("/proc/self/statm") as f:
+        return int(f.read().split()[1]) * os.sysconf("SC_PAGE_SIZE") // 1024
+
+def make_dataset(size):
+    return [{"id": i,
+             "name": "name%d" % i,
+             "score": i * 0.5,
+             "tags": ("tag%d" % (i % 100), "extra%d" % i)}
+            for i in range(size)]
+
+def scan(dataset):
+    total = 0
+    for record in dataset:
+        for key, value in record.items():
+            total += len(key)
+        total += len(record["tags"][1])
+    return total
+
+def worker(dataset, wfd):
+    before = private_dirty()
+    scan(dataset)
+    gc.collect()
+    os.write(wfd, b"%d\n" % (private_dirty() - before))
+
+def run_mode(mode, size, nworkers, wfd):
+    # Run in a child of the benchmark so that every mode starts from a
+    # fresh heap: immortalize_heap() cannot be undone.
+    base = rss()
+    dataset = make_dataset(size)
+    gc.collect()
+    dataset_kb = rss() - base
+    if mode == "freeze":
+        gc.freeze()
+    elif mode == "immortal":
+        gc.immortalize_heap()
+
+    copied = []
+    for i in range(nworkers):
+        r, w = os.pipe()
+        pid = os.fork()
+        if pid == 0:
+            os.close(r)
+            try:
+                worker(dataset, w)
+            finally:
+                os._exit(0)
+        os.close(w)
+        with os.fdopen(r, "rb") as f:
+            copied.append(int(f.read()))
+        os.waitpid(pid, 0)
+    mean = sum(copied) / len(copied)
+    os.write(wfd, b"%-10s %12d %12d %9.1f%%\n" % (
+        mode.encode(), dataset_kb, mean, 100.0 * mean / dataset_kb))
+
+def run(modes, size, nworkers):
+    print("%-10s %12s %12s %10s" % ("mode", "dataset kB", "copied kB",
+                                    "copied"))
+    for mode in modes:
+        r, w = os.pipe()
+        pid = os.fork()
+        if pid == 0:
+            os.close(r)
+            try:
+                run_mode(mode, size, nworkers, w)
+            finally:
+                os._exit(0)
+        os.close(w)
+        with os.fdopen(r, "rb") as f:
+            sys.stdout.write(f.read().decode())
+        sys.stdout.flush()
+        os.waitpid(pid, 0)
+
+
+def main():
+    parser = OptionParser(usage="%prog [options] [mode ...]")
+    parser.add_option("-n", "--size",
+                      action="store", type="int", dest="size",
+                      default=10 ** 5,
+                      help="number of records in the dataset "
+                           "(default 10**5)")
+    parser.add_option("-w", "--workers",
+                      action="store", type="int", dest="workers", default=4,
+                      help="number of forked workers (default 4)")
+    options, args = parser.parse_args()
+    for mode in args:
+        if mode not in MODES:
+            parser.error("unknown mode %r, choose from %s"
+                         % (mode, ", ".join(MODES)))
+    modes = args or MODES
+    if not hasattr(gc, "immortalize_heap"):
+        if "immortal" in args:
+            parser.error("this build has no immortal objects "
+                         "(configure --with-immortal-objects)")
+        modes = [mode for mode in modes if mode != "immortal"]
+
+    print("== %s %s (%s) ==" % (
+        platform.python_implementation(),
+        platform.python_version(),
+        platform.python_build()[0],
+    ))
+    print()
+    run(modes, options.size, options.workers)
+
+if __name__ == "__main__":
+    main()
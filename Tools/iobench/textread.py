@@ -0,0 +1,104 @@
+#!/usr/bin/env python3
+"""Benchmark for reading UTF-8 text through io.TextIOWrapper.
+
+TextIOWrapper decodes the data it reads in chunks of its _CHUNK_SIZE
+(8192 bytes by default), so the speed of reading a text file depends on the
+speed of decoding chunks of that size, not of decoding the whole file.
+
+The text is read from an in-memory buffer, to leave the speed of the disk
+out, with read(), read(4096) and by iterating over lines.  For each kind of
+text, the throughput in MB/s of the UTF-8 data is printed.
+"""
+
+import io
+import platform
+import time
+from optparse import OptionParser
+
+# Lines of text whose characters are mostly of a given width
+KINDS = [
+    ("ascii", "The quick brown fox jumps over the lazy dog, again and again."),
+    ("latin1", "Le coeur déçu mais l'âme plutôt naïve, Louÿs rêva d'été."),
+    ("cjk", "日本語のテキストをデコードする速度を測定します。漢字と仮名。"),
+    ("mixed", "Hello 世界, ça va? Ответ: 42 — résumé, naïve, 你好."),
+    ("emoji", "😀 😃 😄 😁 😆 😅 😂 🤣 🙂 🙃 😉 😊 😇 🥰 😍"),
+]
+LINES = dict(KINDS)
+
+
+def make_data(kind, size):
+    line = (LINES[kind] + "\n").encode("utf-8")
+    return line * (size // len(line) + 1)
+
+def read_whole(f):
+    f.read()
+
+def read_chunks(f):
+    while f.read(4096):
+        pass
+
+def read_lines(f):
+    for line in f:
+        pass
+
+TESTS = [
+    ("read()", read_whole),
+    ("read(4096)", read_chunks),
+    ("lines", read_lines),
+]
+
+def run_test(func, data, chunk_size, duration):
+    best = None
+    start = time.time()
+    while time.time() - start < duration:
+        f = io.TextIOWrapper(io.BytesIO(data), encoding="utf-8")
+        if chunk_size:
+            f._CHUNK_SIZE = chunk_size
+        t = time.perf_counter()
+        func(f)
+        t = time.perf_counter() - t
+        if best is None or t < best:
+            best = t
+    return len(data) / best / 1e6
+
+def run(kinds, size, chunk_size, duration):
+    print("%-8s" % "text" + "".join("%12s" % name for name, _ in TESTS))
+    for kind in kinds:
+        data = make_data(kind, size)
+        results = [run_test(func, data, chunk_size, duration)
+                   for _, func in TESTS]
+        print("%-8s" % kind + "".join("%7.1f MB/s" % r for r in results))
+
+
+def main():
+    parser = OptionParser(usage="%prog [options] [text ...]")
+    parser.add_option("-s", "--size",
+                      action="store", type="int", dest="size",
+                      default=1024 ** 2,
+                      help="size of the UTF-8 data in bytes (default 1 MiB)")
+    parser.add_option("-c", "--chunk-size",
+                      action="store", type="int", dest="chunk_size",
+                      default=None,
+                      help="chunk size of the TextIOWrapper "
+                           "(default: its _CHUNK_SIZE)")
+    parser.add_option("-d", "--duration",
+                      action="store", type="float", dest="duration",
+                      default=1.0,
+                      help="seconds to run each test for (default 1.0)")
+    options, args = parser.parse_args()
+    for kind in args:
+        if kind not in LINES:
+            parser.error("unknown text %r, choose from %s"
+                         % (kind, ", ".join(name for name, _ in KINDS)))
+
+    print("== %s %s (%s) ==" % (
+        platform.python_implementation(),
+        platform.python_version(),
+        platform.python_build()[0],
+    ))
+    print()
+    run(args or [kind for kind, _ in KINDS], options.size, options.chunk_size,
+        options.duration)
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,91 @@
+from pybench import Test
+
+# Every call of a Python function and every resumption of a generator runs
+# a frame through the interpreter's frame evaluation function.  These tests
+# do little else, so comparing them against an interpreter without the
+# eval_frame hook (pybench -c) shows what the indirection costs when no
+# hook is installed.
+# GeneratorCreations also creates a generator, and so a frame which the
+# code object's zombie frame can't serve, for each call.
+
+def _empty():
+    pass
+
+def _calls():
+
+    _empty(); _empty(); _empty(); _empty(); _empty()
+    _empty(); _empty(); _empty(); _empty(); _empty()
+    _empty(); _empty(); _empty(); _empty(); _empty()
+    _empty(); _empty(); _empty(); _empty(); _empty()
+
+def _no_calls():
+    pass
+
+def _gen():
+    while True:
+        yield
+
+def _gen_once(x):
+    yield x
+
+class FrameEvaluations(Test):
+
+    version = 2.0
+    operations = 20
+    rounds = 100000
+
+    def test(self):
+
+        f = _calls
+        for i in range(self.rounds):
+            f()
+
+    def calibrate(self):
+
+        f = _no_calls
+        for i in range(self.rounds):
+            f()
+
+class GeneratorResumptions(Test):
+
+    version = 2.0
+    operations = 20
+    rounds = 100000
+
+    def test(self):
+
+        g = _gen()
+        n = next
+        for i in range(self.rounds):
+            n(g); n(g); n(g); n(g); n(g)
+            n(g); n(g); n(g); n(g); n(g)
+            n(g); n(g); n(g); n(g); n(g)
+            n(g); n(g); n(g); n(g); n(g)
+
+    def calibrate(self):
+
+        g = _gen()
+        n = next
+        for i in range(self.rounds):
+            pass
+
+class GeneratorCreations(Test):
+
+    version = 2.0
+    operations = 10
+    rounds = 50000
+
+    def test(self):
+
+        g = _gen_once
+        n = next
+        for i in range(self.rounds):
+            n(g(i)); n(g(i)); n(g(i)); n(g(i)); n(g(i))
+            n(g(i)); n(g(i)); n(g(i)); n(g(i)); n(g(i))
+
+    def calibrate(self):
+
+        g = _gen_once
+        n = next
+        for i in range(self.rounds):
+            pass
@@ -0,0 +1,96 @@
+from pybench import Test
+
+# Module level names looked up by the tests below.  The lookups are done
+# in module level functions which are called once per round, as in a
+# typical program where a hot function is called over and over again.
+
+_a = 1
+_b = 2
+_c = 3
+
+def _helper():
+    pass
+
+def _global_lookups():
+
+    _a; _b; _c; _helper
+    _a; _b; _c; _helper
+    _a; _b; _c; _helper
+    _a; _b; _c; _helper
+    _a; _b; _c; _helper
+
+def _builtin_lookups():
+
+    len; isinstance; str; int
+    len; isinstance; str; int
+    len; isinstance; str; int
+    len; isinstance; str; int
+    len; isinstance; str; int
+
+def _no_lookups():
+    pass
+
+class GlobalLookups(Test):
+
+    version = 2.0
+    operations = 20
+    rounds = 200000
+
+    def test(self):
+
+        f = _global_lookups
+        for i in range(self.rounds):
+            f()
+
+    def calibrate(self):
+
+        f = _no_lookups
+        for i in range(self.rounds):
+            f()
+
+class BuiltinLookups(Test):
+
+    version = 2.0
+    operations = 20
+    rounds = 200000
+
+    def test(self):
+
+        f = _builtin_lookups
+        for i in range(self.rounds):
+            f()
+
+    def calibrate(self):
+
+        f = _no_lookups
+        for i in range(self.rounds):
+            f()
+
+class GlobalCallLookups(Test):
+
+    version = 2.0
+    operations = 10
+    rounds = 100000
+
+    def test(self):
+
+        l = [1, 2, 3]
+
+        def f(l=l):
+            len(l); isinstance(l, list); _helper()
+            len(l); isinstance(l, list); _helper()
+            len(l); isinstance(l, list); _helper()
+            len(l)
+
+        for i in range(self.rounds):
+            f()
+
+    def calibrate(self):
+
+        l = [1, 2, 3]
+
+        def f(l=l):
+            pass
+
+        for i in range(self.rounds):
+            f()
@@ -21,6 +21,8 @@ from Arithmetic import *
 from Calls import *
 from Constructs import *
 from Lookups import *
+from Globals import *
+from FrameEval import *
 from Instances import *
 try:
     from NewInstances import *
@@ -47,6 +47,9 @@ def main(opcode_py, outfile='Include/opcode.h'):
             if name == 'POP_EXCEPT': # Special entry for HAVE_ARGUMENT
                 fobj.write("#define %-23s %3d\n" %
                             ('HAVE_ARGUMENT', opcode['HAVE_ARGUMENT']))
+        fobj.write("\n    /* Specialized instructions, see Python/ceval.c */\n")
+        for name, op in opcode['_specialized_instructions']:
+            fobj.write("#define %-23s %3d\n" % (name, op))
         fobj.write(footer)
 
 
@@ -0,0 +1,127 @@
+#! /usr/bin/env python3
+
+"""
+Print a report of the bytecode statistics collected by sys._stats_on().
+
+Run a script with the statistics enabled and report them when it exits:
+
+$ ./python Tools/scripts/summarize_stats.py [-n N] the_script.py --args
+
+or collect them around the interesting part of a workload and pass the
+result of sys._stats() to report():
+
+    import sys
+    sys.path.append('<python_srcdir>/Tools/scripts')
+    import summarize_stats
+
+    sys._stats_on()
+    workload()
+    sys._stats_off()
+    summarize_stats.report(sys._stats())
+
+The report lists the most frequent opcodes and opcode pairs, the hit
+ratio of each inline cache, the specialization successes, failures and
+deoptimizations of the adaptive instructions, and the code objects which
+ran the most instructions.
+"""
+
+import argparse
+import opcode
+import runpy
+import sys
+
+opname = list(opcode.opname)
+for _name, _op in opcode._specialized_instructions:
+    opname[_op] = _name
+# The first opcode of a pair is 0 when the second one started a frame
+opname[0] = "<frame start>"
+
+
+def _percent(part, total):
+    if not total:
+        return 0.0
+    return 100.0 * part / total
+
+
+def _code_name(code):
+    return "%s (%s:%d)" % (code.co_name, code.co_filename,
+                           code.co_firstlineno)
+
+
+def report(stats, file=None, limit=20):
+    """Print the statistics returned by sys._stats() to file, showing at
+    most limit entries in the opcode, pair and code object tables."""
+    if file is None:
+        file = sys.stdout
+    if stats is None:
+        print("No statistics: sys._stats_on() was never called", file=file)
+        return
+
+    total = sum(stats['opcodes'].values())
+    print("Instructions run: %d" % total, file=file)
+
+    print("\nMost frequent opcodes:", file=file)
+    counts = sorted(stats['opcodes'].items(), key=lambda item: -item[1])
+    cumulative = 0
+    for op, count in counts[:limit]:
+        cumulative += count
+        print("  %-28s %12d %6.2f%% %6.2f%%"
+              % (opname[op], count, _percent(count, total),
+                 _percent(cumulative, total)), file=file)
+
+    print("\nMost frequent opcode pairs:", file=file)
+    pairs = sorted(stats['pairs'].items(), key=lambda item: -item[1])
+    for (first, second), count in pairs[:limit]:
+        print("  %-28s %-28s %12d %6.2f%%"
+              % (opname[first], opname[second], count,
+                 _percent(count, total)), file=file)
+
+    if stats['cache']:
+        print("\nInline caches:", file=file)
+        for op, cache in sorted(stats['cache'].items()):
+            lookups = cache['hits'] + cache['misses']
+            print("  %-28s %12d hits %12d misses %6.2f%% hit ratio"
+                  % (opname[op], cache['hits'], cache['misses'],
+                     _percent(cache['hits'], lookups)), file=file)
+
+    if stats['specialization'] or stats['deopts']:
+        print("\nSpecialization:", file=file)
+        for op, spec in sorted(stats['specialization'].items()):
+            print("  %-28s %12d success %12d failure"
+                  % (opname[op], spec['success'], spec['failure']),
+                  file=file)
+        for op, count in sorted(stats['deopts'].items()):
+            print("  %-28s %12d deopts" % (opname[op], count), file=file)
+
+    print("\nCode objects running the most instructions:", file=file)
+    code = sorted(stats['code'].values(),
+                  key=lambda counts: -sum(counts['opcodes'].values()))
+    for counts in code[:limit]:
+        run = sum(counts['opcodes'].values())
+        print("  %12d %6.2f%% %10d calls  %s"
+              % (run, _percent(run, total), counts['calls'],
+                 _code_name(counts['code'])), file=file)
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description="Run a script and report its bytecode statistics")
+    parser.add_argument('-n', '--limit', type=int, default=20,
+                        help="number of entries in each table (default: 20)")
+    parser.add_argument('script', help="the script to run")
+    parser.add_argument('args', nargs=argparse.REMAINDER,
+                        help="the arguments of the script")
+    args = parser.parse_args()
+
+    sys.argv = [args.script] + args.args
+    sys._stats_clear()
+    sys._stats_on()
+    try:
+        runpy.run_path(args.script, run_name='__main__')
+    finally:
+        sys._stats_off()
+        report(sys._stats(), file=sys.stderr, limit=args.limit)
+
+
+if __name__ == '__main__':
+    main()
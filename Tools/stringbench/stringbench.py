@@ -1354,6 +1354,83 @@ def format_with_dict(STR):
         s % d
 
 
+#### Search long texts, like scanning logs
+
+_log_lines = []
+for i in range(1000):
+    _log_lines.append("2015-05-31 12:%02d:%02d INFO [worker-%d] "
+                      "GET /api/v1/items/%d handled in %d ms" %
+                      (i // 60 % 60, i % 60, i % 8, i * 7919 % 100000, i % 97))
+log_text = "\n".join(_log_lines)
+del _log_lines
+
+@bench('"ERROR" in log_text', "search a 77 KB log", 100)
+def in_test_log_no_match(STR):
+    s1 = STR(log_text)
+    s2 = STR("ERROR")
+    for x in _RANGE_100:
+        s2 in s1
+
+@bench('log_text.find("handled in 100 ms")', "search a 77 KB log", 100)
+def find_test_log_no_match(STR):
+    s1 = STR(log_text)
+    s2 = STR("handled in 100 ms")
+    s1_find = s1.find
+    for x in _RANGE_100:
+        s1_find(s2)
+
+@bench('log_text.find("/items/39810 ")', "search a 77 KB log", 100)
+def find_test_log_late_match(STR):
+    s1 = STR(log_text)
+    s2 = STR("/items/39810 ")
+    s1_find = s1.find
+    for x in _RANGE_100:
+        s1_find(s2)
+
+@bench('log_text.count("[worker-3]")', "search a 77 KB log", 100)
+def count_test_log(STR):
+    s1 = STR(log_text)
+    s2 = STR("[worker-3]")
+    s1_count = s1.count
+    for x in _RANGE_100:
+        s1_count(s2)
+
+@bench('log_text.split("GET ")', "search a 77 KB log", 100)
+def split_test_log(STR):
+    s1 = STR(log_text)
+    s2 = STR("GET ")
+    s1_split = s1.split
+    for x in _RANGE_100:
+        s1_split(s2)
+
+@bench('log_text.replace("INFO", "DEBUG")', "search a 77 KB log", 100)
+def replace_test_log(STR):
+    s1 = STR(log_text)
+    s2 = STR("INFO")
+    s3 = STR("DEBUG")
+    s1_replace = s1.replace
+    for x in _RANGE_100:
+        s1_replace(s2, s3)
+
+# Quadratic for Boyer-Moore-Horspool: each position matches half the needle
+@bench('s="A"*500; ("A"*100000).find(s+"B"+s)',
+       "search worst case, 1001 characters", 10)
+def find_test_worst_case(STR):
+    s1 = STR("A" * 100000)
+    s2 = STR("A" * 500 + "B" + "A" * 500)
+    s1_find = s1.find
+    for x in _RANGE_10:
+        s1_find(s2)
+
+@bench('s="A"*500; ("A"*100000).count(s+"B"+s)',
+       "search worst case, 1001 characters", 10)
+def count_test_worst_case(STR):
+    s1 = STR("A" * 100000)
+    s2 = STR("A" * 500 + "B" + "A" * 500)
+    s1_count = s1.count
+    for x in _RANGE_10:
+        s1_count(s2)
+
 #### Upper- and lower- case conversion
 
 @bench('("Where in the world is Carmen San Deigo?"*10).lower()',
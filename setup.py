@@ -622,8 +622,12 @@ class PyBuildExt(build_ext):
         exts.append( Extension('_testimportmultiple', ['_testimportmultiple.c']) )
         # Test multi-phase extension module init (PEP 489)
         exts.append( Extension('_testmultiphase', ['_testmultiphase.c']) )
+        # Test the frame evaluation hook (PyInterpreterState.eval_frame)
+        exts.append( Extension('_testframeeval', ['_testframeevalmodule.c']) )
         # profiler (_lsprof is for cProfile.py)
         exts.append( Extension('_lsprof', ['_lsprof.c', 'rotatingtree.c']) )
+        # sampling profiler (_sampleprof is for sampleprof.py)
+        exts.append( Extension('_sampleprof', ['_sampleprof.c']) )
         # static Unicode character database
         exts.append( Extension('unicodedata', ['unicodedata.c']) )
         # _opcode module